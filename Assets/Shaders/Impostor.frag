@@ -0,0 +1,112 @@
+#version 330 core
+
+// Constants
+#define MAX_DIR_LIGHTS 4
+#define MAX_POINT_LIGHTS 8
+#define MAX_SPOT_LIGHTS 8
+
+// Structs
+struct DirectionalLight {
+    vec3 color;
+    float intensity;
+    vec3 direction;
+};
+
+struct PointLight {
+    vec3 color;
+    float intensity;
+    vec3 position;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct SpotLight {
+    vec3 color;
+    float intensity;
+    vec3 position;
+    vec3 direction;
+    float innerCutoff;
+    float outerCutoff;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+// Input
+in vec2 TexCoord;
+in vec3 FragPos;
+in vec3 DepthAxis;
+in mat3 NormalMatrix;
+
+// Output
+out vec4 FragColor;
+
+// Uniforms
+uniform mat4 u_ViewMatrix;
+uniform mat4 u_ProjectionMatrix;
+
+uniform sampler2D u_ImpostorAlbedo;
+uniform sampler2D u_ImpostorNormalDepth;
+uniform vec3 u_ImpostorAmbient;
+
+uniform DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
+uniform PointLight u_PointLights[MAX_POINT_LIGHTS];
+uniform SpotLight u_SpotLights[MAX_SPOT_LIGHTS];
+uniform int u_DirLightCount;
+uniform int u_PointLightCount;
+uniform int u_SpotLightCount;
+
+void main()
+{
+    vec4 albedo = texture(u_ImpostorAlbedo, TexCoord);
+    if (albedo.a < 0.5) {
+        discard;
+    }
+
+    // Empty texels are black with zero coverage, so mipmaps come out premultiplied.
+    vec3 diffuseColor = albedo.rgb / albedo.a;
+
+    vec4 normalDepth = texture(u_ImpostorNormalDepth, TexCoord);
+    vec3 norm = normalize(NormalMatrix * (normalDepth.rgb * 2.0 - 1.0));
+
+    // Depth 0 is the front of the bounding sphere, 0.5 the quad, 1 its back.
+    vec3 position = FragPos + DepthAxis * (1.0 - 2.0 * normalDepth.a);
+
+    // Diffuse only, the atlas keeps no specular.
+    vec3 result = u_ImpostorAmbient * diffuseColor;
+
+    for (int i = 0; i < u_DirLightCount; i++)
+    {
+        DirectionalLight light = u_DirLights[i];
+        vec3 radiance = light.color * light.intensity;
+        result += radiance * (u_ImpostorAmbient + max(dot(norm, normalize(-light.direction)), 0.0)) * diffuseColor;
+    }
+
+    for (int i = 0; i < u_PointLightCount; i++)
+    {
+        PointLight light = u_PointLights[i];
+        float distance = length(light.position - position);
+        float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+        vec3 radiance = light.color * light.intensity * attenuation;
+        result += radiance * (u_ImpostorAmbient + max(dot(norm, normalize(light.position - position)), 0.0)) * diffuseColor;
+    }
+
+    for (int i = 0; i < u_SpotLightCount; i++)
+    {
+        SpotLight light = u_SpotLights[i];
+        vec3 lightDir = normalize(light.position - position);
+        float distance = length(light.position - position);
+        float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+        float theta = dot(lightDir, normalize(-light.direction));
+        float intensity = clamp((theta - light.outerCutoff) / (light.innerCutoff - light.outerCutoff), 0.0, 1.0);
+        vec3 radiance = light.color * light.intensity;
+        result += radiance * (u_ImpostorAmbient + max(dot(norm, lightDir), 0.0) * attenuation * intensity) * diffuseColor;
+    }
+
+    FragColor = vec4(result, 1.0);
+
+    // The quad is flat, the depth of the surface it shows comes from the atlas.
+    vec4 clip = u_ProjectionMatrix * u_ViewMatrix * vec4(position, 1.0);
+    gl_FragDepth = clamp(clip.z / clip.w * 0.5 + 0.5, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#version 330 core
+
+// Input
+layout(location = 0) in vec2 aCorner;       // quad corner in [-1, 1]
+layout(location = 1) in mat4 aModelMatrix;  // per instance, locations 1-4
+
+// Output
+out vec2 TexCoord;
+out vec3 FragPos;
+out vec3 DepthAxis;     // world-space offset from the quad to the front of the bounding sphere
+out mat3 NormalMatrix;
+
+// Uniforms
+uniform mat4 u_ViewMatrix;
+uniform mat4 u_ProjectionMatrix;
+uniform vec3 u_CameraPos;
+
+uniform int u_ImpostorFrames;
+uniform vec3 u_ImpostorCenter;
+uniform float u_ImpostorRadius;
+
+// Functions, Y is the pole (see Impostor::OctahedralDecode)
+vec2 SignNotZero(vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec3 OctahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0)
+        n.xz = (1.0 - abs(n.zx)) * SignNotZero(n.xz);
+    return normalize(n);
+}
+
+vec2 OctahedralEncode(vec3 d)
+{
+    d /= abs(d.x) + abs(d.y) + abs(d.z);
+    return d.y >= 0.0 ? d.xz : (1.0 - abs(d.zx)) * SignNotZero(d.xz);
+}
+
+void main()
+{
+    // The view direction in model space picks the frame, the quad is placed where that frame was rendered.
+    vec3 toCamera = vec3(inverse(aModelMatrix) * vec4(u_CameraPos, 1.0)) - u_ImpostorCenter;
+    if (dot(toCamera, toCamera) < 1e-8)
+        toCamera = vec3(0.0, 1.0, 0.0);
+
+    float frames = float(u_ImpostorFrames);
+    vec2 frame = clamp(floor((OctahedralEncode(normalize(toCamera)) * 0.5 + 0.5) * frames), 0.0, frames - 1.0);
+    vec3 direction = OctahedralDecode((frame + 0.5) / frames * 2.0 - 1.0);
+
+    // Same basis as the lookAt of ImpostorBaker::Bake.
+    vec3 up = abs(direction.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right = normalize(cross(-direction, up));
+    vec3 quadUp = cross(right, -direction);
+
+    vec3 position = u_ImpostorCenter + (aCorner.x * right + aCorner.y * quadUp) * u_ImpostorRadius;
+
+    TexCoord = (frame + aCorner * 0.5 + 0.5) / frames;
+    FragPos = vec3(aModelMatrix * vec4(position, 1.0));
+    DepthAxis = mat3(aModelMatrix) * direction * u_ImpostorRadius;
+    NormalMatrix = transpose(inverse(mat3(aModelMatrix)));
+
+    gl_Position = u_ProjectionMatrix * u_ViewMatrix * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,71 @@
+#version 330 core
+
+// Renders one impostor frame, paired with Main.vert (model matrix = model space, see ImpostorBaker).
+// Features (injected by ShaderManager::LoadPermutations)
+// HAS_DIFFUSE_TEXTURE, HAS_NORMAL_TEXTURE, HAS_OPACITY_TEXTURE
+
+// Structs
+struct Material {
+    vec3 diffuseColor;
+
+#ifdef HAS_DIFFUSE_TEXTURE
+    sampler2D diffuseTexture;
+#endif
+#ifdef HAS_NORMAL_TEXTURE
+    sampler2D normalTexture;
+#endif
+#ifdef HAS_OPACITY_TEXTURE
+    sampler2D opacityTexture;
+#endif
+};
+
+// Input
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+#ifdef HAS_NORMAL_TEXTURE
+in mat3 TBN;
+#endif
+
+// Output
+layout(location = 0) out vec4 Albedo;       // rgb = albedo, a = coverage
+layout(location = 1) out vec4 NormalDepth;  // rgb = model-space normal * 0.5 + 0.5, a = depth
+
+// Uniforms
+uniform Material u_Material;
+
+void main()
+{
+#ifdef HAS_DIFFUSE_TEXTURE
+    vec4 texColor = texture(u_Material.diffuseTexture, TexCoord);
+#else
+    vec4 texColor = vec4(u_Material.diffuseColor, 1.0);
+#endif
+
+#ifdef HAS_OPACITY_TEXTURE
+    float opacity = texture(u_Material.opacityTexture, TexCoord).r;
+#else
+    float opacity = texColor.a;
+#endif
+
+    // Impostors are alpha tested, anything half transparent counts as solid.
+    if (opacity < 0.5) {
+        discard;
+    }
+
+#ifdef HAS_NORMAL_TEXTURE
+    vec3 norm = normalize(TBN * (texture(u_Material.normalTexture, TexCoord).rgb * 2.0 - 1.0));
+#else
+    vec3 norm = normalize(Normal);
+#endif
+
+    // Double-sided: a back face seen through a gap faces the frame.
+    if (!gl_FrontFacing) {
+        norm = -norm;
+    }
+
+    Albedo = vec4(texColor.rgb, 1.0);
+
+    // The projection is orthographic, so window depth is already linear over the bounding sphere.
+    NormalDepth = vec4(norm * 0.5 + 0.5, gl_FragCoord.z);
+}
\ No newline at end of file
@@ -1,12 +1,15 @@
 #version 330 core
 
-// Constants
-#define RM_DEFAULT 0
-#define RM_WIREFRAME 1
+// Features (injected by ShaderManager::LoadPermutations)
+// HAS_DIFFUSE_TEXTURE, HAS_SPECULAR_TEXTURE, HAS_EMISSIVE_TEXTURE,
+// HAS_NORMAL_TEXTURE, HAS_OPACITY_TEXTURE, HAS_LIGHTMAP, BAKED_LIGHTING, RENDER_WIREFRAME
 
+// Constants
 #define MAX_DIR_LIGHTS 4
 #define MAX_POINT_LIGHTS 8
 #define MAX_SPOT_LIGHTS 8
+#define SHADOW_ATLAS_LAYER 1.0      // static and dynamic casters, see ShadowAtlas
+#define SHADOW_NORMAL_OFFSET 0.02   // world units
 
 // Structs
 struct Material {
@@ -15,20 +18,21 @@ struct Material {
     vec3 specularColor;
     float shininess;
 
+#ifdef HAS_DIFFUSE_TEXTURE
     sampler2D diffuseTexture;
-    bool hasDiffuseTexture;
-
+#endif
+#ifdef HAS_SPECULAR_TEXTURE
     sampler2D specularTexture;
-    bool hasSpecularTexture;
-
+#endif
+#ifdef HAS_EMISSIVE_TEXTURE
     sampler2D emissiveTexture;
-    bool hasEmissiveTexture;
-
+#endif
+#ifdef HAS_NORMAL_TEXTURE
     sampler2D normalTexture;
-    bool hasNormalTexture;
-
+#endif
+#ifdef HAS_OPACITY_TEXTURE
     sampler2D opacityTexture;
-    bool hasOpacityTexture;
+#endif
 };
 
 struct DirectionalLight {
@@ -44,6 +48,12 @@ struct PointLight {
     float constant;
     float linear;
     float quadratic;
+
+    bool hasShadow;
+    vec2 shadowFaces[6];    // atlas UV origin of each cube face
+    float shadowTileSize;
+    float shadowNear;
+    float shadowFar;
 };
 
 struct SpotLight {
@@ -56,13 +66,21 @@ struct SpotLight {
     float constant;
     float linear;
     float quadratic;
+
+    bool hasShadow;
+    mat4 shadowMatrix;      // world space to atlas UV and depth
 };
 
 // Input
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
+#ifdef HAS_NORMAL_TEXTURE
 in mat3 TBN;
+#endif
+#ifdef HAS_LIGHTMAP
+in vec2 LightmapCoord;
+#endif
 
 // Output
 out vec4 FragColor;
@@ -70,44 +88,59 @@ out vec4 FragColor;
 // Uniforms
 uniform Material u_Material;
 uniform vec3 u_CameraPos;
-uniform int u_RenderMode;
 
 uniform DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
 uniform PointLight u_PointLights[MAX_POINT_LIGHTS];
 uniform SpotLight u_SpotLights[MAX_SPOT_LIGHTS];
 uniform sampler2DArray u_DirLightShadowMaps;
+uniform sampler2DArrayShadow u_ShadowAtlas;
 uniform int u_DirLightCount;
 uniform int u_PointLightCount;
 uniform int u_SpotLightCount;
 
+// Baked lights are left out of the counts above with BAKED_LIGHTING, see BakedLighting
+#ifdef BAKED_LIGHTING
+#ifdef HAS_LIGHTMAP
+uniform sampler2D u_Lightmap;
+#else
+uniform vec3 u_ProbeSH[9];      // irradiance probes around the mesh
+#endif
+#endif
+
 // Functions
 vec3 CalculateDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
 vec3 CalculatePointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
 vec3 CalculateSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
 vec3 CalculateNormalFromMap();
+vec3 CalculateBakedLight(vec3 normal);
+float CalculatePointShadow(PointLight light, vec3 fragPos, vec3 normal);
+float CalculateSpotShadow(SpotLight light, vec3 fragPos, vec3 normal);
 
 void main()
 {
-    if (u_RenderMode == RM_WIREFRAME)
-    {
-        FragColor = vec4(0.0, 1.0, 0.0, 1.0);
-        return;
-    }
-
+#ifdef RENDER_WIREFRAME
+    FragColor = vec4(0.0, 1.0, 0.0, 1.0);
+#else
     // Base color with alpha check
-    vec4 texColor = u_Material.hasDiffuseTexture ? 
-                   texture(u_Material.diffuseTexture, TexCoord) : 
-                   vec4(u_Material.diffuseColor, 1.0);
+#ifdef HAS_DIFFUSE_TEXTURE
+    vec4 texColor = texture(u_Material.diffuseTexture, TexCoord);
+#else
+    vec4 texColor = vec4(u_Material.diffuseColor, 1.0);
+#endif
     
     // Get specular color from texture if available
-    vec3 specularColor = u_Material.hasSpecularTexture ?
-                        texture(u_Material.specularTexture, TexCoord).rgb :
-                        u_Material.specularColor;
+#ifdef HAS_SPECULAR_TEXTURE
+    vec3 specularColor = texture(u_Material.specularTexture, TexCoord).rgb;
+#else
+    vec3 specularColor = u_Material.specularColor;
+#endif
     
     // Get opacity from texture if available
-    float opacity = u_Material.hasOpacityTexture ?
-                   texture(u_Material.opacityTexture, TexCoord).r :
-                   texColor.a;
+#ifdef HAS_OPACITY_TEXTURE
+    float opacity = texture(u_Material.opacityTexture, TexCoord).r;
+#else
+    float opacity = texColor.a;
+#endif
     
     // Alpha test - discard fully transparent fragments
     if (opacity < 0.01) {
@@ -117,17 +150,21 @@ void main()
     vec3 diffuseColor = texColor.rgb;
     
     // Normals and view direction
-    vec3 norm;
-    if (u_Material.hasNormalTexture) {
-        norm = CalculateNormalFromMap();
-    } else {
-        norm = normalize(Normal);
-    }
+#ifdef HAS_NORMAL_TEXTURE
+    vec3 norm = CalculateNormalFromMap();
+#else
+    vec3 norm = normalize(Normal);
+#endif
 
     vec3 viewDir = normalize(u_CameraPos - FragPos);
     
     // Result color starts with ambient
     vec3 result = u_Material.ambientColor * diffuseColor;
+
+    // Diffuse light of the baked lights
+#ifdef BAKED_LIGHTING
+    result += CalculateBakedLight(norm) * diffuseColor;
+#endif
     
     // Directional lights
     for(int i = 0; i < u_DirLightCount; i++)
@@ -142,15 +179,17 @@ void main()
         result += CalculateSpotLight(u_SpotLights[i], norm, FragPos, viewDir, diffuseColor, specularColor);
     
     // Add emissive light if texture is available
-    if (u_Material.hasEmissiveTexture) {
-        vec3 emissive = texture(u_Material.emissiveTexture, TexCoord).rgb;
-        result += emissive;
-    }
+#ifdef HAS_EMISSIVE_TEXTURE
+    vec3 emissive = texture(u_Material.emissiveTexture, TexCoord).rgb;
+    result += emissive;
+#endif
     
     // Use computed opacity (from texture or diffuse alpha)
     FragColor = vec4(result, opacity);
+#endif
 }
 
+#ifdef HAS_NORMAL_TEXTURE
 vec3 CalculateNormalFromMap()
 {
     // Sample normal from the normal map in [0, 1] range
@@ -162,6 +201,25 @@ vec3 CalculateNormalFromMap()
     // Transform from tangent space to world space
     return normalize(TBN * normalTexture);
 }
+#endif
+
+#ifdef BAKED_LIGHTING
+// Light arriving at the surface from the baked lights, from the lightmap or the L2 SH probes
+vec3 CalculateBakedLight(vec3 normal)
+{
+#ifdef HAS_LIGHTMAP
+    return texture(u_Lightmap, LightmapCoord).rgb;
+#else
+    vec3 n = normal;
+    vec3 result = u_ProbeSH[0] * 0.282095
+        + u_ProbeSH[1] * 0.488603 * n.y + u_ProbeSH[2] * 0.488603 * n.z + u_ProbeSH[3] * 0.488603 * n.x
+        + u_ProbeSH[4] * 1.092548 * n.x * n.y + u_ProbeSH[5] * 1.092548 * n.y * n.z
+        + u_ProbeSH[6] * 0.315392 * (3.0 * n.z * n.z - 1.0) + u_ProbeSH[7] * 1.092548 * n.x * n.z
+        + u_ProbeSH[8] * 0.546274 * (n.x * n.x - n.y * n.y);
+    return max(result, vec3(0.0));
+#endif
+}
+#endif
 
 // Calculates directional light contribution
 vec3 CalculateDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
@@ -206,6 +264,13 @@ vec3 CalculatePointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewD
     ambient *= attenuation;
     diffuse *= attenuation;
     specular *= attenuation;
+
+    // Shadow (ambient is left lit)
+    if (light.hasShadow) {
+        float shadow = CalculatePointShadow(light, fragPos, normal);
+        diffuse *= shadow;
+        specular *= shadow;
+    }
     
     return ambient + diffuse + specular;
 }
@@ -238,6 +303,87 @@ vec3 CalculateSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir
     // Apply attenuation and spot intensity
     diffuse *= attenuation * intensity;
     specular *= attenuation * intensity;
+
+    // Shadow (ambient is left lit)
+    if (light.hasShadow) {
+        float shadow = CalculateSpotShadow(light, fragPos, normal);
+        diffuse *= shadow;
+        specular *= shadow;
+    }
     
     return ambient + diffuse + specular;
+}
+
+// Filtered depth comparison in the shadow atlas, 1 = lit. Taps stay inside the tile.
+float SampleShadowAtlas(vec2 uv, vec2 tileMin, vec2 tileMax, float depth)
+{
+    vec2 texel = 1.0 / vec2(textureSize(u_ShadowAtlas, 0).xy);
+    tileMin += texel;
+    tileMax -= texel;
+
+    // Four bilinear comparisons, half a texel apart
+    float lit = 0.0;
+    for (int i = 0; i < 4; i++)
+    {
+        vec2 offset = (vec2(i & 1, i >> 1) - 0.5) * texel;
+        lit += texture(u_ShadowAtlas, vec4(clamp(uv + offset, tileMin, tileMax), SHADOW_ATLAS_LAYER, depth));
+    }
+
+    return lit * 0.25;
+}
+
+// Point light shadows are six cube faces laid out as separate tiles, picked like a cube map would
+float CalculatePointShadow(PointLight light, vec3 fragPos, vec3 normal)
+{
+    vec3 v = fragPos + normal * SHADOW_NORMAL_OFFSET - light.position;
+    vec3 a = abs(v);
+
+    int face;
+    vec3 dir;
+    vec3 up;
+    if (a.x >= a.y && a.x >= a.z) {
+        face = v.x >= 0.0 ? 0 : 1;
+        dir = vec3(v.x >= 0.0 ? 1.0 : -1.0, 0.0, 0.0);
+        up = vec3(0.0, -1.0, 0.0);
+    } else if (a.y >= a.z) {
+        face = v.y >= 0.0 ? 2 : 3;
+        dir = vec3(0.0, v.y >= 0.0 ? 1.0 : -1.0, 0.0);
+        up = vec3(0.0, 0.0, dir.y);
+    } else {
+        face = v.z >= 0.0 ? 4 : 5;
+        dir = vec3(0.0, 0.0, v.z >= 0.0 ? 1.0 : -1.0);
+        up = vec3(0.0, -1.0, 0.0);
+    }
+
+    // Same basis and 90 degree projection the face was rendered with
+    float ma = dot(v, dir);
+    vec3 right = cross(dir, up);
+    vec3 faceUp = cross(right, dir);
+    vec2 uv = vec2(dot(v, right), dot(v, faceUp)) / ma * 0.5 + 0.5;
+
+    float n = light.shadowNear;
+    float f = light.shadowFar;
+    float depth = ((f + n) / (f - n) - 2.0 * f * n / ((f - n) * ma)) * 0.5 + 0.5;
+    if (depth >= 1.0) {
+        return 1.0;
+    }
+
+    vec2 origin = light.shadowFaces[face];
+    return SampleShadowAtlas(origin + uv * light.shadowTileSize, origin, origin + light.shadowTileSize, depth);
+}
+
+float CalculateSpotShadow(SpotLight light, vec3 fragPos, vec3 normal)
+{
+    vec4 position = light.shadowMatrix * vec4(fragPos + normal * SHADOW_NORMAL_OFFSET, 1.0);
+    if (position.w <= 0.0) {
+        return 1.0;
+    }
+
+    vec3 coords = position.xyz / position.w;
+    if (coords.z >= 1.0) {
+        return 1.0;
+    }
+
+    // The tile is a little wider than the cone, so the whole atlas is a safe bound here
+    return SampleShadowAtlas(coords.xy, vec2(0.0), vec2(1.0), coords.z);
 }
\ No newline at end of file
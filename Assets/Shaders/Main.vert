@@ -2,35 +2,85 @@
 
 // Input
 layout(location = 0) in vec3 aPosition;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec4 aNormal;   // normal, octahedral normal (xy) or QTangent, see VertexLayout
 layout(location = 2) in vec2 aTexCoord;
-layout(location = 3) in vec3 aTangent;
-layout(location = 4) in vec3 aBitangent;
+layout(location = 3) in vec4 aTangent;  // xyz = tangent, w = handedness
+#ifdef HAS_LIGHTMAP
+layout(location = 4) in vec2 aLightmapCoord;
+#endif
 
 // Output
 out vec2 TexCoord;
 out vec3 Normal;
 out vec3 FragPos;
+#ifdef HAS_NORMAL_TEXTURE
 out mat3 TBN;
+#endif
+#ifdef HAS_LIGHTMAP
+out vec2 LightmapCoord;
+#endif
 
 // Uniforms
 uniform mat4 u_ModelMatrix;
 uniform mat4 u_ViewMatrix;
 uniform mat4 u_ProjectionMatrix;
 
+uniform vec3 u_PositionScale;
+uniform vec3 u_PositionOffset;
+
 // Functions
+vec3 OctahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void DecodeTangentFrame(out vec3 N, out vec3 T, out vec3 B)
+{
+#if defined(HAS_QTANGENT)
+    vec4 q = normalize(aNormal);
+    float handedness = q.w < 0.0 ? -1.0 : 1.0;
+
+    T = vec3(1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.w * q.z), 2.0 * (q.x * q.z - q.w * q.y));
+    N = vec3(2.0 * (q.x * q.z + q.w * q.y), 2.0 * (q.y * q.z - q.w * q.x), 1.0 - 2.0 * (q.x * q.x + q.y * q.y));
+    B = cross(N, T) * handedness;
+#elif defined(HAS_OCTAHEDRAL_NORMAL)
+    N = OctahedralDecode(aNormal.xy);
+    T = aTangent.xyz;
+    B = cross(N, T) * aTangent.w;
+#else
+    N = aNormal.xyz;
+    T = aTangent.xyz;
+    B = cross(N, T) * aTangent.w;
+#endif
+}
+
 void main()
 {
+    vec3 position = aPosition * u_PositionScale + u_PositionOffset;
+
     TexCoord = aTexCoord;
-    FragPos = vec3(u_ModelMatrix * vec4(aPosition, 1.0));
+#ifdef HAS_LIGHTMAP
+    LightmapCoord = aLightmapCoord;
+#endif
+    FragPos = vec3(u_ModelMatrix * vec4(position, 1.0));
 
     mat3 normalMatrix = mat3(transpose(inverse(u_ModelMatrix)));
 
-    vec3 T = normalize(normalMatrix * aTangent);
-    vec3 B = normalize(normalMatrix * aBitangent);
-    vec3 N = normalize(normalMatrix * aNormal);
+    vec3 aN, aT, aB;
+    DecodeTangentFrame(aN, aT, aB);
+
+    vec3 N = normalize(normalMatrix * aN);
+
+#ifdef HAS_NORMAL_TEXTURE
+    vec3 T = normalize(normalMatrix * aT);
+    vec3 B = normalize(normalMatrix * aB);
 
     TBN = mat3(T, B, N);
+#endif
     Normal = N;
 
     gl_Position = u_ProjectionMatrix * u_ViewMatrix * vec4(FragPos, 1.0);
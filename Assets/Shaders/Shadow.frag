@@ -0,0 +1,7 @@
+#version 330 core
+
+// Functions
+void main()
+{
+    // Only depth is written.
+}
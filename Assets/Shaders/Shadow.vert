@@ -0,0 +1,21 @@
+#version 330 core
+
+// Depth only, renders shadow casters into the shadow atlas (see ShadowAtlas).
+
+// Input
+layout(location = 0) in vec3 aPosition;
+
+// Uniforms
+uniform mat4 u_ModelMatrix;
+uniform mat4 u_ViewMatrix;
+uniform mat4 u_ProjectionMatrix;
+
+uniform vec3 u_PositionScale;
+uniform vec3 u_PositionOffset;
+
+// Functions
+void main()
+{
+    vec3 position = aPosition * u_PositionScale + u_PositionOffset;
+    gl_Position = u_ProjectionMatrix * u_ViewMatrix * u_ModelMatrix * vec4(position, 1.0);
+}
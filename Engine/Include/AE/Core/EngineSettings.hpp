@@ -3,6 +3,7 @@
 #include "PCH.hpp"
 
 #include "Rendering/Color.hpp"
+#include "Rendering/VertexLayout.hpp"
 
 #include "Resources/Texture.hpp"
 
@@ -56,8 +57,31 @@ namespace AE
             AE::Color clearColor = AE::Color(0.1f, 0.1f, 0.1f, 1.0f);
             bool enableDepthTest = true;
             bool enableFaceCulling = true;
+            int frameCaptureRingSize = 3;
+            bool enableShaderCache = true;
+            std::string shaderCacheDirectory = "Cache/Shaders";
+            VertexLayout meshVertexLayout = VertexLayout::Compressed();
+            MeshResidency meshResidency = MeshResidency::SharedArena;
+            bool enableMeshletCulling = true;
+            bool enableCullCache = true;     // reuse visibility while the camera stays within the thresholds below
+            float cullCacheDistance = 0.01f; // world units
+            float cullCacheAngle = 0.25f;    // degrees
+            bool enablePVS = true;           // reject cells the main camera can't see, when a PVS is set
+            int shadowAtlasSize = 4096;      // texels per side, shared by the shadows of all point and spot lights
         } renderer;
 
+        struct ImporterSettings {
+            bool optimizeMeshes = true;
+            int optimizerThreads = 0; // 0 = hardware concurrency
+            int vertexCacheSize = 32;
+            float overdrawThreshold = 1.05f;
+            bool buildMeshlets = true;
+            int meshletMaxVertices = 64;
+            int meshletMaxTriangles = 124;
+            bool shareMaterials = true; // identical materials across models become one object
+            float staticBatchChunkSize = 32.0f; // world units; bigger chunks mean fewer draws, coarser culling
+        } importer;
+
         static EngineSettings& Get()
         {
             static EngineSettings settings;
@@ -31,7 +31,7 @@ namespace AE
 
     private:
 
-        static inline std::stack<std::string> _contextStack;
+        static inline thread_local std::stack<std::string> _contextStack;
 
         friend class LoggerContext;
     };
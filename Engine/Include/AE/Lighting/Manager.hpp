@@ -14,13 +14,15 @@ namespace AE
         bool AddLight(const std::string& name, std::unique_ptr<LightSource> light);
         bool RemoveLight(const std::string& name);
         
-        void Apply(Shader* shader);
+        void Apply(Shader* shader, bool skipBaked = false);
         
         template <typename T>
         T* GetLight(const std::string& name);
         
         size_t GetLightCount() const;
 
+        std::vector<LightSource*> GetEnabledLights(bool skipBaked = false) const;
+
         bool HasLight(const std::string& name) const;
 
     private:
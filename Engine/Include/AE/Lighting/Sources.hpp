@@ -7,6 +7,21 @@ namespace AE
 {
     enum class LightType { Directional, Point, Spot };
 
+    // Where the shadow of a point or spot light is in the renderer's shadow atlas, written every frame (see ShadowAtlas).
+    struct LightShadow
+    {
+        bool enabled = false;
+
+        // Point lights: atlas UV origin of each cube face (+X, -X, +Y, -Y, +Z, -Z), all tileSize wide.
+        std::array<glm::vec2, 6> faces = {};
+        float tileSize = 0.0f;
+        float nearPlane = 0.0f;
+        float farPlane = 0.0f;
+
+        // Spot lights: world space to atlas UV and depth.
+        glm::mat4 matrix = glm::mat4(1.0f);
+    };
+
     class LightSource
     {
     public:
@@ -23,6 +38,14 @@ namespace AE
         float intensity;
         bool enabled;
 
+        // Point and spot lights only.
+        bool castShadows = false;
+        LightShadow shadow;
+
+        // Static light whose diffuse light is part of the renderer's BakedLighting. While baked lighting
+        // is set it is left out of real-time shading and the shadow atlas.
+        bool baked = false;
+
         virtual void Apply(Shader* shader, const std::string& uniformName, int index = 0) = 0;
         
         virtual LightType GetType() = 0;
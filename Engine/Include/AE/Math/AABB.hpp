@@ -2,6 +2,8 @@
 
 #include "PCH.hpp"
 
+#include <span>
+
 namespace AE
 {
     class AABB
@@ -26,5 +28,7 @@ namespace AE
 
         AABB Transform(const glm::mat4& matrix) const;
 
+        static AABB FromPoints(std::span<const glm::vec3> points);
+
     };
 }
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Math/AABB.hpp"
+
+#include <span>
+
+namespace AE
+{
+    // Bounding volume hierarchy over a triangle soup, for ray queries on the CPU (baking, line
+    // of sight). Queries are const and can run from several threads at once. Leaves keep their
+    // triangles in packets of four, tested together with SSE2 where available.
+    class BVH
+    {
+    public:
+
+        struct Hit
+        {
+            float distance = 0.0f;      // in units of the ray direction
+            uint32_t triangle = 0;      // index of the triangle in the indices given to Build
+            float u = 0.0f, v = 0.0f;   // barycentric weights of its second and third corner
+            bool backFace = false;      // the ray came from the side the winding faces away from
+        };
+
+        void Build(std::span<const glm::vec3> positions, std::span<const uint32_t> indices);
+
+        // True when a triangle cuts the segment between the two points (ends excluded).
+        bool IsOccluded(const glm::vec3& from, const glm::vec3& to) const;
+
+        // Closest triangle along origin + t * direction for t in (0, maxDistance]. Both faces count.
+        bool Intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const;
+
+        const AABB& GetBounds() const;
+        std::size_t GetTriangleCount() const;
+        std::size_t GetNodeCount() const;
+        bool IsEmpty() const;
+
+    private:
+
+        static constexpr uint32_t MaxLeafTriangles = 4;
+        static constexpr int MaxDepth = 48;     // keeps the traversal stack fixed
+        static constexpr int BinCount = 12;
+
+        struct Node
+        {
+            AABB bounds;
+            uint32_t first = 0;     // first packet for leaves, right child for inner nodes (left is next)
+            uint32_t count = 0;     // triangles, 0 for inner nodes
+        };
+
+        // Four triangles as structures of arrays: [axis][lane]. Unused lanes are degenerate and never hit.
+        struct alignas(16) TrianglePacket
+        {
+            float v0[3][4];
+            float edge1[3][4];
+            float edge2[3][4];
+            uint32_t triangles[4];
+        };
+
+        std::vector<Node> _nodes;
+        std::vector<TrianglePacket> _packets;
+        std::size_t _triangleCount = 0;
+
+        void _Build(std::vector<uint32_t>& order, std::vector<AABB>& boxes, std::vector<glm::vec3>& centroids,
+            uint32_t first, uint32_t count, int depth);
+
+        // Bit i is set when lane i is hit with t in (tMin, tMax); t, u and v are written for every lane.
+        static int _IntersectPacket(const TrianglePacket& packet, const glm::vec3& origin, const glm::vec3& direction,
+            float tMin, float tMax, float* t, float* u, float* v);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include <span>
+
+namespace AE
+{
+    class BoundingSphere
+    {
+    public:
+
+        BoundingSphere();
+        BoundingSphere(const glm::vec3& center, float radius);
+
+        glm::vec3 center;
+        float radius;
+
+        bool Contains(const glm::vec3& point) const;
+
+        // Conservative: the radius grows by the largest axis scale of the matrix.
+        BoundingSphere Transform(const glm::mat4& matrix) const;
+
+        // Near-minimal sphere: a Ritter-style start refined by repeatedly pulling in the
+        // farthest point, usually within a few percent of the optimum.
+        static BoundingSphere FromPoints(std::span<const glm::vec3> points);
+    };
+}
\ No newline at end of file
@@ -4,6 +4,13 @@
 
 namespace AE
 {
+    enum class FrustumTest
+    {
+        Outside,
+        Intersects,
+        Inside
+    };
+
     class AABB;
     class Frustum
     {
@@ -11,9 +18,19 @@ namespace AE
 
         void Update(const glm::mat4& viewProjection);
 
+        // Normalized planes as (normal, distance), pointing inwards.
+        std::array<glm::vec4, 6> GetPlanes() const;
+
         bool Contains(const glm::vec3& point) const;
         bool Intersects(const glm::vec3& center, float radius) const;
         bool Intersects(const AABB& aabb) const;
+
+        FrustumTest Classify(const glm::vec3& center, float radius) const;
+
+        // Test `planeHint` first and store the rejecting plane in it. Objects tend to be
+        // rejected by the same plane frame after frame, so rejection mostly costs one plane.
+        FrustumTest Classify(const glm::vec3& center, float radius, int& planeHint) const;
+        bool Intersects(const AABB& aabb, int& planeHint) const;
     
     private:
         enum FrustumPlane {
@@ -32,5 +49,7 @@ namespace AE
         };
         
         std::array<FrustumPlaneData, FrustumPlane::Count> _planes;
+
+        static bool _IsOutside(const FrustumPlaneData& plane, const AABB& aabb);
     };
 }
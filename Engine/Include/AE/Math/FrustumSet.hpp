@@ -0,0 +1,48 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Math/Frustum.hpp"
+
+#include <optional>
+
+namespace AE
+{
+    // Several view frusta with their planes stored SoA, so a sphere is tested against four views at once.
+    // Results are masks with one bit per view, in the order the frusta were added.
+    class FrustumSet
+    {
+    public:
+
+        static constexpr std::size_t MaxFrusta = 32;
+
+        void Clear();
+
+        // Returns false when the set is full.
+        bool Add(const Frustum& frustum);
+
+        // A view without a frustum, which sees everything.
+        bool AddUnbounded();
+
+        std::size_t GetCount() const;
+        bool IsEmpty() const;
+
+        // nullptr for unbounded views.
+        const Frustum* GetFrustum(std::size_t index) const;
+
+        // Views that may see the sphere. `intersecting` receives those where it straddles a plane,
+        // which a tighter test can still reject.
+        uint32_t Classify(const glm::vec3& center, float radius, uint32_t& intersecting) const;
+
+    private:
+
+        std::vector<std::optional<Frustum>> _frusta;
+
+        // For each of the 6 planes, the x, y, z and w streams of _paddedCount floats.
+        std::vector<float> _planes;
+        std::size_t _paddedCount = 0;
+
+        bool _Add(const std::optional<Frustum>& frustum);
+        const float* _GetStream(std::size_t plane, std::size_t component) const;
+    };
+}
\ No newline at end of file
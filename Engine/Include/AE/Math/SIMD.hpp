@@ -0,0 +1,50 @@
+#pragma once
+
+#include "PCH.hpp"
+
+// SSE2 is part of every x86-64 target; other targets take the scalar paths.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define AE_SIMD_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace AE::SIMD
+{
+#ifdef AE_SIMD_SSE2
+    // Loads four tightly packed vec3s and transposes them into x, y and z registers.
+    inline void LoadVec3x4(const glm::vec3* points, __m128& x, __m128& y, __m128& z)
+    {
+        static_assert(sizeof(glm::vec3) == 3 * sizeof(float));
+
+        const float* data = &points[0].x;
+
+        // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+        const __m128 a = _mm_loadu_ps(data);
+        const __m128 b = _mm_loadu_ps(data + 4);
+        const __m128 c = _mm_loadu_ps(data + 8);
+
+        const __m128 x2y1x3z2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2));
+        const __m128 y0z0y1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+        const __m128 y2y1y3z2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3));
+        const __m128 z2z3z2z3 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 3, 0));
+
+        x = _mm_shuffle_ps(a, x2y1x3z2, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm_shuffle_ps(y0z0y1z1, y2y1y3z2, _MM_SHUFFLE(2, 0, 2, 0));
+        z = _mm_shuffle_ps(y0z0y1z1, z2z3z2z3, _MM_SHUFFLE(1, 0, 3, 1));
+    }
+
+    inline float HorizontalMin(__m128 v)
+    {
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(v);
+    }
+
+    inline float HorizontalMax(__m128 v)
+    {
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(v);
+    }
+#endif
+}
\ No newline at end of file
@@ -44,6 +44,10 @@ namespace AE
 
         bool IsInitialized() const;
 
+        // True after the size changed until the engine resizes the renderer for it at the start of
+        // the next frame, however many resize events came in.
+        bool WasResized() const;
+
         void SetTitle(const std::string& title);
         void SetPosition(int x, int y);
         void SetSize(int width, int height);
@@ -71,6 +75,7 @@ namespace AE
         struct WindowState
         {
             bool initialized = false;
+            bool resized = false;
         } _state;
         
         bool _CreateWindow();
@@ -84,6 +89,9 @@ namespace AE
         
         void _Update();
 
+        // Returns whether the size changed since the last call, sizes set later in the frame are kept for the next.
+        bool _ConsumeResize();
+
         friend class Engine;
     };
 }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Math/AABB.hpp"
+#include "Math/BoundingSphere.hpp"
+
+namespace AE
+{
+    // World bounds of one mesh and its last visibility result.
+    struct CullEntry
+    {
+        BoundingSphere sphere;
+        AABB bounds;
+        bool hasBounds = false;
+
+        uint32_t views = 0;     // bit i set: view i may see it
+        int plane = 0;          // plane that rejected it last, tested first next time (single view only)
+        uint64_t epoch = 0;     // cull epoch of `views`, 0 = never tested
+
+        // Irradiance probes sampled at the center of `bounds`, kept like the bounds until the transform changes.
+        std::array<glm::vec3, 9> probeSH;
+        uint64_t probeEpoch = 0;    // probe epoch of `probeSH`, 0 = never sampled
+    };
+
+    // Culling state of one submitted mesh or model instance, kept by its owner between frames.
+    // World bounds are only recomputed when the submitted transform changes, and visibility is
+    // reused until the camera moves past the renderer's thresholds.
+    class CullCache
+    {
+    public:
+
+        // Transform changes are picked up on submit. Call this after editing the mesh or model itself.
+        void Invalidate();
+
+    private:
+
+        const void* _source = nullptr;
+        glm::mat4 _transform = glm::mat4(1.0f);
+        std::vector<CullEntry> _entries;
+        bool _valid = false;
+
+        friend class Renderer;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+
+namespace AE
+{
+    class Framebuffer;
+    class FrameCapture
+    {
+    public:
+
+        struct CaptureStats
+        {
+            uint64_t requestedFrames = 0;
+            uint64_t droppedFrames = 0;
+            uint64_t encodedFrames = 0;
+            uint64_t measuredFrames = 0;
+
+            double lastOverheadMs = 0.0;
+            double totalOverheadMs = 0.0;
+            double maxOverheadMs = 0.0;
+
+            double GetAverageOverheadMs() const;
+        };
+
+        FrameCapture(int ringSize = 3);
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        // Queues an asynchronous read of the current frame into the next free pixel pack
+        // buffer. The image is encoded to 'path' (TGA) on a worker thread a few frames later.
+        bool Capture(const std::string& path, int width, int height, const Framebuffer* source = nullptr, GLenum slot = 0);
+
+        // Called once per frame; maps finished buffers and hands them to the encoder.
+        void Update();
+
+        // Blocks until every queued capture has been read back and written to disk.
+        void Flush();
+
+        const CaptureStats& GetStats() const;
+        int GetRingSize() const;
+
+        bool IsBusy() const;
+
+    private:
+
+        struct PixelPackSlot
+        {
+            GLuint pbo = 0;
+            GLsync fence = nullptr;
+            std::size_t capacity = 0;
+
+            std::string path;
+            int width = 0;
+            int height = 0;
+            uint64_t frame = 0;
+            bool pending = false;
+        };
+
+        struct EncodeJob
+        {
+            std::string path;
+            int width = 0;
+            int height = 0;
+            std::vector<unsigned char> pixels;
+        };
+
+        std::vector<PixelPackSlot> _slots;
+        std::size_t _writeIndex = 0;
+        std::size_t _readIndex = 0;
+        uint64_t _frame = 0;
+
+        double _frameOverheadMs = 0.0;
+        bool _frameHadCapture = false;
+
+        CaptureStats _stats;
+
+        std::thread _worker;
+        mutable std::mutex _mutex;
+        std::condition_variable _jobAvailable;
+        std::condition_variable _jobsDone;
+        std::deque<EncodeJob> _jobs;
+        std::size_t _activeJobs = 0;
+        std::atomic<uint64_t> _encodedFrames = 0;
+        bool _stopWorker = false;
+
+        bool _ResolveSlot(PixelPackSlot& slot, bool wait);
+        void _WorkerLoop();
+
+        static bool _WriteTGA(const EncodeJob& job);
+    };
+}
@@ -64,7 +64,10 @@ namespace AE
 
         void Bind() const;
         void Unbind() const;
+        void BindRead(GLenum slot = 0) const;
 
+        // Attachments only reallocate when they grow past or shrink well below their storage, which
+        // can then be larger than the framebuffer: render through a viewport of GetWidth x GetHeight.
         void Resize(int width, int height);
 
         void AttachColorTexture(std::shared_ptr<Texture> texture, GLenum slot = 0);
@@ -101,6 +104,8 @@ namespace AE
 
         DepthMode _depthMode = DepthMode::None;
         GLuint _depthRenderbuffer = 0;
+        int _depthCapacityWidth = 0;
+        int _depthCapacityHeight = 0;
         
         std::vector<ColorAttachment> _colorAttachments;
         std::vector<ColorArrayAttachment> _colorArrayAttachments;
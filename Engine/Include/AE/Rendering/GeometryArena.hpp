@@ -0,0 +1,55 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include <mutex>
+
+namespace AE
+{
+    // Shared bump allocator for CPU-side geometry that outlives the GPU upload.
+    // Many small meshes end up packed into a few large blocks instead of one
+    // heap allocation per attribute array.
+    class GeometryArena
+    {
+    public:
+
+        struct Allocation
+        {
+            unsigned char* data = nullptr;
+            std::size_t size = 0;
+            uint32_t block = 0;
+
+            bool IsValid() const { return data != nullptr; }
+        };
+
+        GeometryArena(const GeometryArena&) = delete;
+        GeometryArena& operator=(const GeometryArena&) = delete;
+
+        static GeometryArena& Get();
+
+        Allocation Allocate(std::size_t size, std::size_t alignment = 16);
+        void Free(Allocation& allocation);
+
+        std::size_t GetUsedBytes() const;
+        std::size_t GetReservedBytes() const;
+        std::size_t GetBlockCount() const;
+
+    private:
+
+        static constexpr std::size_t BLOCK_SIZE = 4 * 1024 * 1024;
+
+        struct Block
+        {
+            std::unique_ptr<unsigned char[]> memory;
+            std::size_t capacity = 0;
+            std::size_t offset = 0;
+            std::size_t live = 0;
+        };
+
+        std::vector<Block> _blocks;
+        std::size_t _usedBytes = 0;
+        mutable std::mutex _mutex;
+
+        GeometryArena() = default;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Rendering/VertexLayout.hpp"
+#include "Rendering/Mesh.hpp"
+#include "Rendering/CullCache.hpp"
+#include "Math/AABB.hpp"
+
+#include <map>
+
+namespace AE
+{
+    class SceneNode;
+    class Model;
+    class ModelNode;
+    class Material;
+    class Shader;
+    class Renderer;
+    class Texture;
+    struct MeshGeometry;
+
+    // Hierarchical LOD of static scenery, built by HLODBuilder. Beyond the switch distance the
+    // nodes of a cluster are hidden and one merged, simplified proxy is drawn in their place.
+    class HLOD
+    {
+    public:
+
+        struct Cluster
+        {
+            AABB bounds;
+            std::shared_ptr<Mesh> proxy;
+            std::shared_ptr<Material> material;
+            std::vector<std::weak_ptr<SceneNode>> nodes;
+
+            std::size_t sourceDraws = 0;
+            std::size_t sourceTriangles = 0;
+
+            bool proxyActive = false;
+            CullCache cullCache;
+        };
+
+        struct Stats
+        {
+            std::size_t activeProxies = 0;
+            std::size_t hiddenNodes = 0;
+            std::size_t savedDraws = 0;
+        };
+
+        // Shows every hidden node again.
+        ~HLOD();
+
+        // Distances are taken from the view to the closest point of a cluster's bounds.
+        void Update(const glm::vec3& viewPosition);
+        void Submit(Renderer* renderer, Shader* shader);
+
+        // Shows every node and stops drawing proxies until the next Update.
+        void Reset();
+
+        float GetSwitchDistance() const;
+        void SetSwitchDistance(float distance);
+
+        const std::vector<Cluster>& GetClusters() const;
+        const Stats& GetStats() const;
+
+    private:
+
+        std::vector<Cluster> _clusters;
+        float _switchDistance = 150.0f;
+        Stats _stats;
+
+        void _SetProxyActive(Cluster& cluster, bool active);
+
+        friend class HLODBuilder;
+    };
+
+    // Groups static nodes into clusters over a grid, then merges each cluster into one proxy:
+    // the meshes are pre-transformed, simplified by vertex clustering and textured from an atlas
+    // holding one small tile per source material.
+    class HLODBuilder
+    {
+    public:
+
+        struct Settings
+        {
+            // Edge of the grid cell that groups nodes, in world units.
+            float clusterSize = 64.0f;
+            // Smaller groups save too few draws to be worth a proxy.
+            std::size_t minNodes = 2;
+
+            float switchDistance = 150.0f;
+
+            // Grid of the vertex clustering, roughly the geometric error of the proxies.
+            float simplifyCellSize = 1.0f;
+
+            // Texels per side of a material tile in the proxy atlas.
+            int atlasTileSize = 32;
+
+            bool optimize = true;
+            VertexLayout layout = VertexLayout::Uncompressed();
+            MeshResidency residency = MeshResidency::GPUOnly;
+        };
+
+        struct Stats
+        {
+            std::size_t sourceNodes = 0;
+            std::size_t skippedNodes = 0;
+            std::size_t clusters = 0;
+            std::size_t sourceDraws = 0;
+            std::size_t sourceTriangles = 0;
+            std::size_t proxyTriangles = 0;
+            std::size_t atlasTiles = 0;
+        };
+
+        HLODBuilder();
+        explicit HLODBuilder(const Settings& settings);
+
+        // The model is drawn by the node with `transform`. Every mesh needs its attributes on the
+        // CPU (load the model with keepCPUData), nodes with other meshes are left out and keep rendering as they are.
+        bool Add(const std::shared_ptr<SceneNode>& node, const std::shared_ptr<Model>& model, const glm::mat4& transform);
+
+        // Must run on the render thread, material textures are read back for the atlas.
+        // Pending nodes are cleared, stats are kept.
+        std::shared_ptr<HLOD> Build();
+
+        const Stats& GetStats() const;
+
+    private:
+
+        struct Source
+        {
+            std::weak_ptr<SceneNode> node;
+            std::shared_ptr<Model> model;
+            glm::mat4 transform;
+            AABB bounds;
+            std::size_t draws;
+            std::size_t triangles;
+        };
+
+        struct Group
+        {
+            std::shared_ptr<Material> material;
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec3> normals;
+            std::vector<glm::vec2> texCoords;
+        };
+
+        Settings _settings;
+        Stats _stats;
+
+        std::vector<Source> _sources;
+
+        // What a tile shows. The texture is held so its address can't be taken by another one.
+        struct TileKey
+        {
+            std::shared_ptr<Texture> texture;
+            glm::vec3 color;
+
+            bool operator<(const TileKey& other) const;
+        };
+
+        // Atlas tiles are baked once per texture and color and shared by every cluster.
+        std::map<TileKey, std::vector<unsigned char>> _tiles;
+
+        bool _Collect(const ModelNode& node, const glm::mat4& parentTransform, Source& source) const;
+        void _AddNode(const ModelNode& node, const glm::mat4& parentTransform, std::vector<Group>& groups,
+            std::unordered_map<const Material*, std::size_t>& groupIndex) const;
+        bool _BuildCluster(const std::vector<const Source*>& sources, HLOD::Cluster& cluster);
+        const std::vector<unsigned char>& _GetTile(const std::shared_ptr<Material>& material);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "PCH.hpp"
+
+namespace AE
+{
+    class Model;
+    class Shader;
+    class ShaderManager;
+    class Texture;
+
+    // A model pre-rendered from a grid of directions over the whole sphere, laid out as an
+    // octahedral atlas: frame (x, y) shows the model as seen from OctahedralDecode of its center.
+    // Far instances are drawn as one camera-facing quad showing the closest frame (see Renderer::SubmitImpostor).
+    class Impostor
+    {
+    public:
+
+        Impostor(std::shared_ptr<Texture> albedo, std::shared_ptr<Texture> normalDepth,
+            int framesPerSide, int frameResolution, const glm::vec3& center, float radius, const glm::vec3& ambientColor);
+
+        static std::shared_ptr<Impostor> Load(const std::string& path);
+        bool Save(const std::string& path) const;
+
+        // Unit direction from the model center for a point of [-1, 1]^2, and back. Y is the pole.
+        static glm::vec3 OctahedralDecode(const glm::vec2& e);
+        static glm::vec2 OctahedralEncode(const glm::vec3& direction);
+
+        // Rgb = albedo, a = coverage.
+        const std::shared_ptr<Texture>& GetAlbedo() const;
+        // Rgb = model-space normal * 0.5 + 0.5, a = depth along the frame direction, 0 at center + radius.
+        const std::shared_ptr<Texture>& GetNormalDepth() const;
+
+        int GetFramesPerSide() const;
+        int GetFrameResolution() const;
+
+        // Model-space sphere every frame is fitted to.
+        const glm::vec3& GetCenter() const;
+        float GetRadius() const;
+
+        // Average ambient color of the source materials, lighting has nothing else to go on.
+        const glm::vec3& GetAmbientColor() const;
+
+    private:
+
+        std::shared_ptr<Texture> _albedo;
+        std::shared_ptr<Texture> _normalDepth;
+
+        int _framesPerSide;
+        int _frameResolution;
+
+        glm::vec3 _center;
+        float _radius;
+        glm::vec3 _ambientColor;
+    };
+
+    // Renders impostor atlases. Draws only into its own framebuffer, so it works before the first
+    // frame and with a hidden window, but it needs a current GL context.
+    class ImpostorBaker
+    {
+    public:
+
+        struct Settings
+        {
+            // The atlas is framesPerSide * frameResolution texels wide.
+            int framesPerSide = 8;
+            int frameResolution = 128;
+        };
+
+        ImpostorBaker();
+        explicit ImpostorBaker(const Settings& settings);
+
+        // The model must be flattened. The bake shader is a permutation shader writing albedo to
+        // output 0 and normal/depth to output 1 (see ImpostorBake.frag). Variants still compiling are
+        // waited for when a shader manager is given, otherwise their meshes are left out.
+        std::shared_ptr<Impostor> Bake(const Model& model, Shader* bakeShader, ShaderManager* shaderMgr = nullptr);
+
+    private:
+
+        Settings _settings;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "PCH.hpp"
+
+namespace AE
+{
+    enum class IndexType : GLenum
+    {
+        UInt16 = GL_UNSIGNED_SHORT,
+        UInt32 = GL_UNSIGNED_INT
+    };
+
+    std::size_t GetIndexTypeSize(IndexType type);
+
+    // Read-only view over typed indices, wherever they are stored.
+    struct IndexView
+    {
+        const void* data = nullptr;
+        std::size_t count = 0;
+        IndexType type = IndexType::UInt16;
+
+        uint32_t operator[](std::size_t i) const;
+
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+    };
+
+    // Index storage that uses 16-bit indices whenever every index fits,
+    // and widens to 32-bit only when it has to.
+    class IndexData
+    {
+    public:
+
+        IndexData() = default;
+        IndexData(IndexType type, std::size_t reserve = 0);
+        IndexData(const std::vector<GLuint>& indices);
+        IndexData(std::initializer_list<GLuint> indices);
+
+        // Narrowest type able to address 'vertexCount' vertices.
+        static IndexType SelectType(std::size_t vertexCount);
+
+        void Reserve(std::size_t count);
+        void PushBack(uint32_t index);
+        void Clear();
+
+        // Frees the storage, unlike Clear().
+        void Release();
+
+        uint32_t operator[](std::size_t i) const;
+
+        IndexType GetType() const;
+        std::size_t GetCount() const;
+        std::size_t GetSizeInBytes() const;
+        std::size_t GetCapacityInBytes() const;
+        const void* GetData() const;
+        bool IsEmpty() const;
+
+        IndexView GetView() const;
+        std::vector<GLuint> ToVector() const;
+
+    private:
+
+        IndexType _type = IndexType::UInt16;
+        std::size_t _count = 0;
+        std::vector<unsigned char> _bytes;
+
+        void _Widen();
+    };
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 namespace AE
 {
+    enum class ShaderFeature : uint32_t;
+
     class Shader;
     class Texture;
     class Material
@@ -42,6 +44,13 @@ namespace AE
 
         bool IsTransparent() const;
 
+        // Features of the shader variant matching this material's texture set.
+        ShaderFeature GetShaderFeatures() const;
+
+        // Colors, shininess and texture identity; equal materials can share one batch.
+        uint64_t GetContentHash() const;
+        bool operator==(const Material& other) const;
+
         void SetAmbientColor(const Color& ambientColor);
         void SetDiffuseColor(const Color& diffuseColor);
         void SetSpecularColor(const Color& specularColor);
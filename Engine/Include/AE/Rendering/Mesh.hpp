@@ -3,20 +3,48 @@
 #include "PCH.hpp"
 
 #include "Math/AABB.hpp"
+#include "Math/BoundingSphere.hpp"
+#include "Rendering/VertexLayout.hpp"
+#include "Rendering/GeometryArena.hpp"
+#include "Rendering/IndexData.hpp"
+#include "Rendering/Meshlet.hpp"
+#include "Resources/Shader.hpp"
+
+#include <span>
 
 namespace AE
 {
+    enum class MeshUsage
+    {
+        Static,     // Uploaded once
+        Dynamic,    // Updated now and then, often in ranges
+        Stream      // Rewritten (almost) every frame
+    };
+
     class Mesh
     {
     public:
+
+        struct MemoryUsage
+        {
+            std::size_t gpuBytes = 0;
+            std::size_t cpuBytes = 0;
+            std::size_t arenaBytes = 0;
+            std::size_t releasedBytes = 0;
+        };
     
+        // Attributes are taken by value: pass them with std::move() to skip the copy.
         Mesh(
-            const std::vector<glm::vec3>& vertices,
-            const std::vector<GLuint>& indices = {},
-            const std::vector<glm::vec3>& normals = {},
-            const std::vector<glm::vec2>& texCoords = {},
-            const std::vector<glm::vec3>& tangents = {},
-            const std::vector<glm::vec3>& bitangents = {}
+            std::vector<glm::vec3> vertices,
+            IndexData indices = {},
+            std::vector<glm::vec3> normals = {},
+            std::vector<glm::vec2> texCoords = {},
+            std::vector<glm::vec3> tangents = {},
+            std::vector<glm::vec3> bitangents = {},
+            std::vector<glm::vec2> lightmapTexCoords = {},
+            const VertexLayout& layout = VertexLayout::Uncompressed(),
+            MeshResidency residency = MeshResidency::CPURetained,
+            MeshUsage usage = MeshUsage::Static
         );
         
         ~Mesh();
@@ -27,69 +55,154 @@ namespace AE
         void Setup();
         void Draw(GLenum mode = GL_TRIANGLES);
 
-        // AABB
+        // Draws several ranges of the index buffer in one call. Offsets are in bytes.
+        void DrawRanges(const GLsizei* counts, const void* const* offsets, GLsizei rangeCount, GLenum mode = GL_TRIANGLES);
+
+        // Bounds, recomputed from the positions on setup and when they are replaced. Range updates only
+        // grow them, call CalculateBounds to tighten them after moving vertices inward.
         const AABB& GetAABB() const;
         void SetAABB(const AABB& aabb);
+        const BoundingSphere& GetBoundingSphere() const;
+
+        void CalculateBounds();
+
+        // Vertex layout
+        const VertexLayout& GetVertexLayout() const;
+        void SetVertexLayout(const VertexLayout& layout);
+        GLsizei GetVertexStride() const;
+
+        // Vertex decoding the shader has to match, and the dequantization of positions.
+        ShaderFeature GetShaderFeatures() const;
+        const glm::vec3& GetPositionScale() const;
+        const glm::vec3& GetPositionOffset() const;
+
+        // Residency
+        MeshResidency GetResidency() const;
+        bool IsCPUResident() const;
+
+        // Positions and indices, available unless the mesh is GPU-only.
+        std::span<const glm::vec3> GetPositionData() const;
+        IndexView GetIndexData() const;
 
-        // void CalculateAABB() const;
+        // Usage. Dynamic and stream meshes always keep their CPU data and float positions,
+        // since updates are repacked from it.
+        MeshUsage GetUsage() const;
+        void SetUsage(MeshUsage usage);
+
+        // Range updates, uploaded on the next draw.
+        void UpdateVertices(std::size_t first, std::span<const glm::vec3> vertices);
+        void UpdateNormals(std::size_t first, std::span<const glm::vec3> normals);
+        void UpdateTexCoords(std::size_t first, std::span<const glm::vec2> texCoords);
+        void UpdateTangents(std::size_t first, std::span<const glm::vec3> tangents);
+
+        // Meshlets, for cluster culling. Dropped when positions or indices change.
+        const MeshletSet& GetMeshlets() const;
+        void SetMeshlets(std::vector<Meshlet> meshlets);
+        bool HasMeshlets() const;
+
+        // Memory
+        const MemoryUsage& GetMemoryUsage() const;
+        static const MemoryUsage& GetTotalMemoryUsage();
         
         // Vertices
         const std::vector<glm::vec3>& GetVertices() const;
         void SetVertices(const std::vector<glm::vec3>& vertices);
+        void SetVertices(std::vector<glm::vec3>&& vertices);
         std::size_t GetVerticesCount() const;
         bool HasVertices() const;
         
         // Normals
         const std::vector<glm::vec3>& GetNormals() const;
         void SetNormals(const std::vector<glm::vec3>& normals);
+        void SetNormals(std::vector<glm::vec3>&& normals);
         std::size_t GetNormalsCount() const;
         bool HasNormals() const;
         
         // TexCoords
         const std::vector<glm::vec2>& GetTexCoords() const;
         void SetTexCoords(const std::vector<glm::vec2>& texCoords);
+        void SetTexCoords(std::vector<glm::vec2>&& texCoords);
         std::size_t GetTexCoordsCount() const;
         bool HasTexCoords() const;
         
         // Tangents
         const std::vector<glm::vec3>& GetTangents() const;
         void SetTangents(const std::vector<glm::vec3>& tangents);
+        void SetTangents(std::vector<glm::vec3>&& tangents);
         std::size_t GetTangentsCount() const;
         bool HasTangents() const;
         
         // Bitangents
         const std::vector<glm::vec3>& GetBitangents() const;
         void SetBitangents(const std::vector<glm::vec3>& bitangents);
+        void SetBitangents(std::vector<glm::vec3>&& bitangents);
         std::size_t GetBitangentsCount() const;
         bool HasBitangents() const;
+
+        // Lightmap texture coordinates, into the atlas of the level's BakedLighting
+        const std::vector<glm::vec2>& GetLightmapTexCoords() const;
+        void SetLightmapTexCoords(const std::vector<glm::vec2>& texCoords);
+        void SetLightmapTexCoords(std::vector<glm::vec2>&& texCoords);
+        std::size_t GetLightmapTexCoordsCount() const;
+        bool HasLightmapTexCoords() const;
         
         // Indices
-        const std::vector<GLuint>& GetIndices() const;
-        void SetIndices(const std::vector<GLuint>& indices);
+        const IndexData& GetIndices() const;
+        void SetIndices(const IndexData& indices);
+        void SetIndices(IndexData&& indices);
         std::size_t GetIndicesCount() const;
         bool HasIndices() const;
+        IndexType GetIndexType() const;
     
     private:
     
-        enum VBOs {
-            VERTICES,
-            NORMALS,
-            TEXCOORDS,
-            TANGENTS,
-            BITANGENTS,
-            VBO_COUNT
-        };
-    
-        GLuint _vao, _ebo;
-        GLuint _vbos[VBO_COUNT];
+        GLuint _vao, _vbo, _ebo;
+
+        VertexLayout _layout;
+        GLsizei _stride = 0;
+        ShaderFeature _shaderFeatures = ShaderFeature::None;
+        glm::vec3 _positionScale = glm::vec3(1.0f);
+        glm::vec3 _positionOffset = glm::vec3(0.0f);
+        bool _dirty = false;
+
+        MeshResidency _residency;
+        MeshUsage _usage;
+
+        // Pending in-place updates of non-static meshes.
+        std::size_t _dirtyFirst = 0;
+        std::size_t _dirtyEnd = 0;
+        bool _indicesDirty = false;
+        bool _boundsDirty = false;   // positions replaced, not just grown
+        uint32_t _attributeMask = 0;
+        std::size_t _vertexCount = 0;
+        std::size_t _indexCount = 0;
+        IndexType _indexType = IndexType::UInt16;
+        GeometryArena::Allocation _arena;
+        MemoryUsage _memory;
 
         AABB _aabb;
+        BoundingSphere _boundingSphere;
+        MeshletSet _meshlets;
         
         std::vector<glm::vec3> _vertices;
         std::vector<glm::vec3> _normals;
         std::vector<glm::vec2> _texCoords;
         std::vector<glm::vec3> _tangents;
         std::vector<glm::vec3> _bitangents;
-        std::vector<GLuint> _indices;
+        std::vector<glm::vec2> _lightmapTexCoords;
+        IndexData _indices;
+
+        void _ApplyUsage();
+        void _ApplyResidency();
+        void _UpdateMemoryUsage();
+
+        uint32_t _GetAttributeMask() const;
+        GLenum _GetBufferUsage() const;
+        void _MarkDirty(std::size_t first, std::size_t count);
+        void _MarkIndicesDirty();
+        void _GrowBounds(std::span<const glm::vec3> vertices);
+        void _FlushUpdates();
+        void _UploadVertices();
+        void _UploadIndices();
     };
 }
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "PCH.hpp"
+
+namespace AE
+{
+    // A cluster of up to ~64 vertices / ~124 triangles, stored as a contiguous range of the mesh's index buffer.
+    struct Meshlet
+    {
+        // Bounding sphere, in object space.
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+
+        // Backface cone: the meshlet is invisible when dot(normalize(coneApex - camera), coneAxis) >= coneCutoff.
+        // A cutoff of 1 disables the test (the normals spread over more than a hemisphere).
+        glm::vec3 coneApex = glm::vec3(0.0f);
+        glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        float coneCutoff = 1.0f;
+
+        uint32_t firstIndex = 0;
+        uint32_t triangleCount = 0;
+        uint32_t vertexCount = 0;
+    };
+
+    struct MeshletCullParams
+    {
+        // Frustum planes (normal, distance) and camera position, in the object space of the mesh.
+        std::array<glm::vec4, 6> planes;
+        glm::vec3 cameraPosition = glm::vec3(0.0f);
+        bool cullBackfaces = true;
+
+        // Moves world-space planes and camera into the object space of a transform.
+        // Backface culling is turned off for mirroring transforms, which flip the winding.
+        static MeshletCullParams FromWorld(const std::array<glm::vec4, 6>& worldPlanes,
+            const glm::vec3& worldCameraPosition, const glm::mat4& transform, bool cullBackfaces = true);
+    };
+
+    struct MeshletCullStats
+    {
+        std::size_t meshletsTested = 0;
+        std::size_t meshletsFrustumCulled = 0;
+        std::size_t meshletsBackfaceCulled = 0;
+        std::size_t trianglesTested = 0;
+        std::size_t trianglesCulled = 0;
+    };
+
+    // The meshlets of a mesh, with their bounds kept in SoA form so four of them are culled at once.
+    class MeshletSet
+    {
+    public:
+
+        MeshletSet() = default;
+        explicit MeshletSet(std::vector<Meshlet> meshlets);
+
+        const std::vector<Meshlet>& GetMeshlets() const;
+        std::size_t GetCount() const;
+        std::size_t GetTriangleCount() const;
+        bool IsEmpty() const;
+
+        // Appends the indices of the meshlets that survive to `visible`. Returns how many were appended.
+        std::size_t Cull(const MeshletCullParams& params, std::vector<uint32_t>& visible, MeshletCullStats* stats = nullptr) const;
+
+    private:
+
+        enum Stream
+        {
+            CenterX = 0, CenterY, CenterZ, Radius,
+            ApexX, ApexY, ApexZ,
+            AxisX, AxisY, AxisZ, Cutoff,
+            StreamCount
+        };
+
+        std::vector<Meshlet> _meshlets;
+        std::size_t _triangleCount = 0;
+
+        // StreamCount arrays of _paddedCount floats each.
+        std::vector<float> _bounds;
+        std::size_t _paddedCount = 0;
+
+        const float* _GetStream(Stream stream) const;
+    };
+}
\ No newline at end of file
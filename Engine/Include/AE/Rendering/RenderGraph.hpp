@@ -0,0 +1,199 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Common/TextureCommon.hpp"
+
+#include <functional>
+#include <map>
+
+namespace AE
+{
+    class Texture;
+    class TextureArray;
+    class Framebuffer;
+
+    // Frame graph of render passes, rebuilt every frame. Passes declare the textures they create,
+    // read and write; Compile drops passes nothing depends on and lets transient textures whose
+    // lifetimes don't overlap share one texture. GL can't alias memory between formats, so only
+    // textures with identical descriptors share. The textures and framebuffers live in a pool
+    // owned by the graph and are reused between frames.
+    class RenderGraph
+    {
+    public:
+
+        // Index of a texture in the graph, valid until the next Reset.
+        struct Resource
+        {
+            uint32_t index = UINT32_MAX;
+
+            bool IsValid() const { return index != UINT32_MAX; }
+        };
+
+        struct Stats
+        {
+            std::size_t passes = 0;
+            std::size_t culledPasses = 0;
+            std::size_t transientTextures = 0;
+            std::size_t physicalTextures = 0;
+
+            // Render-target memory of the transient textures with one texture each, and as aliased.
+            std::size_t requestedBytes = 0;
+            std::size_t allocatedBytes = 0;
+
+            std::size_t GetSavedBytes() const { return requestedBytes - allocatedBytes; }
+        };
+
+        class Builder
+        {
+        public:
+
+            // A transient texture, written by this pass.
+            Resource Create(const std::string& name, const TextureDesc& descriptor);
+            Resource Read(Resource resource);
+            // Color textures are attached in call order, depth formats to the depth attachment.
+            Resource Write(Resource resource);
+
+            // Keeps the pass even if nothing reads what it writes, e.g. it draws to the screen.
+            void SetSideEffect();
+
+        private:
+
+            Builder(RenderGraph& graph, uint32_t pass);
+
+            RenderGraph& _graph;
+            uint32_t _pass;
+
+            friend class RenderGraph;
+        };
+
+        class Context
+        {
+        public:
+
+            // Pooled textures keep their storage across size changes, sample with Texture::GetUVScale
+            // and clamp to Texture::GetUVLimit.
+            std::shared_ptr<Texture> GetTexture(Resource resource) const;
+
+            // The textures the pass writes, already bound with a matching viewport. nullptr if it writes none.
+            Framebuffer* GetFramebuffer() const;
+            // A framebuffer with only this texture attached, e.g. to blit from a texture the pass reads.
+            // Creating it changes the framebuffer binding, bind GetFramebuffer() again before drawing.
+            Framebuffer* GetFramebuffer(Resource resource) const;
+
+        private:
+
+            Context(RenderGraph& graph, Framebuffer* framebuffer);
+
+            RenderGraph& _graph;
+            Framebuffer* _framebuffer;
+
+            friend class RenderGraph;
+        };
+
+        using SetupFunction = std::function<void(Builder&)>;
+        using ExecuteFunction = std::function<void(const Context&)>;
+
+        // Passes run in the order they are added, a pass can only read what earlier passes wrote.
+        void AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+
+        // A texture owned outside of the graph. Never aliased, and passes writing it are always kept.
+        Resource Import(const std::string& name, std::shared_ptr<Texture> texture);
+        // One layer of a texture array owned outside of the graph, attached to framebuffers on its own.
+        Resource Import(const std::string& name, std::shared_ptr<TextureArray> texture, int layer);
+
+        // Keeps every pass that contributes to the resource.
+        void MarkOutput(Resource resource);
+
+        // Culls passes, computes lifetimes and assigns transient textures. Doesn't touch GL.
+        bool Compile();
+
+        // Compiles if needed, takes textures from the pool and runs the remaining passes.
+        // The framebuffer and viewport bound before are restored afterwards.
+        void Execute();
+
+        // Drops passes and resources. Pooled textures stay for the next frame.
+        void Reset();
+        void ReleasePool();
+
+        // Texture of a resource after Execute, until the next Reset.
+        std::shared_ptr<Texture> GetTexture(Resource resource) const;
+
+        const Stats& GetStats() const;
+
+        // Pooled textures unused for longer are released.
+        static constexpr uint64_t PoolFrames = 3;
+
+    private:
+
+        struct ResourceNode
+        {
+            std::string name;
+            TextureDesc descriptor;
+            std::shared_ptr<Texture> imported;
+            int layer = -1; // of an imported texture array
+            bool output = false;
+
+            std::vector<uint32_t> writers;
+            uint32_t readers = 0;
+
+            // Compiled
+            uint32_t references = 0;
+            uint32_t firstUse = UINT32_MAX;
+            uint32_t lastUse = 0;
+            int physical = -1;
+        };
+
+        struct PassNode
+        {
+            std::string name;
+            ExecuteFunction execute;
+
+            std::vector<uint32_t> reads;
+            std::vector<uint32_t> writes;
+            bool sideEffect = false;
+
+            // Compiled
+            uint32_t references = 0;
+            bool culled = false;
+        };
+
+        // One texture after aliasing, holding every resource assigned to it in turn.
+        struct PhysicalTexture
+        {
+            TextureDesc descriptor;
+            uint32_t busyUntil = 0;
+            std::shared_ptr<Texture> texture;
+        };
+
+        struct PooledTexture
+        {
+            TextureDesc descriptor;
+            std::shared_ptr<Texture> texture;
+            uint64_t lastFrame = 0;
+        };
+
+        struct PooledFramebuffer
+        {
+            std::shared_ptr<Framebuffer> framebuffer;
+            uint64_t lastFrame = 0;
+        };
+
+        std::vector<PassNode> _passes;
+        std::vector<ResourceNode> _resources;
+        std::vector<PhysicalTexture> _physical;
+        bool _compiled = false;
+
+        std::vector<PooledTexture> _texturePool;
+        // Keyed by the attached texture IDs and layers, colors in order and the depth texture last.
+        // Framebuffers that turned out incomplete stay in as nullptr, so they are only reported once.
+        std::map<std::vector<GLuint>, PooledFramebuffer> _framebufferPool;
+        uint64_t _frame = 0;
+
+        Stats _stats;
+
+        std::shared_ptr<Texture> _AcquireTexture(const TextureDesc& descriptor);
+        Framebuffer* _AcquireFramebuffer(const std::vector<uint32_t>& resources);
+        void _TrimPool();
+    };
+}
\ No newline at end of file
@@ -2,6 +2,11 @@
 
 #include "PCH.hpp"
 
+#include "Rendering/Meshlet.hpp"
+#include "Rendering/RenderGraph.hpp"
+#include "Rendering/ShadowAtlas.hpp"
+#include "Math/FrustumSet.hpp"
+
 namespace AE
 {
     class Camera;
@@ -11,6 +16,16 @@ namespace AE
     class Model;
     class ModelNode;
     class Skybox;
+    class Texture;
+    class Framebuffer;
+    class FrameCapture;
+    class AABB;
+    class BoundingSphere;
+    class CullCache;
+    class PVS;
+    class BakedLighting;
+    class Impostor;
+    struct CullEntry;
 
     enum class RenderMode
     {
@@ -18,27 +33,121 @@ namespace AE
         Wireframe
     };
     
+    // A camera rendered in addition to the main one: split-screen, reflection probes, shadow cascades...
+    struct RenderView
+    {
+        std::shared_ptr<Camera> camera;
+        bool offscreen = false;                 // renders into a texture of its own, see Renderer::GetViewTexture
+        glm::ivec2 size = glm::ivec2(0);        // of that texture; zero = the size of the window
+        glm::ivec4 viewport = glm::ivec4(0);    // x, y, width, height; zero size = the whole target
+        bool clear = true;
+    };
+
     class LightManager;
     class Renderer
     {
     public:
+
+        struct CullingStats
+        {
+            std::size_t meshesTested = 0;
+            std::size_t meshesCulled = 0;   // rejected by every view
+
+            // Triangles of every tested mesh, and those rejected by the mesh bounds or by meshlet culling of the main view.
+            std::size_t trianglesTested = 0;
+            std::size_t trianglesCulled = 0;
+
+            MeshletCullStats meshlets;
+
+            // Mesh and model tests answered from a CullCache without touching the frustum.
+            std::size_t cacheHits = 0;
+
+            // Meshes and models inside the main view's frustum that the PVS hid from it.
+            std::size_t pvsCulled = 0;
+
+            float GetTriangleRejectionRate() const
+            {
+                return trianglesTested > 0 ? static_cast<float>(trianglesCulled) / static_cast<float>(trianglesTested) : 0.0f;
+            }
+        };
     
+        struct BatchStats
+        {
+            std::size_t opaqueBatches = 0;
+            std::size_t transparentBatches = 0;
+            std::size_t impostorBatches = 0;
+            std::size_t instances = 0;
+
+            std::size_t GetBatchCount() const { return opaqueBatches + transparentBatches + impostorBatches; }
+        };
+
         Renderer(LightManager* lightMgr = nullptr);
         ~Renderer();
     
-        void SubmitMesh(Mesh* mesh, Shader* shader, Material* material = nullptr, const glm::mat4& transform = glm::mat4(1.0f));
-        void SubmitModel(Model* model, Shader* shader, const glm::mat4& transform = glm::mat4(1.0f));
+        // A cache owned by the caller keeps world bounds and visibility of the instance between frames.
+        void SubmitMesh(Mesh* mesh, Shader* shader, Material* material = nullptr, const glm::mat4& transform = glm::mat4(1.0f),
+            CullCache* cache = nullptr);
+        void SubmitModel(Model* model, Shader* shader, const glm::mat4& transform = glm::mat4(1.0f), CullCache* cache = nullptr);
         void SubmitModelNode(ModelNode* node, Shader* shader, const glm::mat4& parentTransform = glm::mat4(1.0f));
 
+        // Draws the model the impostor was baked from as one camera-facing quad. Instances of the same
+        // impostor are drawn together in one instanced call, with the impostor shader (see SetImpostorShader).
+        void SubmitImpostor(Impostor* impostor, const glm::mat4& transform = glm::mat4(1.0f));
+
+        // Geometry casting shadows from point and spot lights, submitted every frame whether it is visible
+        // or not. Shadows of static casters are only rendered again when the light moves (see ShadowAtlas).
+        void SubmitShadowCaster(Mesh* mesh, const glm::mat4& transform = glm::mat4(1.0f), bool isStatic = false);
+        void SubmitShadowCaster(Model* model, const glm::mat4& transform = glm::mat4(1.0f), bool isStatic = false);
+
         RenderMode GetRenderMode() const;
         void SetRenderMode(RenderMode mode);
     
         std::shared_ptr<Camera> GetCamera() const;
         void SetCamera(std::shared_ptr<Camera> camera);
+
+        // Extra views are culled in the same traversal as the main camera, which is view 0. Offscreen
+        // views are rendered before the main view, the others on top of it.
+        // Returns the view index, or 0 when all FrustumSet::MaxFrusta views are taken.
+        std::size_t AddView(const RenderView& view);
+        // Views after `index` move down by one.
+        bool RemoveView(std::size_t index);
+        void ClearViews();
+        std::size_t GetViewCount() const;
+
+        // Color texture of an offscreen view, rendered every frame before the main view. nullptr until
+        // it was first rendered. Its storage only grows or shrinks in steps with the view (see
+        // Texture::Resize): scale UVs by GetUVScale and clamp them to GetUVLimit when sampling it.
+        std::shared_ptr<Texture> GetViewTexture(std::size_t index) const;
    
         std::shared_ptr<Skybox> GetSkybox() const;
         void SetSkybox(std::shared_ptr<Skybox> skybox);
         void SetSkyboxShader(std::shared_ptr<Shader> shader);
+
+        void SetImpostorShader(std::shared_ptr<Shader> shader);
+
+        // Depth-only shader for the shadow atlas, lights with castShadows get shadows once it is set.
+        void SetShadowShader(std::shared_ptr<Shader> shader);
+        ShadowAtlas* GetShadowAtlas() const;
+
+        // Precomputed visibility of the static level, only applied to the main view.
+        std::shared_ptr<PVS> GetPVS() const;
+        void SetPVS(std::shared_ptr<PVS> pvs);
+
+        // Lightmap and probes of the static level. While set, lights marked `baked` are left out of the
+        // real-time lighting and the shadow atlas: meshes with lightmap coordinates sample the lightmap,
+        // the others the probes at their center.
+        std::shared_ptr<BakedLighting> GetBakedLighting() const;
+        void SetBakedLighting(std::shared_ptr<BakedLighting> bakedLighting);
+
+        bool CaptureFrame(const std::string& path, const Framebuffer* source = nullptr);
+        void StartCaptureSequence(const std::string& directory, int frameInterval = 1);
+        void StopCaptureSequence();
+        bool IsCapturingSequence() const;
+        FrameCapture* GetFrameCapture() const;
+
+        // Culling counters of the last rendered frame.
+        const CullingStats& GetCullingStats() const;
+        const BatchStats& GetBatchStats() const;
         
         bool IsInitialized() const;
     
@@ -53,22 +162,102 @@ namespace AE
             {
                 Mesh* mesh;
                 glm::mat4 transform;
+
+                // Index ranges in _drawCounts / _drawOffsets left by meshlet culling, none = whole mesh.
+                uint32_t firstRange = 0;
+                uint32_t rangeCount = 0;
+
+                // Probe lighting in _probeSamples, UINT32_MAX = the variant doesn't use probes.
+                uint32_t probeSample = UINT32_MAX;
             };
     
             std::vector<InstanceData> instances;
         };
 
+        struct ImpostorBatch
+        {
+            Impostor* impostor;
+            std::vector<glm::mat4> transforms;
+        };
+
         LightManager* _lightMgr;
     
         RenderMode _renderMode = RenderMode::Default;
         
-        std::vector<RenderBatch> _opaqueBatches;
-        std::vector<RenderBatch> _transparentBatches;
+        std::vector<GLsizei> _drawCounts;
+        std::vector<const void*> _drawOffsets;
+        std::vector<uint32_t> _visibleMeshlets;
+        CullingStats _cullingStats;
+
+        // Bumped whenever a camera moved past the cache thresholds; CullEntry results from older epochs are stale.
+        uint64_t _cullEpoch = 1;
+
+        struct CullReference
+        {
+            glm::vec3 position = glm::vec3(0.0f);
+            glm::vec3 forward = glm::vec3(0.0f);
+            glm::vec3 up = glm::vec3(0.0f);
+            glm::mat4 projection = glm::mat4(1.0f);
+            bool valid = false;
+        };
+        BatchStats _batchStats;
+
+        struct ViewState
+        {
+            RenderView view;
+            std::shared_ptr<Texture> color; // of an offscreen view
+            std::vector<RenderBatch> opaqueBatches;
+            std::vector<RenderBatch> transparentBatches;
+            std::vector<ImpostorBatch> impostorBatches;
+            CullReference reference;
+        };
+
+        // [0] is the main camera. Culling results are masks over these, tested against _viewFrusta.
+        std::vector<ViewState> _views;
+        FrustumSet _viewFrusta;
     
         std::shared_ptr<Camera> _camera;
 
         std::shared_ptr<Skybox> _skybox;
         std::shared_ptr<Shader> _skyboxShader;
+
+        // Unit quad plus the per-instance model matrices, created with the first impostor drawn.
+        std::shared_ptr<Shader> _impostorShader;
+        GLuint _impostorVAO = 0;
+        GLuint _impostorQuadVBO = 0;
+        GLuint _impostorInstanceVBO = 0;
+
+        // Passes of the frame, declared again every frame. Its render target memory is logged when it changes.
+        RenderGraph _graph;
+        std::size_t _graphRequestedBytes = SIZE_MAX;
+        std::size_t _graphAllocatedBytes = SIZE_MAX;
+
+        // Of the window, set by _OnResize.
+        glm::ivec2 _frameSize = glm::ivec2(0);
+
+        std::shared_ptr<Shader> _shadowShader;
+        std::unique_ptr<ShadowAtlas> _shadowAtlas;
+        std::vector<ShadowAtlas::Caster> _shadowCasters;
+
+        std::shared_ptr<PVS> _pvs;
+        int _pvsCell = -1; // cell of the main camera, -1 = PVS not used this frame
+
+        std::shared_ptr<BakedLighting> _bakedLighting;
+
+        // Probe lighting of this frame's instances. Bumping the epoch drops the samples cached in CullEntry.
+        std::vector<std::array<glm::vec3, 9>> _probeSamples;
+        uint64_t _probeEpoch = 1;
+
+        std::unique_ptr<FrameCapture> _frameCapture;
+
+        struct CaptureSequence
+        {
+            std::string directory;
+            int frameInterval = 1;
+            uint64_t frameCounter = 0;
+            uint64_t captureIndex = 0;
+            bool active = false;
+        } _captureSequence;
     
         struct RendererState
         {
@@ -78,12 +267,37 @@ namespace AE
         bool _Initialize();
         void _Shutdown();
         
-        void _RenderBatch(const RenderBatch& batch);
-        void _RenderSkybox();
+        void _SubmitMesh(Mesh* mesh, Shader* shader, const Material* material, const glm::mat4& transform, uint32_t views,
+            CullEntry* entry = nullptr);
+        uint32_t _SampleProbes(Mesh* mesh, const glm::mat4& transform, CullEntry* entry);
+
+        uint32_t _CullMesh(const BoundingSphere& sphere, const AABB& bounds, const glm::mat4& transform, std::size_t triangles);
+        uint32_t _CullMesh(CullEntry& entry, std::size_t triangles);
+        uint32_t _GetVisibleViews(const BoundingSphere& sphere, const AABB& bounds, const glm::mat4& transform);
+        uint32_t _GetVisibleViews(CullEntry& entry);
+        uint32_t _GetBoxRejectedViews(const AABB& worldBounds, uint32_t views) const;
+        uint32_t _GetPVSRejectedViews(const AABB& worldBounds);
+
+        CullEntry* _GetCullEntries(CullCache* cache, const void* source, const glm::mat4& transform, std::size_t count);
+        void _PrepareViews();
+        void _UpdateCullEpoch();
+        bool _CullMeshlets(Mesh* mesh, const glm::mat4& transform, Camera& camera, uint32_t& firstRange, uint32_t& rangeCount);
+
+        RenderGraph::Resource _AddOffscreenView(std::size_t index);
+        // Draws into the rectangle `target` of the bound framebuffer.
+        void _RenderView(ViewState& state, const glm::ivec4& target);
+        void _RenderBatch(const RenderBatch& batch, Camera* camera);
+        void _RenderSkybox(Camera* camera);
+        void _RenderImpostors(const ViewState& state);
+        void _CreateImpostorBuffers();
         
-        void _RenderOpaqueBatches();
-        void _RenderTransparentBatches();
+        void _RenderOpaqueBatches(const ViewState& state);
+        void _RenderTransparentBatches(ViewState& state);
+
+        void _UpdateShadows();
+        void _UpdateCapture();
     
+        void _OnResize(int width, int height);
         void _PrepareFrame();
         void _RenderFrame();
     
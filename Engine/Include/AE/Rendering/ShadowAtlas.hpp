@@ -0,0 +1,139 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Math/BoundingSphere.hpp"
+
+namespace AE
+{
+    class Mesh;
+    class Shader;
+    class Camera;
+    class RenderGraph;
+    class TextureArray;
+    class LightSource;
+
+    // Shadow maps of point and spot lights packed into square tiles of one depth texture array.
+    // A spot light takes one tile, a point light one per cube face. Tiles are sized by how large the
+    // light's range appears on screen and kept between frames: they are only rendered again when the
+    // light or a caster within its range moved. Layer 0 holds the static casters, layer 1 a copy of it
+    // with the dynamic casters on top, so a moving dynamic caster never redraws the static ones.
+    // Both are rendered by passes of the frame's RenderGraph. Shaders sample layer 1.
+    class ShadowAtlas
+    {
+    public:
+
+        struct Settings
+        {
+            int size = 4096; // texels per side
+            int minTileSize = 64;
+            int maxTileSize = 1024;
+
+            // Lights with unbounded attenuation are cut off here.
+            float maxLightRange = 100.0f;
+
+            // Tiles of lights off screen stay cached this long, unless a visible light needs the space.
+            int idleFrames = 300;
+        };
+
+        struct Caster
+        {
+            Mesh* mesh;
+            glm::mat4 transform;
+            BoundingSphere sphere; // world space
+            bool isStatic;
+        };
+
+        struct Stats
+        {
+            std::size_t shadowedLights = 0;
+            std::size_t staticTilesRendered = 0;
+            std::size_t dynamicTilesRendered = 0;
+            std::size_t cachedTiles = 0;
+        };
+
+        ShadowAtlas();
+        explicit ShadowAtlas(const Settings& settings);
+        ~ShadowAtlas();
+
+        ShadowAtlas(const ShadowAtlas&) = delete;
+        ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+        // Assigns tiles and writes the shadow of every point and spot light that casts shadows, lights
+        // without a tile get none. Tiles that changed are rendered with the depth-only shader by passes
+        // added to `graph`, which use `casters` until the graph has run.
+        void Update(const std::vector<LightSource*>& lights, const std::vector<Caster>& casters,
+            Camera* camera, int screenHeight, Shader* shader, RenderGraph& graph);
+
+        // Drops every tile, they are assigned and rendered again on the next update.
+        void Clear();
+
+        const std::shared_ptr<TextureArray>& GetTexture() const;
+        const Settings& GetSettings() const;
+        const Stats& GetStats() const;
+
+        // Distance at which the light falls below 1/256 of full brightness, at most `maxRange`.
+        static float GetLightRange(const LightSource& light, float maxRange);
+
+        static constexpr int StaticLayer = 0;
+        static constexpr int DynamicLayer = 1;
+
+    private:
+
+        // Tiles come from a quadtree over the atlas, level 0 being the whole atlas.
+        struct Tile
+        {
+            glm::ivec2 origin = glm::ivec2(0);
+            int level = -1;
+        };
+
+        struct LightEntry
+        {
+            std::array<Tile, 6> tiles;
+            std::array<glm::mat4, 6> viewProjections;
+            int tileCount = 0;
+
+            // What the tiles were rendered with, compared every frame.
+            uint64_t lightHash = 0;
+            uint64_t staticHash = 0;
+            uint64_t dynamicHash = 0;
+            bool staticValid = false;
+            bool dynamicValid = false;
+
+            uint64_t lastFrame = 0; // last frame the light was on screen
+        };
+
+        // Tiles of one light to render this frame.
+        struct Work
+        {
+            const LightEntry* entry = nullptr;
+            std::vector<const Caster*> staticCasters;
+            std::vector<const Caster*> dynamicCasters;
+            bool renderStatic = false;
+        };
+
+        Settings _settings;
+
+        std::shared_ptr<TextureArray> _texture;
+        std::vector<Work> _work; // until the passes ran
+
+        std::vector<std::vector<glm::ivec2>> _freeTiles; // per level
+        std::unordered_map<const LightSource*, LightEntry> _lights;
+        uint64_t _frame = 0;
+        bool _failed = false;
+
+        Stats _stats;
+
+        bool _Create();
+
+        int _GetTileSize(int level) const;
+        int _GetLevel(int tileSize) const;
+        bool _AllocateTile(int level, Tile& tile);
+        bool _AllocateTiles(LightEntry& entry, int count, int level);
+        void _FreeTile(const Tile& tile);
+        void _FreeTiles(LightEntry& entry);
+
+        void _AddPasses(RenderGraph& graph, Shader* shader);
+        void _RenderTiles(const LightEntry& entry, const std::vector<const Caster*>& casters, Shader* shader, bool clear) const;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Rendering/VertexLayout.hpp"
+#include "Rendering/IndexData.hpp"
+#include "Rendering/Mesh.hpp"
+#include "Resources/MeshOptimizer.hpp"
+
+#include <span>
+
+namespace AE
+{
+    class Model;
+    class ModelNode;
+    class Material;
+
+    // Merges static geometry that shares a material into combined meshes. Vertices are
+    // pre-transformed into a common space and triangles are split over a grid of chunks,
+    // so the merged meshes can still be culled.
+    class StaticBatcher
+    {
+    public:
+
+        struct Settings
+        {
+            // Edge of a grid cell in world units. Larger chunks mean fewer draws but coarser culling;
+            // 0 merges everything sharing a material into one mesh.
+            float chunkSize = 32.0f;
+
+            bool optimize = true;
+            MeshOptimizer::Settings optimizer;
+
+            VertexLayout layout = VertexLayout::Uncompressed();
+            MeshResidency residency = MeshResidency::GPUOnly;
+        };
+
+        struct Stats
+        {
+            std::size_t sourceMeshes = 0;
+            std::size_t mergedMeshes = 0;
+            std::size_t skippedMeshes = 0;
+            std::size_t chunks = 0;
+            std::size_t triangles = 0;
+        };
+
+        StaticBatcher();
+        explicit StaticBatcher(const Settings& settings);
+
+        // Adds raw geometry. Missing indices mean a plain triangle list.
+        void Add(std::span<const glm::vec3> positions,
+            std::span<const glm::vec3> normals,
+            std::span<const glm::vec2> texCoords,
+            std::span<const glm::vec3> tangents,
+            std::span<const glm::vec3> bitangents,
+            std::span<const glm::vec2> lightmapTexCoords,
+            IndexView indices,
+            const glm::mat4& transform,
+            const std::shared_ptr<Material>& material);
+
+        // Needs every attribute on the CPU, so only CPU-retained meshes can be merged: load models
+        // meant for batching with ModelManager::Load(..., keepCPUData = true).
+        bool Add(const Mesh& mesh, const glm::mat4& transform, const std::shared_ptr<Material>& material);
+
+        // Merges every mesh of the hierarchy. Meshes that can't be merged are kept as they are.
+        void Add(const Model& model, const glm::mat4& transform = glm::mat4(1.0f));
+
+        // Creates one mesh per chunk and returns them as a flattened model. Pending geometry is cleared, stats are kept.
+        std::shared_ptr<Model> Build();
+
+        const Stats& GetStats() const;
+
+    private:
+
+        enum AttributeBits : uint32_t
+        {
+            Normals = 1 << 0,
+            TexCoords = 1 << 1,
+            Tangents = 1 << 2,
+            Lightmap = 1 << 3
+        };
+
+        struct ChunkKey
+        {
+            const Material* material;
+            glm::ivec3 cell;
+            uint32_t attributes;
+
+            bool operator==(const ChunkKey& other) const = default;
+        };
+
+        struct ChunkKeyHash
+        {
+            std::size_t operator()(const ChunkKey& key) const;
+        };
+
+        struct Chunk
+        {
+            std::shared_ptr<Material> material;
+            MeshGeometry geometry;
+        };
+
+        struct PassThrough
+        {
+            std::shared_ptr<Mesh> mesh;
+            std::shared_ptr<Material> material;
+            glm::mat4 transform;
+        };
+
+        Settings _settings;
+        Stats _stats;
+
+        std::vector<Chunk> _chunks;
+        std::unordered_map<ChunkKey, std::size_t, ChunkKeyHash> _chunkIndex;
+        std::vector<PassThrough> _passThrough;
+
+        void _AddNode(const ModelNode& node, const glm::mat4& parentTransform);
+        bool _AddMesh(const Mesh& mesh, const glm::mat4& transform, const std::shared_ptr<Material>& material);
+        std::size_t _GetChunk(const ChunkKey& key, const std::shared_ptr<Material>& material);
+    };
+}
\ No newline at end of file
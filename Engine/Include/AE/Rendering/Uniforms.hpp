@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Resources/Shader.hpp"
+
+namespace AE
+{
+    // Handles for the uniforms the engine sets every frame.
+    namespace Uniforms
+    {
+        inline const UniformHandle ProjectionMatrix("u_ProjectionMatrix");
+        inline const UniformHandle ViewMatrix("u_ViewMatrix");
+        inline const UniformHandle ModelMatrix("u_ModelMatrix");
+        inline const UniformHandle CameraPos("u_CameraPos");
+
+        inline const UniformHandle PositionScale("u_PositionScale");
+        inline const UniformHandle PositionOffset("u_PositionOffset");
+
+        inline const UniformHandle Cubemap("u_Cubemap");
+
+        inline const UniformHandle ImpostorAlbedo("u_ImpostorAlbedo");
+        inline const UniformHandle ImpostorNormalDepth("u_ImpostorNormalDepth");
+        inline const UniformHandle ImpostorFrames("u_ImpostorFrames");
+        inline const UniformHandle ImpostorCenter("u_ImpostorCenter");
+        inline const UniformHandle ImpostorRadius("u_ImpostorRadius");
+        inline const UniformHandle ImpostorAmbient("u_ImpostorAmbient");
+
+        inline const UniformHandle DirLightCount("u_DirLightCount");
+        inline const UniformHandle PointLightCount("u_PointLightCount");
+        inline const UniformHandle SpotLightCount("u_SpotLightCount");
+
+        inline const UniformHandle ShadowAtlas("u_ShadowAtlas");
+
+        inline const UniformHandle Lightmap("u_Lightmap");
+        inline const UniformHandle ProbeSH("u_ProbeSH");   // vec3[9], see Shader::SetVec3Array
+    }
+}
\ No newline at end of file
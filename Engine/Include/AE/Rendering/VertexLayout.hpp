@@ -0,0 +1,93 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include <span>
+
+namespace AE
+{
+    enum class ShaderFeature : uint32_t;
+
+    // Where a mesh keeps its attributes once uploaded. Lives here with the vertex formats so settings
+    // can name both without pulling in the mesh and shader headers.
+    enum class MeshResidency
+    {
+        GPUOnly,        // CPU arrays are dropped after upload, only the AABB is kept
+        CPURetained,    // Every attribute stays in memory (physics, picking, editing)
+        SharedArena     // Positions and indices are kept in the shared GeometryArena
+    };
+
+    enum class VertexPositionFormat
+    {
+        Float,      // 3 x float, 12 bytes
+        Quantized   // 4 x unorm16 relative to the mesh bounds, 8 bytes
+    };
+
+    enum class VertexNormalFormat
+    {
+        Float,      // normal 3 x float + tangent 4 x float (handedness in w), up to 28 bytes
+        Compressed  // octahedral normal 2 x snorm16 (4 bytes), or a QTangent 4 x snorm16 (8 bytes) with tangents
+    };
+
+    enum class VertexTexCoordFormat
+    {
+        Float,      // 2 x float, 8 bytes
+        Half        // 2 x half, 4 bytes
+    };
+
+    struct VertexAttribute
+    {
+        GLuint location = 0;
+        GLint size = 0;
+        GLenum type = GL_FLOAT;
+        GLboolean normalized = GL_FALSE;
+        std::size_t offset = 0;
+    };
+
+    // Result of interleaving a mesh's attributes into a single vertex buffer.
+    struct PackedVertices
+    {
+        std::vector<unsigned char> data;
+        std::vector<VertexAttribute> attributes;
+        GLsizei stride = 0;
+
+        // Quantized positions are decoded as: position = stored * scale + offset
+        glm::vec3 positionScale = glm::vec3(1.0f);
+        glm::vec3 positionOffset = glm::vec3(0.0f);
+
+        // Decoding paths the vertex shader needs for this data, none by default.
+        ShaderFeature features{};
+    };
+
+    struct VertexLayout
+    {
+        enum Location : GLuint
+        {
+            POSITION = 0,
+            NORMAL = 1,
+            TEXCOORD = 2,
+            TANGENT = 3,
+            LIGHTMAP = 4
+        };
+
+        VertexPositionFormat position = VertexPositionFormat::Float;
+        VertexNormalFormat normal = VertexNormalFormat::Float;
+        VertexTexCoordFormat texCoord = VertexTexCoordFormat::Float;
+
+        static VertexLayout Uncompressed();
+        static VertexLayout Compressed();
+
+        // Bitangents are only used to derive the handedness of the tangent frame. Lightmap coordinates
+        // are always stored as floats, half floats lose whole texels of a large lightmap.
+        PackedVertices Pack(
+            std::span<const glm::vec3> positions,
+            std::span<const glm::vec3> normals = {},
+            std::span<const glm::vec2> texCoords = {},
+            std::span<const glm::vec3> tangents = {},
+            std::span<const glm::vec3> bitangents = {},
+            std::span<const glm::vec2> lightmapTexCoords = {}
+        ) const;
+
+        bool operator==(const VertexLayout& other) const = default;
+    };
+}
\ No newline at end of file
@@ -7,6 +7,8 @@
 namespace AE
 {
     class Shader;
+    class ShaderCache;
+    class ShaderCompiler;
     class ShaderManager : public ResourceManager<Shader>
     {
     public:
@@ -23,6 +25,49 @@ namespace AE
             const std::string& fragmentSrc
         );
 
+        // Loads a shader whose feature permutations (see ShaderFeature) are compiled
+        // lazily through Shader::GetVariant() with the matching #defines injected.
+        std::shared_ptr<Shader> LoadPermutations(const std::string& name,
+            const std::string& vertexPath,
+            const std::string& fragmentPath
+        );
+
+        // Non-blocking variants: the returned shader stays pending (Shader::IsPending())
+        // until the driver finishes it, so many loads can compile in parallel.
+        std::shared_ptr<Shader> LoadAsync(const std::string& name,
+            const std::string& vertexPath,
+            const std::string& fragmentPath
+        );
+
+        std::shared_ptr<Shader> LoadPermutationsAsync(const std::string& name,
+            const std::string& vertexPath,
+            const std::string& fragmentPath
+        );
+
+        void WaitForPending();
+        std::size_t GetPendingCount() const;
+
+        ShaderCache* GetCache() const;
+
+    private:
+
+        friend class Engine;
+
+        // Shared with the variant compilers, which live as long as their shaders.
+        std::shared_ptr<ShaderCompiler> _compiler;
+
+        void _Update();
+
+        std::shared_ptr<Shader> _LoadFromFiles(const std::string& name,
+            const std::string& vertexPath, const std::string& fragmentPath,
+            bool permutations, bool async
+        );
+
+        std::shared_ptr<Shader> _Build(const std::string& name,
+            const std::string& vertexSrc, const std::string& fragmentSrc,
+            bool permutations, bool async
+        );
+
     };
 
     class Texture;
@@ -60,16 +105,24 @@ namespace AE
 
     class Material;
     class Mesh;
+    struct MeshGeometry;
     class Model;
     class ModelNode;
+    class StaticBatcher;
     class ModelManager : public ResourceManager<Model>
     {
     public:
 
         ModelManager(TextureManager* textureMgr);
 
+        // With staticBatch, meshes sharing a material are pre-transformed and merged into
+        // spatial chunks (see StaticBatcher). The node hierarchy is not kept.
+        // With keepCPUData, meshes are CPU-retained whatever the residency setting, so they can be
+        // merged or simplified later on (StaticBatcher::Add, HLODBuilder).
         std::shared_ptr<Model> Load(const std::string& name,
-            const std::string& path
+            const std::string& path,
+            bool staticBatch = false,
+            bool keepCPUData = false
         );
     
     private:
@@ -77,11 +130,39 @@ namespace AE
         // NOTE: Not thread-safe! Fix if parallel loading is needed.
         std::string _directory = ".";
         std::string _currentModelName;
+        std::size_t _currentVertexCount = 0;
+        std::size_t _currentVertexBytes = 0;
+        std::size_t _currentMeshCount = 0;
+        std::size_t _currentShortIndexMeshes = 0;
+        std::size_t _currentGPUBytes = 0;
+        std::size_t _currentCPUBytes = 0;
+        std::size_t _currentReleasedBytes = 0;
+        bool _currentKeepCPUData = false;
+        std::size_t _currentMaterialRefs = 0;
+        std::size_t _currentMaterialsMerged = 0;    // duplicates within the model being loaded
+        std::size_t _currentMaterialsShared = 0;    // taken over from models loaded before
 
         TextureManager* _textureMgr;
 
+        // Meshes of the model being loaded, indexed like aiScene::mMeshes.
+        std::vector<std::shared_ptr<Mesh>> _meshes;
+
+        // Materials of the model being loaded, indexed like aiScene::mMaterials.
+        std::vector<std::shared_ptr<Material>> _materials;
+
+        // Imported materials by content hash, shared across models while any of them is alive.
+        std::unordered_map<uint64_t, std::vector<std::weak_ptr<Material>>> _materialCache;
+
         void _ProcessNode(aiNode* node, const aiScene* scene, const std::shared_ptr<ModelNode>& parent);
-        std::shared_ptr<Mesh> _ProcessMesh(aiMesh* mesh, const aiScene* scene);
+        void _BatchNode(aiNode* node, const aiScene* scene, const glm::mat4& parentTransform,
+            const std::vector<MeshGeometry>& geometries, StaticBatcher& batcher);
+        void _ProcessMeshes(const aiScene* scene);
+        std::vector<MeshGeometry> _ExtractGeometries(const aiScene* scene, bool optimize);
+        MeshGeometry _ExtractGeometry(const aiMesh* mesh) const;
+        std::shared_ptr<Mesh> _CreateMesh(const aiMesh* mesh, MeshGeometry&& geometry);
+        void _AddMeshStats(const Mesh& mesh);
+        std::shared_ptr<Material> _GetMaterial(unsigned int index, const aiScene* scene);
+        std::shared_ptr<Material> _InternMaterial(const std::shared_ptr<Material>& material);
         std::shared_ptr<Material> _ProcessMaterial(aiMaterial* aiMat, const aiScene* scene);
         std::shared_ptr<Texture> _LoadTexture(aiMaterial* aiMat, aiTextureType type, const aiScene* scene);
         glm::mat4 _ConvertMatrix(const aiMatrix4x4& aiMat);
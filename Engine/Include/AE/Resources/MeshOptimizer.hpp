@@ -0,0 +1,96 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Rendering/Meshlet.hpp"
+
+namespace AE
+{
+    // CPU-side geometry of a single mesh, before it is uploaded.
+    struct MeshGeometry
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<glm::vec2> texCoords;
+        std::vector<glm::vec3> tangents;
+        std::vector<glm::vec3> bitangents;
+        std::vector<glm::vec2> lightmapTexCoords;
+        std::vector<uint32_t> indices;
+
+        // Filled when the mesh is split into clusters, each one a contiguous range of `indices`.
+        std::vector<Meshlet> meshlets;
+
+        std::size_t GetVertexCount() const { return positions.size(); }
+        std::size_t GetTriangleCount() const { return indices.size() / 3; }
+    };
+
+    // Import-time optimization of triangle lists: vertex welding, post-transform
+    // vertex cache ordering (Forsyth), overdraw-aware cluster ordering, meshlet
+    // clustering and vertex fetch ordering. Stateless and safe to run on worker threads.
+    class MeshOptimizer
+    {
+    public:
+
+        struct Settings
+        {
+            bool weldVertices = true;
+            bool optimizeVertexCache = true;
+            bool optimizeOverdraw = true;
+            bool optimizeVertexFetch = true;
+
+            // Size of the simulated FIFO cache used for ACMR and cluster splitting.
+            int cacheSize = 32;
+
+            // Overdraw ordering may make the ACMR at most this much worse.
+            float overdrawThreshold = 1.05f;
+
+            // Meshes with more triangles than fit in one meshlet are split for cluster culling.
+            bool buildMeshlets = true;
+            std::size_t meshletMaxVertices = 64;
+            std::size_t meshletMaxTriangles = 124;
+
+            // How much a meshlet prefers triangles facing its way, which tightens its normal cone.
+            float meshletConeWeight = 0.25f;
+        };
+
+        struct Stats
+        {
+            std::size_t verticesBefore = 0;
+            std::size_t verticesAfter = 0;
+            std::size_t triangles = 0;
+            std::size_t meshlets = 0;
+
+            // Average cache miss ratio: transformed vertices per triangle.
+            float acmrBefore = 0.0f;
+            float acmrAfter = 0.0f;
+        };
+
+        static Stats Optimize(MeshGeometry& geometry, const Settings& settings);
+        static Stats Optimize(MeshGeometry& geometry);
+
+        // Merges vertices whose attributes are bit-identical. Returns the new vertex count.
+        static std::size_t WeldVertices(MeshGeometry& geometry);
+
+        static void OptimizeVertexCache(std::vector<uint32_t>& indices, std::size_t vertexCount);
+        static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+            int cacheSize = 32, float threshold = 1.05f);
+
+        // Greedily grows clusters along shared vertices and reorders the triangles so each one is
+        // contiguous. Run it after the cache and overdraw passes, it keeps their order within a meshlet.
+        static std::vector<Meshlet> BuildMeshlets(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+            std::size_t maxVertices = 64, std::size_t maxTriangles = 124, float coneWeight = 0.25f);
+
+        // Reorders vertices by first use and drops unreferenced ones. Returns the new vertex count.
+        static std::size_t OptimizeVertexFetch(MeshGeometry& geometry);
+
+        // Vertex clustering (Lindstrom 2000): vertices snap to a grid of `cellSize` and every cell collapses
+        // to the point with the least quadric error of its triangles. Coarse but robust on merged, non-manifold
+        // input, meant for distant proxies. Tangents, lightmap coordinates and meshlets are dropped. Returns the new triangle count.
+        static std::size_t SimplifyClustered(MeshGeometry& geometry, float cellSize);
+        // Same, on a grid starting at `gridOrigin` instead of the bounds of the geometry. Meshes simplified on one
+        // grid collapse their shared border vertices into the same cells.
+        static std::size_t SimplifyClustered(MeshGeometry& geometry, float cellSize, const glm::vec3& gridOrigin);
+
+        static float ComputeACMR(const std::vector<uint32_t>& indices, std::size_t vertexCount, int cacheSize = 32);
+    };
+}
\ No newline at end of file
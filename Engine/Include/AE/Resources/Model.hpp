@@ -2,6 +2,9 @@
 
 #include "PCH.hpp"
 
+#include "Math/AABB.hpp"
+#include "Math/BoundingSphere.hpp"
+
 namespace AE
 {
     class Mesh;
@@ -50,10 +53,41 @@ namespace AE
     class Model
     {
     public:
+
+        // One mesh of the hierarchy, with its node transforms and bounds already folded into model space.
+        struct DrawItem
+        {
+            Mesh* mesh;
+            Material* material;
+            glm::mat4 transform;
+            BoundingSphere sphere;
+            AABB bounds;
+            std::size_t triangleCount;
+        };
+
         Model() : root(std::make_shared<ModelNode>("Root")) {}
         ~Model() = default;
     
         std::shared_ptr<ModelNode> root;
 
+        // Rebuilds the draw list from the hierarchy. Call it again after editing nodes.
+        void Flatten();
+
+        const std::vector<DrawItem>& GetDrawItems() const;
+        bool IsFlattened() const;
+
+        // Model-space bounds of every draw item.
+        const BoundingSphere& GetBoundingSphere() const;
+        const AABB& GetAABB() const;
+        std::size_t GetTriangleCount() const;
+
+    private:
+
+        std::vector<DrawItem> _drawItems;
+        BoundingSphere _sphere;
+        AABB _bounds;
+        std::size_t _triangleCount = 0;
+
+        void _FlattenNode(const ModelNode* node, const glm::mat4& parentTransform);
     };
 }    
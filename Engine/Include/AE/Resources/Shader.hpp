@@ -2,13 +2,98 @@
 
 #include "PCH.hpp"
 
+#include <functional>
+#include <string_view>
+#include <span>
+
 namespace AE
 {
+    enum class ShaderFeature : uint32_t
+    {
+        None            = 0,
+        DiffuseTexture  = 1 << 0,
+        SpecularTexture = 1 << 1,
+        EmissiveTexture = 1 << 2,
+        NormalTexture   = 1 << 3,
+        OpacityTexture  = 1 << 4,
+        Wireframe       = 1 << 5,
+
+        // Vertex decoding, selected by the mesh's vertex layout
+        OctahedralNormal = 1 << 6,
+        QTangentFrame    = 1 << 7,
+        Lightmap         = 1 << 8,  // lightmap texture coordinates, see BakedLighting
+
+        // Lighting from the level's BakedLighting, the lightmap if the mesh has one, else the probes
+        BakedLighting    = 1 << 9
+    };
+
+    inline ShaderFeature operator|(ShaderFeature a, ShaderFeature b)
+    {
+        return static_cast<ShaderFeature>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+
+    inline ShaderFeature operator&(ShaderFeature a, ShaderFeature b)
+    {
+        return static_cast<ShaderFeature>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+    }
+
+    inline ShaderFeature& operator|=(ShaderFeature& a, ShaderFeature b) { return a = a | b; }
+
+    inline bool HasFeature(ShaderFeature features, ShaderFeature feature)
+    {
+        return (features & feature) == feature;
+    }
+
+    constexpr uint64_t HashUniformName(std::string_view name)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : name)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    // Process-wide id of a uniform name. Create handles once (e.g. as statics) and reuse
+    // them: every shader resolves a handle to its location only once, after which setting
+    // the uniform is an array lookup plus the GL call.
+    class UniformHandle
+    {
+    public:
+
+        explicit UniformHandle(std::string_view name);
+
+        uint32_t GetIndex() const;
+        uint64_t GetHash() const;
+        const std::string& GetName() const;
+
+    private:
+
+        uint32_t _index;
+        uint64_t _hash;
+
+    };
+
     class Shader
     {
     public:
+
+        struct UniformInfo
+        {
+            std::string name;
+            GLint location;
+            GLenum type;
+            GLint size;
+        };
+
+        struct UniformStats
+        {
+            uint64_t uploads = 0;
+            uint64_t skipped = 0;
+        };
     
-        Shader(GLuint id = 0);
+        Shader(GLuint id = 0, ShaderFeature features = ShaderFeature::None);
         ~Shader();
     
         void Bind() const;
@@ -17,9 +102,23 @@ namespace AE
         GLuint GetID() const;
     
         GLint GetUniformLocation(const std::string& name);
+        GLint GetUniformLocation(const UniformHandle& handle);
+
+        // Active uniforms reflected when the program was linked.
+        const std::vector<UniformInfo>& GetUniforms() const;
    
         bool IsValid() const;
 
+        // Still compiling in the background; not usable until the shader manager finishes it.
+        bool IsPending() const;
+
+        // Returns the permutation compiled with the given features. Variants are compiled
+        // on first use (asynchronously, so they may be pending) and cached; shaders loaded
+        // without permutations return themselves.
+        Shader* GetVariant(ShaderFeature features);
+        ShaderFeature GetFeatures() const;
+        std::size_t GetVariantCount() const;
+
         void SetInt(const std::string& name, int value);
         void SetFloat(const std::string& name, float value);
         void SetBool(const std::string& name, bool value);
@@ -28,12 +127,71 @@ namespace AE
         void SetVec4(const std::string& name, const glm::vec4& value);
         void SetMat3(const std::string& name, const glm::mat3& value);
         void SetMat4(const std::string& name, const glm::mat4& value);
+
+        void SetInt(const UniformHandle& handle, int value);
+        void SetFloat(const UniformHandle& handle, float value);
+        void SetBool(const UniformHandle& handle, bool value);
+        void SetVec2(const UniformHandle& handle, const glm::vec2& value);
+        void SetVec3(const UniformHandle& handle, const glm::vec3& value);
+        void SetVec4(const UniformHandle& handle, const glm::vec4& value);
+        void SetMat3(const UniformHandle& handle, const glm::mat3& value);
+        void SetMat4(const UniformHandle& handle, const glm::mat4& value);
+
+        // Consecutive elements of an array uniform from the handle's element on, in one upload.
+        void SetVec3Array(const UniformHandle& handle, std::span<const glm::vec3> values);
+
+        // Set* calls whose value matches the last upload are skipped; these count both.
+        // Values written with raw glUniform* calls bypass the shadow copies.
+        const UniformStats& GetUniformStats() const;
+
+        static const UniformStats& GetGlobalUniformStats();
+        static void ResetGlobalUniformStats();
     
     private:
+
+        friend class ShaderManager;
+        friend class ShaderCompiler;
+
+        using VariantCompiler = std::function<std::shared_ptr<Shader>(ShaderFeature)>;
     
         GLuint _id;
+        ShaderFeature _features;
+        bool _pending = false;
     
-        std::unordered_map<std::string, GLint> _uniforms;
+        struct UniformShadow
+        {
+            std::array<unsigned char, sizeof(glm::mat4)> value;
+            bool valid = false;
+        };
+
+        std::vector<UniformInfo> _uniforms;
+        std::vector<UniformShadow> _shadows;
+        std::vector<GLint> _arrayLengths;   // array elements from each slot to the end of its array, 1 otherwise
+        std::unordered_map<uint64_t, GLint> _slots;
+        std::vector<GLint> _handleSlots;
+
+        UniformStats _uniformStats;
+
+        VariantCompiler _variantCompiler;
+        std::unordered_map<uint32_t, std::shared_ptr<Shader>> _variants;
+
+        void _SetVariantCompiler(VariantCompiler compiler);
+        void _SetProgram(GLuint id);
+
+        void _Reflect();
+        GLint _FindSlot(uint64_t hash, const std::string& name);
+        GLint _GetSlot(const UniformHandle& handle);
+        GLint _ResolveHandle(const UniformHandle& handle);
+        bool _ShouldUpload(GLint slot, const void* data, std::size_t size);
+
+        void _UploadInt(GLint slot, int value);
+        void _UploadFloat(GLint slot, float value);
+        void _UploadVec2(GLint slot, const glm::vec2& value);
+        void _UploadVec3(GLint slot, const glm::vec3& value);
+        void _UploadVec4(GLint slot, const glm::vec4& value);
+        void _UploadMat3(GLint slot, const glm::mat3& value);
+        void _UploadMat4(GLint slot, const glm::mat4& value);
+        void _UploadVec3Array(GLint slot, std::span<const glm::vec3> values);
     
     };
 }
\ No newline at end of file
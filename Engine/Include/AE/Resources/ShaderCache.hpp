@@ -0,0 +1,54 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include <filesystem>
+
+namespace AE
+{
+    // On-disk cache of linked program binaries (GL_ARB_get_program_binary).
+    // Entries are keyed by the final shader sources and the driver identity, and the
+    // whole cache is purged when the vendor, renderer or driver version changes.
+    class ShaderCache
+    {
+    public:
+
+        struct CacheStats
+        {
+            uint32_t hits = 0;
+            uint32_t misses = 0;
+            uint32_t stores = 0;
+
+            double loadTimeMs = 0.0;
+            double savedTimeMs = 0.0;
+        };
+
+        ShaderCache(const std::string& directory);
+        ~ShaderCache();
+
+        ShaderCache(const ShaderCache&) = delete;
+        ShaderCache& operator=(const ShaderCache&) = delete;
+
+        uint64_t GetKey(const std::string& vertexSrc, const std::string& fragmentSrc) const;
+
+        // Returns a linked program, or 0 if the entry is missing, stale or rejected by the driver.
+        GLuint Load(uint64_t key);
+        bool Store(uint64_t key, GLuint program, double compileTimeMs);
+
+        const CacheStats& GetStats() const;
+
+        bool IsEnabled() const;
+
+    private:
+
+        std::filesystem::path _directory;
+        uint64_t _driverHash = 0;
+        bool _enabled = false;
+
+        CacheStats _stats;
+
+        std::filesystem::path _GetEntryPath(uint64_t key) const;
+        void _ValidateDriver(const std::string& driverInfo);
+
+    };
+}
\ No newline at end of file
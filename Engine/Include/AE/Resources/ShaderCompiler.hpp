@@ -0,0 +1,75 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include <chrono>
+
+namespace AE
+{
+    class Shader;
+    class ShaderCache;
+    enum class ShaderFeature : uint32_t;
+
+    // Issues compiles and links without waiting on them, so the driver can work on many
+    // programs at once (GL_KHR_parallel_shader_compile). Shaders handed out by CompileAsync()
+    // stay pending until Update() finds their program finished.
+    class ShaderCompiler
+    {
+    public:
+
+        ShaderCompiler(std::shared_ptr<ShaderCache> cache = nullptr);
+        ~ShaderCompiler();
+
+        ShaderCompiler(const ShaderCompiler&) = delete;
+        ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+        std::shared_ptr<Shader> CompileAsync(const std::string& name,
+            const std::string& vertexSrc,
+            const std::string& fragmentSrc,
+            ShaderFeature features
+        );
+
+        // Blocking compile; returns the linked program or 0.
+        GLuint Compile(const std::string& vertexSrc, const std::string& fragmentSrc);
+
+        // Finalizes every program the driver has finished. Never blocks when the
+        // parallel compile extension is available.
+        void Update();
+
+        // Blocks until every pending program is finalized.
+        void Flush();
+
+        std::size_t GetPendingCount() const;
+        bool IsParallel() const;
+
+        ShaderCache* GetCache() const;
+
+    private:
+
+        struct PendingProgram
+        {
+            std::string name;
+            std::weak_ptr<Shader> shader;
+
+            GLuint vertex = 0;
+            GLuint fragment = 0;
+            GLuint program = 0;
+
+            uint64_t cacheKey = 0;
+
+            // Spent in the compile/link calls and the status checks that wait for them. Frames passing
+            // between issue and finalize aren't counted: this is the time a cached binary saves the calling thread.
+            double compileTimeMs = 0.0;
+        };
+
+        std::shared_ptr<ShaderCache> _cache;
+        std::vector<PendingProgram> _pending;
+
+        bool _parallel = false;
+
+        PendingProgram _Issue(const std::string& vertexSrc, const std::string& fragmentSrc);
+        void _Resolve(bool wait);
+        GLuint _Finalize(PendingProgram& pending);
+
+    };
+}
\ No newline at end of file
@@ -19,14 +19,24 @@ namespace AE
         virtual ~Texture();
 
         static std::shared_ptr<Texture> Create(const TextureData& data, bool generateMipmaps = false);
+        // Empty texture with exactly the formats and sampling of the descriptor, e.g. a render target.
+        static std::shared_ptr<Texture> Create(const TextureDesc& descriptor);
 
         void Bind(int slot = 0) const;
         void Unbind(int slot = 0) const;
 
-        void Resize(int width, int height);
+        // Storage grows in steps and stays when shrinking a little, the texture then only covers the corner
+        // of it starting at texel (0, 0): render through a viewport of its size and scale UVs by GetUVScale.
+        // Texels past that corner keep stale contents, and neither wrapping nor ClampToEdge stops at the corner,
+        // so filtered lookups must clamp their UVs to GetUVLimit. Mipmaps would mix the stale texels in as well.
+        // Returns whether the storage was allocated again. Its contents are lost then.
+        bool Resize(int width, int height);
 
         void GenerateMipmaps();
 
+        // Reads a mip level back as RGBA8. Waits for the GPU, so it's meant for load-time baking.
+        std::vector<unsigned char> ReadPixels(int level, int& width, int& height) const;
+
         static std::shared_ptr<Texture> GetDefault();
 
         const TextureDesc& GetDescriptor() const;
@@ -34,6 +44,11 @@ namespace AE
         GLuint GetID() const;
         int GetWidth() const;
         int GetHeight() const;
+        int GetCapacityWidth() const;
+        int GetCapacityHeight() const;
+        glm::vec2 GetUVScale() const;
+        // Largest UV a bilinear lookup can take without reading past the texture's corner of the storage.
+        glm::vec2 GetUVLimit() const;
         int GetChannels() const;
         TextureFilter GetMinFilter() const;
         TextureFilter GetMagFilter() const;
@@ -50,6 +65,9 @@ namespace AE
         void SetWrapS(TextureWrap wrap);
         void SetWrapT(TextureWrap wrap);
 
+        // Highest mip level sampled. Atlases cap it so their tiles don't blur into each other.
+        void SetMaxLevel(int level);
+
     protected:
 
         virtual void AllocateStorage(int width, int height, GLenum internalFormat, GLenum format);
@@ -61,5 +79,9 @@ namespace AE
         GLuint _id;
         bool _hasMipmaps = false;
         bool _hasTransparency = false;
+
+        // Allocated size, at least the size of the texture.
+        int _capacityWidth = 0;
+        int _capacityHeight = 0;
     };
 }
\ No newline at end of file
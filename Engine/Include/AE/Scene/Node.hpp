@@ -39,6 +39,14 @@ namespace AE
         bool IsEnabled() const;
         void SetEnabled(bool enabled);
 
+        // Hidden nodes keep updating but skip rendering, children included.
+        bool IsVisible() const;
+        void SetVisible(bool visible);
+
+        // Static nodes promise not to move, so their geometry may be merged at load time.
+        bool IsStatic() const;
+        void SetStatic(bool isStatic);
+
     protected:
 
         Transform transform;
@@ -60,6 +68,8 @@ namespace AE
         {
             bool initialized = false;
             bool enabled = true;
+            bool visible = true;
+            bool isStatic = false;
         } _state;
 
         bool _Initialize();
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Math/AABB.hpp"
+
+#include <span>
+
+namespace AE
+{
+    class Texture;
+    class LightSource;
+
+    // Diffuse light of the static lights in a static level, path traced offline (see the LightBaker
+    // tool) and saved next to the level: a lightmap for the level's own surfaces, and a grid of
+    // irradiance probes for everything else. Shaders multiply either with the surface color, in
+    // place of the real-time loop over the baked lights. Everything is in world space.
+    class BakedLighting
+    {
+    public:
+
+        // A mesh of the level in world space. Bake generates its lightmap coordinates, splitting vertices
+        // where charts meet: afterwards `sourceVertices` holds the input vertex every vertex came from.
+        struct BakeMesh
+        {
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec3> normals;
+            std::vector<uint32_t> indices;
+            glm::vec3 albedo = glm::vec3(0.8f);
+
+            std::vector<glm::vec2> lightmapTexCoords;
+            std::vector<uint32_t> sourceVertices;
+        };
+
+        struct BakeSettings
+        {
+            float texelsPerUnit = 4.0f;
+            int maxLightmapSize = 2048;         // texels per side, the density is lowered until the charts fit
+            int padding = 2;                    // texels around every chart, keeps filtering from bleeding
+            int samples = 128;                  // paths per texel and per probe
+            int bounces = 2;
+            float probeSpacing = 2.0f;
+            std::size_t maxProbes = 32768;
+            glm::vec3 skyColor = glm::vec3(0.0f);   // radiance of rays leaving the level
+            int threads = 0;                    // 0 = hardware concurrency
+        };
+
+        struct BakeStats
+        {
+            glm::ivec2 lightmapSize = glm::ivec2(0, 0);
+            std::size_t charts = 0;
+            std::size_t texels = 0;             // texels covered by a surface
+            std::size_t probes = 0;
+            std::size_t invalidProbes = 0;      // inside geometry, filled from their neighbours
+            std::size_t raysCast = 0;
+            double elapsedMs = 0.0;
+        };
+
+        // L2 spherical harmonics, already convolved with the cosine lobe: evaluated for a normal they
+        // give the diffuse light arriving at a surface facing that way.
+        using SHCoefficients = std::array<glm::vec3, 9>;
+
+        static std::shared_ptr<BakedLighting> Bake(std::vector<BakeMesh>& meshes, std::span<LightSource* const> lights,
+            const BakeSettings& settings);
+        static std::shared_ptr<BakedLighting> Bake(std::vector<BakeMesh>& meshes, std::span<LightSource* const> lights);
+
+        static std::shared_ptr<BakedLighting> Load(const std::string& path);
+        bool Save(const std::string& path) const;
+
+        // Trilinear blend of the eight probes around the position, clamped to the grid.
+        SHCoefficients SampleProbes(const glm::vec3& position) const;
+        static glm::vec3 EvaluateSH(const SHCoefficients& sh, const glm::vec3& normal);
+
+        // RGB16F, uploaded on first use.
+        const std::shared_ptr<Texture>& GetLightmapTexture();
+
+        const glm::ivec2& GetLightmapSize() const;
+        const AABB& GetProbeBounds() const;
+        const glm::ivec3& GetProbeResolution() const;
+        float GetProbeSpacing() const;
+        std::size_t GetProbeCount() const;
+        const BakeStats& GetBakeStats() const;
+
+    private:
+
+        glm::ivec2 _lightmapSize = glm::ivec2(0, 0);
+        std::vector<uint16_t> _lightmap;    // RGB half floats, rows from v = 0
+        std::shared_ptr<Texture> _lightmapTexture;
+
+        // Probes sit on the corners of the cells, the first one at _probeBounds.min.
+        AABB _probeBounds;
+        glm::ivec3 _probeResolution = glm::ivec3(0, 0, 0);
+        float _probeSpacing = 1.0f;
+        std::vector<SHCoefficients> _probes;
+
+        BakeStats _bakeStats;
+
+        void _ResizeProbes(const AABB& bounds, float spacing);
+        std::size_t _GetProbeIndex(const glm::ivec3& coords) const;
+    };
+}
\ No newline at end of file
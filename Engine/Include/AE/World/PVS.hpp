@@ -0,0 +1,78 @@
+#pragma once
+
+#include "PCH.hpp"
+
+#include "Math/AABB.hpp"
+
+#include <span>
+
+namespace AE
+{
+    // Potentially visible set of a static level: the level is split into a grid of cells and
+    // every cell stores which other cells can be seen from anywhere inside it. Baked offline
+    // (see the PVSBaker tool) and saved next to the level. Everything is in world space.
+    class PVS
+    {
+    public:
+
+        struct BakeSettings
+        {
+            float cellSize = 4.0f;
+            int samples = 32;           // rays per cell pair; more rays find smaller openings
+            int dilation = 1;           // cells added around every visible cell, hides sampling misses
+            int threads = 0;            // 0 = hardware concurrency
+            std::size_t maxCells = 16384;
+        };
+
+        struct BakeStats
+        {
+            std::size_t cells = 0;
+            std::size_t pairsTested = 0;
+            std::size_t raysCast = 0;
+            float visibleFraction = 0.0f;
+            double elapsedMs = 0.0;
+        };
+
+        // Visibility is sampled with rays between random points of two cells, against the triangles.
+        static std::shared_ptr<PVS> Bake(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+            const BakeSettings& settings);
+        static std::shared_ptr<PVS> Bake(std::span<const glm::vec3> positions, std::span<const uint32_t> indices);
+
+        static std::shared_ptr<PVS> Load(const std::string& path);
+        bool Save(const std::string& path) const;
+
+        // -1 outside the grid.
+        int GetCell(const glm::vec3& position) const;
+        bool IsCellVisible(int from, int to) const;
+
+        // Whether any cell the box touches is visible from `fromCell`. Boxes leaving the grid
+        // and a camera outside of it (-1) are always visible.
+        bool IsVisible(int fromCell, const AABB& bounds) const;
+
+        const AABB& GetBounds() const;
+        const glm::ivec3& GetResolution() const;
+        float GetCellSize() const;
+        std::size_t GetCellCount() const;
+        const BakeStats& GetBakeStats() const;
+
+        // Average share of the level visible from a cell.
+        float GetVisibleFraction() const;
+
+    private:
+
+        AABB _bounds;
+        glm::ivec3 _resolution = glm::ivec3(0, 0, 0);
+        float _cellSize = 1.0f;
+
+        // One row of _rowWords bits per cell.
+        std::vector<uint64_t> _bits;
+        std::size_t _rowWords = 0;
+
+        BakeStats _bakeStats;
+
+        void _Resize(const AABB& bounds, float cellSize);
+        glm::ivec3 _GetCoords(std::size_t cell) const;
+        std::size_t _GetIndex(const glm::ivec3& coords) const;
+        void _SetVisible(std::size_t from, std::size_t to);
+    };
+}
\ No newline at end of file
@@ -224,6 +224,12 @@ namespace AE
 
         _inputMgr->_Update();
         _PollEvents();
+
+        // Once per frame, after every resize event of the frame was handled.
+        if (_window->_ConsumeResize())
+            _renderer->_OnResize(_window->GetWidth(), _window->GetHeight());
+
+        _shaderMgr->_Update();
         _application->_Update();
         _sceneMgr->_Update();
     }
@@ -1,4 +1,5 @@
 #include "Lighting/Manager.hpp"
+#include "Rendering/Uniforms.hpp"
 #include "Core/Logger.hpp"
 
 namespace AE
@@ -36,7 +37,7 @@ namespace AE
         return false;
     }
 
-    void LightManager::Apply(Shader* shader)
+    void LightManager::Apply(Shader* shader, bool skipBaked)
     {
         if (!shader) return;
 
@@ -46,7 +47,7 @@ namespace AE
 
         for (auto& [id, light] : _lights)
         {
-            if (!light->enabled) continue;
+            if (!light->enabled || (skipBaked && light->baked)) continue;
             
             switch (light->GetType())
             {
@@ -62,9 +63,9 @@ namespace AE
             }
         }
 
-        shader->SetInt("u_DirLightCount", static_cast<int>(directionalLights.size()));
-        shader->SetInt("u_PointLightCount", static_cast<int>(pointLights.size()));
-        shader->SetInt("u_SpotLightCount", static_cast<int>(spotLights.size()));
+        shader->SetInt(Uniforms::DirLightCount, static_cast<int>(directionalLights.size()));
+        shader->SetInt(Uniforms::PointLightCount, static_cast<int>(pointLights.size()));
+        shader->SetInt(Uniforms::SpotLightCount, static_cast<int>(spotLights.size()));
 
         for (size_t i = 0; i < directionalLights.size(); ++i)
         {
@@ -87,6 +88,18 @@ namespace AE
         return _lights.size();
     }
 
+    std::vector<LightSource*> LightManager::GetEnabledLights(bool skipBaked) const
+    {
+        std::vector<LightSource*> lights;
+        lights.reserve(_lights.size());
+
+        for (const auto& [id, light] : _lights)
+            if (light->enabled && !(skipBaked && light->baked))
+                lights.push_back(light.get());
+
+        return lights;
+    }
+
     bool LightManager::HasLight(const std::string& name) const
     {
         return _lights.find(name) != _lights.end();
@@ -28,6 +28,16 @@ namespace AE
         shader->SetFloat(prefix + ".constant", constant);
         shader->SetFloat(prefix + ".linear", linear);
         shader->SetFloat(prefix + ".quadratic", quadratic);
+
+        shader->SetBool(prefix + ".hasShadow", shadow.enabled);
+        if (!shadow.enabled) return;
+
+        for (int face = 0; face < 6; ++face)
+            shader->SetVec2(prefix + ".shadowFaces[" + std::to_string(face) + "]", shadow.faces[face]);
+
+        shader->SetFloat(prefix + ".shadowTileSize", shadow.tileSize);
+        shader->SetFloat(prefix + ".shadowNear", shadow.nearPlane);
+        shader->SetFloat(prefix + ".shadowFar", shadow.farPlane);
     }
     
     LightType PointLight::GetType()
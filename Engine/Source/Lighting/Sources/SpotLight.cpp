@@ -33,6 +33,10 @@ namespace AE
         shader->SetFloat(prefix + ".constant", constant);
         shader->SetFloat(prefix + ".linear", linear);
         shader->SetFloat(prefix + ".quadratic", quadratic);
+
+        shader->SetBool(prefix + ".hasShadow", shadow.enabled);
+        if (shadow.enabled)
+            shader->SetMat4(prefix + ".shadowMatrix", shadow.matrix);
     }
     
     LightType SpotLight::GetType()
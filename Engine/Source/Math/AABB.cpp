@@ -1,4 +1,5 @@
 #include "Math/AABB.hpp"
+#include "Math/SIMD.hpp"
 
 namespace AE
 {
@@ -58,7 +59,11 @@ namespace AE
     AABB AABB::Transform(const glm::mat4& matrix) const
     {
         std::array<glm::vec3, 8> vertices = GetVertices();
-        AABB result;
+
+        // Seeded with the first corner, a default box would always include the origin.
+        glm::vec4 first = matrix * glm::vec4(vertices[0], 1.0f);
+        glm::vec3 corner = glm::vec3(first) / first.w;
+        AABB result(corner, corner);
         
         for (const auto& vertex : vertices)
         {
@@ -68,4 +73,43 @@ namespace AE
         
         return result;
     }
+
+    AABB AABB::FromPoints(std::span<const glm::vec3> points)
+    {
+        if (points.empty())
+            return AABB();
+
+        glm::vec3 min = points[0];
+        glm::vec3 max = points[0];
+        std::size_t i = 0;
+
+#ifdef AE_SIMD_SSE2
+        if (points.size() >= 4)
+        {
+            __m128 minX = _mm_set1_ps(min.x), minY = _mm_set1_ps(min.y), minZ = _mm_set1_ps(min.z);
+            __m128 maxX = minX, maxY = minY, maxZ = minZ;
+
+            for (; i + 4 <= points.size(); i += 4)
+            {
+                __m128 x, y, z;
+                SIMD::LoadVec3x4(points.data() + i, x, y, z);
+
+                minX = _mm_min_ps(minX, x); maxX = _mm_max_ps(maxX, x);
+                minY = _mm_min_ps(minY, y); maxY = _mm_max_ps(maxY, y);
+                minZ = _mm_min_ps(minZ, z); maxZ = _mm_max_ps(maxZ, z);
+            }
+
+            min = glm::vec3(SIMD::HorizontalMin(minX), SIMD::HorizontalMin(minY), SIMD::HorizontalMin(minZ));
+            max = glm::vec3(SIMD::HorizontalMax(maxX), SIMD::HorizontalMax(maxY), SIMD::HorizontalMax(maxZ));
+        }
+#endif
+
+        for (; i < points.size(); ++i)
+        {
+            min = glm::min(min, points[i]);
+            max = glm::max(max, points[i]);
+        }
+
+        return AABB(min, max);
+    }
 }
@@ -0,0 +1,434 @@
+#include "Math/BVH.hpp"
+#include "Math/SIMD.hpp"
+
+#include <limits>
+
+namespace AE
+{
+    void BVH::Build(std::span<const glm::vec3> positions, std::span<const uint32_t> indices)
+    {
+        _nodes.clear();
+        _packets.clear();
+        _triangleCount = 0;
+
+        const std::size_t triangleCount = indices.size() / 3;
+
+        std::vector<uint32_t> order;
+        std::vector<AABB> boxes;
+        std::vector<glm::vec3> centroids;
+        std::vector<uint32_t> sources;
+
+        order.reserve(triangleCount);
+        boxes.reserve(triangleCount);
+        centroids.reserve(triangleCount);
+        sources.reserve(triangleCount);
+
+        for (std::size_t i = 0; i < triangleCount; ++i)
+        {
+            const uint32_t a = indices[i * 3], b = indices[i * 3 + 1], c = indices[i * 3 + 2];
+            if (a >= positions.size() || b >= positions.size() || c >= positions.size())
+                continue;
+
+            const glm::vec3& p0 = positions[a];
+            const glm::vec3& p1 = positions[b];
+            const glm::vec3& p2 = positions[c];
+
+            AABB box(glm::min(p0, glm::min(p1, p2)), glm::max(p0, glm::max(p1, p2)));
+
+            order.push_back(static_cast<uint32_t>(sources.size()));
+            sources.push_back(static_cast<uint32_t>(i));
+            centroids.push_back(box.GetCenter());
+            boxes.push_back(box);
+        }
+
+        if (sources.empty())
+            return;
+
+        _triangleCount = sources.size();
+        _nodes.reserve(_triangleCount * 2 / MaxLeafTriangles + 1);
+        _Build(order, boxes, centroids, 0, static_cast<uint32_t>(_triangleCount), 0);
+
+        // Every leaf gets its own packets, so they are read as whole registers.
+        _packets.reserve(_triangleCount / 2 + 1);
+        for (Node& node : _nodes)
+        {
+            if (node.count == 0)
+                continue;
+
+            const uint32_t first = node.first;
+            node.first = static_cast<uint32_t>(_packets.size());
+
+            for (uint32_t i = 0; i < node.count; ++i)
+            {
+                if (i % 4 == 0)
+                    _packets.push_back(TrianglePacket{});
+
+                TrianglePacket& packet = _packets.back();
+                const uint32_t lane = i % 4;
+                const uint32_t source = sources[order[first + i]];
+
+                const glm::vec3& p0 = positions[indices[source * 3]];
+                const glm::vec3 edge1 = positions[indices[source * 3 + 1]] - p0;
+                const glm::vec3 edge2 = positions[indices[source * 3 + 2]] - p0;
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    packet.v0[axis][lane] = p0[axis];
+                    packet.edge1[axis][lane] = edge1[axis];
+                    packet.edge2[axis][lane] = edge2[axis];
+                }
+                packet.triangles[lane] = source;
+            }
+        }
+    }
+
+    void BVH::_Build(std::vector<uint32_t>& order, std::vector<AABB>& boxes, std::vector<glm::vec3>& centroids,
+        uint32_t first, uint32_t count, int depth)
+    {
+        const uint32_t nodeIndex = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+
+        AABB bounds = boxes[order[first]];
+        AABB centroidBounds(centroids[order[first]], centroids[order[first]]);
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            bounds.Expand(boxes[order[i]]);
+            centroidBounds.Expand(centroids[order[i]]);
+        }
+
+        _nodes[nodeIndex].bounds = bounds;
+
+        const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+        if (count <= MaxLeafTriangles || extent[axis] <= 0.0f || depth >= MaxDepth)
+        {
+            _nodes[nodeIndex].first = first;
+            _nodes[nodeIndex].count = count;
+            return;
+        }
+
+        // Binned SAH along the longest centroid axis.
+        struct Bin { AABB bounds; uint32_t count = 0; };
+        std::array<Bin, BinCount> bins;
+
+        const float scale = BinCount / extent[axis];
+        auto GetBin = [&](uint32_t triangle)
+        {
+            int bin = static_cast<int>((centroids[triangle][axis] - centroidBounds.min[axis]) * scale);
+            return std::clamp(bin, 0, BinCount - 1);
+        };
+
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            Bin& bin = bins[GetBin(order[i])];
+            bin.bounds = bin.count == 0 ? boxes[order[i]] : AABB(glm::min(bin.bounds.min, boxes[order[i]].min), glm::max(bin.bounds.max, boxes[order[i]].max));
+            bin.count++;
+        }
+
+        auto Area = [](const AABB& box)
+        {
+            const glm::vec3 d = box.max - box.min;
+            return d.x * d.y + d.y * d.z + d.z * d.x;
+        };
+
+        // Sweep from the right to get the cost of every right side, then from the left.
+        std::array<float, BinCount> rightArea{};
+        std::array<uint32_t, BinCount> rightCount{};
+        AABB rightBounds;
+        uint32_t rightTotal = 0;
+        for (int i = BinCount - 1; i > 0; --i)
+        {
+            if (bins[i].count > 0)
+            {
+                rightBounds = rightTotal == 0 ? bins[i].bounds : AABB(glm::min(rightBounds.min, bins[i].bounds.min), glm::max(rightBounds.max, bins[i].bounds.max));
+                rightTotal += bins[i].count;
+            }
+            rightArea[i] = rightTotal > 0 ? Area(rightBounds) : 0.0f;
+            rightCount[i] = rightTotal;
+        }
+
+        float bestCost = std::numeric_limits<float>::max();
+        int bestSplit = -1;
+        AABB leftBounds;
+        uint32_t leftTotal = 0;
+        for (int i = 0; i < BinCount - 1; ++i)
+        {
+            if (bins[i].count > 0)
+            {
+                leftBounds = leftTotal == 0 ? bins[i].bounds : AABB(glm::min(leftBounds.min, bins[i].bounds.min), glm::max(leftBounds.max, bins[i].bounds.max));
+                leftTotal += bins[i].count;
+            }
+
+            if (leftTotal == 0 || rightCount[i + 1] == 0)
+                continue;
+
+            const float cost = leftTotal * Area(leftBounds) + rightCount[i + 1] * rightArea[i + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        // Splitting has to beat intersecting every triangle of a leaf.
+        if (bestSplit < 0 || (count <= MaxLeafTriangles * 4 && bestCost >= count * Area(bounds)))
+        {
+            _nodes[nodeIndex].first = first;
+            _nodes[nodeIndex].count = count;
+            return;
+        }
+
+        auto middle = std::partition(order.begin() + first, order.begin() + first + count,
+            [&](uint32_t triangle) { return GetBin(triangle) <= bestSplit; });
+
+        const uint32_t leftCount = static_cast<uint32_t>(middle - (order.begin() + first));
+
+        _Build(order, boxes, centroids, first, leftCount, depth + 1);
+        _nodes[nodeIndex].first = static_cast<uint32_t>(_nodes.size());
+        _Build(order, boxes, centroids, first + leftCount, count - leftCount, depth + 1);
+    }
+
+    int BVH::_IntersectPacket(const TrianglePacket& packet, const glm::vec3& origin, const glm::vec3& direction,
+        float tMin, float tMax, float* t, float* u, float* v)
+    {
+        // Möller-Trumbore, both faces count.
+        constexpr float Epsilon = 1e-12f;
+
+#ifdef AE_SIMD_SSE2
+        const __m128 dx = _mm_set1_ps(direction.x);
+        const __m128 dy = _mm_set1_ps(direction.y);
+        const __m128 dz = _mm_set1_ps(direction.z);
+
+        const __m128 e1x = _mm_load_ps(packet.edge1[0]), e1y = _mm_load_ps(packet.edge1[1]), e1z = _mm_load_ps(packet.edge1[2]);
+        const __m128 e2x = _mm_load_ps(packet.edge2[0]), e2y = _mm_load_ps(packet.edge2[1]), e2z = _mm_load_ps(packet.edge2[2]);
+
+        // p = direction x edge2
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+        // s = origin - v0
+        const __m128 sx = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_load_ps(packet.v0[0]));
+        const __m128 sy = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_load_ps(packet.v0[1]));
+        const __m128 sz = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_load_ps(packet.v0[2]));
+
+        const __m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+        // q = s x edge1
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+        const __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+        const __m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+
+        // Degenerate lanes divide by zero; their NaNs fail every comparison below anyway.
+        __m128 mask = _mm_cmpge_ps(absDet, _mm_set1_ps(Epsilon));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(uu, zero));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(vv, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(uu, vv), _mm_set1_ps(1.0f)));
+        mask = _mm_and_ps(mask, _mm_cmpgt_ps(tt, _mm_set1_ps(tMin)));
+        mask = _mm_and_ps(mask, _mm_cmplt_ps(tt, _mm_set1_ps(tMax)));
+
+        _mm_storeu_ps(t, tt);
+        _mm_storeu_ps(u, uu);
+        _mm_storeu_ps(v, vv);
+
+        return _mm_movemask_ps(mask);
+#else
+        int mask = 0;
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const glm::vec3 v0(packet.v0[0][lane], packet.v0[1][lane], packet.v0[2][lane]);
+            const glm::vec3 edge1(packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane]);
+            const glm::vec3 edge2(packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane]);
+
+            t[lane] = u[lane] = v[lane] = 0.0f;
+
+            const glm::vec3 p = glm::cross(direction, edge2);
+            const float det = glm::dot(edge1, p);
+            if (std::abs(det) < Epsilon)
+                continue;
+
+            const float invDet = 1.0f / det;
+            const glm::vec3 s = origin - v0;
+            const glm::vec3 q = glm::cross(s, edge1);
+
+            u[lane] = glm::dot(s, p) * invDet;
+            v[lane] = glm::dot(direction, q) * invDet;
+            t[lane] = glm::dot(edge2, q) * invDet;
+
+            if (u[lane] >= 0.0f && v[lane] >= 0.0f && u[lane] + v[lane] <= 1.0f && t[lane] > tMin && t[lane] < tMax)
+                mask |= 1 << lane;
+        }
+
+        return mask;
+#endif
+    }
+
+    static glm::vec3 GetInverseDirection(const glm::vec3& direction)
+    {
+        constexpr float Epsilon = 1e-6f;
+
+        glm::vec3 inverse;
+        for (int i = 0; i < 3; ++i)
+            inverse[i] = std::abs(direction[i]) > Epsilon ? 1.0f / direction[i] : std::copysign(std::numeric_limits<float>::max(), direction[i]);
+
+        return inverse;
+    }
+
+    // Parameter where the ray enters the box, or infinity when it misses it within (tMin, tMax).
+    static float GetBoxEntry(const AABB& box, const glm::vec3& origin, const glm::vec3& inverse, float tMin, float tMax)
+    {
+        const glm::vec3 t0 = (box.min - origin) * inverse;
+        const glm::vec3 t1 = (box.max - origin) * inverse;
+        const glm::vec3 near = glm::min(t0, t1);
+        const glm::vec3 far = glm::max(t0, t1);
+
+        const float enter = std::max(std::max(near.x, near.y), std::max(near.z, tMin));
+        const float exit = std::min(std::min(far.x, far.y), std::min(far.z, tMax));
+        return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+    }
+
+    bool BVH::IsOccluded(const glm::vec3& from, const glm::vec3& to) const
+    {
+        if (_nodes.empty())
+            return false;
+
+        // The segment is from + t * direction for t in (0, 1).
+        const float tMin = 1e-4f, tMax = 1.0f - 1e-4f;
+
+        const glm::vec3 direction = to - from;
+        const glm::vec3 inverse = GetInverseDirection(direction);
+
+        uint32_t stack[MaxDepth + 2];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        alignas(16) float t[4], u[4], v[4];
+
+        while (stackSize > 0)
+        {
+            const Node& node = _nodes[stack[--stackSize]];
+            if (GetBoxEntry(node.bounds, from, inverse, tMin, tMax) == std::numeric_limits<float>::infinity())
+                continue;
+
+            if (node.count > 0)
+            {
+                const uint32_t packets = (node.count + 3) / 4;
+                for (uint32_t i = node.first; i < node.first + packets; ++i)
+                    if (_IntersectPacket(_packets[i], from, direction, tMin, tMax, t, u, v))
+                        return true;
+                continue;
+            }
+
+            const uint32_t left = static_cast<uint32_t>(&node - _nodes.data()) + 1;
+            stack[stackSize++] = node.first;
+            stack[stackSize++] = left;
+        }
+
+        return false;
+    }
+
+    bool BVH::Intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const
+    {
+        if (_nodes.empty())
+            return false;
+
+        const glm::vec3 inverse = GetInverseDirection(direction);
+
+        float closest = maxDistance;
+        const TrianglePacket* hitPacket = nullptr;
+        int hitLane = 0;
+
+        // Entries carry the distance the box was entered at, so boxes behind the closest hit are skipped.
+        struct Entry { uint32_t node; float entry; };
+        Entry stack[MaxDepth + 2];
+        int stackSize = 0;
+
+        const float rootEntry = GetBoxEntry(_nodes[0].bounds, origin, inverse, 0.0f, closest);
+        if (rootEntry == std::numeric_limits<float>::infinity())
+            return false;
+
+        stack[stackSize++] = { 0, rootEntry };
+
+        alignas(16) float t[4], u[4], v[4];
+
+        while (stackSize > 0)
+        {
+            const Entry entry = stack[--stackSize];
+            if (entry.entry > closest)
+                continue;
+
+            const Node& node = _nodes[entry.node];
+
+            if (node.count > 0)
+            {
+                const uint32_t packets = (node.count + 3) / 4;
+                for (uint32_t i = node.first; i < node.first + packets; ++i)
+                {
+                    // tMax is exclusive, the nudge keeps a hit at exactly maxDistance.
+                    int mask = _IntersectPacket(_packets[i], origin, direction, 0.0f, std::nextafter(closest, std::numeric_limits<float>::max()), t, u, v);
+
+                    for (int lane = 0; mask != 0; ++lane, mask >>= 1)
+                    {
+                        if ((mask & 1) && t[lane] <= closest)
+                        {
+                            closest = t[lane];
+                            hitPacket = &_packets[i];
+                            hitLane = lane;
+                            hit.u = u[lane];
+                            hit.v = v[lane];
+                        }
+                    }
+                }
+                continue;
+            }
+
+            // Nearer child last, so it is popped first.
+            const uint32_t left = entry.node + 1;
+            const uint32_t right = node.first;
+            const float leftEntry = GetBoxEntry(_nodes[left].bounds, origin, inverse, 0.0f, closest);
+            const float rightEntry = GetBoxEntry(_nodes[right].bounds, origin, inverse, 0.0f, closest);
+
+            const bool leftFirst = leftEntry <= rightEntry;
+            const Entry near = leftFirst ? Entry{ left, leftEntry } : Entry{ right, rightEntry };
+            const Entry far = leftFirst ? Entry{ right, rightEntry } : Entry{ left, leftEntry };
+
+            if (far.entry != std::numeric_limits<float>::infinity())
+                stack[stackSize++] = far;
+            if (near.entry != std::numeric_limits<float>::infinity())
+                stack[stackSize++] = near;
+        }
+
+        if (!hitPacket)
+            return false;
+
+        const glm::vec3 edge1(hitPacket->edge1[0][hitLane], hitPacket->edge1[1][hitLane], hitPacket->edge1[2][hitLane]);
+        const glm::vec3 edge2(hitPacket->edge2[0][hitLane], hitPacket->edge2[1][hitLane], hitPacket->edge2[2][hitLane]);
+
+        hit.distance = closest;
+        hit.triangle = hitPacket->triangles[hitLane];
+        hit.backFace = glm::dot(direction, glm::cross(edge1, edge2)) > 0.0f;
+
+        return true;
+    }
+
+    const AABB& BVH::GetBounds() const
+    {
+        static const AABB empty;
+        return _nodes.empty() ? empty : _nodes[0].bounds;
+    }
+
+    std::size_t BVH::GetTriangleCount() const { return _triangleCount; }
+    std::size_t BVH::GetNodeCount() const { return _nodes.size(); }
+    bool BVH::IsEmpty() const { return _nodes.empty(); }
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "Math/BoundingSphere.hpp"
+#include "Math/AABB.hpp"
+#include "Math/SIMD.hpp"
+
+#include <cmath>
+
+namespace AE
+{
+    // Refinement passes before falling back to a single sequential Ritter pass.
+    static constexpr int SPHERE_REFINE_ITERATIONS = 16;
+
+    // Relative slack that absorbs rounding, so every input point tests as contained.
+    static constexpr float SPHERE_EPSILON = 1e-5f;
+
+    // Index of the point farthest from `from`, and its squared distance.
+    static std::size_t FindFarthest(std::span<const glm::vec3> points, const glm::vec3& from, float& distanceSq)
+    {
+        const std::size_t count = points.size();
+
+        std::size_t best = 0;
+        float bestDistanceSq = -1.0f;
+        std::size_t i = 0;
+
+#ifdef AE_SIMD_SSE2
+        if (count >= 4)
+        {
+            const __m128 fx = _mm_set1_ps(from.x);
+            const __m128 fy = _mm_set1_ps(from.y);
+            const __m128 fz = _mm_set1_ps(from.z);
+
+            __m128 maxDistance = _mm_set1_ps(-1.0f);
+            __m128i maxIndex = _mm_setzero_si128();
+            __m128i index = _mm_set_epi32(3, 2, 1, 0);
+            const __m128i step = _mm_set1_epi32(4);
+
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 x, y, z;
+                SIMD::LoadVec3x4(points.data() + i, x, y, z);
+
+                x = _mm_sub_ps(x, fx);
+                y = _mm_sub_ps(y, fy);
+                z = _mm_sub_ps(z, fz);
+
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+                __m128i farther = _mm_castps_si128(_mm_cmpgt_ps(distance, maxDistance));
+
+                maxDistance = _mm_max_ps(maxDistance, distance);
+                maxIndex = _mm_or_si128(_mm_and_si128(farther, index), _mm_andnot_si128(farther, maxIndex));
+                index = _mm_add_epi32(index, step);
+            }
+
+            alignas(16) float laneDistance[4];
+            alignas(16) int32_t laneIndex[4];
+            _mm_store_ps(laneDistance, maxDistance);
+            _mm_store_si128(reinterpret_cast<__m128i*>(laneIndex), maxIndex);
+
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (laneDistance[lane] > bestDistanceSq)
+                {
+                    bestDistanceSq = laneDistance[lane];
+                    best = static_cast<std::size_t>(laneIndex[lane]);
+                }
+            }
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            glm::vec3 d = points[i] - from;
+            float dSq = glm::dot(d, d);
+            if (dSq > bestDistanceSq)
+            {
+                bestDistanceSq = dSq;
+                best = i;
+            }
+        }
+
+        distanceSq = bestDistanceSq;
+        return best;
+    }
+
+    static void Grow(BoundingSphere& sphere, const glm::vec3& point, float distance)
+    {
+        float newRadius = (sphere.radius + distance) * 0.5f;
+        sphere.center += (point - sphere.center) * ((newRadius - sphere.radius) / distance);
+        sphere.radius = newRadius;
+    }
+
+    BoundingSphere::BoundingSphere() : center(0.0f), radius(0.0f) {}
+    BoundingSphere::BoundingSphere(const glm::vec3& center, float radius)
+        : center(center), radius(radius) {}
+
+    bool BoundingSphere::Contains(const glm::vec3& point) const
+    {
+        glm::vec3 d = point - center;
+        return glm::dot(d, d) <= radius * radius;
+    }
+
+    BoundingSphere BoundingSphere::Transform(const glm::mat4& matrix) const
+    {
+        float scaleSq = std::max({
+            glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+            glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])),
+            glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))
+        });
+
+        return BoundingSphere(glm::vec3(matrix * glm::vec4(center, 1.0f)), radius * std::sqrt(scaleSq));
+    }
+
+    BoundingSphere BoundingSphere::FromPoints(std::span<const glm::vec3> points)
+    {
+        if (points.empty())
+            return BoundingSphere();
+
+        // Start from the two mutually far points found from the box center, as in Ritter's method.
+        const glm::vec3 boxCenter = AABB::FromPoints(points).GetCenter();
+
+        float boxRadiusSq;
+        const glm::vec3& a = points[FindFarthest(points, boxCenter, boxRadiusSq)];
+
+        float distanceSq;
+        const glm::vec3& b = points[FindFarthest(points, a, distanceSq)];
+
+        BoundingSphere sphere((a + b) * 0.5f, std::sqrt(distanceSq) * 0.5f);
+
+        // Growing towards the farthest outlier keeps the sphere much tighter than growing in input order.
+        bool converged = false;
+        for (int iteration = 0; iteration < SPHERE_REFINE_ITERATIONS && !converged; ++iteration)
+        {
+            std::size_t farthest = FindFarthest(points, sphere.center, distanceSq);
+            float limit = sphere.radius * (1.0f + SPHERE_EPSILON);
+
+            if (distanceSq <= limit * limit)
+                converged = true;
+            else
+                Grow(sphere, points[farthest], std::sqrt(distanceSq));
+        }
+
+        if (!converged)
+        {
+            for (const glm::vec3& point : points)
+            {
+                glm::vec3 d = point - sphere.center;
+                float dSq = glm::dot(d, d);
+                if (dSq > sphere.radius * sphere.radius)
+                    Grow(sphere, point, std::sqrt(dSq));
+            }
+        }
+
+        // Round-ish point sets are often bounded better by the sphere around the box center.
+        const float boxRadius = std::sqrt(boxRadiusSq);
+        if (boxRadius < sphere.radius)
+            sphere = BoundingSphere(boxCenter, boxRadius);
+
+        sphere.radius *= 1.0f + SPHERE_EPSILON;
+        return sphere;
+    }
+}
\ No newline at end of file
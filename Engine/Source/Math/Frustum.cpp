@@ -49,6 +49,15 @@ namespace AE
         }
     }
     
+    std::array<glm::vec4, 6> Frustum::GetPlanes() const
+    {
+        std::array<glm::vec4, 6> planes;
+        for (std::size_t i = 0; i < planes.size(); ++i)
+            planes[i] = glm::vec4(_planes[i].normal, _planes[i].distance);
+
+        return planes;
+    }
+
     bool Frustum::Contains(const glm::vec3& point) const
     {
         for (const auto& plane : _planes)
@@ -69,19 +78,87 @@ namespace AE
         return true;
     }
     
+    FrustumTest Frustum::Classify(const glm::vec3& center, float radius) const
+    {
+        FrustumTest result = FrustumTest::Inside;
+
+        for (const auto& plane : _planes)
+        {
+            float distance = glm::dot(plane.normal, center) + plane.distance;
+
+            if (distance < -radius)
+                return FrustumTest::Outside;
+
+            if (distance < radius)
+                result = FrustumTest::Intersects;
+        }
+        return result;
+    }
+
+    FrustumTest Frustum::Classify(const glm::vec3& center, float radius, int& planeHint) const
+    {
+        planeHint = std::clamp(planeHint, 0, static_cast<int>(Count) - 1);
+
+        const float hintDistance = glm::dot(_planes[planeHint].normal, center) + _planes[planeHint].distance;
+        if (hintDistance < -radius)
+            return FrustumTest::Outside;
+
+        FrustumTest result = hintDistance < radius ? FrustumTest::Intersects : FrustumTest::Inside;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            if (i == planeHint) continue;
+
+            float distance = glm::dot(_planes[i].normal, center) + _planes[i].distance;
+
+            if (distance < -radius)
+            {
+                planeHint = i;
+                return FrustumTest::Outside;
+            }
+
+            if (distance < radius)
+                result = FrustumTest::Intersects;
+        }
+        return result;
+    }
+
     bool Frustum::Intersects(const AABB& aabb) const
     {
         for (const auto& plane : _planes)
         {
-            glm::vec3 positiveVertex = aabb.min;
-            
-            if (plane.normal.x >= 0) positiveVertex.x = aabb.max.x;
-            if (plane.normal.y >= 0) positiveVertex.y = aabb.max.y;
-            if (plane.normal.z >= 0) positiveVertex.z = aabb.max.z;
-            
-            if (glm::dot(plane.normal, positiveVertex) + plane.distance < 0.0f)
+            if (_IsOutside(plane, aabb))
                 return false;
         }
         return true;
     }
+
+    bool Frustum::Intersects(const AABB& aabb, int& planeHint) const
+    {
+        planeHint = std::clamp(planeHint, 0, static_cast<int>(Count) - 1);
+
+        if (_IsOutside(_planes[planeHint], aabb))
+            return false;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            if (i != planeHint && _IsOutside(_planes[i], aabb))
+            {
+                planeHint = i;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Frustum::_IsOutside(const FrustumPlaneData& plane, const AABB& aabb)
+    {
+        glm::vec3 positiveVertex = aabb.min;
+        
+        if (plane.normal.x >= 0) positiveVertex.x = aabb.max.x;
+        if (plane.normal.y >= 0) positiveVertex.y = aabb.max.y;
+        if (plane.normal.z >= 0) positiveVertex.z = aabb.max.z;
+        
+        return glm::dot(plane.normal, positiveVertex) + plane.distance < 0.0f;
+    }
 }
@@ -0,0 +1,121 @@
+#include "Math/FrustumSet.hpp"
+#include "Math/SIMD.hpp"
+
+#include <limits>
+
+namespace AE
+{
+    void FrustumSet::Clear()
+    {
+        _frusta.clear();
+        _planes.clear();
+        _paddedCount = 0;
+    }
+
+    bool FrustumSet::Add(const Frustum& frustum) { return _Add(frustum); }
+    bool FrustumSet::AddUnbounded() { return _Add(std::nullopt); }
+
+    std::size_t FrustumSet::GetCount() const { return _frusta.size(); }
+    bool FrustumSet::IsEmpty() const { return _frusta.empty(); }
+
+    const Frustum* FrustumSet::GetFrustum(std::size_t index) const
+    {
+        return _frusta[index] ? &*_frusta[index] : nullptr;
+    }
+
+    bool FrustumSet::_Add(const std::optional<Frustum>& frustum)
+    {
+        if (_frusta.size() >= MaxFrusta)
+            return false;
+
+        _frusta.push_back(frustum);
+
+        // Restripe the streams; views are added a handful of times per frame at most.
+        _paddedCount = (_frusta.size() + 3) & ~std::size_t(3);
+        _planes.assign(6 * 4 * _paddedCount, 0.0f);
+
+        for (std::size_t view = 0; view < _frusta.size(); ++view)
+        {
+            // An unbounded view gets planes that everything is far inside of.
+            std::array<glm::vec4, 6> planes;
+            if (_frusta[view])
+                planes = _frusta[view]->GetPlanes();
+            else
+                planes.fill(glm::vec4(0.0f, 0.0f, 0.0f, std::numeric_limits<float>::max()));
+
+            for (std::size_t plane = 0; plane < planes.size(); ++plane)
+                for (std::size_t component = 0; component < 4; ++component)
+                    _planes[(plane * 4 + component) * _paddedCount + view] = planes[plane][static_cast<int>(component)];
+        }
+
+        return true;
+    }
+
+    const float* FrustumSet::_GetStream(std::size_t plane, std::size_t component) const
+    {
+        return _planes.data() + (plane * 4 + component) * _paddedCount;
+    }
+
+    uint32_t FrustumSet::Classify(const glm::vec3& center, float radius, uint32_t& intersecting) const
+    {
+        uint32_t visible = 0;
+        intersecting = 0;
+
+        for (std::size_t base = 0; base < _frusta.size(); base += 4)
+        {
+            // Bit i set: view base + i has the sphere fully outside / fully inside.
+            int outside, inside;
+
+#ifdef AE_SIMD_SSE2
+            const __m128 cx = _mm_set1_ps(center.x);
+            const __m128 cy = _mm_set1_ps(center.y);
+            const __m128 cz = _mm_set1_ps(center.z);
+            const __m128 r = _mm_set1_ps(radius);
+            const __m128 negR = _mm_set1_ps(-radius);
+
+            __m128 outsideMask = _mm_setzero_ps();
+            __m128 insideMask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+            for (std::size_t plane = 0; plane < 6; ++plane)
+            {
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(cx, _mm_loadu_ps(_GetStream(plane, 0) + base)), _mm_mul_ps(cy, _mm_loadu_ps(_GetStream(plane, 1) + base))),
+                    _mm_add_ps(_mm_mul_ps(cz, _mm_loadu_ps(_GetStream(plane, 2) + base)), _mm_loadu_ps(_GetStream(plane, 3) + base)));
+
+                outsideMask = _mm_or_ps(outsideMask, _mm_cmplt_ps(distance, negR));
+                insideMask = _mm_and_ps(insideMask, _mm_cmpge_ps(distance, r));
+            }
+
+            outside = _mm_movemask_ps(outsideMask);
+            inside = _mm_movemask_ps(insideMask);
+#else
+            outside = 0;
+            inside = 0;
+            for (std::size_t lane = 0; lane < 4; ++lane)
+            {
+                bool out = false, in = true;
+                for (std::size_t plane = 0; plane < 6; ++plane)
+                {
+                    const std::size_t i = base + lane;
+                    float distance = _GetStream(plane, 0)[i] * center.x + _GetStream(plane, 1)[i] * center.y
+                        + _GetStream(plane, 2)[i] * center.z + _GetStream(plane, 3)[i];
+
+                    out = out || distance < -radius;
+                    in = in && distance >= radius;
+                }
+
+                if (out) outside |= 1 << lane;
+                if (in) inside |= 1 << lane;
+            }
+#endif
+
+            const std::size_t lanes = std::min<std::size_t>(4, _frusta.size() - base);
+            const uint32_t laneMask = (1u << lanes) - 1u;
+
+            visible |= (static_cast<uint32_t>(~outside) & laneMask) << base;
+            intersecting |= (static_cast<uint32_t>(~outside & ~inside) & laneMask) << base;
+        }
+
+        return visible;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#include "Rendering/CullCache.hpp"
+
+namespace AE
+{
+    void CullCache::Invalidate()
+    {
+        _valid = false;
+    }
+}
\ No newline at end of file
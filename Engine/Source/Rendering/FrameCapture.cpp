@@ -0,0 +1,313 @@
+#include "Rendering/FrameCapture.hpp"
+#include "Rendering/Framebuffer.hpp"
+#include "Core/Logger.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+
+namespace AE
+{
+    using Clock = std::chrono::steady_clock;
+
+    static double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double FrameCapture::CaptureStats::GetAverageOverheadMs() const
+    {
+        return measuredFrames > 0 ? totalOverheadMs / static_cast<double>(measuredFrames) : 0.0;
+    }
+
+    FrameCapture::FrameCapture(int ringSize)
+        : _slots(static_cast<std::size_t>(std::max(ringSize, 2)))
+    {
+        for (auto& slot : _slots)
+            glGenBuffers(1, &slot.pbo);
+
+        _worker = std::thread(&FrameCapture::_WorkerLoop, this);
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        Flush();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopWorker = true;
+        }
+        _jobAvailable.notify_all();
+
+        if (_worker.joinable())
+            _worker.join();
+
+        for (auto& slot : _slots)
+        {
+            if (slot.fence) glDeleteSync(slot.fence);
+            if (slot.pbo) glDeleteBuffers(1, &slot.pbo);
+        }
+
+        if (_stats.requestedFrames > 0)
+        {
+            LoggerContext ctx("FrameCapture", "~FrameCapture");
+            Logger::Info("Captured {} frame(s) ({} dropped), overhead: avg {:.3f} ms, max {:.3f} ms per frame",
+                _stats.encodedFrames, _stats.droppedFrames, _stats.GetAverageOverheadMs(), _stats.maxOverheadMs);
+        }
+    }
+
+    bool FrameCapture::Capture(const std::string& path, int width, int height, const Framebuffer* source, GLenum slot)
+    {
+        Clock::time_point start = Clock::now();
+
+        LoggerContext ctx("FrameCapture", "Capture");
+
+        _stats.requestedFrames++;
+
+        if (path.empty() || width <= 0 || height <= 0)
+        {
+            Logger::Error("Invalid params! Path cannot be empty and size must be positive!");
+            _stats.droppedFrames++;
+            return false;
+        }
+
+        PixelPackSlot& target = _slots[_writeIndex];
+
+        // Never stall the pipeline: if the oldest read is still in flight, skip this frame.
+        if (target.pending && !_ResolveSlot(target, false))
+        {
+            Logger::Warning("All {} pixel pack buffers are busy, dropping capture '{}'", _slots.size(), path);
+            _stats.droppedFrames++;
+            return false;
+        }
+
+        const std::size_t size = static_cast<std::size_t>(width) * height * 4;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, target.pbo);
+        if (target.capacity < size)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            target.capacity = size;
+        }
+
+        if (source)
+        {
+            source->BindRead(slot);
+        }
+        else
+        {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glReadBuffer(GL_BACK);
+        }
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+        target.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        target.path = path;
+        target.width = width;
+        target.height = height;
+        target.frame = _frame;
+        target.pending = true;
+
+        _writeIndex = (_writeIndex + 1) % _slots.size();
+
+        _frameHadCapture = true;
+        _frameOverheadMs += ElapsedMs(start);
+
+        return true;
+    }
+
+    void FrameCapture::Update()
+    {
+        Clock::time_point start = Clock::now();
+
+        bool hadWork = _frameHadCapture;
+
+        // Slots are resolved in submission order, and never in the frame they were issued in.
+        // A fence normally signals one or two frames later, well within the ring size.
+        while (true)
+        {
+            PixelPackSlot& slot = _slots[_readIndex];
+            if (!slot.pending || slot.frame == _frame || !_ResolveSlot(slot, false))
+                break;
+
+            hadWork = true;
+            _readIndex = (_readIndex + 1) % _slots.size();
+        }
+
+        _stats.encodedFrames = _encodedFrames.load();
+
+        if (hadWork)
+        {
+            _frameOverheadMs += ElapsedMs(start);
+
+            _stats.lastOverheadMs = _frameOverheadMs;
+            _stats.totalOverheadMs += _frameOverheadMs;
+            _stats.maxOverheadMs = std::max(_stats.maxOverheadMs, _frameOverheadMs);
+            _stats.measuredFrames++;
+        }
+
+        _frameOverheadMs = 0.0;
+        _frameHadCapture = false;
+        _frame++;
+    }
+
+    void FrameCapture::Flush()
+    {
+        for (std::size_t i = 0; i < _slots.size(); ++i)
+        {
+            PixelPackSlot& slot = _slots[(_readIndex + i) % _slots.size()];
+            if (slot.pending)
+                _ResolveSlot(slot, true);
+        }
+
+        _readIndex = _writeIndex;
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobsDone.wait(lock, [this]() { return _jobs.empty() && _activeJobs == 0; });
+
+        _stats.encodedFrames = _encodedFrames.load();
+    }
+
+    const FrameCapture::CaptureStats& FrameCapture::GetStats() const { return _stats; }
+    int FrameCapture::GetRingSize() const { return static_cast<int>(_slots.size()); }
+
+    bool FrameCapture::IsBusy() const
+    {
+        for (const auto& slot : _slots)
+        {
+            if (slot.pending) return true;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        return !_jobs.empty() || _activeJobs > 0;
+    }
+
+    bool FrameCapture::_ResolveSlot(PixelPackSlot& slot, bool wait)
+    {
+        if (!slot.pending) return true;
+
+        if (slot.fence)
+        {
+            GLenum result = glClientWaitSync(slot.fence, 0, 0);
+            while (wait && result == GL_TIMEOUT_EXPIRED)
+                result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+
+            if (result == GL_TIMEOUT_EXPIRED)
+                return false;
+
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+
+            if (result == GL_WAIT_FAILED)
+            {
+                Logger::Error("Failed to wait for capture '{}'!", slot.path);
+                slot.pending = false;
+                _stats.droppedFrames++;
+                return true;
+            }
+        }
+
+        EncodeJob job;
+        job.path = std::move(slot.path);
+        job.width = slot.width;
+        job.height = slot.height;
+
+        const std::size_t size = static_cast<std::size_t>(slot.width) * slot.height * 4;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        if (data)
+        {
+            job.pixels.assign(static_cast<unsigned char*>(data), static_cast<unsigned char*>(data) + size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.pending = false;
+
+        if (!data)
+        {
+            Logger::Error("Failed to map pixel pack buffer for capture '{}'!", job.path);
+            _stats.droppedFrames++;
+            return true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _jobs.push_back(std::move(job));
+        }
+        _jobAvailable.notify_one();
+
+        return true;
+    }
+
+    void FrameCapture::_WorkerLoop()
+    {
+        while (true)
+        {
+            EncodeJob job;
+
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _jobAvailable.wait(lock, [this]() { return _stopWorker || !_jobs.empty(); });
+
+                if (_jobs.empty())
+                    return;
+
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+                _activeJobs++;
+            }
+
+            bool written = _WriteTGA(job);
+
+            if (written)
+                _encodedFrames++;
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _activeJobs--;
+            }
+            _jobsDone.notify_all();
+        }
+    }
+
+    bool FrameCapture::_WriteTGA(const EncodeJob& job)
+    {
+        LoggerContext ctx("FrameCapture", "_WriteTGA");
+
+        std::filesystem::path path(job.path);
+        if (path.has_parent_path())
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            Logger::Error("Failed to open file: '{}'", job.path);
+            return false;
+        }
+
+        // Uncompressed true-color, 32 bpp, bottom-left origin: matches glReadPixels(GL_BGRA) as-is.
+        unsigned char header[18] = {};
+        header[2] = 2;
+        header[12] = static_cast<unsigned char>(job.width & 0xFF);
+        header[13] = static_cast<unsigned char>((job.width >> 8) & 0xFF);
+        header[14] = static_cast<unsigned char>(job.height & 0xFF);
+        header[15] = static_cast<unsigned char>((job.height >> 8) & 0xFF);
+        header[16] = 32;
+        header[17] = 0x08;
+
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(job.pixels.data()), static_cast<std::streamsize>(job.pixels.size()));
+
+        return static_cast<bool>(file);
+    }
+}
@@ -38,6 +38,12 @@ namespace AE
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
+    void Framebuffer::BindRead(GLenum slot) const
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _id);
+        glReadBuffer(GL_COLOR_ATTACHMENT0 + slot);
+    }
+
     void Framebuffer::Resize(int width, int height)
     {
         if (width == _width && height == _height)
@@ -46,65 +52,48 @@ namespace AE
         _width = width;
         _height = height;
 
-        glBindFramebuffer(GL_FRAMEBUFFER, _id);
+        // Attachments keep their names when they grow, so they stay attached and only
+        // a reallocation needs the completeness check again.
+        bool reallocated = false;
 
         for (auto& attachment : _colorAttachments)
-        {
-            attachment.texture->Resize(width, height);
-            glFramebufferTexture2D(
-                GL_FRAMEBUFFER, 
-                GL_COLOR_ATTACHMENT0 + attachment.slot, 
-                GL_TEXTURE_2D, 
-                attachment.texture->GetID(), 
-                0
-            );
-        }
+            reallocated |= attachment.texture->Resize(width, height);
 
         for (auto& attachment : _colorArrayAttachments)
-        {
-            attachment.textureArray->Resize(width, height);
-            glFramebufferTextureLayer(
-                GL_FRAMEBUFFER, 
-                GL_COLOR_ATTACHMENT0 + attachment.slot, 
-                attachment.textureArray->GetID(), 
-                0, 
-                attachment.layer
-            );
-        }
+            reallocated |= attachment.textureArray->Resize(width, height);
 
         if (_depthAttachment)
         {
-            _depthAttachment->texture->Resize(width, height);
-            glFramebufferTexture2D(
-                GL_FRAMEBUFFER, 
-                GL_DEPTH_ATTACHMENT, 
-                GL_TEXTURE_2D, 
-                _depthAttachment->texture->GetID(), 
-                0
-            );
+            reallocated |= _depthAttachment->texture->Resize(width, height);
         }
         else if (_depthArrayAttachment)
         {
-            _depthArrayAttachment->textureArray->Resize(width, height);
-            glFramebufferTextureLayer(
-                GL_FRAMEBUFFER, 
-                GL_DEPTH_ATTACHMENT, 
-                _depthArrayAttachment->textureArray->GetID(), 
-                0, 
-                _depthArrayAttachment->layer
-            );
+            reallocated |= _depthArrayAttachment->textureArray->Resize(width, height);
         }
         else if (_depthMode == DepthMode::Renderbuffer && _depthRenderbuffer != 0)
         {
-            glBindRenderbuffer(GL_RENDERBUFFER, _depthRenderbuffer);
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
-            glBindRenderbuffer(GL_RENDERBUFFER, 0);
-        }
+            const bool grow = width > _depthCapacityWidth || height > _depthCapacityHeight;
+            const bool shrink = static_cast<int64_t>(width) * height * 4 < static_cast<int64_t>(_depthCapacityWidth) * _depthCapacityHeight;
 
-        _UpdateDrawBuffers();
-        _CheckCompleteness();
+            if (grow || shrink)
+            {
+                _depthCapacityWidth = grow ? std::max(width, _depthCapacityWidth + _depthCapacityWidth / 2) : width;
+                _depthCapacityHeight = grow ? std::max(height, _depthCapacityHeight + _depthCapacityHeight / 2) : height;
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                glBindRenderbuffer(GL_RENDERBUFFER, _depthRenderbuffer);
+                glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, _depthCapacityWidth, _depthCapacityHeight);
+                glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+                reallocated = true;
+            }
+        }
+
+        if (reallocated)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, _id);
+            _CheckCompleteness();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
     }
 
     void Framebuffer::AttachColorTexture(std::shared_ptr<Texture> texture, GLenum slot)
@@ -259,6 +248,8 @@ namespace AE
         glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthRenderbuffer);
         glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
+        _depthCapacityWidth = _width;
+        _depthCapacityHeight = _height;
         _depthMode = DepthMode::Renderbuffer;
         _CheckCompleteness();
 
@@ -0,0 +1,103 @@
+#include "Rendering/GeometryArena.hpp"
+
+namespace AE
+{
+    GeometryArena& GeometryArena::Get()
+    {
+        static GeometryArena arena;
+        return arena;
+    }
+
+    GeometryArena::Allocation GeometryArena::Allocate(std::size_t size, std::size_t alignment)
+    {
+        if (size == 0) return {};
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto AlignUp = [alignment](std::size_t value) { return (value + alignment - 1) / alignment * alignment; };
+
+        for (std::size_t i = 0; i < _blocks.size(); ++i)
+        {
+            Block& block = _blocks[i];
+            if (!block.memory) continue;
+
+            std::size_t offset = AlignUp(block.offset);
+            if (offset + size > block.capacity) continue;
+
+            block.offset = offset + size;
+            block.live++;
+            _usedBytes += size;
+
+            return {block.memory.get() + offset, size, static_cast<uint32_t>(i)};
+        }
+
+        // Reuse a released slot before growing the block list.
+        std::size_t index = _blocks.size();
+        for (std::size_t i = 0; i < _blocks.size(); ++i)
+        {
+            if (!_blocks[i].memory)
+            {
+                index = i;
+                break;
+            }
+        }
+
+        if (index == _blocks.size())
+            _blocks.emplace_back();
+
+        // Oversized requests get a block of their own.
+        Block& block = _blocks[index];
+        block.capacity = std::max(BLOCK_SIZE, AlignUp(size));
+        block.memory = std::make_unique<unsigned char[]>(block.capacity);
+        block.offset = size;
+        block.live = 1;
+        _usedBytes += size;
+
+        return {block.memory.get(), size, static_cast<uint32_t>(index)};
+    }
+
+    void GeometryArena::Free(Allocation& allocation)
+    {
+        if (!allocation.IsValid()) return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        Block& block = _blocks[allocation.block];
+        _usedBytes -= allocation.size;
+
+        // Blocks are only recycled as a whole, once the last allocation in them is gone.
+        if (--block.live == 0)
+        {
+            block.memory.reset();
+            block.capacity = 0;
+            block.offset = 0;
+        }
+
+        allocation = {};
+    }
+
+    std::size_t GeometryArena::GetUsedBytes() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _usedBytes;
+    }
+
+    std::size_t GeometryArena::GetReservedBytes() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::size_t reserved = 0;
+        for (const Block& block : _blocks)
+            reserved += block.capacity;
+
+        return reserved;
+    }
+
+    std::size_t GeometryArena::GetBlockCount() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        return static_cast<std::size_t>(std::count_if(_blocks.begin(), _blocks.end(),
+            [](const Block& block) { return block.memory != nullptr; }));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,496 @@
+#include "Rendering/HLOD.hpp"
+#include "Rendering/Renderer.hpp"
+#include "Rendering/Material.hpp"
+#include "Resources/Model.hpp"
+#include "Resources/Texture.hpp"
+#include "Resources/MeshOptimizer.hpp"
+#include "Scene/Node.hpp"
+#include "Core/EngineSettings.hpp"
+#include "Core/Logger.hpp"
+
+#include <numeric>
+
+namespace AE
+{
+    HLOD::~HLOD()
+    {
+        Reset();
+    }
+
+    void HLOD::Update(const glm::vec3& viewPosition)
+    {
+        _stats = {};
+
+        // Clusters come back a little closer than they leave, so one sitting on the threshold doesn't swap every frame.
+        const float enter = _switchDistance * _switchDistance;
+        const float leave = enter * 0.81f;
+
+        for (Cluster& cluster : _clusters)
+        {
+            const glm::vec3 closest = glm::clamp(viewPosition, cluster.bounds.min, cluster.bounds.max);
+            const glm::vec3 offset = closest - viewPosition;
+            const float distanceSq = glm::dot(offset, offset);
+
+            if (!cluster.proxyActive && distanceSq > enter)
+                _SetProxyActive(cluster, true);
+            else if (cluster.proxyActive && distanceSq < leave)
+                _SetProxyActive(cluster, false);
+
+            if (cluster.proxyActive)
+            {
+                _stats.activeProxies++;
+                _stats.hiddenNodes += cluster.nodes.size();
+                _stats.savedDraws += cluster.sourceDraws > 0 ? cluster.sourceDraws - 1 : 0;
+            }
+        }
+    }
+
+    void HLOD::Submit(Renderer* renderer, Shader* shader)
+    {
+        if (!renderer || !shader) return;
+
+        for (Cluster& cluster : _clusters)
+        {
+            if (cluster.proxyActive && cluster.proxy)
+                renderer->SubmitMesh(cluster.proxy.get(), shader, cluster.material.get(), glm::mat4(1.0f), &cluster.cullCache);
+        }
+    }
+
+    void HLOD::Reset()
+    {
+        for (Cluster& cluster : _clusters)
+        {
+            if (cluster.proxyActive)
+                _SetProxyActive(cluster, false);
+        }
+
+        _stats = {};
+    }
+
+    float HLOD::GetSwitchDistance() const { return _switchDistance; }
+    void HLOD::SetSwitchDistance(float distance) { _switchDistance = std::max(distance, 0.0f); }
+
+    const std::vector<HLOD::Cluster>& HLOD::GetClusters() const { return _clusters; }
+    const HLOD::Stats& HLOD::GetStats() const { return _stats; }
+
+    void HLOD::_SetProxyActive(Cluster& cluster, bool active)
+    {
+        cluster.proxyActive = active;
+
+        for (const auto& weakNode : cluster.nodes)
+        {
+            if (auto node = weakNode.lock())
+                node->SetVisible(!active);
+        }
+    }
+
+    HLODBuilder::HLODBuilder()
+        : _settings() {}
+
+    HLODBuilder::HLODBuilder(const Settings& settings)
+        : _settings(settings) {}
+
+    bool HLODBuilder::Add(const std::shared_ptr<SceneNode>& node, const std::shared_ptr<Model>& model, const glm::mat4& transform)
+    {
+        LoggerContext ctx("HLODBuilder", "Add");
+
+        _stats.sourceNodes++;
+
+        if (!node || !model || !model->root)
+        {
+            _stats.skippedNodes++;
+            return false;
+        }
+
+        Source source{ node, model, transform, AABB(), 0, 0 };
+        if (!_Collect(*model->root, transform, source))
+        {
+            Logger::Warning("Node '{}' has meshes without CPU data, load its model with keepCPUData to build a proxy for it", node->GetName());
+            _stats.skippedNodes++;
+            return false;
+        }
+
+        if (source.draws == 0)
+        {
+            _stats.skippedNodes++;
+            return false;
+        }
+
+        _sources.push_back(std::move(source));
+        return true;
+    }
+
+    bool HLODBuilder::_Collect(const ModelNode& node, const glm::mat4& parentTransform, Source& source) const
+    {
+        const glm::mat4 transform = parentTransform * node.GetTransform();
+
+        for (const auto& mesh : node.GetMeshes())
+        {
+            if (!mesh) continue;
+            if (mesh->GetResidency() != MeshResidency::CPURetained)
+                return false;
+
+            const AABB bounds = mesh->GetAABB().Transform(transform);
+            if (source.draws == 0)
+                source.bounds = bounds;
+            else
+                source.bounds.Expand(bounds);
+
+            source.draws++;
+            source.triangles += (mesh->HasIndices() ? mesh->GetIndicesCount() : mesh->GetVerticesCount()) / 3;
+        }
+
+        for (const auto& child : node.GetChildren())
+        {
+            if (!_Collect(*child, transform, source))
+                return false;
+        }
+
+        return true;
+    }
+
+    std::shared_ptr<HLOD> HLODBuilder::Build()
+    {
+        LoggerContext ctx("HLODBuilder", "Build");
+
+        auto hlod = std::make_shared<HLOD>();
+        hlod->_switchDistance = _settings.switchDistance;
+
+        // Nodes are grouped by the grid cell of their center, in the order they were added.
+        std::vector<std::vector<const Source*>> cells;
+        std::unordered_map<uint64_t, std::size_t> cellIndex;
+
+        const float clusterSize = std::max(_settings.clusterSize, 1e-3f);
+        for (const Source& source : _sources)
+        {
+            const glm::ivec3 cell(glm::floor(source.bounds.GetCenter() / clusterSize));
+            const uint64_t key = (static_cast<uint64_t>(cell.x) & 0x1fffff)
+                | ((static_cast<uint64_t>(cell.y) & 0x1fffff) << 21)
+                | ((static_cast<uint64_t>(cell.z) & 0x1fffff) << 42);
+
+            auto [it, inserted] = cellIndex.try_emplace(key, cells.size());
+            if (inserted)
+                cells.emplace_back();
+
+            cells[it->second].push_back(&source);
+        }
+
+        std::size_t clusteredNodes = 0;
+        std::size_t proxyTriangles = _stats.proxyTriangles;
+
+        for (const auto& sources : cells)
+        {
+            if (sources.size() < std::max<std::size_t>(_settings.minNodes, 1))
+                continue;
+
+            HLOD::Cluster cluster;
+            if (!_BuildCluster(sources, cluster))
+                continue;
+
+            clusteredNodes += sources.size();
+            hlod->_clusters.push_back(std::move(cluster));
+        }
+
+        std::size_t sourceDraws = 0, sourceTriangles = 0;
+        for (const HLOD::Cluster& cluster : hlod->_clusters)
+        {
+            sourceDraws += cluster.sourceDraws;
+            sourceTriangles += cluster.sourceTriangles;
+        }
+
+        _stats.clusters += hlod->_clusters.size();
+        _stats.sourceDraws += sourceDraws;
+        _stats.sourceTriangles += sourceTriangles;
+
+        Logger::Info("Built {} proxies for {} of {} nodes: {} draws -> {}, {} -> {} triangles beyond {} units",
+            hlod->_clusters.size(), clusteredNodes, _sources.size(), sourceDraws, hlod->_clusters.size(),
+            sourceTriangles, _stats.proxyTriangles - proxyTriangles, _settings.switchDistance);
+
+        _sources.clear();
+
+        return hlod;
+    }
+
+    bool HLODBuilder::_BuildCluster(const std::vector<const Source*>& sources, HLOD::Cluster& cluster)
+    {
+        std::vector<Group> groups;
+        std::unordered_map<const Material*, std::size_t> groupIndex;
+
+        cluster.bounds = sources.front()->bounds;
+        for (const Source* source : sources)
+        {
+            _AddNode(*source->model->root, source->transform, groups, groupIndex);
+
+            cluster.bounds.Expand(source->bounds);
+            cluster.nodes.push_back(source->node);
+            cluster.sourceDraws += source->draws;
+            cluster.sourceTriangles += source->triangles;
+        }
+
+        if (groups.empty())
+            return false;
+
+        // Every material group is clustered on the same grid, so the vertices they share at their seams
+        // fall into the same cells and the proxy doesn't open up along material borders.
+        const float cellSize = std::max(_settings.simplifyCellSize, 1e-3f);
+        const glm::vec3 gridOrigin = glm::floor(cluster.bounds.min / cellSize) * cellSize;
+
+        const int tile = std::max(_settings.atlasTileSize, 4);
+        const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(groups.size()))));
+        const int rows = (static_cast<int>(groups.size()) + columns - 1) / columns;
+        const int atlasWidth = columns * tile;
+        const int atlasHeight = rows * tile;
+
+        std::vector<unsigned char> atlas(static_cast<std::size_t>(atlasWidth) * atlasHeight * 4, 0);
+
+        // Mips stop while a tile still has a few texels, and coordinates stay half a texel of the last one inside
+        // the tile, so neither the mips nor the filter reach into the neighbours.
+        const bool mipmaps = EngineSettings::Get().graphics.generateMipmaps;
+        const int maxLevel = mipmaps ? std::max(static_cast<int>(std::log2(static_cast<float>(tile))) - 3, 0) : 0;
+        const float inset = 0.5f * static_cast<float>(1 << maxLevel);
+
+        MeshGeometry proxy;
+
+        // The proxy material is the triangle-weighted mix of the sources; the atlas carries the diffuse color.
+        glm::vec3 ambient(0.0f), specular(0.0f);
+        float shininess = 0.0f;
+        float weight = 0.0f;
+
+        for (std::size_t g = 0; g < groups.size(); ++g)
+        {
+            Group& group = groups[g];
+            const int column = static_cast<int>(g) % columns;
+            const int row = static_cast<int>(g) / columns;
+
+            const std::vector<unsigned char>& pixels = _GetTile(group.material);
+            for (int y = 0; y < tile; ++y)
+            {
+                std::copy_n(&pixels[static_cast<std::size_t>(y) * tile * 4], tile * 4,
+                    &atlas[(static_cast<std::size_t>(row * tile + y) * atlasWidth + column * tile) * 4]);
+            }
+
+            MeshGeometry geometry;
+            geometry.positions = std::move(group.positions);
+            geometry.normals = std::move(group.normals);
+            geometry.texCoords = std::move(group.texCoords);
+            geometry.indices.resize(geometry.positions.size());
+            std::iota(geometry.indices.begin(), geometry.indices.end(), 0u);
+
+            const std::size_t triangles = MeshOptimizer::SimplifyClustered(geometry, cellSize, gridOrigin);
+            if (triangles == 0) continue;
+
+            // Texture coordinates are in [0, 1] of the source texture; move them into the tile.
+            const glm::vec2 origin(column * tile + inset, row * tile + inset);
+            const glm::vec2 atlasSize(static_cast<float>(atlasWidth), static_cast<float>(atlasHeight));
+
+            const uint32_t base = static_cast<uint32_t>(proxy.positions.size());
+            for (std::size_t v = 0; v < geometry.positions.size(); ++v)
+            {
+                proxy.positions.push_back(geometry.positions[v]);
+                proxy.normals.push_back(geometry.normals[v]);
+                proxy.texCoords.push_back((origin + geometry.texCoords[v] * (static_cast<float>(tile) - 2.0f * inset)) / atlasSize);
+            }
+            for (uint32_t index : geometry.indices)
+                proxy.indices.push_back(base + index);
+
+            const Material* material = group.material ? group.material.get() : Material::GetDefault();
+            const float w = static_cast<float>(triangles);
+            ambient += glm::vec3(material->GetAmbientColor().r, material->GetAmbientColor().g, material->GetAmbientColor().b) * w;
+            specular += glm::vec3(material->GetSpecularColor().r, material->GetSpecularColor().g, material->GetSpecularColor().b) * w;
+            shininess += material->GetShininess() * w;
+            weight += w;
+        }
+
+        if (proxy.indices.empty())
+            return false;
+
+        if (_settings.optimize)
+            MeshOptimizer::Optimize(proxy);
+
+        auto mesh = std::make_shared<Mesh>(std::move(proxy.positions), IndexData(proxy.indices),
+            std::move(proxy.normals), std::move(proxy.texCoords), std::vector<glm::vec3>(), std::vector<glm::vec3>(),
+            std::vector<glm::vec2>(), _settings.layout, _settings.residency);
+
+        if (!proxy.meshlets.empty())
+            mesh->SetMeshlets(std::move(proxy.meshlets));
+
+        // Tiles sit side by side, so the atlas must not wrap into the neighbours.
+        auto texture = Texture::Create({ atlas.data(), atlasWidth, atlasHeight, 4 }, mipmaps);
+        if (!texture)
+            return false;
+
+        texture->SetWrapS(TextureWrap::ClampToEdge);
+        texture->SetWrapT(TextureWrap::ClampToEdge);
+        if (mipmaps)
+            texture->SetMaxLevel(maxLevel);
+
+        ambient /= weight;
+        specular /= weight;
+
+        cluster.material = std::make_shared<Material>(Color(ambient.x, ambient.y, ambient.z, 1.0f), Color(1.0f, 1.0f, 1.0f, 1.0f),
+            Color(specular.x, specular.y, specular.z, 1.0f), shininess / weight);
+        cluster.material->SetDiffuseTexture(texture);
+        cluster.proxy = mesh;
+
+        _stats.proxyTriangles += proxy.GetTriangleCount();
+        _stats.atlasTiles += groups.size();
+
+        return true;
+    }
+
+    void HLODBuilder::_AddNode(const ModelNode& node, const glm::mat4& parentTransform, std::vector<Group>& groups,
+        std::unordered_map<const Material*, std::size_t>& groupIndex) const
+    {
+        const glm::mat4 transform = parentTransform * node.GetTransform();
+        const glm::mat3 linear = glm::mat3(transform);
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+        const bool flipWinding = glm::determinant(linear) < 0.0f;
+
+        const auto& meshes = node.GetMeshes();
+        const auto& materials = node.GetMaterials();
+
+        for (std::size_t i = 0; i < meshes.size(); ++i)
+        {
+            if (!meshes[i]) continue;
+
+            const Mesh& mesh = *meshes[i];
+            std::shared_ptr<Material> material = i < materials.size() ? materials[i] : nullptr;
+
+            auto [it, inserted] = groupIndex.try_emplace(material.get(), groups.size());
+            if (inserted)
+                groups.push_back({ material, {}, {}, {} });
+
+            Group& group = groups[it->second];
+
+            const auto& positions = mesh.GetVertices();
+            const auto& normals = mesh.GetNormals();
+            const auto& texCoords = mesh.GetTexCoords();
+            const IndexView indices = mesh.GetIndexData();
+
+            const std::size_t vertexCount = positions.size();
+            const bool hasNormals = normals.size() == vertexCount;
+            const bool hasTexCoords = texCoords.size() == vertexCount;
+
+            const std::size_t indexCount = indices.empty() ? vertexCount : indices.size();
+            auto GetIndex = [&](std::size_t index) -> uint32_t
+            {
+                return indices.empty() ? static_cast<uint32_t>(index) : indices[index];
+            };
+
+            // Corners are kept apart here; the simplifier merges them by position anyway.
+            for (std::size_t t = 0; t + 2 < indexCount; t += 3)
+            {
+                uint32_t triangle[3] = { GetIndex(t), GetIndex(t + 1), GetIndex(t + 2) };
+                if (triangle[0] >= vertexCount || triangle[1] >= vertexCount || triangle[2] >= vertexCount)
+                    continue;
+
+                if (flipWinding)
+                    std::swap(triangle[1], triangle[2]);
+
+                glm::vec3 world[3];
+                for (int c = 0; c < 3; ++c)
+                    world[c] = glm::vec3(transform * glm::vec4(positions[triangle[c]], 1.0f));
+
+                const glm::vec3 cross = glm::cross(world[1] - world[0], world[2] - world[0]);
+                const float area = glm::length(cross);
+                if (area <= 0.0f) continue;
+
+                // The atlas holds one copy of each texture, so a triangle is shifted into [0, 1]. Ones spanning
+                // more than a repeat can't be mapped and take the middle of the tile instead.
+                glm::vec2 uv[3] = { glm::vec2(0.5f), glm::vec2(0.5f), glm::vec2(0.5f) };
+                if (hasTexCoords)
+                {
+                    const glm::vec2 lo = glm::floor(glm::min(texCoords[triangle[0]], glm::min(texCoords[triangle[1]], texCoords[triangle[2]])));
+                    const glm::vec2 hi = glm::max(texCoords[triangle[0]], glm::max(texCoords[triangle[1]], texCoords[triangle[2]])) - lo;
+
+                    if (hi.x <= 1.0f + 1e-3f && hi.y <= 1.0f + 1e-3f)
+                    {
+                        for (int c = 0; c < 3; ++c)
+                            uv[c] = glm::clamp(texCoords[triangle[c]] - lo, glm::vec2(0.0f), glm::vec2(1.0f));
+                    }
+                }
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    group.positions.push_back(world[c]);
+                    group.normals.push_back(hasNormals ? glm::normalize(normalMatrix * normals[triangle[c]]) : cross / area);
+                    group.texCoords.push_back(uv[c]);
+                }
+            }
+        }
+
+        for (const auto& child : node.GetChildren())
+            _AddNode(*child, transform, groups, groupIndex);
+    }
+
+    const std::vector<unsigned char>& HLODBuilder::_GetTile(const std::shared_ptr<Material>& material)
+    {
+        const Material* source = material ? material.get() : Material::GetDefault();
+
+        std::shared_ptr<Texture> texture = source->GetDiffuseTexture();
+        const Color& color = source->GetDiffuseColor();
+
+        auto [it, inserted] = _tiles.try_emplace(TileKey{ texture, color.ToVec3() });
+        std::vector<unsigned char>& pixels = it->second;
+        if (!inserted)
+            return pixels;
+
+        const int tile = std::max(_settings.atlasTileSize, 4);
+        pixels.assign(static_cast<std::size_t>(tile) * tile * 4, 255);
+
+        // The smallest mip that still covers the tile keeps the read-back small.
+        std::vector<unsigned char> texels;
+        int width = 0, height = 0;
+
+        if (texture && texture->IsValid())
+        {
+            int level = 0;
+            while (texture->HasMipmaps() && (texture->GetWidth() >> (level + 1)) >= tile && (texture->GetHeight() >> (level + 1)) >= tile)
+                level++;
+
+            texels = texture->ReadPixels(level, width, height);
+        }
+
+        for (int y = 0; y < tile; ++y)
+        {
+            for (int x = 0; x < tile; ++x)
+            {
+                glm::vec3 texel(1.0f);
+
+                if (!texels.empty())
+                {
+                    // Box filter over the texels this tile texel covers.
+                    const int x0 = x * width / tile, x1 = std::max(x0 + 1, (x + 1) * width / tile);
+                    const int y0 = y * height / tile, y1 = std::max(y0 + 1, (y + 1) * height / tile);
+
+                    glm::vec3 sum(0.0f);
+                    for (int sy = y0; sy < y1; ++sy)
+                    {
+                        for (int sx = x0; sx < x1; ++sx)
+                        {
+                            const unsigned char* p = &texels[(static_cast<std::size_t>(sy) * width + sx) * 4];
+                            sum += glm::vec3(p[0], p[1], p[2]);
+                        }
+                    }
+
+                    texel = sum / (255.0f * static_cast<float>((x1 - x0) * (y1 - y0)));
+                }
+
+                // Proxies are drawn opaque, alpha stays 255.
+                unsigned char* out = &pixels[(static_cast<std::size_t>(y) * tile + x) * 4];
+                out[0] = static_cast<unsigned char>(std::clamp(texel.x * color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+                out[1] = static_cast<unsigned char>(std::clamp(texel.y * color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+                out[2] = static_cast<unsigned char>(std::clamp(texel.z * color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+
+        return pixels;
+    }
+
+    const HLODBuilder::Stats& HLODBuilder::GetStats() const { return _stats; }
+
+    bool HLODBuilder::TileKey::operator<(const TileKey& other) const
+    {
+        return std::tie(texture, color.x, color.y, color.z) < std::tie(other.texture, other.color.x, other.color.y, other.color.z);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,405 @@
+#include "Rendering/Impostor.hpp"
+#include "Rendering/Mesh.hpp"
+#include "Rendering/Material.hpp"
+#include "Rendering/Framebuffer.hpp"
+#include "Rendering/RenderGraph.hpp"
+#include "Rendering/Uniforms.hpp"
+#include "Resources/Model.hpp"
+#include "Resources/Texture.hpp"
+#include "Resources/Shader.hpp"
+#include "Resources/Managers.hpp"
+#include "Core/Logger.hpp"
+
+#include <fstream>
+#include <chrono>
+
+namespace AE
+{
+    static constexpr uint32_t IMPOSTOR_MAGIC = 0x4D494541; // "AEIM"
+    static constexpr uint32_t IMPOSTOR_VERSION = 1;
+
+    struct ImpostorFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        int32_t framesPerSide;
+        int32_t frameResolution;
+        float center[3];
+        float radius;
+        float ambientColor[3];
+    };
+
+    static std::shared_ptr<Texture> CreateAtlasTexture(unsigned char* pixels, int size)
+    {
+        auto texture = Texture::Create({ pixels, size, size, 4 });
+        if (!texture) return nullptr;
+
+        // Bilinear filtering must not wrap into the frame on the opposite side of the atlas.
+        texture->SetWrapS(TextureWrap::ClampToEdge);
+        texture->SetWrapT(TextureWrap::ClampToEdge);
+
+        return texture;
+    }
+
+    static void FinishAtlasTexture(Texture& texture, int frameResolution)
+    {
+        // Mips stop while a frame still has a few texels, deeper ones would average neighbouring frames.
+        texture.GenerateMipmaps();
+        texture.SetMaxLevel(std::max(static_cast<int>(std::log2(static_cast<float>(frameResolution))) - 2, 0));
+        texture.SetMinFilter(TextureFilter::LinearMipmapLinear);
+        texture.SetMagFilter(TextureFilter::Linear);
+    }
+
+    Impostor::Impostor(std::shared_ptr<Texture> albedo, std::shared_ptr<Texture> normalDepth,
+        int framesPerSide, int frameResolution, const glm::vec3& center, float radius, const glm::vec3& ambientColor)
+        : _albedo(std::move(albedo)), _normalDepth(std::move(normalDepth)),
+        _framesPerSide(framesPerSide), _frameResolution(frameResolution),
+        _center(center), _radius(radius), _ambientColor(ambientColor) {}
+
+    std::shared_ptr<Impostor> Impostor::Load(const std::string& path)
+    {
+        LoggerContext ctx("Impostor", "Load");
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            Logger::Error("Failed to open file: '{}'", path);
+            return nullptr;
+        }
+
+        ImpostorFileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file || header.magic != IMPOSTOR_MAGIC || header.version != IMPOSTOR_VERSION
+            || header.framesPerSide <= 0 || header.frameResolution <= 0 || header.radius <= 0.0f)
+        {
+            Logger::Error("'{}' is not a valid impostor file!", path);
+            return nullptr;
+        }
+
+        const int size = header.framesPerSide * header.frameResolution;
+        const std::size_t bytes = static_cast<std::size_t>(size) * size * 4;
+
+        std::vector<unsigned char> albedo(bytes), normalDepth(bytes);
+        file.read(reinterpret_cast<char*>(albedo.data()), bytes);
+        file.read(reinterpret_cast<char*>(normalDepth.data()), bytes);
+
+        if (!file)
+        {
+            Logger::Error("'{}' is truncated!", path);
+            return nullptr;
+        }
+
+        auto albedoTexture = CreateAtlasTexture(albedo.data(), size);
+        auto normalDepthTexture = CreateAtlasTexture(normalDepth.data(), size);
+        if (!albedoTexture || !normalDepthTexture)
+            return nullptr;
+
+        FinishAtlasTexture(*albedoTexture, header.frameResolution);
+        FinishAtlasTexture(*normalDepthTexture, header.frameResolution);
+
+        return std::make_shared<Impostor>(std::move(albedoTexture), std::move(normalDepthTexture),
+            header.framesPerSide, header.frameResolution,
+            glm::vec3(header.center[0], header.center[1], header.center[2]), header.radius,
+            glm::vec3(header.ambientColor[0], header.ambientColor[1], header.ambientColor[2]));
+    }
+
+    bool Impostor::Save(const std::string& path) const
+    {
+        LoggerContext ctx("Impostor", "Save");
+
+        const int size = _framesPerSide * _frameResolution;
+
+        int albedoWidth = 0, albedoHeight = 0, normalWidth = 0, normalHeight = 0;
+        std::vector<unsigned char> albedo = _albedo ? _albedo->ReadPixels(0, albedoWidth, albedoHeight) : std::vector<unsigned char>();
+        std::vector<unsigned char> normalDepth = _normalDepth ? _normalDepth->ReadPixels(0, normalWidth, normalHeight) : std::vector<unsigned char>();
+
+        if (albedoWidth != size || albedoHeight != size || normalWidth != size || normalHeight != size)
+        {
+            Logger::Error("Atlas textures don't match the frame layout!");
+            return false;
+        }
+
+        ImpostorFileHeader header{};
+        header.magic = IMPOSTOR_MAGIC;
+        header.version = IMPOSTOR_VERSION;
+        header.framesPerSide = _framesPerSide;
+        header.frameResolution = _frameResolution;
+        header.center[0] = _center.x;
+        header.center[1] = _center.y;
+        header.center[2] = _center.z;
+        header.radius = _radius;
+        header.ambientColor[0] = _ambientColor.x;
+        header.ambientColor[1] = _ambientColor.y;
+        header.ambientColor[2] = _ambientColor.z;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            Logger::Error("Failed to open file: '{}'", path);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(albedo.data()), albedo.size());
+        file.write(reinterpret_cast<const char*>(normalDepth.data()), normalDepth.size());
+
+        if (!file)
+        {
+            Logger::Error("Failed to write file: '{}'", path);
+            return false;
+        }
+
+        return true;
+    }
+
+    glm::vec3 Impostor::OctahedralDecode(const glm::vec2& e)
+    {
+        glm::vec3 n(e.x, 1.0f - std::abs(e.x) - std::abs(e.y), e.y);
+
+        // The lower hemisphere is folded over the diagonals of the square.
+        if (n.y < 0.0f)
+        {
+            const float x = n.x, z = n.z;
+            n.x = (1.0f - std::abs(z)) * (x >= 0.0f ? 1.0f : -1.0f);
+            n.z = (1.0f - std::abs(x)) * (z >= 0.0f ? 1.0f : -1.0f);
+        }
+
+        return glm::normalize(n);
+    }
+
+    glm::vec2 Impostor::OctahedralEncode(const glm::vec3& direction)
+    {
+        const glm::vec3 n = direction / (std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z));
+        glm::vec2 e(n.x, n.z);
+
+        if (n.y < 0.0f)
+        {
+            e.x = (1.0f - std::abs(n.z)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            e.y = (1.0f - std::abs(n.x)) * (n.z >= 0.0f ? 1.0f : -1.0f);
+        }
+
+        return e;
+    }
+
+    const std::shared_ptr<Texture>& Impostor::GetAlbedo() const { return _albedo; }
+    const std::shared_ptr<Texture>& Impostor::GetNormalDepth() const { return _normalDepth; }
+
+    int Impostor::GetFramesPerSide() const { return _framesPerSide; }
+    int Impostor::GetFrameResolution() const { return _frameResolution; }
+
+    const glm::vec3& Impostor::GetCenter() const { return _center; }
+    float Impostor::GetRadius() const { return _radius; }
+    const glm::vec3& Impostor::GetAmbientColor() const { return _ambientColor; }
+
+    ImpostorBaker::ImpostorBaker()
+        : _settings() {}
+
+    ImpostorBaker::ImpostorBaker(const Settings& settings)
+        : _settings(settings) {}
+
+    std::shared_ptr<Impostor> ImpostorBaker::Bake(const Model& model, Shader* bakeShader, ShaderManager* shaderMgr)
+    {
+        LoggerContext ctx("ImpostorBaker", "Bake");
+
+        if (!bakeShader)
+        {
+            Logger::Error("No bake shader given!");
+            return nullptr;
+        }
+
+        if (!model.IsFlattened())
+        {
+            Logger::Error("Model has nothing to draw, it must be flattened first!");
+            return nullptr;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        const int frames = std::max(_settings.framesPerSide, 1);
+        const int resolution = std::max(_settings.frameResolution, 1);
+        const int size = frames * resolution;
+
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        if (size > maxSize)
+        {
+            Logger::Error("Atlas of {}x{} exceeds the maximum texture size ({})!", size, size, maxSize);
+            return nullptr;
+        }
+
+        const BoundingSphere& sphere = model.GetBoundingSphere();
+        const glm::vec3 center = sphere.center;
+        const float radius = std::max(sphere.radius, 1e-4f);
+
+        struct Draw
+        {
+            const Model::DrawItem* item;
+            const Material* material;
+            Shader* shader;
+        };
+
+        std::vector<Draw> draws;
+        draws.reserve(model.GetDrawItems().size());
+
+        glm::vec3 ambientColor(0.0f);
+        bool pending = false;
+
+        for (const Model::DrawItem& item : model.GetDrawItems())
+        {
+            const Material* material = item.material ? item.material : Material::GetDefault();
+
+            Shader* shader = bakeShader->GetVariant(material->GetShaderFeatures() | item.mesh->GetShaderFeatures());
+            pending = pending || shader->IsPending();
+
+            draws.push_back({ &item, material, shader });
+            ambientColor += material->GetAmbientColor().ToVec3();
+        }
+
+        ambientColor /= static_cast<float>(std::max<std::size_t>(draws.size(), 1));
+
+        if (pending && shaderMgr)
+            shaderMgr->WaitForPending();
+
+        std::shared_ptr<Texture> albedo = CreateAtlasTexture(nullptr, size);
+        std::shared_ptr<Texture> normalDepth = CreateAtlasTexture(nullptr, size);
+        if (!albedo || !normalDepth)
+            return nullptr;
+
+        albedo->SetMinFilter(TextureFilter::Linear);
+        normalDepth->SetMinFilter(TextureFilter::Linear);
+
+        // Depth is only needed while the frames are drawn, the graph allocates it for the pass.
+        TextureDesc depthDescriptor;
+        depthDescriptor.width = size;
+        depthDescriptor.height = size;
+        depthDescriptor.channels = 1;
+        depthDescriptor.type = GL_FLOAT;
+        depthDescriptor.internalFormat = TextureFormat::Depth24;
+        depthDescriptor.format = TextureFormat::Depth;
+        depthDescriptor.minFilter = TextureFilter::Nearest;
+        depthDescriptor.magFilter = TextureFilter::Nearest;
+        depthDescriptor.wrapS = TextureWrap::ClampToEdge;
+        depthDescriptor.wrapT = TextureWrap::ClampToEdge;
+
+        RenderGraph graph;
+        const RenderGraph::Resource albedoTarget = graph.Import("ImpostorAlbedo", albedo);
+        const RenderGraph::Resource normalDepthTarget = graph.Import("ImpostorNormalDepth", normalDepth);
+
+        // The sphere fills every frame, and depth runs linearly from its near to its far side.
+        const glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, radius, radius * 3.0f);
+
+        std::vector<glm::mat4> views(static_cast<std::size_t>(frames) * frames);
+        for (int y = 0; y < frames; ++y)
+        {
+            for (int x = 0; x < frames; ++x)
+            {
+                const float u = (static_cast<float>(x) + 0.5f) / static_cast<float>(frames) * 2.0f - 1.0f;
+                const float v = (static_cast<float>(y) + 0.5f) / static_cast<float>(frames) * 2.0f - 1.0f;
+                const glm::vec3 direction = Impostor::OctahedralDecode(glm::vec2(u, v));
+
+                // Impostor.vert rebuilds the same basis for the quad, both sides have to agree.
+                const glm::vec3 up = std::abs(direction.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                views[y * frames + x] = glm::lookAt(center + direction * radius * 2.0f, center, up);
+            }
+        }
+
+        GLint previousPolygonMode[2] = {};
+        GLint previousDepthFunc = GL_LESS;
+        GLboolean previousDepthMask = GL_TRUE;
+        glGetIntegerv(GL_POLYGON_MODE, previousPolygonMode);
+        glGetIntegerv(GL_DEPTH_FUNC, &previousDepthFunc);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &previousDepthMask);
+        const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        const GLboolean faceCulling = glIsEnabled(GL_CULL_FACE);
+        const GLboolean blending = glIsEnabled(GL_BLEND);
+
+        bool complete = false;
+        std::size_t skipped = 0;
+
+        graph.AddPass("ImpostorFrames", [&](RenderGraph::Builder& builder)
+        {
+            builder.Write(albedoTarget);
+            builder.Write(normalDepthTarget);
+            builder.Create("ImpostorDepth", depthDescriptor);
+        },
+        [&](const RenderGraph::Context& context)
+        {
+            complete = context.GetFramebuffer() && context.GetFramebuffer()->IsComplete();
+            if (!complete) return;
+
+            // Empty texels: no coverage, and a depth behind everything.
+            const GLfloat clearAlbedo[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            const GLfloat clearNormalDepth[4] = { 0.5f, 0.5f, 0.5f, 1.0f };
+            const GLfloat clearDepth = 1.0f;
+            glClearBufferfv(GL_COLOR, 0, clearAlbedo);
+            glClearBufferfv(GL_COLOR, 1, clearNormalDepth);
+            glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+            glDisable(GL_CULL_FACE);
+            glDisable(GL_BLEND);
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+            for (const Draw& draw : draws)
+            {
+                Shader* shader = draw.shader;
+                if (shader->IsPending())
+                {
+                    skipped++;
+                    continue;
+                }
+
+                shader->Bind();
+                shader->SetMat4(Uniforms::ProjectionMatrix, projection);
+                shader->SetMat4(Uniforms::ModelMatrix, draw.item->transform);
+                shader->SetVec3(Uniforms::PositionScale, draw.item->mesh->GetPositionScale());
+                shader->SetVec3(Uniforms::PositionOffset, draw.item->mesh->GetPositionOffset());
+                draw.material->Apply(shader);
+
+                for (int y = 0; y < frames; ++y)
+                {
+                    for (int x = 0; x < frames; ++x)
+                    {
+                        glViewport(x * resolution, y * resolution, resolution, resolution);
+                        shader->SetMat4(Uniforms::ViewMatrix, views[y * frames + x]);
+                        draw.item->mesh->Draw();
+                    }
+                }
+
+                shader->Unbind();
+            }
+        });
+
+        // Restores the framebuffer and viewport bound before.
+        graph.Execute();
+
+        glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(previousPolygonMode[0]));
+        glDepthFunc(static_cast<GLenum>(previousDepthFunc));
+        glDepthMask(previousDepthMask);
+        if (depthTest) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+        if (faceCulling) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
+        if (blending) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+
+        if (!complete)
+        {
+            Logger::Error("Bake framebuffer is not complete!");
+            return nullptr;
+        }
+
+        if (skipped > 0)
+            Logger::Warning("{} of {} meshes left out, their shader variants are still compiling", skipped, draws.size());
+
+        FinishAtlasTexture(*albedo, resolution);
+        FinishAtlasTexture(*normalDepth, resolution);
+
+        const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Logger::Info("Baked {}x{} impostor frames of {} px from {} meshes in {:.1f} ms",
+            frames, frames, resolution, draws.size() - skipped, elapsedMs);
+
+        return std::make_shared<Impostor>(std::move(albedo), std::move(normalDepth),
+            frames, resolution, center, radius, ambientColor);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "Rendering/IndexData.hpp"
+
+#include <cstring>
+
+namespace AE
+{
+    static uint32_t ReadIndex(const void* data, IndexType type, std::size_t i)
+    {
+        if (type == IndexType::UInt16)
+        {
+            uint16_t value;
+            std::memcpy(&value, static_cast<const unsigned char*>(data) + i * sizeof(uint16_t), sizeof(value));
+            return value;
+        }
+
+        uint32_t value;
+        std::memcpy(&value, static_cast<const unsigned char*>(data) + i * sizeof(uint32_t), sizeof(value));
+        return value;
+    }
+
+    std::size_t GetIndexTypeSize(IndexType type)
+    {
+        return type == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    }
+
+    uint32_t IndexView::operator[](std::size_t i) const { return ReadIndex(data, type, i); }
+
+    IndexData::IndexData(IndexType type, std::size_t reserve)
+        : _type(type)
+    {
+        Reserve(reserve);
+    }
+
+    IndexData::IndexData(const std::vector<GLuint>& indices)
+    {
+        GLuint max = 0;
+        for (GLuint index : indices)
+            max = std::max(max, index);
+
+        _type = max <= 0xFFFF ? IndexType::UInt16 : IndexType::UInt32;
+
+        Reserve(indices.size());
+        for (GLuint index : indices)
+            PushBack(index);
+    }
+
+    IndexData::IndexData(std::initializer_list<GLuint> indices)
+        : IndexData(std::vector<GLuint>(indices)) {}
+
+    IndexType IndexData::SelectType(std::size_t vertexCount)
+    {
+        return vertexCount <= 0x10000 ? IndexType::UInt16 : IndexType::UInt32;
+    }
+
+    void IndexData::Reserve(std::size_t count)
+    {
+        _bytes.reserve(count * GetIndexTypeSize(_type));
+    }
+
+    void IndexData::PushBack(uint32_t index)
+    {
+        if (_type == IndexType::UInt16 && index > 0xFFFF)
+            _Widen();
+
+        const std::size_t size = GetIndexTypeSize(_type);
+        _bytes.resize(_bytes.size() + size);
+
+        if (_type == IndexType::UInt16)
+        {
+            uint16_t value = static_cast<uint16_t>(index);
+            std::memcpy(_bytes.data() + _count * size, &value, size);
+        }
+        else
+        {
+            std::memcpy(_bytes.data() + _count * size, &index, size);
+        }
+
+        _count++;
+    }
+
+    void IndexData::Clear()
+    {
+        _bytes.clear();
+        _count = 0;
+    }
+
+    void IndexData::Release()
+    {
+        std::vector<unsigned char>().swap(_bytes);
+        _count = 0;
+    }
+
+    uint32_t IndexData::operator[](std::size_t i) const { return ReadIndex(_bytes.data(), _type, i); }
+
+    IndexType IndexData::GetType() const { return _type; }
+    std::size_t IndexData::GetCount() const { return _count; }
+    std::size_t IndexData::GetSizeInBytes() const { return _bytes.size(); }
+    std::size_t IndexData::GetCapacityInBytes() const { return _bytes.capacity(); }
+    const void* IndexData::GetData() const { return _bytes.data(); }
+    bool IndexData::IsEmpty() const { return _count == 0; }
+
+    IndexView IndexData::GetView() const { return { _bytes.data(), _count, _type }; }
+
+    std::vector<GLuint> IndexData::ToVector() const
+    {
+        std::vector<GLuint> indices(_count);
+        for (std::size_t i = 0; i < _count; ++i)
+            indices[i] = (*this)[i];
+
+        return indices;
+    }
+
+    void IndexData::_Widen()
+    {
+        std::vector<unsigned char> wide(_count * sizeof(uint32_t));
+        for (std::size_t i = 0; i < _count; ++i)
+        {
+            uint32_t value = (*this)[i];
+            std::memcpy(wide.data() + i * sizeof(uint32_t), &value, sizeof(value));
+        }
+
+        _bytes = std::move(wide);
+        _type = IndexType::UInt32;
+    }
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "Resources/Shader.hpp"
 #include "Resources/Texture.hpp"
 
+#include <optional>
+
 namespace AE
 {
     enum
@@ -13,6 +15,48 @@ namespace AE
         OPACITY_TEXTURE_SLOT
     };
 
+    struct MaterialUniforms
+    {
+        UniformHandle ambientColor;
+        UniformHandle diffuseColor;
+        UniformHandle specularColor;
+        UniformHandle shininess;
+
+        UniformHandle diffuseTexture;
+        UniformHandle specularTexture;
+        UniformHandle emissiveTexture;
+        UniformHandle normalTexture;
+        UniformHandle opacityTexture;
+
+        MaterialUniforms(const std::string& prefix)
+            : ambientColor(prefix + ".ambientColor"),
+              diffuseColor(prefix + ".diffuseColor"),
+              specularColor(prefix + ".specularColor"),
+              shininess(prefix + ".shininess"),
+              diffuseTexture(prefix + ".diffuseTexture"),
+              specularTexture(prefix + ".specularTexture"),
+              emissiveTexture(prefix + ".emissiveTexture"),
+              normalTexture(prefix + ".normalTexture"),
+              opacityTexture(prefix + ".opacityTexture")
+        {}
+    };
+
+    static uint64_t HashFNV1a(const void* data, std::size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    static bool SameColor(const Color& a, const Color& b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+
     Material::Material(
         const Color& ambientColor,
         const Color& diffuseColor,
@@ -32,54 +76,53 @@ namespace AE
 
         shader->Bind();
 
-        shader->SetVec3(uniformName + ".ambientColor", _ambientColor.ToVec3());
-        shader->SetVec3(uniformName + ".diffuseColor", _diffuseColor.ToVec3());
-        shader->SetVec3(uniformName + ".specularColor", _specularColor.ToVec3());
-        shader->SetFloat(uniformName + ".shininess", _shininess);
+        // Handles for the default name are built once; custom names pay for a registry lookup.
+        static const MaterialUniforms defaultUniforms("u_Material");
+
+        std::optional<MaterialUniforms> customUniforms;
+        if (uniformName != "u_Material")
+            customUniforms.emplace(uniformName);
+
+        const MaterialUniforms& uniforms = customUniforms ? *customUniforms : defaultUniforms;
+
+        shader->SetVec3(uniforms.ambientColor, _ambientColor.ToVec3());
+        shader->SetFloat(uniforms.shininess, _shininess);
+
+        // The variant selected via GetShaderFeatures() only declares the samplers it uses,
+        // and the plain colors are only read where no texture replaces them.
 
         // Diffuse
         if (HasDiffuseTexture() && _diffuseTexture->IsValid()) {
-            _diffuseTexture->Bind(0);
-            shader->SetInt(uniformName + ".diffuseTexture", DIFFUSE_TEXTURE_SLOT);
-            shader->SetBool(uniformName + ".hasDiffuseTexture", true);
+            _diffuseTexture->Bind(DIFFUSE_TEXTURE_SLOT);
+            shader->SetInt(uniforms.diffuseTexture, DIFFUSE_TEXTURE_SLOT);
         } else {
-            shader->SetBool(uniformName + ".hasDiffuseTexture", false);
+            shader->SetVec3(uniforms.diffuseColor, _diffuseColor.ToVec3());
         }
 
         // Specular
         if (HasSpecularTexture() && _specularTexture->IsValid()) {
-            _specularTexture->Bind(1);
-            shader->SetInt(uniformName + ".specularTexture", SPECULAR_TEXTURE_SLOT);
-            shader->SetBool(uniformName + ".hasSpecularTexture", true);
+            _specularTexture->Bind(SPECULAR_TEXTURE_SLOT);
+            shader->SetInt(uniforms.specularTexture, SPECULAR_TEXTURE_SLOT);
         } else {
-            shader->SetBool(uniformName + ".hasSpecularTexture", false);
+            shader->SetVec3(uniforms.specularColor, _specularColor.ToVec3());
         }
 
         // Emissive
         if (HasEmissiveTexture() && _emissiveTexture->IsValid()) {
-            _emissiveTexture->Bind(2);
-            shader->SetInt(uniformName + ".emissiveTexture", EMISSIVE_TEXTURE_SLOT);
-            shader->SetBool(uniformName + ".hasEmissiveTexture", true);
-        } else {
-            shader->SetBool(uniformName + ".hasEmissiveTexture", false);
+            _emissiveTexture->Bind(EMISSIVE_TEXTURE_SLOT);
+            shader->SetInt(uniforms.emissiveTexture, EMISSIVE_TEXTURE_SLOT);
         }
 
         // Normal
         if (HasNormalTexture() && _normalTexture->IsValid()) {
-            _normalTexture->Bind(3);
-            shader->SetInt(uniformName + ".normalTexture", NORMAL_TEXTURE_SLOT);
-            shader->SetBool(uniformName + ".hasNormalTexture", true);
-        } else {
-            shader->SetBool(uniformName + ".hasNormalTexture", false);
+            _normalTexture->Bind(NORMAL_TEXTURE_SLOT);
+            shader->SetInt(uniforms.normalTexture, NORMAL_TEXTURE_SLOT);
         }
 
         // Opacity
         if (HasOpacityTexture() && _opacityTexture->IsValid()) {
-            _opacityTexture->Bind(4);
-            shader->SetInt(uniformName + ".opacityTexture", OPACITY_TEXTURE_SLOT);
-            shader->SetBool(uniformName + ".hasOpacityTexture", true);
-        } else {
-            shader->SetBool(uniformName + ".hasOpacityTexture", false);
+            _opacityTexture->Bind(OPACITY_TEXTURE_SLOT);
+            shader->SetInt(uniforms.opacityTexture, OPACITY_TEXTURE_SLOT);
         }
     }
 
@@ -114,6 +157,48 @@ namespace AE
         return _diffuseTexture && _diffuseTexture->HasTransparency();
     }
 
+    uint64_t Material::GetContentHash() const
+    {
+        const Texture* textures[] = {
+            _diffuseTexture.get(), _specularTexture.get(), _emissiveTexture.get(),
+            _normalTexture.get(), _opacityTexture.get()
+        };
+
+        uint64_t hash = HashFNV1a(&_ambientColor, sizeof(Color));
+        hash = HashFNV1a(&_diffuseColor, sizeof(Color), hash);
+        hash = HashFNV1a(&_specularColor, sizeof(Color), hash);
+        hash = HashFNV1a(&_shininess, sizeof(float), hash);
+        hash = HashFNV1a(textures, sizeof(textures), hash);
+
+        return hash;
+    }
+
+    bool Material::operator==(const Material& other) const
+    {
+        return SameColor(_ambientColor, other._ambientColor)
+            && SameColor(_diffuseColor, other._diffuseColor)
+            && SameColor(_specularColor, other._specularColor)
+            && _shininess == other._shininess
+            && _diffuseTexture == other._diffuseTexture
+            && _specularTexture == other._specularTexture
+            && _emissiveTexture == other._emissiveTexture
+            && _normalTexture == other._normalTexture
+            && _opacityTexture == other._opacityTexture;
+    }
+
+    ShaderFeature Material::GetShaderFeatures() const
+    {
+        ShaderFeature features = ShaderFeature::None;
+
+        if (HasDiffuseTexture() && _diffuseTexture->IsValid()) features |= ShaderFeature::DiffuseTexture;
+        if (HasSpecularTexture() && _specularTexture->IsValid()) features |= ShaderFeature::SpecularTexture;
+        if (HasEmissiveTexture() && _emissiveTexture->IsValid()) features |= ShaderFeature::EmissiveTexture;
+        if (HasNormalTexture() && _normalTexture->IsValid()) features |= ShaderFeature::NormalTexture;
+        if (HasOpacityTexture() && _opacityTexture->IsValid()) features |= ShaderFeature::OpacityTexture;
+
+        return features;
+    }
+
     void Material::SetAmbientColor(const Color& ambientColor) { _ambientColor = ambientColor; }
     void Material::SetDiffuseColor(const Color& diffuseColor) { _diffuseColor = diffuseColor; }
     void Material::SetSpecularColor(const Color& specularColor) { _specularColor = specularColor; }
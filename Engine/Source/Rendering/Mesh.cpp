@@ -1,38 +1,85 @@
 #include "Rendering/Mesh.hpp"
 #include "Core/Logger.hpp"
 
+#include <cstring>
+
 namespace AE
 {
+    static Mesh::MemoryUsage TotalMemoryUsage;
+
+    template<typename T>
+    static std::size_t CapacityBytes(const std::vector<T>& v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+
+    template<typename T>
+    static void Release(std::vector<T>& v)
+    {
+        std::vector<T>().swap(v);
+    }
+
+    template<typename T>
+    static bool CopyRange(std::vector<T>& dst, std::size_t first, std::span<const T> src)
+    {
+        if (first + src.size() > dst.size())
+        {
+            LoggerContext ctx("Mesh", "Update");
+            Logger::Error("Range [{}, {}) is out of bounds ({} values)!", first, first + src.size(), dst.size());
+            return false;
+        }
+
+        std::copy(src.begin(), src.end(), dst.begin() + first);
+        return true;
+    }
+
+    template<typename T>
+    static std::span<const T> SubRange(const std::vector<T>& v, std::size_t count, std::size_t first, std::size_t end)
+    {
+        if (v.size() != count) return {};
+        return std::span<const T>(v).subspan(first, end - first);
+    }
+
     Mesh::Mesh(
-        const std::vector<glm::vec3>& vertices,
-        const std::vector<GLuint>& indices,
-        const std::vector<glm::vec3>& normals,
-        const std::vector<glm::vec2>& texCoords,
-        const std::vector<glm::vec3>& tangents,
-        const std::vector<glm::vec3>& bitangents
+        std::vector<glm::vec3> vertices,
+        IndexData indices,
+        std::vector<glm::vec3> normals,
+        std::vector<glm::vec2> texCoords,
+        std::vector<glm::vec3> tangents,
+        std::vector<glm::vec3> bitangents,
+        std::vector<glm::vec2> lightmapTexCoords,
+        const VertexLayout& layout,
+        MeshResidency residency,
+        MeshUsage usage
     )
-        : _vao(0), _ebo(0),
-          _vertices(vertices),
-          _indices(indices),
-          _normals(normals),
-          _texCoords(texCoords),
-          _tangents(tangents),
-          _bitangents(bitangents)
+        : _vao(0), _vbo(0), _ebo(0),
+          _layout(layout),
+          _residency(residency),
+          _usage(usage),
+          _vertices(std::move(vertices)),
+          _indices(std::move(indices)),
+          _normals(std::move(normals)),
+          _texCoords(std::move(texCoords)),
+          _tangents(std::move(tangents)),
+          _bitangents(std::move(bitangents)),
+          _lightmapTexCoords(std::move(lightmapTexCoords))
     {
-        for (int i = 0; i < VBO_COUNT; ++i)
-            _vbos[i] = 0;
-    
+        _ApplyUsage();
         Setup();
     }
     
     Mesh::~Mesh()
     {
         if (_vao) glDeleteVertexArrays(1, &_vao);
+        if (_vbo) glDeleteBuffers(1, &_vbo);
         if (_ebo) glDeleteBuffers(1, &_ebo);
-        for (int i = 0; i < VBO_COUNT; ++i)
-        {
-            if (_vbos[i]) glDeleteBuffers(1, &_vbos[i]);
-        }
+
+        GeometryArena::Get().Free(_arena);
+
+        TotalMemoryUsage.gpuBytes -= _memory.gpuBytes;
+        TotalMemoryUsage.cpuBytes -= _memory.cpuBytes;
+        TotalMemoryUsage.arenaBytes -= _memory.arenaBytes;
+        TotalMemoryUsage.releasedBytes -= _memory.releasedBytes;
     }
     
     void Mesh::Bind() const
@@ -48,9 +95,13 @@ namespace AE
     void Mesh::Setup()
     {
         LoggerContext ctx("Mesh", "Setup");
+
+        _dirty = false;
+        _dirtyFirst = _dirtyEnd = 0;
+        _indicesDirty = false;
     
-        if (!HasVertices()) {
-            Logger::Error("Mesh has no vertices!");
+        if (_vertices.empty()) {
+            Logger::Error(_vao ? "Mesh CPU data was released, nothing to upload!" : "Mesh has no vertices!");
             return;
         }
     
@@ -59,13 +110,10 @@ namespace AE
             glDeleteVertexArrays(1, &_vao);
             _vao = 0;
     
-            for (int i = 0; i < VBO_COUNT; ++i)
+            if (_vbo != 0)
             {
-                if (_vbos[i] != 0)
-                {
-                    glDeleteBuffers(1, &_vbos[i]);
-                    _vbos[i] = 0;
-                }
+                glDeleteBuffers(1, &_vbo);
+                _vbo = 0;
             }
     
             if (_ebo != 0)
@@ -74,66 +122,54 @@ namespace AE
                 _ebo = 0;
             }
         }
+
+        PackedVertices packed = _layout.Pack(_vertices, _normals, _texCoords, _tangents, _bitangents, _lightmapTexCoords);
+
+        // Draw only relies on these, the CPU arrays may be released below.
+        _vertexCount = _vertices.size();
+        _indexCount = _indices.GetCount();
+        _indexType = _indices.GetType();
+        _attributeMask = _GetAttributeMask();
+
+        CalculateBounds();
+
+        _stride = packed.stride;
+        _shaderFeatures = packed.features;
+        _positionScale = packed.positionScale;
+        _positionOffset = packed.positionOffset;
     
         glGenVertexArrays(1, &_vao);
         glBindVertexArray(_vao);
     
-        // VERTICES
-        glGenBuffers(1, &_vbos[VERTICES]);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbos[VERTICES]);
-        glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(glm::vec3), _vertices.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    
-        // NORMALS
-        if (HasNormals()) {
-            glGenBuffers(1, &_vbos[NORMALS]);
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[NORMALS]);
-            glBufferData(GL_ARRAY_BUFFER, _normals.size() * sizeof(glm::vec3), _normals.data(), GL_STATIC_DRAW);
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-        } else {
-            glVertexAttrib3f(1, 0.0f, 0.0f, 1.0f);
-        }
-    
-        // TEXCOORDS
-        if (HasTexCoords()) {
-            glGenBuffers(1, &_vbos[TEXCOORDS]);
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[TEXCOORDS]);
-            glBufferData(GL_ARRAY_BUFFER, _texCoords.size() * sizeof(glm::vec2), _texCoords.data(), GL_STATIC_DRAW);
-            glEnableVertexAttribArray(2);
-            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-        } else {
-            glVertexAttrib2f(2, 0.0f, 0.0f);
-        }
-    
-        // TANGENTS
-        if (HasTangents()) {
-            glGenBuffers(1, &_vbos[TANGENTS]);
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[TANGENTS]);
-            glBufferData(GL_ARRAY_BUFFER, _tangents.size() * sizeof(glm::vec3), _tangents.data(), GL_STATIC_DRAW);
-            glEnableVertexAttribArray(3);
-            glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-        } else {
-            glVertexAttrib3f(3, 1.0f, 0.0f, 0.0f);
-        }
-    
-        // BITANGENTS
-        if (HasBitangents()) {
-            glGenBuffers(1, &_vbos[BITANGENTS]);
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[BITANGENTS]);
-            glBufferData(GL_ARRAY_BUFFER, _bitangents.size() * sizeof(glm::vec3), _bitangents.data(), GL_STATIC_DRAW);
-            glEnableVertexAttribArray(4);
-            glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-        } else {
-            glVertexAttrib3f(4, 0.0f, 1.0f, 0.0f);
+        // All attributes are interleaved in a single buffer.
+        glGenBuffers(1, &_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+        glBufferData(GL_ARRAY_BUFFER, packed.data.size(), packed.data.data(), _GetBufferUsage());
+
+        bool enabled[5] = {};
+        for (const VertexAttribute& attribute : packed.attributes)
+        {
+            glEnableVertexAttribArray(attribute.location);
+            glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized,
+                packed.stride, reinterpret_cast<const void*>(attribute.offset));
+            enabled[attribute.location] = true;
         }
+
+        // Missing attributes fall back to constants, always in the uncompressed form.
+        if (!enabled[VertexLayout::NORMAL])
+            glVertexAttrib4f(VertexLayout::NORMAL, 0.0f, 0.0f, 1.0f, 0.0f);
+
+        if (!enabled[VertexLayout::TEXCOORD])
+            glVertexAttrib2f(VertexLayout::TEXCOORD, 0.0f, 0.0f);
+
+        if (!enabled[VertexLayout::TANGENT])
+            glVertexAttrib4f(VertexLayout::TANGENT, 1.0f, 0.0f, 0.0f, 1.0f);
     
         // INDICES
-        if (HasIndices()) {
+        if (!_indices.IsEmpty()) {
             glGenBuffers(1, &_ebo);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(GLuint), _indices.data(), GL_STATIC_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.GetSizeInBytes(), _indices.GetData(), _GetBufferUsage());
         }
     
         glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -143,105 +179,443 @@ namespace AE
         if (error != GL_NO_ERROR) {
             Logger::Error("OpenGL error: {}", error);
         }
+
+        _ApplyResidency();
+        _UpdateMemoryUsage();
     }
     
     void Mesh::Draw(GLenum mode)
     {
-        if (_vao == 0 || _vertices.empty())
+        _FlushUpdates();
+
+        if (_vao == 0 || _vertexCount == 0)
             return;
     
         glBindVertexArray(_vao);
     
-        if (HasIndices()) {
-            glDrawElements(mode, _indices.size(), GL_UNSIGNED_INT, 0);
+        if (_indexCount > 0) {
+            glDrawElements(mode, _indexCount, static_cast<GLenum>(_indexType), 0);
         } else {
-            glDrawArrays(mode, 0, _vertices.size());
+            glDrawArrays(mode, 0, _vertexCount);
         }
     
         glBindVertexArray(0);
     }
 
+    void Mesh::DrawRanges(const GLsizei* counts, const void* const* offsets, GLsizei rangeCount, GLenum mode)
+    {
+        _FlushUpdates();
+
+        if (_vao == 0 || _indexCount == 0 || rangeCount <= 0)
+            return;
+
+        glBindVertexArray(_vao);
+        glMultiDrawElements(mode, counts, static_cast<GLenum>(_indexType), offsets, rangeCount);
+        glBindVertexArray(0);
+    }
+
     const AABB& Mesh::GetAABB() const { return _aabb; }
-    void Mesh::SetAABB(const AABB& aabb) { _aabb = aabb; }
+    const BoundingSphere& Mesh::GetBoundingSphere() const { return _boundingSphere; }
+
+    // The sphere is replaced by the box's circumsphere so the two never disagree.
+    void Mesh::SetAABB(const AABB& aabb)
+    {
+        _aabb = aabb;
+        _boundingSphere = BoundingSphere(aabb.GetCenter(), glm::length(aabb.GetExtents()));
+    }
+
+    void Mesh::CalculateBounds()
+    {
+        if (_vertices.empty())
+        {
+            LoggerContext ctx("Mesh", "CalculateBounds");
+            Logger::Warning("Mesh CPU data was released, keeping the current bounds");
+            return;
+        }
+
+        _aabb = AABB::FromPoints(_vertices);
+        _boundingSphere = BoundingSphere::FromPoints(_vertices);
+        _boundsDirty = false;
+    }
     
     const std::vector<glm::vec3>& Mesh::GetVertices() const { return _vertices; }
     const std::vector<glm::vec3>& Mesh::GetNormals() const { return _normals; }
     const std::vector<glm::vec2>& Mesh::GetTexCoords() const { return _texCoords; }
     const std::vector<glm::vec3>& Mesh::GetTangents() const { return _tangents; }
     const std::vector<glm::vec3>& Mesh::GetBitangents() const { return _bitangents; }
-    const std::vector<GLuint>&    Mesh::GetIndices() const { return _indices; }
+    const std::vector<glm::vec2>& Mesh::GetLightmapTexCoords() const { return _lightmapTexCoords; }
+    const IndexData&              Mesh::GetIndices() const { return _indices; }
     
-    std::size_t Mesh::GetVerticesCount() const   { return _vertices.size(); }
+    std::size_t Mesh::GetVerticesCount() const   { return IsCPUResident() ? _vertices.size() : _vertexCount; }
     std::size_t Mesh::GetNormalsCount() const    { return _normals.size(); }
     std::size_t Mesh::GetTexCoordsCount() const  { return _texCoords.size(); }
     std::size_t Mesh::GetTangentsCount() const   { return _tangents.size(); }
     std::size_t Mesh::GetBitangentsCount() const { return _bitangents.size(); }
-    std::size_t Mesh::GetIndicesCount() const    { return _indices.size(); }
+    std::size_t Mesh::GetLightmapTexCoordsCount() const { return _lightmapTexCoords.size(); }
+    std::size_t Mesh::GetIndicesCount() const    { return IsCPUResident() ? _indices.GetCount() : _indexCount; }
     
-    bool Mesh::HasVertices() const   { return !_vertices.empty(); }
+    bool Mesh::HasVertices() const   { return GetVerticesCount() > 0; }
     bool Mesh::HasNormals() const    { return !_normals.empty(); }
     bool Mesh::HasTexCoords() const  { return !_texCoords.empty(); }
     bool Mesh::HasTangents() const   { return !_tangents.empty(); }
     bool Mesh::HasBitangents() const { return !_bitangents.empty(); }
-    bool Mesh::HasIndices() const    { return !_indices.empty(); }
+    bool Mesh::HasLightmapTexCoords() const { return !_lightmapTexCoords.empty(); }
+    bool Mesh::HasIndices() const    { return GetIndicesCount() > 0; }
+    IndexType Mesh::GetIndexType() const { return IsCPUResident() ? _indices.GetType() : _indexType; }
     
-    void Mesh::SetVertices(const std::vector<glm::vec3>& vertices)
+    const VertexLayout& Mesh::GetVertexLayout() const { return _layout; }
+    GLsizei Mesh::GetVertexStride() const { return _stride; }
+
+    void Mesh::SetVertexLayout(const VertexLayout& layout)
     {
-        _vertices = vertices;
-    
-        if (_vbos[VERTICES]) {
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[VERTICES]);
-            glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(glm::vec3), _vertices.data(), GL_STATIC_DRAW);
+        if (_layout == layout) return;
+
+        if (!IsCPUResident())
+        {
+            LoggerContext ctx("Mesh", "SetVertexLayout");
+            Logger::Warning("Cannot repack a mesh whose CPU data was released!");
+            return;
         }
+
+        _layout = layout;
+        _ApplyUsage();
+        _dirty = true;
     }
-    
-    void Mesh::SetNormals(const std::vector<glm::vec3>& normals)
+
+    ShaderFeature Mesh::GetShaderFeatures() const { return _shaderFeatures; }
+    const glm::vec3& Mesh::GetPositionScale() const { return _positionScale; }
+    const glm::vec3& Mesh::GetPositionOffset() const { return _positionOffset; }
+
+    MeshResidency Mesh::GetResidency() const { return _residency; }
+    bool Mesh::IsCPUResident() const { return !_vertices.empty(); }
+
+    std::span<const glm::vec3> Mesh::GetPositionData() const
     {
-        _normals = normals;
-    
-        if (_vbos[NORMALS]) {
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[NORMALS]);
-            glBufferData(GL_ARRAY_BUFFER, _normals.size() * sizeof(glm::vec3), _normals.data(), GL_STATIC_DRAW);
+        if (!IsCPUResident() && _arena.IsValid())
+            return { reinterpret_cast<const glm::vec3*>(_arena.data), _vertexCount };
+
+        return { _vertices.data(), _vertices.size() };
+    }
+
+    IndexView Mesh::GetIndexData() const
+    {
+        if (!IsCPUResident() && _arena.IsValid())
+            return { _arena.data + _vertexCount * sizeof(glm::vec3), _indexCount, _indexType };
+
+        return _indices.GetView();
+    }
+
+    const Mesh::MemoryUsage& Mesh::GetMemoryUsage() const { return _memory; }
+    const Mesh::MemoryUsage& Mesh::GetTotalMemoryUsage() { return TotalMemoryUsage; }
+
+    void Mesh::_ApplyResidency()
+    {
+        if (_residency == MeshResidency::CPURetained)
+            return;
+
+        std::size_t before = CapacityBytes(_vertices) + CapacityBytes(_normals) + CapacityBytes(_texCoords)
+            + CapacityBytes(_tangents) + CapacityBytes(_bitangents) + CapacityBytes(_lightmapTexCoords) + _indices.GetCapacityInBytes();
+
+        GeometryArena& arena = GeometryArena::Get();
+        arena.Free(_arena);
+
+        if (_residency == MeshResidency::SharedArena)
+        {
+            const std::size_t positionBytes = _vertices.size() * sizeof(glm::vec3);
+            const std::size_t indexBytes = _indices.GetSizeInBytes();
+
+            _arena = arena.Allocate(positionBytes + indexBytes);
+            std::memcpy(_arena.data, _vertices.data(), positionBytes);
+            if (indexBytes > 0)
+                std::memcpy(_arena.data + positionBytes, _indices.GetData(), indexBytes);
         }
+
+        Release(_vertices);
+        Release(_normals);
+        Release(_texCoords);
+        Release(_tangents);
+        Release(_bitangents);
+        Release(_lightmapTexCoords);
+        _indices.Release();
+
+        _memory.releasedBytes += before - _arena.size;
     }
-    
-    void Mesh::SetTexCoords(const std::vector<glm::vec2>& texCoords)
+
+    void Mesh::_UpdateMemoryUsage()
     {
-        _texCoords = texCoords;
-    
-        if (_vbos[TEXCOORDS]) {
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[TEXCOORDS]);
-            glBufferData(GL_ARRAY_BUFFER, _texCoords.size() * sizeof(glm::vec2), _texCoords.data(), GL_STATIC_DRAW);
+        MemoryUsage usage;
+        usage.releasedBytes = _memory.releasedBytes;
+
+        if (_vbo) usage.gpuBytes += _vertexCount * _stride;
+        if (_ebo) usage.gpuBytes += _indexCount * GetIndexTypeSize(_indexType);
+
+        usage.cpuBytes = CapacityBytes(_vertices) + CapacityBytes(_normals) + CapacityBytes(_texCoords)
+            + CapacityBytes(_tangents) + CapacityBytes(_bitangents) + CapacityBytes(_lightmapTexCoords) + _indices.GetCapacityInBytes();
+        usage.arenaBytes = _arena.size;
+
+        TotalMemoryUsage.gpuBytes += usage.gpuBytes - _memory.gpuBytes;
+        TotalMemoryUsage.cpuBytes += usage.cpuBytes - _memory.cpuBytes;
+        TotalMemoryUsage.arenaBytes += usage.arenaBytes - _memory.arenaBytes;
+        TotalMemoryUsage.releasedBytes += usage.releasedBytes - _memory.releasedBytes;
+
+        _memory = usage;
+    }
+
+    MeshUsage Mesh::GetUsage() const { return _usage; }
+
+    void Mesh::SetUsage(MeshUsage usage)
+    {
+        if (_usage == usage) return;
+
+        _usage = usage;
+        _ApplyUsage();
+        _dirty = true;
+    }
+
+    void Mesh::UpdateVertices(std::size_t first, std::span<const glm::vec3> vertices)
+    {
+        if (!CopyRange(_vertices, first, vertices)) return;
+
+        _meshlets = {};
+        _GrowBounds(vertices);
+        _MarkDirty(first, vertices.size());
+    }
+
+    void Mesh::UpdateNormals(std::size_t first, std::span<const glm::vec3> normals)
+    {
+        if (CopyRange(_normals, first, normals)) _MarkDirty(first, normals.size());
+    }
+
+    void Mesh::UpdateTexCoords(std::size_t first, std::span<const glm::vec2> texCoords)
+    {
+        if (CopyRange(_texCoords, first, texCoords)) _MarkDirty(first, texCoords.size());
+    }
+
+    void Mesh::UpdateTangents(std::size_t first, std::span<const glm::vec3> tangents)
+    {
+        if (CopyRange(_tangents, first, tangents)) _MarkDirty(first, tangents.size());
+    }
+
+    // Attributes share one interleaved buffer, so any change repacks it before the next draw.
+    void Mesh::SetVertices(const std::vector<glm::vec3>& vertices) { SetVertices(std::vector<glm::vec3>(vertices)); }
+    void Mesh::SetNormals(const std::vector<glm::vec3>& normals) { SetNormals(std::vector<glm::vec3>(normals)); }
+    void Mesh::SetTexCoords(const std::vector<glm::vec2>& texCoords) { SetTexCoords(std::vector<glm::vec2>(texCoords)); }
+    void Mesh::SetTangents(const std::vector<glm::vec3>& tangents) { SetTangents(std::vector<glm::vec3>(tangents)); }
+    void Mesh::SetBitangents(const std::vector<glm::vec3>& bitangents) { SetBitangents(std::vector<glm::vec3>(bitangents)); }
+    void Mesh::SetLightmapTexCoords(const std::vector<glm::vec2>& texCoords) { SetLightmapTexCoords(std::vector<glm::vec2>(texCoords)); }
+    void Mesh::SetIndices(const IndexData& indices) { SetIndices(IndexData(indices)); }
+
+    void Mesh::SetVertices(std::vector<glm::vec3>&& vertices) { _vertices = std::move(vertices); _meshlets = {}; _boundsDirty = true; _MarkDirty(0, _vertices.size()); }
+    void Mesh::SetNormals(std::vector<glm::vec3>&& normals) { _normals = std::move(normals); _MarkDirty(0, _vertices.size()); }
+    void Mesh::SetTexCoords(std::vector<glm::vec2>&& texCoords) { _texCoords = std::move(texCoords); _MarkDirty(0, _vertices.size()); }
+    void Mesh::SetTangents(std::vector<glm::vec3>&& tangents) { _tangents = std::move(tangents); _MarkDirty(0, _vertices.size()); }
+    void Mesh::SetBitangents(std::vector<glm::vec3>&& bitangents) { _bitangents = std::move(bitangents); _MarkDirty(0, _vertices.size()); }
+    void Mesh::SetLightmapTexCoords(std::vector<glm::vec2>&& texCoords) { _lightmapTexCoords = std::move(texCoords); _MarkDirty(0, _vertices.size()); }
+    void Mesh::SetIndices(IndexData&& indices) { _indices = std::move(indices); _meshlets = {}; _MarkIndicesDirty(); }
+
+    const MeshletSet& Mesh::GetMeshlets() const { return _meshlets; }
+    bool Mesh::HasMeshlets() const { return !_meshlets.IsEmpty(); }
+
+    void Mesh::SetMeshlets(std::vector<Meshlet> meshlets)
+    {
+        LoggerContext ctx("Mesh", "SetMeshlets");
+
+        const std::size_t indexCount = GetIndicesCount();
+        for (const Meshlet& meshlet : meshlets)
+        {
+            if (static_cast<std::size_t>(meshlet.firstIndex) + meshlet.triangleCount * 3 > indexCount)
+            {
+                Logger::Error("Meshlet range exceeds the index buffer ({} indices), ignoring meshlets!", indexCount);
+                return;
+            }
         }
+
+        _meshlets = MeshletSet(std::move(meshlets));
     }
-    
-    void Mesh::SetTangents(const std::vector<glm::vec3>& tangents)
+
+    void Mesh::_ApplyUsage()
     {
-        _tangents = tangents;
-    
-        if (_vbos[TANGENTS]) {
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[TANGENTS]);
-            glBufferData(GL_ARRAY_BUFFER, _tangents.size() * sizeof(glm::vec3), _tangents.data(), GL_STATIC_DRAW);
+        if (_usage == MeshUsage::Static)
+            return;
+
+        LoggerContext ctx("Mesh", "_ApplyUsage");
+
+        if (_residency != MeshResidency::CPURetained)
+        {
+            Logger::Debug("Non-static meshes keep their CPU data, forcing CPURetained residency");
+            _residency = MeshResidency::CPURetained;
+        }
+
+        // Quantization bounds would change with every update.
+        if (_layout.position == VertexPositionFormat::Quantized)
+        {
+            Logger::Debug("Non-static meshes use float positions, ignoring quantization");
+            _layout.position = VertexPositionFormat::Float;
         }
     }
-    
-    void Mesh::SetBitangents(const std::vector<glm::vec3>& bitangents)
+
+    uint32_t Mesh::_GetAttributeMask() const
     {
-        _bitangents = bitangents;
-    
-        if (_vbos[BITANGENTS]) {
-            glBindBuffer(GL_ARRAY_BUFFER, _vbos[BITANGENTS]);
-            glBufferData(GL_ARRAY_BUFFER, _bitangents.size() * sizeof(glm::vec3), _bitangents.data(), GL_STATIC_DRAW);
+        const std::size_t count = _vertices.size();
+
+        const bool hasNormals = _normals.size() == count;
+        const bool hasTangents = hasNormals && _tangents.size() == count;
+
+        return (hasNormals ? 1u : 0u)
+            | (_texCoords.size() == count ? 2u : 0u)
+            | (hasTangents ? 4u : 0u)
+            | (hasTangents && _bitangents.size() == count ? 8u : 0u)
+            | (_lightmapTexCoords.size() == count ? 16u : 0u);
+    }
+
+    GLenum Mesh::_GetBufferUsage() const
+    {
+        switch (_usage)
+        {
+            case MeshUsage::Dynamic: return GL_DYNAMIC_DRAW;
+            case MeshUsage::Stream: return GL_STREAM_DRAW;
+            default: return GL_STATIC_DRAW;
         }
     }
-    
-    void Mesh::SetIndices(const std::vector<GLuint>& indices)
+
+    void Mesh::_MarkDirty(std::size_t first, std::size_t count)
     {
-        _indices = indices;
-    
-        if (_ebo) {
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(GLuint), _indices.data(), GL_STATIC_DRAW);
+        // Static meshes, or a change in the set of attributes (and so the layout), need a full rebuild.
+        if (_usage == MeshUsage::Static || _vbo == 0 || _GetAttributeMask() != _attributeMask)
+        {
+            _dirty = true;
+            return;
+        }
+
+        if (_dirtyEnd > _dirtyFirst)
+        {
+            _dirtyFirst = std::min(_dirtyFirst, first);
+            _dirtyEnd = std::max(_dirtyEnd, first + count);
+        }
+        else
+        {
+            _dirtyFirst = first;
+            _dirtyEnd = first + count;
         }
     }
+
+    void Mesh::_MarkIndicesDirty()
+    {
+        if (_usage == MeshUsage::Static || _ebo == 0 || _indices.IsEmpty())
+            _dirty = true;
+        else
+            _indicesDirty = true;
+    }
+
+    // Conservative: the box takes in the new positions and the sphere grows just enough to hold each of them.
+    void Mesh::_GrowBounds(std::span<const glm::vec3> vertices)
+    {
+        for (const glm::vec3& vertex : vertices)
+        {
+            _aabb.Expand(vertex);
+
+            const float distance = glm::length(vertex - _boundingSphere.center);
+            if (distance <= _boundingSphere.radius)
+                continue;
+
+            const float radius = (_boundingSphere.radius + distance) * 0.5f;
+            _boundingSphere.center += (vertex - _boundingSphere.center) * ((radius - _boundingSphere.radius) / distance);
+            _boundingSphere.radius = radius;
+        }
+    }
+
+    void Mesh::_FlushUpdates()
+    {
+        if (_dirty)
+        {
+            Setup();
+            return;
+        }
+
+        if (_dirtyEnd > _dirtyFirst)
+            _UploadVertices();
+
+        if (_indicesDirty)
+            _UploadIndices();
+    }
+
+    void Mesh::_UploadVertices()
+    {
+        const std::size_t count = _vertices.size();
+
+        std::size_t first = _dirtyFirst;
+        std::size_t end = std::min(_dirtyEnd, count);
+        _dirtyFirst = _dirtyEnd = 0;
+
+        // Stream meshes are always rewritten whole, and so is a buffer that changed size.
+        const bool whole = _usage == MeshUsage::Stream || count != _vertexCount || (first == 0 && end == count);
+        if (whole)
+        {
+            first = 0;
+            end = count;
+        }
+
+        if (end <= first)
+            return;
+
+        PackedVertices packed = _layout.Pack(
+            SubRange(_vertices, count, first, end),
+            SubRange(_normals, count, first, end),
+            SubRange(_texCoords, count, first, end),
+            SubRange(_tangents, count, first, end),
+            SubRange(_bitangents, count, first, end),
+            SubRange(_lightmapTexCoords, count, first, end)
+        );
+
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+
+        if (whole)
+        {
+            // Orphaning: the driver hands out fresh storage instead of waiting for draws still reading the old one.
+            glBufferData(GL_ARRAY_BUFFER, packed.data.size(), nullptr, _GetBufferUsage());
+
+            void* data = glMapBufferRange(GL_ARRAY_BUFFER, 0, packed.data.size(),
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+            if (data)
+            {
+                std::memcpy(data, packed.data.data(), packed.data.size());
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+            }
+            else
+            {
+                glBufferSubData(GL_ARRAY_BUFFER, 0, packed.data.size(), packed.data.data());
+            }
+        }
+        else
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, first * _stride, packed.data.size(), packed.data.data());
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        _vertexCount = count;
+
+        // Range updates already grew the bounds.
+        if (_boundsDirty)
+            CalculateBounds();
+
+        _UpdateMemoryUsage();
+    }
+
+    void Mesh::_UploadIndices()
+    {
+        _indicesDirty = false;
+
+        // The element buffer binding is VAO state.
+        glBindVertexArray(_vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.GetSizeInBytes(), nullptr, _GetBufferUsage());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, _indices.GetSizeInBytes(), _indices.GetData());
+        glBindVertexArray(0);
+
+        _indexCount = _indices.GetCount();
+        _indexType = _indices.GetType();
+        _UpdateMemoryUsage();
+    }
 }
@@ -0,0 +1,172 @@
+#include "Rendering/Meshlet.hpp"
+#include "Math/SIMD.hpp"
+
+namespace AE
+{
+    MeshletCullParams MeshletCullParams::FromWorld(const std::array<glm::vec4, 6>& worldPlanes,
+        const glm::vec3& worldCameraPosition, const glm::mat4& transform, bool cullBackfaces)
+    {
+        MeshletCullParams params;
+
+        // dot(plane, M * p) == dot(plane * M, p), so plane * M is the plane in object space.
+        for (std::size_t i = 0; i < worldPlanes.size(); ++i)
+        {
+            glm::vec4 plane = worldPlanes[i] * transform;
+            float length = glm::length(glm::vec3(plane));
+            params.planes[i] = length > 0.0f ? plane / length : plane;
+        }
+
+        params.cameraPosition = glm::vec3(glm::inverse(transform) * glm::vec4(worldCameraPosition, 1.0f));
+        params.cullBackfaces = cullBackfaces && glm::determinant(glm::mat3(transform)) > 0.0f;
+
+        return params;
+    }
+
+    MeshletSet::MeshletSet(std::vector<Meshlet> meshlets)
+        : _meshlets(std::move(meshlets))
+    {
+        _paddedCount = (_meshlets.size() + 3) & ~std::size_t(3);
+        _bounds.assign(_paddedCount * StreamCount, 0.0f);
+
+        for (std::size_t i = 0; i < _meshlets.size(); ++i)
+        {
+            const Meshlet& meshlet = _meshlets[i];
+
+            _bounds[CenterX * _paddedCount + i] = meshlet.center.x;
+            _bounds[CenterY * _paddedCount + i] = meshlet.center.y;
+            _bounds[CenterZ * _paddedCount + i] = meshlet.center.z;
+            _bounds[Radius * _paddedCount + i] = meshlet.radius;
+            _bounds[ApexX * _paddedCount + i] = meshlet.coneApex.x;
+            _bounds[ApexY * _paddedCount + i] = meshlet.coneApex.y;
+            _bounds[ApexZ * _paddedCount + i] = meshlet.coneApex.z;
+            _bounds[AxisX * _paddedCount + i] = meshlet.coneAxis.x;
+            _bounds[AxisY * _paddedCount + i] = meshlet.coneAxis.y;
+            _bounds[AxisZ * _paddedCount + i] = meshlet.coneAxis.z;
+
+            // The test is done squared, a cutoff above 1 can never pass.
+            _bounds[Cutoff * _paddedCount + i] = meshlet.coneCutoff >= 1.0f ? 2.0f : meshlet.coneCutoff;
+
+            _triangleCount += meshlet.triangleCount;
+        }
+    }
+
+    const std::vector<Meshlet>& MeshletSet::GetMeshlets() const { return _meshlets; }
+    std::size_t MeshletSet::GetCount() const { return _meshlets.size(); }
+    std::size_t MeshletSet::GetTriangleCount() const { return _triangleCount; }
+    bool MeshletSet::IsEmpty() const { return _meshlets.empty(); }
+
+    const float* MeshletSet::_GetStream(Stream stream) const
+    {
+        return _bounds.data() + stream * _paddedCount;
+    }
+
+    std::size_t MeshletSet::Cull(const MeshletCullParams& params, std::vector<uint32_t>& visible, MeshletCullStats* stats) const
+    {
+        const std::size_t count = _meshlets.size();
+        const std::size_t start = visible.size();
+
+        std::size_t frustumCulled = 0;
+        std::size_t backfaceCulled = 0;
+        std::size_t trianglesCulled = 0;
+
+        for (std::size_t base = 0; base < count; base += 4)
+        {
+            // Bit i set: meshlet base + i is inside the frustum / facing away from the camera.
+            int inside, backfacing = 0;
+
+#ifdef AE_SIMD_SSE2
+            const __m128 cx = _mm_loadu_ps(_GetStream(CenterX) + base);
+            const __m128 cy = _mm_loadu_ps(_GetStream(CenterY) + base);
+            const __m128 cz = _mm_loadu_ps(_GetStream(CenterZ) + base);
+            const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(_GetStream(Radius) + base));
+
+            __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const glm::vec4& plane : params.planes)
+            {
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y))),
+                    _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(distance, negRadius));
+            }
+            inside = _mm_movemask_ps(mask);
+
+            if (params.cullBackfaces && inside)
+            {
+                const __m128 dx = _mm_sub_ps(_mm_loadu_ps(_GetStream(ApexX) + base), _mm_set1_ps(params.cameraPosition.x));
+                const __m128 dy = _mm_sub_ps(_mm_loadu_ps(_GetStream(ApexY) + base), _mm_set1_ps(params.cameraPosition.y));
+                const __m128 dz = _mm_sub_ps(_mm_loadu_ps(_GetStream(ApexZ) + base), _mm_set1_ps(params.cameraPosition.z));
+                const __m128 cutoff = _mm_loadu_ps(_GetStream(Cutoff) + base);
+
+                // dot(normalize(d), axis) >= cutoff, without the square root.
+                __m128 d = _mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(dx, _mm_loadu_ps(_GetStream(AxisX) + base)),
+                    _mm_mul_ps(dy, _mm_loadu_ps(_GetStream(AxisY) + base))),
+                    _mm_mul_ps(dz, _mm_loadu_ps(_GetStream(AxisZ) + base)));
+                __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+                __m128 away = _mm_and_ps(
+                    _mm_cmpgt_ps(d, _mm_setzero_ps()),
+                    _mm_cmpge_ps(_mm_mul_ps(d, d), _mm_mul_ps(_mm_mul_ps(cutoff, cutoff), lengthSq)));
+
+                backfacing = _mm_movemask_ps(away) & inside;
+            }
+#else
+            inside = 0;
+            for (std::size_t lane = 0; lane < 4; ++lane)
+            {
+                const std::size_t i = base + lane;
+                const glm::vec3 center(_GetStream(CenterX)[i], _GetStream(CenterY)[i], _GetStream(CenterZ)[i]);
+                const float radius = _GetStream(Radius)[i];
+
+                bool in = true;
+                for (const glm::vec4& plane : params.planes)
+                    in = in && glm::dot(glm::vec3(plane), center) + plane.w >= -radius;
+
+                if (!in) continue;
+                inside |= 1 << lane;
+
+                if (!params.cullBackfaces) continue;
+
+                const glm::vec3 d = glm::vec3(_GetStream(ApexX)[i], _GetStream(ApexY)[i], _GetStream(ApexZ)[i]) - params.cameraPosition;
+                const glm::vec3 axis(_GetStream(AxisX)[i], _GetStream(AxisY)[i], _GetStream(AxisZ)[i]);
+                const float cutoff = _GetStream(Cutoff)[i];
+
+                float dp = glm::dot(d, axis);
+                if (dp > 0.0f && dp * dp >= cutoff * cutoff * glm::dot(d, d))
+                    backfacing |= 1 << lane;
+            }
+#endif
+
+            const std::size_t lanes = std::min<std::size_t>(4, count - base);
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+                const int bit = 1 << lane;
+
+                if ((inside & bit) && !(backfacing & bit))
+                {
+                    visible.push_back(static_cast<uint32_t>(base + lane));
+                    continue;
+                }
+
+                if (inside & bit)
+                    backfaceCulled++;
+                else
+                    frustumCulled++;
+
+                trianglesCulled += _meshlets[base + lane].triangleCount;
+            }
+        }
+
+        if (stats)
+        {
+            stats->meshletsTested += count;
+            stats->meshletsFrustumCulled += frustumCulled;
+            stats->meshletsBackfaceCulled += backfaceCulled;
+            stats->trianglesTested += _triangleCount;
+            stats->trianglesCulled += trianglesCulled;
+        }
+
+        return visible.size() - start;
+    }
+}
\ No newline at end of file
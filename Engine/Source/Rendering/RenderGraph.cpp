@@ -0,0 +1,552 @@
+#include "Rendering/RenderGraph.hpp"
+#include "Rendering/Framebuffer.hpp"
+#include "Resources/TextureArray.hpp"
+#include "Core/Logger.hpp"
+
+namespace AE
+{
+    static bool IsDepthFormat(TextureFormat format)
+    {
+        return format == TextureFormat::Depth || format == TextureFormat::Depth24
+            || format == TextureFormat::Depth32F || format == TextureFormat::Depth24_Stencil8;
+    }
+
+    // What drivers typically allocate per texel, three-component formats are padded to four.
+    static std::size_t GetTexelSize(TextureFormat format)
+    {
+        switch (format)
+        {
+            case TextureFormat::R8:
+                return 1;
+            case TextureFormat::RG8:
+            case TextureFormat::R16:
+            case TextureFormat::R16F:
+                return 2;
+            case TextureFormat::RG16:
+            case TextureFormat::RG16F:
+            case TextureFormat::R32F:
+            case TextureFormat::RGB10_A2:
+            case TextureFormat::R11F_G11F_B10F:
+                return 4;
+            case TextureFormat::RGBA16:
+            case TextureFormat::RGB16F:
+            case TextureFormat::RGBA16F:
+            case TextureFormat::RG32F:
+                return 8;
+            case TextureFormat::RGB32F:
+            case TextureFormat::RGBA32F:
+                return 16;
+            default:
+                return 4;
+        }
+    }
+
+    static std::size_t GetByteSize(const TextureDesc& descriptor)
+    {
+        return static_cast<std::size_t>(descriptor.width) * descriptor.height * GetTexelSize(descriptor.internalFormat);
+    }
+
+    // Everything but the size.
+    static bool IsSameFormat(const TextureDesc& a, const TextureDesc& b)
+    {
+        return a.type == b.type
+            && a.internalFormat == b.internalFormat && a.format == b.format
+            && a.minFilter == b.minFilter && a.magFilter == b.magFilter
+            && a.wrapS == b.wrapS && a.wrapT == b.wrapT;
+    }
+
+    static bool IsSameDescriptor(const TextureDesc& a, const TextureDesc& b)
+    {
+        return a.width == b.width && a.height == b.height && IsSameFormat(a, b);
+    }
+
+    RenderGraph::Builder::Builder(RenderGraph& graph, uint32_t pass)
+        : _graph(graph), _pass(pass) {}
+
+    RenderGraph::Resource RenderGraph::Builder::Create(const std::string& name, const TextureDesc& descriptor)
+    {
+        const uint32_t index = static_cast<uint32_t>(_graph._resources.size());
+
+        ResourceNode& resource = _graph._resources.emplace_back();
+        resource.name = name;
+        resource.descriptor = descriptor;
+
+        return Write({ index });
+    }
+
+    RenderGraph::Resource RenderGraph::Builder::Read(Resource resource)
+    {
+        if (resource.index >= _graph._resources.size())
+            return {};
+
+        std::vector<uint32_t>& reads = _graph._passes[_pass].reads;
+        if (std::find(reads.begin(), reads.end(), resource.index) == reads.end())
+        {
+            reads.push_back(resource.index);
+            _graph._resources[resource.index].readers++;
+        }
+
+        return resource;
+    }
+
+    RenderGraph::Resource RenderGraph::Builder::Write(Resource resource)
+    {
+        if (resource.index >= _graph._resources.size())
+            return {};
+
+        std::vector<uint32_t>& writes = _graph._passes[_pass].writes;
+        if (std::find(writes.begin(), writes.end(), resource.index) == writes.end())
+        {
+            writes.push_back(resource.index);
+            _graph._resources[resource.index].writers.push_back(_pass);
+        }
+
+        return resource;
+    }
+
+    void RenderGraph::Builder::SetSideEffect()
+    {
+        _graph._passes[_pass].sideEffect = true;
+    }
+
+    RenderGraph::Context::Context(RenderGraph& graph, Framebuffer* framebuffer)
+        : _graph(graph), _framebuffer(framebuffer) {}
+
+    std::shared_ptr<Texture> RenderGraph::Context::GetTexture(Resource resource) const
+    {
+        return _graph.GetTexture(resource);
+    }
+
+    Framebuffer* RenderGraph::Context::GetFramebuffer() const { return _framebuffer; }
+
+    Framebuffer* RenderGraph::Context::GetFramebuffer(Resource resource) const
+    {
+        if (resource.index >= _graph._resources.size())
+            return nullptr;
+
+        return _graph._AcquireFramebuffer({ resource.index });
+    }
+
+    void RenderGraph::AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute)
+    {
+        const uint32_t index = static_cast<uint32_t>(_passes.size());
+
+        PassNode& pass = _passes.emplace_back();
+        pass.name = name;
+        pass.execute = std::move(execute);
+
+        Builder builder(*this, index);
+        if (setup)
+            setup(builder);
+
+        _compiled = false;
+    }
+
+    RenderGraph::Resource RenderGraph::Import(const std::string& name, std::shared_ptr<Texture> texture)
+    {
+        if (!texture) return {};
+
+        const uint32_t index = static_cast<uint32_t>(_resources.size());
+
+        ResourceNode& resource = _resources.emplace_back();
+        resource.name = name;
+        resource.descriptor = texture->GetDescriptor();
+        resource.imported = std::move(texture);
+
+        _compiled = false;
+        return { index };
+    }
+
+    RenderGraph::Resource RenderGraph::Import(const std::string& name, std::shared_ptr<TextureArray> texture, int layer)
+    {
+        if (!texture || layer < 0 || layer >= texture->GetLayerCount()) return {};
+
+        const Resource resource = Import(name, std::shared_ptr<Texture>(std::move(texture)));
+        _resources[resource.index].layer = layer;
+
+        return resource;
+    }
+
+    void RenderGraph::MarkOutput(Resource resource)
+    {
+        if (resource.index >= _resources.size()) return;
+
+        _resources[resource.index].output = true;
+        _compiled = false;
+    }
+
+    bool RenderGraph::Compile()
+    {
+        LoggerContext ctx("RenderGraph", "Compile");
+
+        const Stats previous = _stats;
+
+        _stats = {};
+        _stats.passes = _passes.size();
+        _physical.clear();
+
+        // Reference counts: a resource by its readers, a pass by what it writes. Whatever leaves the
+        // graph counts as read once more.
+        for (ResourceNode& resource : _resources)
+        {
+            resource.references = resource.readers + (resource.output || resource.imported ? 1 : 0);
+            resource.firstUse = UINT32_MAX;
+            resource.lastUse = 0;
+            resource.physical = -1;
+        }
+
+        std::vector<uint32_t> unreferenced;
+
+        auto CullPass = [&](PassNode& pass)
+        {
+            pass.culled = true;
+
+            for (uint32_t read : pass.reads)
+            {
+                ResourceNode& resource = _resources[read];
+                if (resource.references > 0 && --resource.references == 0)
+                    unreferenced.push_back(read);
+            }
+        };
+
+        for (PassNode& pass : _passes)
+        {
+            pass.references = static_cast<uint32_t>(pass.writes.size());
+            pass.culled = false;
+
+            if (pass.references == 0 && !pass.sideEffect)
+                CullPass(pass);
+        }
+
+        for (uint32_t i = 0; i < _resources.size(); ++i)
+        {
+            if (_resources[i].references == 0 && std::find(unreferenced.begin(), unreferenced.end(), i) == unreferenced.end())
+                unreferenced.push_back(i);
+        }
+
+        // Walks back from unused resources, dropping passes left without any used output.
+        while (!unreferenced.empty())
+        {
+            const uint32_t index = unreferenced.back();
+            unreferenced.pop_back();
+
+            for (uint32_t writer : _resources[index].writers)
+            {
+                PassNode& pass = _passes[writer];
+                if (pass.culled || pass.sideEffect || pass.references == 0)
+                    continue;
+
+                if (--pass.references == 0)
+                    CullPass(pass);
+            }
+        }
+
+        for (uint32_t i = 0; i < _passes.size(); ++i)
+        {
+            PassNode& pass = _passes[i];
+            if (pass.culled)
+            {
+                _stats.culledPasses++;
+                continue;
+            }
+
+            for (uint32_t read : pass.reads)
+            {
+                ResourceNode& resource = _resources[read];
+                if (resource.imported)
+                    continue;
+
+                const bool written = std::any_of(resource.writers.begin(), resource.writers.end(),
+                    [&](uint32_t writer) { return writer < i && !_passes[writer].culled; });
+
+                if (!written)
+                {
+                    Logger::Error("Pass '{}' reads '{}' before any pass writes it!", pass.name, resource.name);
+                    return false;
+                }
+            }
+
+            int width = -1, height = -1;
+            for (uint32_t write : pass.writes)
+            {
+                const TextureDesc& descriptor = _resources[write].descriptor;
+                if (descriptor.width <= 0 || descriptor.height <= 0)
+                {
+                    Logger::Error("'{}' written by pass '{}' has no size!", _resources[write].name, pass.name);
+                    return false;
+                }
+
+                if (width >= 0 && (descriptor.width != width || descriptor.height != height))
+                {
+                    Logger::Error("Pass '{}' writes textures of different sizes!", pass.name);
+                    return false;
+                }
+
+                width = descriptor.width;
+                height = descriptor.height;
+            }
+
+            for (const auto* list : { &pass.reads, &pass.writes })
+            {
+                for (uint32_t index : *list)
+                {
+                    ResourceNode& resource = _resources[index];
+                    resource.firstUse = std::min(resource.firstUse, i);
+                    resource.lastUse = std::max(resource.lastUse, i);
+                }
+            }
+        }
+
+        // Transient textures in the order they come alive, each taking the first free texture with
+        // the same descriptor. Outputs have to outlive the whole graph.
+        std::vector<uint32_t> transient;
+        for (uint32_t i = 0; i < _resources.size(); ++i)
+        {
+            ResourceNode& resource = _resources[i];
+            if (resource.imported || resource.firstUse == UINT32_MAX)
+                continue;
+
+            if (resource.output)
+                resource.lastUse = static_cast<uint32_t>(_passes.size());
+
+            transient.push_back(i);
+        }
+
+        std::stable_sort(transient.begin(), transient.end(),
+            [this](uint32_t a, uint32_t b) { return _resources[a].firstUse < _resources[b].firstUse; });
+
+        for (uint32_t index : transient)
+        {
+            ResourceNode& resource = _resources[index];
+
+            auto physical = std::find_if(_physical.begin(), _physical.end(), [&](const PhysicalTexture& p)
+            {
+                return p.busyUntil < resource.firstUse && IsSameDescriptor(p.descriptor, resource.descriptor);
+            });
+
+            if (physical == _physical.end())
+            {
+                physical = _physical.insert(_physical.end(), PhysicalTexture{ resource.descriptor, 0, nullptr });
+                _stats.allocatedBytes += GetByteSize(resource.descriptor);
+            }
+
+            physical->busyUntil = resource.lastUse;
+            resource.physical = static_cast<int>(physical - _physical.begin());
+
+            _stats.transientTextures++;
+            _stats.requestedBytes += GetByteSize(resource.descriptor);
+        }
+
+        _stats.physicalTextures = _physical.size();
+        _compiled = true;
+
+        if (_stats.physicalTextures != previous.physicalTextures || _stats.requestedBytes != previous.requestedBytes
+            || _stats.culledPasses != previous.culledPasses)
+        {
+            Logger::Debug("{} of {} passes kept, {} transient textures in {} ({:.1f} MB instead of {:.1f} MB)",
+                _stats.passes - _stats.culledPasses, _stats.passes, _stats.transientTextures, _stats.physicalTextures,
+                _stats.allocatedBytes / (1024.0 * 1024.0), _stats.requestedBytes / (1024.0 * 1024.0));
+        }
+
+        return true;
+    }
+
+    void RenderGraph::Execute()
+    {
+        if (!_compiled && !Compile())
+            return;
+
+        _frame++;
+
+        for (PhysicalTexture& physical : _physical)
+            physical.texture = _AcquireTexture(physical.descriptor);
+
+        GLint previousFramebuffer = 0;
+        GLint previousViewport[4] = {};
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+        for (const PassNode& pass : _passes)
+        {
+            if (pass.culled) continue;
+
+            Framebuffer* framebuffer = _AcquireFramebuffer(pass.writes);
+            if (!framebuffer && !pass.writes.empty())
+                continue;
+
+            if (framebuffer)
+            {
+                framebuffer->Bind();
+                glViewport(0, 0, framebuffer->GetWidth(), framebuffer->GetHeight());
+            }
+            else
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+                glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+            }
+
+            if (pass.execute)
+                pass.execute(Context(*this, framebuffer));
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+        glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+
+        _TrimPool();
+    }
+
+    void RenderGraph::Reset()
+    {
+        _passes.clear();
+        _resources.clear();
+        _physical.clear();
+        _compiled = false;
+    }
+
+    void RenderGraph::ReleasePool()
+    {
+        _physical.clear();
+        _framebufferPool.clear();
+        _texturePool.clear();
+    }
+
+    std::shared_ptr<Texture> RenderGraph::GetTexture(Resource resource) const
+    {
+        if (resource.index >= _resources.size())
+            return nullptr;
+
+        const ResourceNode& node = _resources[resource.index];
+        if (node.imported)
+            return node.imported;
+
+        return node.physical >= 0 ? _physical[node.physical].texture : nullptr;
+    }
+
+    const RenderGraph::Stats& RenderGraph::GetStats() const { return _stats; }
+
+    std::shared_ptr<Texture> RenderGraph::_AcquireTexture(const TextureDesc& descriptor)
+    {
+        for (PooledTexture& pooled : _texturePool)
+        {
+            if (pooled.lastFrame != _frame && IsSameDescriptor(pooled.descriptor, descriptor))
+            {
+                pooled.lastFrame = _frame;
+                return pooled.texture;
+            }
+        }
+
+        // A new size, e.g. the window is being resized: resizing an unused texture of the format
+        // mostly fits in its storage and keeps the framebuffers it's attached to.
+        for (PooledTexture& pooled : _texturePool)
+        {
+            if (pooled.lastFrame != _frame && IsSameFormat(pooled.descriptor, descriptor))
+            {
+                pooled.texture->Resize(descriptor.width, descriptor.height);
+                pooled.descriptor = descriptor;
+                pooled.lastFrame = _frame;
+                return pooled.texture;
+            }
+        }
+
+        auto texture = Texture::Create(descriptor);
+        _texturePool.push_back({ descriptor, texture, _frame });
+
+        return texture;
+    }
+
+    Framebuffer* RenderGraph::_AcquireFramebuffer(const std::vector<uint32_t>& resources)
+    {
+        LoggerContext ctx("RenderGraph", "_AcquireFramebuffer");
+
+        std::vector<uint32_t> colors;
+        uint32_t depth = UINT32_MAX;
+
+        for (uint32_t index : resources)
+        {
+            if (!GetTexture({ index })) continue;
+
+            if (IsDepthFormat(_resources[index].descriptor.internalFormat))
+                depth = index;
+            else
+                colors.push_back(index);
+        }
+
+        if (colors.empty() && depth == UINT32_MAX)
+            return nullptr;
+
+        std::vector<GLuint> key;
+        key.reserve(colors.size() * 2 + 2);
+        for (uint32_t index : colors)
+        {
+            key.push_back(GetTexture({ index })->GetID());
+            key.push_back(static_cast<GLuint>(_resources[index].layer + 1));
+        }
+        key.push_back(depth != UINT32_MAX ? GetTexture({ depth })->GetID() : 0);
+        key.push_back(depth != UINT32_MAX ? static_cast<GLuint>(_resources[depth].layer + 1) : 0);
+
+        const std::shared_ptr<Texture> first = GetTexture({ colors.empty() ? depth : colors.front() });
+
+        // Cached framebuffers hold on to their textures, so a key can't be reused by a new texture with an old ID.
+        auto [it, inserted] = _framebufferPool.try_emplace(std::move(key));
+        it->second.lastFrame = _frame;
+
+        if (inserted)
+        {
+            auto framebuffer = Framebuffer::Create(first->GetWidth(), first->GetHeight());
+
+            for (std::size_t i = 0; i < colors.size(); ++i)
+            {
+                const ResourceNode& color = _resources[colors[i]];
+                if (color.layer >= 0)
+                    framebuffer->AttachColorTextureLayer(std::static_pointer_cast<TextureArray>(color.imported), color.layer, static_cast<GLenum>(i));
+                else
+                    framebuffer->AttachColorTexture(GetTexture({ colors[i] }), static_cast<GLenum>(i));
+            }
+
+            // Depth-only, e.g. a shadow map.
+            if (colors.empty())
+            {
+                framebuffer->SetDrawBuffer(GL_NONE);
+                framebuffer->SetReadBuffer(GL_NONE);
+            }
+
+            if (depth != UINT32_MAX)
+            {
+                const ResourceNode& node = _resources[depth];
+                if (node.layer >= 0)
+                    framebuffer->AttachDepthTextureLayer(std::static_pointer_cast<TextureArray>(node.imported), node.layer);
+                else
+                    framebuffer->AttachDepthTexture(GetTexture({ depth }));
+            }
+
+            if (!framebuffer->IsComplete())
+            {
+                Logger::Error("Framebuffer of '{}' is incomplete, passes writing it are skipped!", _resources[colors.empty() ? depth : colors.front()].name);
+                return nullptr;
+            }
+
+            it->second.framebuffer = std::move(framebuffer);
+        }
+        else if (it->second.framebuffer)
+        {
+            // Its textures may have been resized since, this only updates the size when they were.
+            it->second.framebuffer->Resize(first->GetWidth(), first->GetHeight());
+        }
+
+        return it->second.framebuffer.get();
+    }
+
+    void RenderGraph::_TrimPool()
+    {
+        for (auto it = _framebufferPool.begin(); it != _framebufferPool.end();)
+        {
+            if (it->second.lastFrame + PoolFrames < _frame)
+                it = _framebufferPool.erase(it);
+            else
+                ++it;
+        }
+
+        _texturePool.erase(std::remove_if(_texturePool.begin(), _texturePool.end(),
+            [this](const PooledTexture& pooled) { return pooled.lastFrame + PoolFrames < _frame; }), _texturePool.end());
+    }
+}
\ No newline at end of file
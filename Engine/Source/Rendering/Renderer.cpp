@@ -2,22 +2,50 @@
 #include "Rendering/Mesh.hpp"
 #include "Rendering/Camera.hpp"
 #include "Rendering/Material.hpp"
+#include "Rendering/CullCache.hpp"
+#include "Rendering/Framebuffer.hpp"
+#include "Rendering/FrameCapture.hpp"
+#include "Rendering/Impostor.hpp"
+#include "Rendering/Uniforms.hpp"
 #include "Resources/Shader.hpp"
 #include "Resources/Model.hpp"
+#include "Resources/Texture.hpp"
+#include "Resources/TextureArray.hpp"
 #include "Lighting/Manager.hpp"
 #include "World/Skybox.hpp"
+#include "World/PVS.hpp"
+#include "World/BakedLighting.hpp"
 #include "Core/EngineSettings.hpp"
 #include "Core/Logger.hpp"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/norm.hpp>
 
+#include <filesystem>
+#include <bit>
+
 namespace AE
 {
+    // After the material's texture slots.
+    static constexpr int ShadowAtlasSlot = 5;
+    static constexpr int LightmapSlot = 6;
+
+    static void SubmitShadowCasterNode(Renderer& renderer, ModelNode* node, const glm::mat4& parentTransform, bool isStatic)
+    {
+        const glm::mat4 globalTransform = parentTransform * node->GetTransform();
+
+        for (const auto& mesh : node->GetMeshes())
+            renderer.SubmitShadowCaster(mesh.get(), globalTransform, isStatic);
+
+        for (const auto& child : node->GetChildren())
+            SubmitShadowCasterNode(renderer, child.get(), globalTransform, isStatic);
+    }
+
     Renderer::Renderer(LightManager* lightMgr)
     {
         assert(lightMgr != nullptr);
         _lightMgr = lightMgr;
+        _views.resize(1);
     }
     
     Renderer::~Renderer()
@@ -30,39 +58,182 @@ namespace AE
         }
     }
     
-    void Renderer::SubmitMesh(Mesh* mesh, Shader* shader, Material* material, const glm::mat4& transform)
+    void Renderer::SubmitMesh(Mesh* mesh, Shader* shader, Material* material, const glm::mat4& transform, CullCache* cache)
     {
         if (!mesh || !shader) return;
 
-        if (_camera)
+        uint32_t views = 1;
+        CullEntry* entry = _GetCullEntries(cache, mesh, transform, 1);
+
+        if (!_viewFrusta.IsEmpty())
         {
-            const auto& frustum = _camera->GetFrustum();
-            AABB worldAABB = mesh->GetAABB().Transform(transform);
-            if (!frustum.Intersects(worldAABB))
-                return;
+            const std::size_t triangles = (mesh->HasIndices() ? mesh->GetIndicesCount() : mesh->GetVerticesCount()) / 3;
+
+            if (entry)
+            {
+                if (!entry->hasBounds)
+                {
+                    entry->sphere = mesh->GetBoundingSphere().Transform(transform);
+                    entry->bounds = mesh->GetAABB().Transform(transform);
+                    entry->hasBounds = true;
+                }
+
+                views = _CullMesh(*entry, triangles);
+            }
+            else
+                views = _CullMesh(mesh->GetBoundingSphere(), mesh->GetAABB(), transform, triangles);
+
+            if (!views) return;
         }
-    
+
+        _SubmitMesh(mesh, shader, material, transform, views, entry);
+    }
+
+    void Renderer::_SubmitMesh(Mesh* mesh, Shader* shader, const Material* material, const glm::mat4& transform, uint32_t views,
+        CullEntry* entry)
+    {
         const Material* mat = material ? material : Material::GetDefault();
 
-        auto& batches = material->IsTransparent() ? _transparentBatches : _opaqueBatches;
-    
-        for (RenderBatch& batch : batches)
+        // Wireframe ignores the material entirely, so all materials share one variant.
+        ShaderFeature features = _renderMode == RenderMode::Wireframe
+            ? ShaderFeature::Wireframe
+            : mat->GetShaderFeatures();
+
+        // The vertex layout decides how the vertex shader decodes attributes.
+        features |= mesh->GetShaderFeatures();
+
+        if (_bakedLighting && _renderMode != RenderMode::Wireframe)
+            features |= ShaderFeature::BakedLighting;
+
+        shader = shader->GetVariant(features);
+        if (shader->IsPending()) return;
+
+        const bool cullMeshlets = mesh->HasMeshlets() && EngineSettings::Get().renderer.enableMeshletCulling;
+
+        // Lightmapped and unlit variants don't read the probes.
+        const uint32_t probeSample = HasFeature(features, ShaderFeature::BakedLighting) && !HasFeature(features, ShaderFeature::Lightmap)
+            ? _SampleProbes(mesh, transform, entry)
+            : UINT32_MAX;
+
+        for (uint32_t remaining = views; remaining != 0; remaining &= remaining - 1)
         {
-            if (batch.shader == shader && batch.material == mat)
+            ViewState& state = _views[std::countr_zero(remaining)];
+            uint32_t firstRange = 0, rangeCount = 0;
+
+            // Large meshes are culled again per meshlet, only the surviving index ranges get drawn.
+            if (cullMeshlets && state.view.camera)
             {
-                batch.instances.emplace_back(RenderBatch::InstanceData{mesh, transform});
-                return;
+                if (!_CullMeshlets(mesh, transform, *state.view.camera, firstRange, rangeCount))
+                    continue;
             }
+
+            auto& batches = mat->IsTransparent() ? state.transparentBatches : state.opaqueBatches;
+
+            auto batch = std::find_if(batches.begin(), batches.end(),
+                [&](const RenderBatch& b) { return b.shader == shader && b.material == mat; });
+
+            if (batch != batches.end())
+                batch->instances.emplace_back(RenderBatch::InstanceData{mesh, transform, firstRange, rangeCount, probeSample});
+            else
+                batches.emplace_back(RenderBatch{shader, mat, {{mesh, transform, firstRange, rangeCount, probeSample}}});
         }
-    
-        batches.emplace_back(RenderBatch{shader, mat, {{mesh, transform}}});
     }
 
-    void Renderer::SubmitModel(Model* model, Shader* shader, const glm::mat4& transform)
+    uint32_t Renderer::_SampleProbes(Mesh* mesh, const glm::mat4& transform, CullEntry* entry)
+    {
+        // One sample per instance at the center of the mesh, static ones take it once.
+        if (entry && entry->probeEpoch == _probeEpoch)
+        {
+            _probeSamples.push_back(entry->probeSH);
+        }
+        else
+        {
+            const glm::vec3 center = entry && entry->hasBounds ? entry->bounds.GetCenter() : mesh->GetAABB().Transform(transform).GetCenter();
+            _probeSamples.push_back(_bakedLighting->SampleProbes(center));
+
+            if (entry)
+            {
+                entry->probeSH = _probeSamples.back();
+                entry->probeEpoch = _probeEpoch;
+            }
+        }
+
+        return static_cast<uint32_t>(_probeSamples.size() - 1);
+    }
+
+    void Renderer::SubmitModel(Model* model, Shader* shader, const glm::mat4& transform, CullCache* cache)
     {
         if (!model || !shader) return;
 
-        SubmitModelNode(model->root.get(), shader, transform);
+        // Hierarchies that were never flattened are still walked node by node.
+        if (!model->IsFlattened())
+        {
+            SubmitModelNode(model->root.get(), shader, transform);
+            return;
+        }
+
+        const auto& items = model->GetDrawItems();
+
+        if (_viewFrusta.IsEmpty())
+        {
+            for (const Model::DrawItem& item : items)
+                _SubmitMesh(item.mesh, shader, item.material, transform * item.transform, 1);
+            return;
+        }
+
+        // Entry 0 is the whole model, the draw items follow. World bounds are filled in lazily,
+        // so items behind a culled model never pay for theirs.
+        CullEntry* entries = _GetCullEntries(cache, model, transform, items.size() + 1);
+
+        uint32_t modelViews;
+        if (entries)
+        {
+            if (!entries[0].hasBounds)
+            {
+                entries[0].sphere = model->GetBoundingSphere().Transform(transform);
+                entries[0].bounds = model->GetAABB().Transform(transform);
+                entries[0].hasBounds = true;
+            }
+            modelViews = _GetVisibleViews(entries[0]);
+        }
+        else
+            modelViews = _GetVisibleViews(model->GetBoundingSphere(), model->GetAABB(), transform);
+
+        if (!modelViews)
+        {
+            _cullingStats.meshesTested += items.size();
+            _cullingStats.meshesCulled += items.size();
+            _cullingStats.trianglesTested += model->GetTriangleCount();
+            _cullingStats.trianglesCulled += model->GetTriangleCount();
+            return;
+        }
+
+        // Bounds come from the draw item, so culled meshes are never touched.
+        for (std::size_t i = 0; i < items.size(); ++i)
+        {
+            const Model::DrawItem& item = items[i];
+            uint32_t views;
+
+            if (entries)
+            {
+                CullEntry& entry = entries[i + 1];
+                if (!entry.hasBounds)
+                {
+                    entry.sphere = item.sphere.Transform(transform);
+                    entry.bounds = item.bounds.Transform(transform);
+                    entry.hasBounds = true;
+                }
+
+                views = _CullMesh(entry, item.triangleCount);
+            }
+            else
+                views = _CullMesh(item.sphere, item.bounds, transform, item.triangleCount);
+
+            // A view that can't see the model can't see its parts either.
+            views &= modelViews;
+            if (views)
+                _SubmitMesh(item.mesh, shader, item.material, transform * item.transform, views, entries ? &entries[i + 1] : nullptr);
+        }
     }
 
     void Renderer::SubmitModelNode(ModelNode* node, Shader* shader, const glm::mat4& parentTransform)
@@ -84,15 +255,216 @@ namespace AE
             SubmitModelNode(child.get(), shader, globalTransform);
     }
 
+    void Renderer::SubmitShadowCaster(Mesh* mesh, const glm::mat4& transform, bool isStatic)
+    {
+        if (!mesh || !_shadowAtlas) return;
+
+        _shadowCasters.push_back({ mesh, transform, mesh->GetBoundingSphere().Transform(transform), isStatic });
+    }
+
+    void Renderer::SubmitShadowCaster(Model* model, const glm::mat4& transform, bool isStatic)
+    {
+        if (!model || !_shadowAtlas) return;
+
+        if (!model->IsFlattened())
+        {
+            if (model->root)
+                SubmitShadowCasterNode(*this, model->root.get(), transform, isStatic);
+            return;
+        }
+
+        for (const Model::DrawItem& item : model->GetDrawItems())
+        {
+            const glm::mat4 itemTransform = transform * item.transform;
+            _shadowCasters.push_back({ item.mesh, itemTransform, item.mesh->GetBoundingSphere().Transform(itemTransform), isStatic });
+        }
+    }
+
+    void Renderer::SubmitImpostor(Impostor* impostor, const glm::mat4& transform)
+    {
+        if (!impostor) return;
+
+        uint32_t views = 1;
+
+        if (!_viewFrusta.IsEmpty())
+        {
+            const glm::vec3& center = impostor->GetCenter();
+            const float radius = impostor->GetRadius();
+
+            views = _CullMesh(BoundingSphere(center, radius), AABB(center - glm::vec3(radius), center + glm::vec3(radius)), transform, 2);
+            if (!views) return;
+        }
+
+        for (uint32_t remaining = views; remaining != 0; remaining &= remaining - 1)
+        {
+            auto& batches = _views[std::countr_zero(remaining)].impostorBatches;
+
+            auto batch = std::find_if(batches.begin(), batches.end(),
+                [impostor](const ImpostorBatch& b) { return b.impostor == impostor; });
+
+            if (batch != batches.end())
+                batch->transforms.push_back(transform);
+            else
+                batches.emplace_back(ImpostorBatch{impostor, {transform}});
+        }
+    }
+
     RenderMode Renderer::GetRenderMode() const { return _renderMode; }
     void Renderer::SetRenderMode(RenderMode mode) { _renderMode = mode; }
     
     std::shared_ptr<Camera> Renderer::GetCamera() const { return _camera; }
-    void Renderer::SetCamera(std::shared_ptr<Camera> camera) { _camera = camera; }
+    void Renderer::SetCamera(std::shared_ptr<Camera> camera)
+    {
+        _camera = camera;
+        _views[0].reference.valid = false;
+    }
+
+    std::size_t Renderer::AddView(const RenderView& view)
+    {
+        LoggerContext ctx("Renderer", "AddView");
+
+        if (!view.camera)
+        {
+            Logger::Error("View has no camera!");
+            return 0;
+        }
+
+        if (_views.size() >= FrustumSet::MaxFrusta)
+        {
+            Logger::Error("Too many views, at most {} are culled together!", FrustumSet::MaxFrusta);
+            return 0;
+        }
+
+        ViewState state;
+        state.view = view;
+        _views.push_back(std::move(state));
+
+        return _views.size() - 1;
+    }
+
+    bool Renderer::RemoveView(std::size_t index)
+    {
+        if (index == 0 || index >= _views.size())
+            return false;
+
+        _views.erase(_views.begin() + index);
+
+        // Cached masks still use the old view indices.
+        _views[0].reference.valid = false;
+        return true;
+    }
+
+    void Renderer::ClearViews()
+    {
+        _views.resize(1);
+        _views[0].reference.valid = false;
+    }
+
+    std::size_t Renderer::GetViewCount() const { return _views.size(); }
+
+    std::shared_ptr<Texture> Renderer::GetViewTexture(std::size_t index) const
+    {
+        return index < _views.size() ? _views[index].color : nullptr;
+    }
 
     std::shared_ptr<Skybox> Renderer::GetSkybox() const { return _skybox; }
     void Renderer::SetSkybox(std::shared_ptr<Skybox> skybox) { _skybox = skybox; }
     void Renderer::SetSkyboxShader(std::shared_ptr<Shader> shader) { _skyboxShader = shader; }
+
+    void Renderer::SetImpostorShader(std::shared_ptr<Shader> shader) { _impostorShader = shader; }
+
+    void Renderer::SetShadowShader(std::shared_ptr<Shader> shader)
+    {
+        _shadowShader = shader;
+
+        if (_shadowShader && !_shadowAtlas)
+        {
+            ShadowAtlas::Settings settings;
+            settings.size = EngineSettings::Get().renderer.shadowAtlasSize;
+            _shadowAtlas = std::make_unique<ShadowAtlas>(settings);
+        }
+    }
+
+    ShadowAtlas* Renderer::GetShadowAtlas() const { return _shadowAtlas.get(); }
+
+    std::shared_ptr<PVS> Renderer::GetPVS() const { return _pvs; }
+    void Renderer::SetPVS(std::shared_ptr<PVS> pvs)
+    {
+        _pvs = pvs;
+        _pvsCell = -1;
+
+        // Cached results were made with the old visibility.
+        _cullEpoch++;
+    }
+
+    std::shared_ptr<BakedLighting> Renderer::GetBakedLighting() const { return _bakedLighting; }
+    void Renderer::SetBakedLighting(std::shared_ptr<BakedLighting> bakedLighting)
+    {
+        _bakedLighting = bakedLighting;
+        _probeEpoch++;
+
+        // Tiles of lights that are baked now are freed on the next update, the others rendered again.
+        if (_shadowAtlas)
+            _shadowAtlas->Clear();
+    }
+
+    bool Renderer::CaptureFrame(const std::string& path, const Framebuffer* source)
+    {
+        if (!_frameCapture) return false;
+
+        int width, height;
+        if (source)
+        {
+            width = source->GetWidth();
+            height = source->GetHeight();
+        }
+        else
+        {
+            GLint viewport[4];
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            width = viewport[2];
+            height = viewport[3];
+        }
+
+        return _frameCapture->Capture(path, width, height, source);
+    }
+
+    void Renderer::StartCaptureSequence(const std::string& directory, int frameInterval)
+    {
+        LoggerContext ctx("Renderer", "StartCaptureSequence");
+
+        _captureSequence.directory = directory.empty() ? "." : directory;
+        _captureSequence.frameInterval = std::max(frameInterval, 1);
+        _captureSequence.frameCounter = 0;
+        _captureSequence.captureIndex = 0;
+        _captureSequence.active = true;
+
+        Logger::Info("Capturing every {} frame(s) to '{}'", _captureSequence.frameInterval, _captureSequence.directory);
+    }
+
+    void Renderer::StopCaptureSequence()
+    {
+        LoggerContext ctx("Renderer", "StopCaptureSequence");
+
+        if (!_captureSequence.active) return;
+
+        _captureSequence.active = false;
+
+        if (_frameCapture)
+        {
+            _frameCapture->Flush();
+
+            const auto& stats = _frameCapture->GetStats();
+            Logger::Info("Capture sequence stopped: {} frame(s) written, {} dropped, overhead avg {:.3f} ms, max {:.3f} ms",
+                stats.encodedFrames, stats.droppedFrames, stats.GetAverageOverheadMs(), stats.maxOverheadMs);
+        }
+    }
+
+    bool Renderer::IsCapturingSequence() const { return _captureSequence.active; }
+    FrameCapture* Renderer::GetFrameCapture() const { return _frameCapture.get(); }
+
+    const Renderer::CullingStats& Renderer::GetCullingStats() const { return _cullingStats; }
+    const Renderer::BatchStats& Renderer::GetBatchStats() const { return _batchStats; }
     
     bool Renderer::IsInitialized() const { return _state.initialized; }
     
@@ -107,6 +479,13 @@ namespace AE
             Logger::Error("Renderer is already initialized! Aborting...");
             return false;
         }
+
+        _frameCapture = std::make_unique<FrameCapture>(EngineSettings::Get().renderer.frameCaptureRingSize);
+
+        // The default viewport covers the window, _OnResize follows it from here on.
+        GLint viewport[4] = {};
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        _frameSize = glm::ivec2(viewport[2], viewport[3]);
     
         _state.initialized = true;
     
@@ -127,60 +506,371 @@ namespace AE
             return;
         }
     
+        StopCaptureSequence();
+        _frameCapture.reset();
+
         _skybox.reset();
         _skyboxShader.reset();
+        _impostorShader.reset();
+        _shadowShader.reset();
+        _shadowAtlas.reset();
+        _shadowCasters.clear();
+        _graph.Reset();
+        _graph.ReleasePool();
         _camera.reset();
+        _pvs.reset();
+        _pvsCell = -1;
+
+        _views.assign(1, ViewState());
+        _viewFrusta.Clear();
 
-        _opaqueBatches.clear();
-        _transparentBatches.clear();
+        if (_impostorVAO)
+        {
+            glDeleteVertexArrays(1, &_impostorVAO);
+            glDeleteBuffers(1, &_impostorQuadVBO);
+            glDeleteBuffers(1, &_impostorInstanceVBO);
+            _impostorVAO = _impostorQuadVBO = _impostorInstanceVBO = 0;
+        }
     
         _state.initialized = false;
     
         Logger::Info("Renderer shutdown!");
     }
     
-    void Renderer::_RenderBatch(const RenderBatch& batch)
+    uint32_t Renderer::_CullMesh(const BoundingSphere& sphere, const AABB& bounds, const glm::mat4& transform, std::size_t triangles)
+    {
+        _cullingStats.meshesTested++;
+        _cullingStats.trianglesTested += triangles;
+
+        const uint32_t views = _GetVisibleViews(sphere, bounds, transform);
+        if (!views)
+        {
+            _cullingStats.meshesCulled++;
+            _cullingStats.trianglesCulled += triangles;
+        }
+        return views;
+    }
+
+    uint32_t Renderer::_CullMesh(CullEntry& entry, std::size_t triangles)
+    {
+        _cullingStats.meshesTested++;
+        _cullingStats.trianglesTested += triangles;
+
+        const uint32_t views = _GetVisibleViews(entry);
+        if (!views)
+        {
+            _cullingStats.meshesCulled++;
+            _cullingStats.trianglesCulled += triangles;
+        }
+        return views;
+    }
+
+    uint32_t Renderer::_GetVisibleViews(const BoundingSphere& sphere, const AABB& bounds, const glm::mat4& transform)
+    {
+        // The sphere test settles most objects, only views where it straddles a plane pay for the box test.
+        BoundingSphere worldSphere = sphere.Transform(transform);
+
+        uint32_t intersecting;
+        uint32_t views = _viewFrusta.Classify(worldSphere.center, worldSphere.radius, intersecting);
+
+        const bool boxTest = intersecting != 0;
+        const AABB worldBounds = boxTest || _pvsCell >= 0 ? bounds.Transform(transform) : AABB();
+
+        if (boxTest)
+            views &= ~_GetBoxRejectedViews(worldBounds, intersecting);
+
+        // The PVS walks every cell the bounds touch, so it only runs for what the main frustum kept.
+        if ((views & 1) && _pvsCell >= 0)
+            views &= ~_GetPVSRejectedViews(worldBounds);
+
+        return views;
+    }
+
+    uint32_t Renderer::_GetVisibleViews(CullEntry& entry)
+    {
+        if (entry.epoch == _cullEpoch)
+        {
+            _cullingStats.cacheHits++;
+            return entry.views;
+        }
+
+        // Bounds are already in world space. With a single view, the rejecting plane of the last test goes first.
+        if (_viewFrusta.GetCount() == 1 && _viewFrusta.GetFrustum(0))
+        {
+            const Frustum& frustum = *_viewFrusta.GetFrustum(0);
+            FrustumTest sphereTest = frustum.Classify(entry.sphere.center, entry.sphere.radius, entry.plane);
+
+            const bool visible = sphereTest == FrustumTest::Inside
+                || (sphereTest == FrustumTest::Intersects && frustum.Intersects(entry.bounds, entry.plane));
+            entry.views = visible ? 1u : 0u;
+        }
+        else
+        {
+            uint32_t intersecting;
+            entry.views = _viewFrusta.Classify(entry.sphere.center, entry.sphere.radius, intersecting);
+
+            if (intersecting)
+                entry.views &= ~_GetBoxRejectedViews(entry.bounds, intersecting);
+        }
+
+        // The camera cell is part of the epoch, so PVS results are cached like the frustum ones.
+        if ((entry.views & 1) && _pvsCell >= 0)
+            entry.views &= ~_GetPVSRejectedViews(entry.bounds);
+
+        entry.epoch = _cullEpoch;
+        return entry.views;
+    }
+
+    uint32_t Renderer::_GetBoxRejectedViews(const AABB& worldBounds, uint32_t views) const
+    {
+        uint32_t rejected = 0;
+
+        for (uint32_t remaining = views; remaining != 0; remaining &= remaining - 1)
+        {
+            const int view = std::countr_zero(remaining);
+            const Frustum* frustum = _viewFrusta.GetFrustum(view);
+
+            if (frustum && !frustum->Intersects(worldBounds))
+                rejected |= 1u << view;
+        }
+
+        return rejected;
+    }
+
+    uint32_t Renderer::_GetPVSRejectedViews(const AABB& worldBounds)
+    {
+        if (_pvs->IsVisible(_pvsCell, worldBounds))
+            return 0;
+
+        _cullingStats.pvsCulled++;
+        return 1;
+    }
+
+    CullEntry* Renderer::_GetCullEntries(CullCache* cache, const void* source, const glm::mat4& transform, std::size_t count)
+    {
+        if (!cache) return nullptr;
+
+        // Comparing the matrix is cheaper than transforming the bounds, and catches every kind of move.
+        if (!cache->_valid || cache->_source != source || cache->_entries.size() != count || cache->_transform != transform)
+        {
+            cache->_source = source;
+            cache->_transform = transform;
+            cache->_entries.assign(count, CullEntry());
+            cache->_valid = true;
+        }
+
+        return cache->_entries.data();
+    }
+
+    void Renderer::_PrepareViews()
+    {
+        _views[0].view.camera = _camera;
+
+        for (ViewState& state : _views)
+        {
+            state.opaqueBatches.clear();
+            state.transparentBatches.clear();
+            state.impostorBatches.clear();
+        }
+
+        _views[0].opaqueBatches.reserve(128);
+        _views[0].transparentBatches.reserve(128);
+        _probeSamples.clear();
+
+        _UpdateCullEpoch();
+
+        // Moving into another cell changes what the PVS lets through, so cached results are dropped.
+        int pvsCell = -1;
+        if (_pvs && _camera && EngineSettings::Get().renderer.enablePVS)
+            pvsCell = _pvs->GetCell(_camera->transform.GetWorldPosition());
+
+        if (pvsCell != _pvsCell)
+        {
+            _pvsCell = pvsCell;
+            _cullEpoch++;
+        }
+
+        // Without any camera nothing is culled and everything goes to view 0.
+        _viewFrusta.Clear();
+        if (!_camera && _views.size() == 1)
+            return;
+
+        for (const ViewState& state : _views)
+        {
+            if (state.view.camera)
+                _viewFrusta.Add(state.view.camera->GetFrustum());
+            else
+                _viewFrusta.AddUnbounded();
+        }
+    }
+
+    void Renderer::_UpdateCullEpoch()
+    {
+        const auto& settings = EngineSettings::Get().renderer;
+
+        bool moved = !settings.enableCullCache;
+
+        for (ViewState& state : _views)
+        {
+            Camera* camera = state.view.camera.get();
+            if (!camera) continue;
+
+            // Also brings the frustum up to date for this frame.
+            const glm::mat4& projection = camera->GetProjectionMatrix();
+            const glm::vec3 position = camera->transform.GetWorldPosition();
+            const glm::vec3 forward = camera->transform.GetForward();
+            const glm::vec3 up = camera->transform.GetUp();
+
+            const CullReference& reference = state.reference;
+            const float minCos = glm::cos(glm::radians(settings.cullCacheAngle));
+
+            // Rolling keeps the forward vector but turns the side planes, so the up vector is compared as well.
+            moved = moved || !reference.valid
+                || projection != reference.projection
+                || glm::distance(position, reference.position) > settings.cullCacheDistance
+                || glm::dot(forward, reference.forward) < minCos
+                || glm::dot(up, reference.up) < minCos;
+        }
+
+        if (!moved) return;
+
+        // One epoch covers every view, so all references move together.
+        _cullEpoch++;
+
+        for (ViewState& state : _views)
+        {
+            Camera* camera = state.view.camera.get();
+            if (!camera) continue;
+
+            state.reference = { camera->transform.GetWorldPosition(), camera->transform.GetForward(), camera->transform.GetUp(),
+                camera->GetProjectionMatrix(), true };
+        }
+    }
+
+    bool Renderer::_CullMeshlets(Mesh* mesh, const glm::mat4& transform, Camera& camera, uint32_t& firstRange, uint32_t& rangeCount)
+    {
+        const MeshletSet& meshletSet = mesh->GetMeshlets();
+
+        // Face culling off means back faces are visible, so only the frustum test applies.
+        MeshletCullParams params = MeshletCullParams::FromWorld(camera.GetFrustum().GetPlanes(),
+            camera.transform.GetWorldPosition(), transform, EngineSettings::Get().renderer.enableFaceCulling);
+
+        MeshletCullStats stats;
+        _visibleMeshlets.clear();
+        meshletSet.Cull(params, _visibleMeshlets, &stats);
+
+        _cullingStats.meshlets.meshletsTested += stats.meshletsTested;
+        _cullingStats.meshlets.meshletsFrustumCulled += stats.meshletsFrustumCulled;
+        _cullingStats.meshlets.meshletsBackfaceCulled += stats.meshletsBackfaceCulled;
+        _cullingStats.meshlets.trianglesTested += stats.trianglesTested;
+        _cullingStats.meshlets.trianglesCulled += stats.trianglesCulled;
+
+        // Meshes are counted once, so only the main view's meshlets add to the triangle rejection.
+        if (&camera == _camera.get())
+            _cullingStats.trianglesCulled += stats.trianglesCulled;
+
+        if (_visibleMeshlets.empty())
+            return false;
+
+        if (_visibleMeshlets.size() == meshletSet.GetCount())
+            return true;
+
+        // Meshlets are stored back to back in the index buffer, so neighbours merge into one range.
+        const std::size_t indexSize = GetIndexTypeSize(mesh->GetIndexType());
+        const auto& meshlets = meshletSet.GetMeshlets();
+
+        firstRange = static_cast<uint32_t>(_drawCounts.size());
+        uint32_t rangeEnd = 0;
+
+        for (uint32_t i : _visibleMeshlets)
+        {
+            const Meshlet& meshlet = meshlets[i];
+            const uint32_t count = meshlet.triangleCount * 3;
+
+            if (_drawCounts.size() > firstRange && meshlet.firstIndex == rangeEnd)
+            {
+                _drawCounts.back() += static_cast<GLsizei>(count);
+            }
+            else
+            {
+                _drawCounts.push_back(static_cast<GLsizei>(count));
+                _drawOffsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(meshlet.firstIndex) * indexSize));
+            }
+
+            rangeEnd = meshlet.firstIndex + count;
+        }
+
+        rangeCount = static_cast<uint32_t>(_drawCounts.size()) - firstRange;
+        return true;
+    }
+
+    void Renderer::_RenderBatch(const RenderBatch& batch, Camera* camera)
     {
         if (!batch.shader) return;
     
         Shader* shader = batch.shader;
         shader->Bind();
         
-        if (_camera) {
-            shader->SetMat4("u_ProjectionMatrix", _camera->GetProjectionMatrix());
-            shader->SetMat4("u_ViewMatrix", _camera->GetViewMatrix());
-            shader->SetVec3("u_CameraPos", _camera->transform.GetWorldPosition());
+        if (camera) {
+            shader->SetMat4(Uniforms::ProjectionMatrix, camera->GetProjectionMatrix());
+            shader->SetMat4(Uniforms::ViewMatrix, camera->GetViewMatrix());
         } else {
-            shader->SetMat4("u_ProjectionMatrix", glm::mat4(1.0f));
-            shader->SetMat4("u_ViewMatrix", glm::mat4(1.0f));
-            shader->SetVec3("u_CameraPos", glm::vec3(0.0f));
+            shader->SetMat4(Uniforms::ProjectionMatrix, glm::mat4(1.0f));
+            shader->SetMat4(Uniforms::ViewMatrix, glm::mat4(1.0f));
+        }
+
+        // The wireframe variant is unlit and has no material or lighting uniforms.
+        if (!HasFeature(shader->GetFeatures(), ShaderFeature::Wireframe))
+        {
+            shader->SetVec3(Uniforms::CameraPos, camera ? camera->transform.GetWorldPosition() : glm::vec3(0.0f));
+
+            if (batch.material)
+                batch.material->Apply(shader);
+            
+            if (_lightMgr)
+                _lightMgr->Apply(shader, _bakedLighting != nullptr);
+
+            // Always set, an unset shadow sampler would share unit 0 with the diffuse texture.
+            if (_shadowAtlas && _shadowAtlas->GetTexture())
+                _shadowAtlas->GetTexture()->Bind(ShadowAtlasSlot);
+            shader->SetInt(Uniforms::ShadowAtlas, ShadowAtlasSlot);
+
+            // Only lightmapped variants of the baked path declare the sampler.
+            if (_bakedLighting && HasFeature(shader->GetFeatures(), ShaderFeature::BakedLighting | ShaderFeature::Lightmap))
+            {
+                if (_bakedLighting->GetLightmapTexture())
+                    _bakedLighting->GetLightmapTexture()->Bind(LightmapSlot);
+                shader->SetInt(Uniforms::Lightmap, LightmapSlot);
+            }
         }
 
-        shader->SetInt("u_RenderMode", static_cast<int>(_renderMode));
-        
-        if (batch.material)
-            batch.material->Apply(shader);
-        
-        if (_lightMgr)
-            _lightMgr->Apply(shader);
-    
         for (const auto& instance : batch.instances)
         {
-            shader->SetMat4("u_ModelMatrix", instance.transform);
-            instance.mesh->Draw();
+            shader->SetMat4(Uniforms::ModelMatrix, instance.transform);
+
+            if (instance.probeSample != UINT32_MAX)
+                shader->SetVec3Array(Uniforms::ProbeSH, _probeSamples[instance.probeSample]);
+
+            shader->SetVec3(Uniforms::PositionScale, instance.mesh->GetPositionScale());
+            shader->SetVec3(Uniforms::PositionOffset, instance.mesh->GetPositionOffset());
+
+            if (instance.rangeCount > 0)
+                instance.mesh->DrawRanges(&_drawCounts[instance.firstRange], &_drawOffsets[instance.firstRange], static_cast<GLsizei>(instance.rangeCount));
+            else
+                instance.mesh->Draw();
         }
     
         shader->Unbind();
     }
 
-    void Renderer::_RenderSkybox()
+    void Renderer::_RenderSkybox(Camera* camera)
     {
-        if (!_skybox || !_skyboxShader || !_camera) return;
+        if (!_skybox || !_skyboxShader || !camera || _skyboxShader->IsPending()) return;
     
         _skyboxShader->Bind();
 
-        glm::mat4 view = glm::mat4(glm::mat3(_camera->GetViewMatrix()));
-        glm::mat4 projection = _camera->GetProjectionMatrix();
+        glm::mat4 view = glm::mat4(glm::mat3(camera->GetViewMatrix()));
+        glm::mat4 projection = camera->GetProjectionMatrix();
 
         glDepthMask(GL_FALSE);
         glDepthFunc(GL_LEQUAL);
@@ -188,9 +878,9 @@ namespace AE
         
         _skybox->cubemap->Bind();
 
-        _skyboxShader->SetMat4("u_ViewMatrix", view);
-        _skyboxShader->SetMat4("u_ProjectionMatrix", projection);
-        _skyboxShader->SetInt("u_Cubemap", 0);
+        _skyboxShader->SetMat4(Uniforms::ViewMatrix, view);
+        _skyboxShader->SetMat4(Uniforms::ProjectionMatrix, projection);
+        _skyboxShader->SetInt(Uniforms::Cubemap, 0);
 
         _skybox->mesh->Draw();
 
@@ -204,20 +894,103 @@ namespace AE
         _skyboxShader->Unbind();
     }
     
-    void Renderer::_RenderOpaqueBatches()
+    void Renderer::_RenderImpostors(const ViewState& state)
+    {
+        Camera* camera = state.view.camera.get();
+        if (state.impostorBatches.empty() || !camera || !_impostorShader || _impostorShader->IsPending()) return;
+
+        if (!_impostorVAO)
+            _CreateImpostorBuffers();
+
+        Shader* shader = _impostorShader.get();
+        shader->Bind();
+
+        shader->SetMat4(Uniforms::ProjectionMatrix, camera->GetProjectionMatrix());
+        shader->SetMat4(Uniforms::ViewMatrix, camera->GetViewMatrix());
+        shader->SetVec3(Uniforms::CameraPos, camera->transform.GetWorldPosition());
+        shader->SetInt(Uniforms::ImpostorAlbedo, 0);
+        shader->SetInt(Uniforms::ImpostorNormalDepth, 1);
+
+        if (_lightMgr)
+            _lightMgr->Apply(shader);
+
+        // The quad turns to the camera, so which side faces it depends on the frame it shows.
+        glDisable(GL_CULL_FACE);
+
+        glBindVertexArray(_impostorVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, _impostorInstanceVBO);
+
+        for (const ImpostorBatch& batch : state.impostorBatches)
+        {
+            const Impostor* impostor = batch.impostor;
+
+            // Re-specified every batch, so the driver can hand out new storage instead of waiting on the previous draw.
+            glBufferData(GL_ARRAY_BUFFER, batch.transforms.size() * sizeof(glm::mat4), batch.transforms.data(), GL_STREAM_DRAW);
+
+            impostor->GetAlbedo()->Bind(0);
+            impostor->GetNormalDepth()->Bind(1);
+
+            shader->SetInt(Uniforms::ImpostorFrames, impostor->GetFramesPerSide());
+            shader->SetVec3(Uniforms::ImpostorCenter, impostor->GetCenter());
+            shader->SetFloat(Uniforms::ImpostorRadius, impostor->GetRadius());
+            shader->SetVec3(Uniforms::ImpostorAmbient, impostor->GetAmbientColor());
+
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(batch.transforms.size()));
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        if (EngineSettings::Get().renderer.enableFaceCulling)
+            glEnable(GL_CULL_FACE);
+
+        shader->Unbind();
+    }
+
+    void Renderer::_CreateImpostorBuffers()
+    {
+        const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+
+        glGenVertexArrays(1, &_impostorVAO);
+        glGenBuffers(1, &_impostorQuadVBO);
+        glGenBuffers(1, &_impostorInstanceVBO);
+
+        glBindVertexArray(_impostorVAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, _impostorQuadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+        // One model matrix per instance, a column per attribute.
+        glBindBuffer(GL_ARRAY_BUFFER, _impostorInstanceVBO);
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            glEnableVertexAttribArray(1 + column);
+            glVertexAttribPointer(1 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                reinterpret_cast<const void*>(column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(1 + column, 1);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void Renderer::_RenderOpaqueBatches(const ViewState& state)
     {
         glDepthMask(GL_TRUE);
         glDisable(GL_BLEND);
 
-        for (const auto& batch : _opaqueBatches)
-            _RenderBatch(batch);
+        for (const auto& batch : state.opaqueBatches)
+            _RenderBatch(batch, state.view.camera.get());
     }
 
-    void Renderer::_RenderTransparentBatches()
+    void Renderer::_RenderTransparentBatches(ViewState& state)
     {
-        const glm::vec3& camPos = _camera->transform.GetWorldPosition();
+        Camera* camera = state.view.camera.get();
+        const glm::vec3 camPos = camera ? camera->transform.GetWorldPosition() : glm::vec3(0.0f);
 
-        std::sort(_transparentBatches.begin(), _transparentBatches.end(),
+        std::sort(state.transparentBatches.begin(), state.transparentBatches.end(),
             [&camPos](const RenderBatch& a, const RenderBatch& b)
             {
                 float maxDistSqA = 0.0f;
@@ -243,14 +1016,22 @@ namespace AE
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        for (const auto& batch : _transparentBatches)
+        for (const auto& batch : state.transparentBatches)
         {
-            _RenderBatch(batch);
+            _RenderBatch(batch, camera);
         }
 
         glDepthMask(GL_TRUE);
     }
 
+    void Renderer::_OnResize(int width, int height)
+    {
+        glViewport(0, 0, width, height);
+
+        // Offscreen views without a size of their own follow the window from the next frame on.
+        _frameSize = glm::ivec2(width, height);
+    }
+
     void Renderer::_PrepareFrame()
     {
         EngineSettings& settings = EngineSettings::Get();
@@ -273,15 +1054,139 @@ namespace AE
         glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         
-        _opaqueBatches.clear();
-        _opaqueBatches.reserve(128);
+        _drawCounts.clear();
+        _drawOffsets.clear();
+        _cullingStats = {};
+        _shadowCasters.clear();
 
-        _transparentBatches.clear();
-        _transparentBatches.reserve(128);
+        _PrepareViews();
     }
     
     void Renderer::_RenderFrame()
     {
+        _graph.Reset();
+
+        // First, so every view samples this frame's shadows.
+        _UpdateShadows();
+
+        _batchStats = {};
+        for (const ViewState& state : _views)
+        {
+            _batchStats.opaqueBatches += state.opaqueBatches.size();
+            _batchStats.transparentBatches += state.transparentBatches.size();
+            _batchStats.impostorBatches += state.impostorBatches.size();
+
+            for (const ImpostorBatch& batch : state.impostorBatches)
+                _batchStats.instances += batch.transforms.size();
+
+            for (const auto& batches : { &state.opaqueBatches, &state.transparentBatches })
+                for (const RenderBatch& batch : *batches)
+                    _batchStats.instances += batch.instances.size();
+        }
+
+        // Offscreen views first so the main view can sample them, on-screen views (split-screen) on top of it.
+        std::vector<RenderGraph::Resource> viewTextures;
+        for (std::size_t i = 1; i < _views.size(); ++i)
+            if (_views[i].view.offscreen)
+                viewTextures.push_back(_AddOffscreenView(i));
+
+        // The main view draws into whatever was bound, cleared by _PrepareFrame.
+        const glm::ivec4 frame(0, 0, _frameSize.x, _frameSize.y);
+
+        _graph.AddPass("Main View",
+            [&](RenderGraph::Builder& builder)
+            {
+                for (RenderGraph::Resource texture : viewTextures)
+                    builder.Read(texture);
+                builder.SetSideEffect();
+            },
+            [this, frame](const RenderGraph::Context&) { _RenderView(_views[0], frame); });
+
+        for (std::size_t i = 1; i < _views.size(); ++i)
+        {
+            if (_views[i].view.offscreen) continue;
+
+            _graph.AddPass("View " + std::to_string(i),
+                [](RenderGraph::Builder& builder) { builder.SetSideEffect(); },
+                [this, i, frame](const RenderGraph::Context&) { _RenderView(_views[i], frame); });
+        }
+
+        _graph.Execute();
+
+        const RenderGraph::Stats& stats = _graph.GetStats();
+        if (stats.requestedBytes != _graphRequestedBytes || stats.allocatedBytes != _graphAllocatedBytes)
+        {
+            LoggerContext ctx("Renderer", "_RenderFrame");
+            Logger::Info("Frame graph: {} transient render targets in {} textures, {:.1f} MB instead of {:.1f} MB ({:.1f} MB saved by aliasing)",
+                stats.transientTextures, stats.physicalTextures, stats.allocatedBytes / (1024.0 * 1024.0),
+                stats.requestedBytes / (1024.0 * 1024.0), stats.GetSavedBytes() / (1024.0 * 1024.0));
+
+            _graphRequestedBytes = stats.requestedBytes;
+            _graphAllocatedBytes = stats.allocatedBytes;
+        }
+
+        _UpdateCapture();
+    }
+
+    RenderGraph::Resource Renderer::_AddOffscreenView(std::size_t index)
+    {
+        ViewState& state = _views[index];
+        const glm::ivec2 size = state.view.size.x > 0 && state.view.size.y > 0 ? state.view.size : _frameSize;
+        if (size.x <= 0 || size.y <= 0)
+            return {};
+
+        // The color outlives the frame to be sampled, so the view owns it; only the depth is transient.
+        if (!state.color)
+        {
+            TextureDesc descriptor;
+            descriptor.width = size.x;
+            descriptor.height = size.y;
+            descriptor.internalFormat = TextureFormat::RGBA8;
+            descriptor.wrapS = TextureWrap::ClampToEdge;
+            descriptor.wrapT = TextureWrap::ClampToEdge;
+
+            state.color = Texture::Create(descriptor);
+        }
+        else
+        {
+            // Coalesced to once per frame, and mostly within the storage while the window is dragged.
+            state.color->Resize(size.x, size.y);
+        }
+
+        TextureDesc depthDescriptor;
+        depthDescriptor.width = size.x;
+        depthDescriptor.height = size.y;
+        depthDescriptor.channels = 1;
+        depthDescriptor.type = GL_FLOAT;
+        depthDescriptor.internalFormat = TextureFormat::Depth24;
+        depthDescriptor.format = TextureFormat::Depth;
+        depthDescriptor.minFilter = TextureFilter::Nearest;
+        depthDescriptor.magFilter = TextureFilter::Nearest;
+        depthDescriptor.wrapS = TextureWrap::ClampToEdge;
+        depthDescriptor.wrapT = TextureWrap::ClampToEdge;
+
+        const std::string name = "View " + std::to_string(index);
+        const RenderGraph::Resource color = _graph.Import(name + " Color", state.color);
+
+        _graph.AddPass(name,
+            [&](RenderGraph::Builder& builder)
+            {
+                builder.Write(color);
+                builder.Create(name + " Depth", depthDescriptor);
+            },
+            [this, index](const RenderGraph::Context& context)
+            {
+                const Framebuffer* target = context.GetFramebuffer();
+                _RenderView(_views[index], glm::ivec4(0, 0, target->GetWidth(), target->GetHeight()));
+            });
+
+        return color;
+    }
+
+    void Renderer::_RenderView(ViewState& state, const glm::ivec4& target)
+    {
+        const RenderView& view = state.view;
+
         switch (_renderMode)
         {
             case RenderMode::Wireframe:
@@ -292,10 +1197,51 @@ namespace AE
                 glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
                 break;
         }
-        
-        _RenderOpaqueBatches();
-        _RenderSkybox();
-        _RenderTransparentBatches();
 
+        if (view.offscreen || view.viewport.z > 0)
+        {
+            const glm::ivec4 rect = view.viewport.z > 0 && view.viewport.w > 0 ? view.viewport : target;
+
+            glViewport(rect.x, rect.y, rect.z, rect.w);
+
+            if (view.clear)
+            {
+                // Only this view's rectangle, the rest of the target may belong to other views.
+                glEnable(GL_SCISSOR_TEST);
+                glScissor(rect.x, rect.y, rect.z, rect.w);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                glDisable(GL_SCISSOR_TEST);
+            }
+        }
+
+        _RenderOpaqueBatches(state);
+        _RenderImpostors(state);
+        _RenderSkybox(view.camera.get());
+        _RenderTransparentBatches(state);
+    }
+
+    void Renderer::_UpdateShadows()
+    {
+        if (!_shadowAtlas || !_lightMgr) return;
+
+        // Tiles are sized for the main view.
+        _shadowAtlas->Update(_lightMgr->GetEnabledLights(_bakedLighting != nullptr), _shadowCasters, _camera.get(), _frameSize.y,
+            _shadowShader.get(), _graph);
+    }
+
+    void Renderer::_UpdateCapture()
+    {
+        if (!_frameCapture) return;
+
+        if (_captureSequence.active && _captureSequence.frameCounter++ % _captureSequence.frameInterval == 0)
+        {
+            char fileName[32];
+            std::snprintf(fileName, sizeof(fileName), "Frame_%06llu.tga",
+                static_cast<unsigned long long>(_captureSequence.captureIndex++));
+
+            CaptureFrame((std::filesystem::path(_captureSequence.directory) / fileName).string());
+        }
+
+        _frameCapture->Update();
     }
 }
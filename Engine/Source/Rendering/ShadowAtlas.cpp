@@ -0,0 +1,571 @@
+#include "Rendering/ShadowAtlas.hpp"
+#include "Rendering/Mesh.hpp"
+#include "Rendering/Camera.hpp"
+#include "Rendering/Framebuffer.hpp"
+#include "Rendering/RenderGraph.hpp"
+#include "Rendering/Uniforms.hpp"
+#include "Resources/TextureArray.hpp"
+#include "Resources/Shader.hpp"
+#include "Lighting/Sources.hpp"
+#include "Math/Frustum.hpp"
+#include "Core/EngineSettings.hpp"
+#include "Core/Logger.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <bit>
+
+namespace AE
+{
+    // Cube map face order and up vectors, Main.frag picks faces the same way.
+    static const std::array<glm::vec3, 6> FaceDirections = {
+        glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(-1.0f,  0.0f,  0.0f),
+        glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3( 0.0f, -1.0f,  0.0f),
+        glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3( 0.0f,  0.0f, -1.0f)
+    };
+
+    static const std::array<glm::vec3, 6> FaceUps = {
+        glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f),
+        glm::vec3(0.0f,  0.0f,  1.0f), glm::vec3(0.0f,  0.0f, -1.0f),
+        glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)
+    };
+
+    static constexpr float ShadowNearPlane = 0.05f;
+
+    static uint64_t HashFNV1a(const void* data, std::size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    // Clip space of a tile to atlas UV and depth.
+    static glm::mat4 GetTileMatrix(const glm::vec2& origin, float size)
+    {
+        glm::mat4 matrix(1.0f);
+        matrix[0][0] = size * 0.5f;
+        matrix[1][1] = size * 0.5f;
+        matrix[2][2] = 0.5f;
+        matrix[3] = glm::vec4(origin.x + size * 0.5f, origin.y + size * 0.5f, 0.5f, 1.0f);
+        return matrix;
+    }
+
+    ShadowAtlas::ShadowAtlas()
+        : _settings() {}
+
+    ShadowAtlas::ShadowAtlas(const Settings& settings)
+        : _settings(settings) {}
+
+    ShadowAtlas::~ShadowAtlas() = default;
+
+    // Both faces, so casters without a closed back still shadow; the offset keeps lit surfaces from shadowing themselves.
+    // Filled in wireframe mode too, the views set their own polygon mode.
+    static void BeginCasterState()
+    {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.5f, 4.0f);
+    }
+
+    // Back to what the renderer draws with.
+    static void EndCasterState()
+    {
+        const EngineSettings& settings = EngineSettings::Get();
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        if (!settings.renderer.enableDepthTest)
+            glDisable(GL_DEPTH_TEST);
+        if (settings.renderer.enableFaceCulling)
+            glEnable(GL_CULL_FACE);
+    }
+
+    void ShadowAtlas::Update(const std::vector<LightSource*>& lights, const std::vector<Caster>& casters,
+        Camera* camera, int screenHeight, Shader* shader, RenderGraph& graph)
+    {
+        _stats = {};
+        _work.clear();
+        _frame++;
+
+        for (LightSource* light : lights)
+            light->shadow.enabled = false;
+
+        if (!camera || !shader || shader->IsPending())
+            return;
+
+        if (!_texture && (_failed || !_Create()))
+            return;
+
+        struct Candidate
+        {
+            LightSource* light;
+            PointLight* point;
+            SpotLight* spot;
+            glm::vec3 position;
+            float range;
+            float pixels;
+        };
+
+        const glm::vec3 cameraPosition = camera->transform.GetWorldPosition();
+        const float pixelsPerUnit = camera->GetProjectionMatrix()[1][1] * static_cast<float>(screenHeight) * 0.5f;
+        const Frustum& frustum = camera->GetFrustum();
+
+        std::vector<Candidate> candidates;
+        for (LightSource* light : lights)
+        {
+            if (!light->castShadows) continue;
+
+            Candidate candidate{ light, dynamic_cast<PointLight*>(light), dynamic_cast<SpotLight*>(light), glm::vec3(0.0f), 0.0f, 0.0f };
+            if (!candidate.point && !candidate.spot) continue;
+
+            candidate.position = candidate.point ? candidate.point->position : candidate.spot->position;
+            candidate.range = GetLightRange(*light, _settings.maxLightRange);
+
+            // Nothing it lights is on screen.
+            if (candidate.range <= ShadowNearPlane || !frustum.Intersects(candidate.position, candidate.range))
+                continue;
+
+            // Screen importance: how many pixels the lit sphere spans, a cube face covers about half of that.
+            const float distance = glm::length(cameraPosition - candidate.position);
+            candidate.pixels = 2.0f * candidate.range * pixelsPerUnit / std::max(distance, candidate.range);
+            if (candidate.point)
+                candidate.pixels *= 0.5f;
+
+            candidates.push_back(candidate);
+        }
+
+        // The most important lights pick their tiles first.
+        std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) { return a.pixels > b.pixels; });
+
+        // Marked up front, so making room never evicts a light that is on screen.
+        for (const Candidate& candidate : candidates)
+            _lights[candidate.light].lastFrame = _frame;
+
+        const float atlasSize = static_cast<float>(_settings.size);
+
+        for (const Candidate& candidate : candidates)
+        {
+            LightEntry& entry = _lights[candidate.light];
+
+            const int tileCount = candidate.point ? 6 : 1;
+            const int wanted = std::bit_floor(static_cast<unsigned int>(
+                std::clamp(static_cast<int>(candidate.pixels), _settings.minTileSize, _settings.maxTileSize)));
+            int level = _GetLevel(wanted);
+
+            // Tiles grow as soon as the light needs more, but only shrink once it needs a quarter,
+            // so a slowly moving camera doesn't keep re-rendering them.
+            if (entry.tileCount == tileCount && (level == entry.tiles[0].level || level == entry.tiles[0].level + 1))
+                level = entry.tiles[0].level;
+
+            if (entry.tileCount != tileCount || entry.tiles[0].level != level)
+            {
+                _FreeTiles(entry);
+                if (!_AllocateTiles(entry, tileCount, level))
+                    continue;
+            }
+
+            LightShadow& shadow = candidate.light->shadow;
+            const float tileSize = static_cast<float>(_GetTileSize(entry.tiles[0].level)) / atlasSize;
+
+            if (candidate.point)
+            {
+                const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, ShadowNearPlane, candidate.range);
+                for (int face = 0; face < 6; ++face)
+                {
+                    entry.viewProjections[face] = projection
+                        * glm::lookAt(candidate.position, candidate.position + FaceDirections[face], FaceUps[face]);
+                    shadow.faces[face] = glm::vec2(entry.tiles[face].origin) / atlasSize;
+                }
+            }
+            else
+            {
+                // A little wider than the cone, so filtering at its edge stays inside the tile.
+                const float cone = 2.0f * std::acos(std::clamp(candidate.spot->outerCutoff, -1.0f, 1.0f));
+                const float fieldOfView = std::min(cone + glm::radians(4.0f), glm::radians(170.0f));
+
+                const glm::vec3 direction = glm::normalize(candidate.spot->direction);
+                const glm::vec3 up = std::abs(direction.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+                entry.viewProjections[0] = glm::perspective(fieldOfView, 1.0f, ShadowNearPlane, candidate.range)
+                    * glm::lookAt(candidate.position, candidate.position + direction, up);
+                shadow.matrix = GetTileMatrix(glm::vec2(entry.tiles[0].origin) / atlasSize, tileSize) * entry.viewProjections[0];
+            }
+
+            shadow.tileSize = tileSize;
+            shadow.nearPlane = ShadowNearPlane;
+            shadow.farPlane = candidate.range;
+            shadow.enabled = true;
+
+            _stats.shadowedLights++;
+
+            // Everything the tiles depend on: the light through its matrices, where the tiles are, and the casters in range.
+            uint64_t lightHash = HashFNV1a(entry.viewProjections.data(), sizeof(glm::mat4) * tileCount);
+            lightHash = HashFNV1a(entry.tiles.data(), sizeof(Tile) * tileCount, lightHash);
+
+            Work item;
+            item.entry = &entry;
+            uint64_t staticHash = HashFNV1a(nullptr, 0);
+            uint64_t dynamicHash = staticHash;
+
+            for (const Caster& caster : casters)
+            {
+                if (glm::length(caster.sphere.center - candidate.position) > candidate.range + caster.sphere.radius)
+                    continue;
+
+                uint64_t& hash = caster.isStatic ? staticHash : dynamicHash;
+                hash = HashFNV1a(&caster.mesh, sizeof(Mesh*), hash);
+                hash = HashFNV1a(&caster.transform, sizeof(glm::mat4), hash);
+
+                (caster.isStatic ? item.staticCasters : item.dynamicCasters).push_back(&caster);
+            }
+
+            item.renderStatic = !entry.staticValid || entry.lightHash != lightHash || entry.staticHash != staticHash;
+            const bool renderDynamic = item.renderStatic || !entry.dynamicValid || entry.dynamicHash != dynamicHash;
+
+            entry.lightHash = lightHash;
+            entry.staticHash = staticHash;
+            entry.dynamicHash = dynamicHash;
+            entry.staticValid = entry.dynamicValid = true;
+
+            if (renderDynamic)
+                _work.push_back(std::move(item));
+            else
+                _stats.cachedTiles += tileCount;
+        }
+
+        // Lights gone or off screen for too long.
+        for (auto it = _lights.begin(); it != _lights.end();)
+        {
+            if (_frame - it->second.lastFrame > static_cast<uint64_t>(_settings.idleFrames))
+            {
+                _FreeTiles(it->second);
+                it = _lights.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        if (!_work.empty())
+            _AddPasses(graph, shader);
+    }
+
+    void ShadowAtlas::Clear()
+    {
+        for (auto& [light, entry] : _lights)
+            _FreeTiles(entry);
+
+        _lights.clear();
+        _work.clear();
+    }
+
+    const std::shared_ptr<TextureArray>& ShadowAtlas::GetTexture() const { return _texture; }
+    const ShadowAtlas::Settings& ShadowAtlas::GetSettings() const { return _settings; }
+    const ShadowAtlas::Stats& ShadowAtlas::GetStats() const { return _stats; }
+
+    float ShadowAtlas::GetLightRange(const LightSource& light, float maxRange)
+    {
+        float constant, linear, quadratic;
+
+        if (const auto* point = dynamic_cast<const PointLight*>(&light))
+        {
+            constant = point->constant;
+            linear = point->linear;
+            quadratic = point->quadratic;
+        }
+        else if (const auto* spot = dynamic_cast<const SpotLight*>(&light))
+        {
+            constant = spot->constant;
+            linear = spot->linear;
+            quadratic = spot->quadratic;
+        }
+        else
+            return maxRange;
+
+        const float peak = light.intensity * std::max({ light.color.r, light.color.g, light.color.b });
+
+        // quadratic * d^2 + linear * d + constant = 256 * peak
+        const float offset = constant - 256.0f * peak;
+        if (offset >= 0.0f)
+            return 0.0f;
+
+        float range = maxRange;
+        if (quadratic > 0.0f)
+            range = (-linear + std::sqrt(linear * linear - 4.0f * quadratic * offset)) / (2.0f * quadratic);
+        else if (linear > 0.0f)
+            range = -offset / linear;
+
+        return std::min(range, maxRange);
+    }
+
+    bool ShadowAtlas::_Create()
+    {
+        LoggerContext ctx("ShadowAtlas", "_Create");
+
+        // Tiles halve per quadtree level, so every size is a power of two.
+        _settings.size = static_cast<int>(std::bit_ceil(static_cast<unsigned int>(std::max(_settings.size, 64))));
+        _settings.maxTileSize = static_cast<int>(std::bit_floor(static_cast<unsigned int>(std::clamp(_settings.maxTileSize, 16, _settings.size))));
+        _settings.minTileSize = static_cast<int>(std::bit_floor(static_cast<unsigned int>(std::clamp(_settings.minTileSize, 16, _settings.maxTileSize))));
+
+        TextureDesc descriptor;
+        descriptor.width = _settings.size;
+        descriptor.height = _settings.size;
+        descriptor.channels = 1;
+        descriptor.type = GL_FLOAT;
+        descriptor.internalFormat = TextureFormat::Depth24;
+        descriptor.format = TextureFormat::Depth;
+        descriptor.minFilter = TextureFilter::Linear;
+        descriptor.magFilter = TextureFilter::Linear;
+        descriptor.wrapS = TextureWrap::ClampToEdge;
+        descriptor.wrapT = TextureWrap::ClampToEdge;
+
+        // Created with depth comparison on, so shaders sample it as a sampler2DArrayShadow.
+        _texture = TextureArray::Create(descriptor, 2);
+
+        if (!_texture)
+        {
+            Logger::Error("Failed to create the shadow atlas, local lights will have no shadows!");
+            _failed = true;
+            return false;
+        }
+
+        const int levels = std::countr_zero(static_cast<unsigned int>(_settings.size))
+            - std::countr_zero(static_cast<unsigned int>(_settings.minTileSize)) + 1;
+
+        _freeTiles.assign(levels, {});
+        _freeTiles[0].push_back(glm::ivec2(0));
+
+        Logger::Debug("Created a {}x{} shadow atlas!", _settings.size, _settings.size);
+
+        return true;
+    }
+
+    int ShadowAtlas::_GetTileSize(int level) const
+    {
+        return _settings.size >> level;
+    }
+
+    int ShadowAtlas::_GetLevel(int tileSize) const
+    {
+        return std::countr_zero(static_cast<unsigned int>(_settings.size)) - std::countr_zero(static_cast<unsigned int>(tileSize));
+    }
+
+    bool ShadowAtlas::_AllocateTile(int level, Tile& tile)
+    {
+        if (level < 0 || level >= static_cast<int>(_freeTiles.size()))
+            return false;
+
+        int from = level;
+        while (from >= 0 && _freeTiles[from].empty())
+            --from;
+
+        if (from < 0)
+            return false;
+
+        glm::ivec2 origin = _freeTiles[from].back();
+        _freeTiles[from].pop_back();
+
+        // Split down to the wanted size, keeping the first quarter each time.
+        for (int split = from + 1; split <= level; ++split)
+        {
+            const int size = _GetTileSize(split);
+            _freeTiles[split].push_back(glm::ivec2(origin.x + size, origin.y));
+            _freeTiles[split].push_back(glm::ivec2(origin.x, origin.y + size));
+            _freeTiles[split].push_back(glm::ivec2(origin.x + size, origin.y + size));
+        }
+
+        tile.origin = origin;
+        tile.level = level;
+
+        return true;
+    }
+
+    bool ShadowAtlas::_AllocateTiles(LightEntry& entry, int count, int level)
+    {
+        for (; level < static_cast<int>(_freeTiles.size()); ++level)
+        {
+            for (;;)
+            {
+                int allocated = 0;
+                while (allocated < count && _AllocateTile(level, entry.tiles[allocated]))
+                    ++allocated;
+
+                if (allocated == count)
+                {
+                    entry.tileCount = count;
+                    entry.staticValid = entry.dynamicValid = false;
+                    return true;
+                }
+
+                for (int i = 0; i < allocated; ++i)
+                    _FreeTile(entry.tiles[i]);
+
+                // Make room by evicting the light that has been off screen the longest, then try smaller tiles.
+                LightEntry* idle = nullptr;
+                for (auto& [light, other] : _lights)
+                    if (other.tileCount > 0 && other.lastFrame != _frame && (!idle || other.lastFrame < idle->lastFrame))
+                        idle = &other;
+
+                if (!idle)
+                    break;
+
+                _FreeTiles(*idle);
+            }
+        }
+
+        return false;
+    }
+
+    void ShadowAtlas::_FreeTile(const Tile& tile)
+    {
+        glm::ivec2 origin = tile.origin;
+        int level = tile.level;
+
+        // Merge with the three siblings while they are free too.
+        while (level > 0)
+        {
+            const int parentSize = _GetTileSize(level - 1);
+            const glm::ivec2 parent(origin.x / parentSize * parentSize, origin.y / parentSize * parentSize);
+
+            auto isSibling = [&](const glm::ivec2& free)
+            {
+                return free.x / parentSize * parentSize == parent.x && free.y / parentSize * parentSize == parent.y;
+            };
+
+            std::vector<glm::ivec2>& freeTiles = _freeTiles[level];
+            if (std::count_if(freeTiles.begin(), freeTiles.end(), isSibling) < 3)
+                break;
+
+            freeTiles.erase(std::remove_if(freeTiles.begin(), freeTiles.end(), isSibling), freeTiles.end());
+
+            origin = parent;
+            --level;
+        }
+
+        _freeTiles[level].push_back(origin);
+    }
+
+    void ShadowAtlas::_FreeTiles(LightEntry& entry)
+    {
+        for (int i = 0; i < entry.tileCount; ++i)
+            _FreeTile(entry.tiles[i]);
+
+        entry.tileCount = 0;
+        entry.staticValid = entry.dynamicValid = false;
+    }
+
+    void ShadowAtlas::_AddPasses(RenderGraph& graph, Shader* shader)
+    {
+        const RenderGraph::Resource staticLayer = graph.Import("Shadow Atlas Static", _texture, StaticLayer);
+        const RenderGraph::Resource dynamicLayer = graph.Import("Shadow Atlas Dynamic", _texture, DynamicLayer);
+
+        const bool renderStatic = std::any_of(_work.begin(), _work.end(), [](const Work& item) { return item.renderStatic; });
+
+        if (renderStatic)
+        {
+            graph.AddPass("Shadow Static",
+                [&](RenderGraph::Builder& builder) { builder.Write(staticLayer); },
+                [this, shader](const RenderGraph::Context&)
+                {
+                    BeginCasterState();
+                    shader->Bind();
+
+                    for (const Work& item : _work)
+                    {
+                        if (!item.renderStatic) continue;
+
+                        _RenderTiles(*item.entry, item.staticCasters, shader, true);
+                        _stats.staticTilesRendered += item.entry->tileCount;
+                    }
+
+                    shader->Unbind();
+                    EndCasterState();
+                });
+        }
+
+        // Starts each tile from the static depth, then adds the dynamic casters.
+        graph.AddPass("Shadow Dynamic",
+            [&](RenderGraph::Builder& builder)
+            {
+                builder.Read(staticLayer);
+                builder.Write(dynamicLayer);
+            },
+            [this, shader, staticLayer](const RenderGraph::Context& context)
+            {
+                Framebuffer* source = context.GetFramebuffer(staticLayer);
+                if (!source) return;
+
+                context.GetFramebuffer()->Bind();
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, source->GetID());
+
+                BeginCasterState();
+                shader->Bind();
+
+                for (const Work& item : _work)
+                {
+                    const LightEntry& entry = *item.entry;
+
+                    for (int i = 0; i < entry.tileCount; ++i)
+                    {
+                        const glm::ivec2 origin = entry.tiles[i].origin;
+                        const int size = _GetTileSize(entry.tiles[i].level);
+                        glBlitFramebuffer(origin.x, origin.y, origin.x + size, origin.y + size,
+                            origin.x, origin.y, origin.x + size, origin.y + size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+                    }
+
+                    _RenderTiles(entry, item.dynamicCasters, shader, false);
+                    _stats.dynamicTilesRendered += entry.tileCount;
+                }
+
+                shader->Unbind();
+                EndCasterState();
+
+                _work.clear();
+            });
+    }
+
+    void ShadowAtlas::_RenderTiles(const LightEntry& entry, const std::vector<const Caster*>& casters, Shader* shader, bool clear) const
+    {
+        shader->SetMat4(Uniforms::ViewMatrix, glm::mat4(1.0f));
+
+        for (int i = 0; i < entry.tileCount; ++i)
+        {
+            const glm::ivec2 origin = entry.tiles[i].origin;
+            const int size = _GetTileSize(entry.tiles[i].level);
+
+            glViewport(origin.x, origin.y, size, size);
+
+            if (clear)
+            {
+                glEnable(GL_SCISSOR_TEST);
+                glScissor(origin.x, origin.y, size, size);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                glDisable(GL_SCISSOR_TEST);
+            }
+
+            if (casters.empty()) continue;
+
+            Frustum frustum;
+            frustum.Update(entry.viewProjections[i]);
+
+            shader->SetMat4(Uniforms::ProjectionMatrix, entry.viewProjections[i]);
+
+            for (const Caster* caster : casters)
+            {
+                if (!frustum.Intersects(caster->sphere.center, caster->sphere.radius)) continue;
+
+                shader->SetMat4(Uniforms::ModelMatrix, caster->transform);
+                shader->SetVec3(Uniforms::PositionScale, caster->mesh->GetPositionScale());
+                shader->SetVec3(Uniforms::PositionOffset, caster->mesh->GetPositionOffset());
+
+                caster->mesh->Draw();
+            }
+        }
+    }
+}
\ No newline at end of file
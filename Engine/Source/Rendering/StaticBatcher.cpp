@@ -0,0 +1,247 @@
+#include "Rendering/StaticBatcher.hpp"
+#include "Rendering/Material.hpp"
+#include "Resources/Model.hpp"
+#include "Core/Logger.hpp"
+
+namespace AE
+{
+    std::size_t StaticBatcher::ChunkKeyHash::operator()(const ChunkKey& key) const
+    {
+        std::size_t hash = std::hash<const Material*>()(key.material);
+
+        auto Combine = [&hash](std::size_t value)
+        {
+            hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        };
+
+        Combine(static_cast<uint32_t>(key.cell.x));
+        Combine(static_cast<uint32_t>(key.cell.y));
+        Combine(static_cast<uint32_t>(key.cell.z));
+        Combine(key.attributes);
+
+        return hash;
+    }
+
+    StaticBatcher::StaticBatcher()
+        : _settings() {}
+
+    StaticBatcher::StaticBatcher(const Settings& settings)
+        : _settings(settings) {}
+
+    void StaticBatcher::Add(std::span<const glm::vec3> positions,
+        std::span<const glm::vec3> normals,
+        std::span<const glm::vec2> texCoords,
+        std::span<const glm::vec3> tangents,
+        std::span<const glm::vec3> bitangents,
+        std::span<const glm::vec2> lightmapTexCoords,
+        IndexView indices,
+        const glm::mat4& transform,
+        const std::shared_ptr<Material>& material)
+    {
+        const std::size_t vertexCount = positions.size();
+
+        _stats.sourceMeshes++;
+        if (vertexCount == 0)
+            return;
+
+        // Chunks only hold sources with the same attributes, so every array stays complete.
+        uint32_t attributes = 0;
+        if (normals.size() == vertexCount)
+            attributes |= Normals;
+        if (texCoords.size() == vertexCount)
+            attributes |= TexCoords;
+        if (tangents.size() == vertexCount && bitangents.size() == vertexCount)
+            attributes |= Tangents;
+        if (lightmapTexCoords.size() == vertexCount)
+            attributes |= Lightmap;
+
+        const glm::mat3 linear = glm::mat3(transform);
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+
+        // A mirroring transform turns the triangles around, so swap two corners to keep them front-facing.
+        const bool flipWinding = glm::determinant(linear) < 0.0f;
+
+        std::vector<glm::vec3> worldPositions(vertexCount);
+        for (std::size_t i = 0; i < vertexCount; ++i)
+            worldPositions[i] = glm::vec3(transform * glm::vec4(positions[i], 1.0f));
+
+        const std::size_t indexCount = indices.empty() ? vertexCount : indices.size();
+        auto GetIndex = [&](std::size_t i) -> uint32_t
+        {
+            return indices.empty() ? static_cast<uint32_t>(i) : indices[i];
+        };
+
+        // (chunk, source vertex) -> vertex in the chunk, so shared vertices stay shared.
+        std::unordered_map<uint64_t, uint32_t> remap;
+        remap.reserve(vertexCount);
+
+        for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            uint32_t triangle[3] = { GetIndex(i), GetIndex(i + 1), GetIndex(i + 2) };
+            if (triangle[0] >= vertexCount || triangle[1] >= vertexCount || triangle[2] >= vertexCount)
+                continue;
+
+            if (flipWinding)
+                std::swap(triangle[1], triangle[2]);
+
+            glm::ivec3 cell(0, 0, 0);
+            if (_settings.chunkSize > 0.0f)
+            {
+                const glm::vec3 centroid = (worldPositions[triangle[0]] + worldPositions[triangle[1]] + worldPositions[triangle[2]]) / 3.0f;
+                cell = glm::ivec3(glm::floor(centroid / _settings.chunkSize));
+            }
+
+            const std::size_t chunkIndex = _GetChunk({ material.get(), cell, attributes }, material);
+            MeshGeometry& geometry = _chunks[chunkIndex].geometry;
+
+            for (uint32_t vertex : triangle)
+            {
+                auto [it, inserted] = remap.try_emplace((static_cast<uint64_t>(chunkIndex) << 32) | vertex,
+                    static_cast<uint32_t>(geometry.positions.size()));
+
+                if (inserted)
+                {
+                    geometry.positions.push_back(worldPositions[vertex]);
+
+                    if (attributes & Normals)
+                        geometry.normals.push_back(glm::normalize(normalMatrix * normals[vertex]));
+                    if (attributes & TexCoords)
+                        geometry.texCoords.push_back(texCoords[vertex]);
+                    if (attributes & Tangents)
+                    {
+                        geometry.tangents.push_back(glm::normalize(linear * tangents[vertex]));
+                        geometry.bitangents.push_back(glm::normalize(linear * bitangents[vertex]));
+                    }
+                    if (attributes & Lightmap)
+                        geometry.lightmapTexCoords.push_back(lightmapTexCoords[vertex]);
+                }
+
+                geometry.indices.push_back(it->second);
+            }
+
+            _stats.triangles++;
+        }
+
+        _stats.mergedMeshes++;
+    }
+
+    bool StaticBatcher::Add(const Mesh& mesh, const glm::mat4& transform, const std::shared_ptr<Material>& material)
+    {
+        if (_AddMesh(mesh, transform, material))
+            return true;
+
+        LoggerContext ctx("StaticBatcher", "Add");
+        Logger::Warning("Skipped a mesh without CPU data, load it with keepCPUData to batch it");
+        return false;
+    }
+
+    void StaticBatcher::Add(const Model& model, const glm::mat4& transform)
+    {
+        if (!model.root) return;
+
+        const std::size_t skipped = _stats.skippedMeshes;
+        _AddNode(*model.root, transform);
+
+        if (_stats.skippedMeshes > skipped)
+        {
+            LoggerContext ctx("StaticBatcher", "Add");
+            Logger::Warning("Skipped {} meshes without CPU data, they are drawn unbatched. Load the model with keepCPUData to batch them",
+                _stats.skippedMeshes - skipped);
+        }
+    }
+
+    bool StaticBatcher::_AddMesh(const Mesh& mesh, const glm::mat4& transform, const std::shared_ptr<Material>& material)
+    {
+        if (mesh.GetResidency() != MeshResidency::CPURetained)
+        {
+            _stats.sourceMeshes++;
+            _stats.skippedMeshes++;
+            return false;
+        }
+
+        Add(mesh.GetVertices(), mesh.GetNormals(), mesh.GetTexCoords(), mesh.GetTangents(), mesh.GetBitangents(),
+            mesh.GetLightmapTexCoords(), mesh.GetIndexData(), transform, material);
+
+        return true;
+    }
+
+    void StaticBatcher::_AddNode(const ModelNode& node, const glm::mat4& parentTransform)
+    {
+        const glm::mat4 transform = parentTransform * node.GetTransform();
+
+        const auto& meshes = node.GetMeshes();
+        const auto& materials = node.GetMaterials();
+
+        for (std::size_t i = 0; i < meshes.size(); ++i)
+        {
+            if (!meshes[i]) continue;
+
+            std::shared_ptr<Material> material = i < materials.size() ? materials[i] : nullptr;
+            if (!_AddMesh(*meshes[i], transform, material))
+                _passThrough.push_back({ meshes[i], std::move(material), transform });
+        }
+
+        for (const auto& child : node.GetChildren())
+            _AddNode(*child, transform);
+    }
+
+    std::size_t StaticBatcher::_GetChunk(const ChunkKey& key, const std::shared_ptr<Material>& material)
+    {
+        auto [it, inserted] = _chunkIndex.try_emplace(key, _chunks.size());
+        if (inserted)
+            _chunks.push_back({ material, {} });
+
+        return it->second;
+    }
+
+    std::shared_ptr<Model> StaticBatcher::Build()
+    {
+        LoggerContext ctx("StaticBatcher", "Build");
+
+        auto model = std::make_shared<Model>();
+        std::size_t chunks = 0;
+
+        for (Chunk& chunk : _chunks)
+        {
+            MeshGeometry& geometry = chunk.geometry;
+            if (geometry.indices.empty()) continue;
+
+            if (_settings.optimize)
+                MeshOptimizer::Optimize(geometry, _settings.optimizer);
+
+            auto mesh = std::make_shared<Mesh>(std::move(geometry.positions), IndexData(geometry.indices),
+                std::move(geometry.normals), std::move(geometry.texCoords), std::move(geometry.tangents), std::move(geometry.bitangents),
+                std::move(geometry.lightmapTexCoords), _settings.layout, _settings.residency);
+
+            if (!geometry.meshlets.empty())
+                mesh->SetMeshlets(std::move(geometry.meshlets));
+
+            model->root->AddMesh(mesh);
+            model->root->AddMaterial(chunk.material);
+            chunks++;
+        }
+
+        for (PassThrough& entry : _passThrough)
+        {
+            auto node = std::make_shared<ModelNode>("PassThrough", entry.transform);
+            node->AddMesh(entry.mesh);
+            node->AddMaterial(entry.material);
+            model->root->AddChild(node);
+        }
+
+        _stats.chunks += chunks;
+
+        Logger::Info("Merged {} of {} meshes into {} chunks ({} triangles, chunk size {}), {} kept as they are",
+            _stats.mergedMeshes, _stats.sourceMeshes, chunks, _stats.triangles, _settings.chunkSize, _passThrough.size());
+
+        _chunks.clear();
+        _chunkIndex.clear();
+        _passThrough.clear();
+
+        model->Flatten();
+
+        return model;
+    }
+
+    const StaticBatcher::Stats& StaticBatcher::GetStats() const { return _stats; }
+}
\ No newline at end of file
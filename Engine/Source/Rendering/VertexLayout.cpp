@@ -0,0 +1,294 @@
+#include "Rendering/VertexLayout.hpp"
+#include "Resources/Shader.hpp"
+#include "Core/Logger.hpp"
+
+#include <cstring>
+
+namespace AE
+{
+    static int16_t PackSnorm16(float value)
+    {
+        return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    static uint16_t PackUnorm16(float value)
+    {
+        return static_cast<uint16_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    static glm::vec2 OctahedralEncode(glm::vec3 n)
+    {
+        n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+
+        glm::vec2 p(n.x, n.y);
+        if (n.z < 0.0f)
+        {
+            p = glm::vec2(
+                (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+            );
+        }
+
+        return p;
+    }
+
+    // Rotation taking (X, Y, Z) to (T, B, N) as a quaternion (x, y, z, w).
+    static glm::vec4 FrameToQuaternion(const glm::vec3& T, const glm::vec3& B, const glm::vec3& N)
+    {
+        glm::vec4 q;
+
+        float trace = T.x + B.y + N.z;
+        if (trace > 0.0f)
+        {
+            float s = 0.5f / std::sqrt(trace + 1.0f);
+            q = glm::vec4((B.z - N.y) * s, (N.x - T.z) * s, (T.y - B.x) * s, 0.25f / s);
+        }
+        else if (T.x > B.y && T.x > N.z)
+        {
+            float s = 2.0f * std::sqrt(1.0f + T.x - B.y - N.z);
+            q = glm::vec4(0.25f * s, (B.x + T.y) / s, (N.x + T.z) / s, (B.z - N.y) / s);
+        }
+        else if (B.y > N.z)
+        {
+            float s = 2.0f * std::sqrt(1.0f + B.y - T.x - N.z);
+            q = glm::vec4((B.x + T.y) / s, 0.25f * s, (N.y + B.z) / s, (N.x - T.z) / s);
+        }
+        else
+        {
+            float s = 2.0f * std::sqrt(1.0f + N.z - T.x - B.y);
+            q = glm::vec4((N.x + T.z) / s, (N.y + B.z) / s, 0.25f * s, (T.y - B.x) / s);
+        }
+
+        return glm::normalize(q);
+    }
+
+    // Imported tangents are rarely exactly perpendicular to the normal (or may be degenerate).
+    static glm::vec3 OrthogonalTangent(const glm::vec3& N, const glm::vec3& tangent)
+    {
+        glm::vec3 T = tangent - N * glm::dot(N, tangent);
+        if (glm::dot(T, T) < 1e-12f)
+            T = std::abs(N.x) < 0.9f ? glm::cross(N, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(N, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        return glm::normalize(T);
+    }
+
+    static glm::vec4 QTangentEncode(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent)
+    {
+        glm::vec3 N = glm::normalize(normal);
+        glm::vec3 T = OrthogonalTangent(N, tangent);
+        glm::vec3 B = glm::cross(N, T);
+        bool mirrored = glm::dot(B, bitangent) < 0.0f;
+
+        glm::vec4 q = FrameToQuaternion(T, B, N);
+        if (q.w < 0.0f)
+            q = -q;
+
+        // The handedness lives in the sign of w, so w must survive snorm16 rounding.
+        const float bias = 1.0f / 32767.0f;
+        if (q.w < bias)
+        {
+            float xyz = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+            float scale = xyz > 0.0f ? std::sqrt(1.0f - bias * bias) / xyz : 0.0f;
+            q = glm::vec4(q.x * scale, q.y * scale, q.z * scale, bias);
+        }
+
+        return mirrored ? -q : q;
+    }
+
+    template<typename T>
+    static void Write(unsigned char* dst, const T& value)
+    {
+        std::memcpy(dst, &value, sizeof(T));
+    }
+
+    VertexLayout VertexLayout::Uncompressed()
+    {
+        return VertexLayout{};
+    }
+
+    VertexLayout VertexLayout::Compressed()
+    {
+        return VertexLayout{VertexPositionFormat::Quantized, VertexNormalFormat::Compressed, VertexTexCoordFormat::Half};
+    }
+
+    PackedVertices VertexLayout::Pack(
+        std::span<const glm::vec3> positions,
+        std::span<const glm::vec3> normals,
+        std::span<const glm::vec2> texCoords,
+        std::span<const glm::vec3> tangents,
+        std::span<const glm::vec3> bitangents,
+        std::span<const glm::vec2> lightmapTexCoords
+    ) const
+    {
+        LoggerContext ctx("VertexLayout", "Pack");
+
+        PackedVertices packed;
+
+        const std::size_t count = positions.size();
+        if (count == 0)
+            return packed;
+
+        auto Matches = [&](std::size_t size, const char* name)
+        {
+            if (size != 0 && size != count)
+                Logger::Warning("Ignoring {}: {} values for {} vertices!", name, size, count);
+            return size == count;
+        };
+
+        const bool hasNormals = Matches(normals.size(), "normals");
+        const bool hasTexCoords = Matches(texCoords.size(), "texture coordinates");
+        const bool hasTangents = hasNormals && Matches(tangents.size(), "tangents");
+        const bool hasBitangents = hasTangents && Matches(bitangents.size(), "bitangents");
+        const bool hasLightmap = Matches(lightmapTexCoords.size(), "lightmap coordinates");
+
+        auto AddAttribute = [&](GLuint location, GLint size, GLenum type, GLboolean normalized, std::size_t bytes)
+        {
+            packed.attributes.push_back({location, size, type, normalized, static_cast<std::size_t>(packed.stride)});
+            packed.stride += static_cast<GLsizei>(bytes);
+        };
+
+        // Positions
+        if (position == VertexPositionFormat::Quantized)
+        {
+            glm::vec3 min = positions[0];
+            glm::vec3 max = positions[0];
+            for (const glm::vec3& p : positions)
+            {
+                min = glm::min(min, p);
+                max = glm::max(max, p);
+            }
+
+            glm::vec3 extent = max - min;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (extent[i] <= 0.0f) extent[i] = 1.0f;
+            }
+
+            packed.positionScale = extent;
+            packed.positionOffset = min;
+
+            // The fourth component only pads the attribute to 8 bytes.
+            AddAttribute(POSITION, 3, GL_UNSIGNED_SHORT, GL_TRUE, 4 * sizeof(uint16_t));
+        }
+        else
+        {
+            AddAttribute(POSITION, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float));
+        }
+
+        // Normals and tangent frame
+        if (hasNormals)
+        {
+            if (normal == VertexNormalFormat::Compressed)
+            {
+                if (hasTangents)
+                {
+                    AddAttribute(NORMAL, 4, GL_SHORT, GL_TRUE, 4 * sizeof(int16_t));
+                    packed.features |= ShaderFeature::QTangentFrame;
+                }
+                else
+                {
+                    AddAttribute(NORMAL, 2, GL_SHORT, GL_TRUE, 2 * sizeof(int16_t));
+                    packed.features |= ShaderFeature::OctahedralNormal;
+                }
+            }
+            else
+            {
+                AddAttribute(NORMAL, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float));
+            }
+        }
+
+        // TexCoords
+        if (hasTexCoords)
+        {
+            if (texCoord == VertexTexCoordFormat::Half)
+                AddAttribute(TEXCOORD, 2, GL_HALF_FLOAT, GL_FALSE, 2 * sizeof(uint16_t));
+            else
+                AddAttribute(TEXCOORD, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float));
+        }
+
+        // Tangents (float frames only, the QTangent already carries them)
+        if (hasTangents && normal == VertexNormalFormat::Float)
+            AddAttribute(TANGENT, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float));
+
+        // Lightmap coordinates
+        if (hasLightmap)
+        {
+            AddAttribute(LIGHTMAP, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float));
+            packed.features |= ShaderFeature::Lightmap;
+        }
+
+        packed.data.resize(count * packed.stride);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            unsigned char* vertex = packed.data.data() + i * packed.stride;
+
+            for (const VertexAttribute& attribute : packed.attributes)
+            {
+                unsigned char* dst = vertex + attribute.offset;
+
+                switch (attribute.location)
+                {
+                    case POSITION:
+                    {
+                        if (attribute.type == GL_UNSIGNED_SHORT)
+                        {
+                            glm::vec3 p = (positions[i] - packed.positionOffset) / packed.positionScale;
+                            uint16_t q[4] = { PackUnorm16(p.x), PackUnorm16(p.y), PackUnorm16(p.z), 0 };
+                            Write(dst, q);
+                        }
+                        else
+                        {
+                            Write(dst, positions[i]);
+                        }
+                        break;
+                    }
+                    case NORMAL:
+                    {
+                        if (attribute.size == 4)
+                        {
+                            glm::vec3 bitangent = hasBitangents ? bitangents[i] : glm::cross(normals[i], tangents[i]);
+                            glm::vec4 q = QTangentEncode(normals[i], tangents[i], bitangent);
+                            int16_t s[4] = { PackSnorm16(q.x), PackSnorm16(q.y), PackSnorm16(q.z), PackSnorm16(q.w) };
+                            Write(dst, s);
+                        }
+                        else if (attribute.size == 2)
+                        {
+                            glm::vec2 e = OctahedralEncode(normals[i]);
+                            int16_t s[2] = { PackSnorm16(e.x), PackSnorm16(e.y) };
+                            Write(dst, s);
+                        }
+                        else
+                        {
+                            Write(dst, normals[i]);
+                        }
+                        break;
+                    }
+                    case TEXCOORD:
+                    {
+                        if (attribute.type == GL_HALF_FLOAT)
+                            Write(dst, glm::packHalf2x16(texCoords[i]));
+                        else
+                            Write(dst, texCoords[i]);
+                        break;
+                    }
+                    case TANGENT:
+                    {
+                        glm::vec3 N = glm::normalize(normals[i]);
+                        glm::vec3 T = OrthogonalTangent(N, tangents[i]);
+                        float handedness = hasBitangents && glm::dot(glm::cross(N, T), bitangents[i]) < 0.0f ? -1.0f : 1.0f;
+                        Write(dst, glm::vec4(T, handedness));
+                        break;
+                    }
+                    case LIGHTMAP:
+                    {
+                        Write(dst, lightmapTexCoords[i]);
+                        break;
+                    }
+                }
+            }
+        }
+
+        return packed;
+    }
+}
\ No newline at end of file
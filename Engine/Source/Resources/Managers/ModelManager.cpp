@@ -3,21 +3,42 @@
 #include "Resources/Texture.hpp"
 #include "Rendering/Mesh.hpp"
 #include "Rendering/Material.hpp"
+#include "Rendering/StaticBatcher.hpp"
+#include "Resources/MeshOptimizer.hpp"
+#include "Core/EngineSettings.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 
 #include <filesystem>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 namespace AE
 {
     namespace fs = std::filesystem;
     
+    static MeshOptimizer::Settings GetOptimizerSettings()
+    {
+        const auto& importer = EngineSettings::Get().importer;
+
+        MeshOptimizer::Settings optimizerSettings;
+        optimizerSettings.cacheSize = importer.vertexCacheSize;
+        optimizerSettings.overdrawThreshold = importer.overdrawThreshold;
+        optimizerSettings.buildMeshlets = importer.buildMeshlets;
+        optimizerSettings.meshletMaxVertices = static_cast<std::size_t>(std::max(importer.meshletMaxVertices, 3));
+        optimizerSettings.meshletMaxTriangles = static_cast<std::size_t>(std::max(importer.meshletMaxTriangles, 1));
+
+        return optimizerSettings;
+    }
+
     ModelManager::ModelManager(TextureManager* textureMgr)
         : ResourceManager("Model"), _textureMgr(textureMgr) {}
 
     std::shared_ptr<Model> ModelManager::Load(const std::string& name,
-        const std::string& path)
+        const std::string& path, bool staticBatch, bool keepCPUData)
     {
         LoggerContext ctx("ModelManager", "Load");
 
@@ -34,7 +55,6 @@ namespace AE
             aiProcess_Triangulate | 
             aiProcess_FlipUVs | 
             aiProcess_GenSmoothNormals | 
-            aiProcess_GenBoundingBoxes | 
             aiProcess_CalcTangentSpace | 
             aiProcess_OptimizeMeshes
         );
@@ -48,19 +68,93 @@ namespace AE
         fs::path p(path);
         _directory = p.has_parent_path() ? p.parent_path().string() : ".";
 
-        auto model = std::make_shared<Model>();
+        _currentModelName = name;
+        _currentVertexCount = 0;
+        _currentVertexBytes = 0;
+        _currentMeshCount = 0;
+        _currentShortIndexMeshes = 0;
+        _currentGPUBytes = 0;
+        _currentCPUBytes = 0;
+        _currentReleasedBytes = 0;
+        _currentMaterialRefs = 0;
+        _currentKeepCPUData = keepCPUData;
+        _currentMaterialsMerged = 0;
+        _currentMaterialsShared = 0;
+
+        _materials.assign(scene->mNumMaterials, nullptr);
+
+        std::shared_ptr<Model> model;
+
+        if (staticBatch)
+        {
+            const auto& importer = EngineSettings::Get().importer;
+            const auto& renderer = EngineSettings::Get().renderer;
+
+            StaticBatcher::Settings batchSettings;
+            batchSettings.chunkSize = importer.staticBatchChunkSize;
+            batchSettings.optimize = importer.optimizeMeshes;
+            batchSettings.optimizer = GetOptimizerSettings();
+            batchSettings.layout = renderer.meshVertexLayout;
+            batchSettings.residency = keepCPUData ? MeshResidency::CPURetained : renderer.meshResidency;
 
-        model->root = std::make_shared<ModelNode>(
-            scene->mRootNode->mName.C_Str(),
-            _ConvertMatrix(scene->mRootNode->mTransformation)
-        );
+            // Sources are optimized as merged chunks, not one by one.
+            std::vector<MeshGeometry> geometries = _ExtractGeometries(scene, false);
 
-        _currentModelName = name;
+            StaticBatcher batcher(batchSettings);
+            _BatchNode(scene->mRootNode, scene, glm::mat4(1.0f), geometries, batcher);
+            geometries.clear();
 
-        _ProcessNode(scene->mRootNode, scene, model->root);
+            model = batcher.Build();
+            model->root->SetName(scene->mRootNode->mName.C_Str());
+
+            for (const auto& mesh : model->root->GetMeshes())
+                _AddMeshStats(*mesh);
+        }
+        else
+        {
+            model = std::make_shared<Model>();
+            model->root = std::make_shared<ModelNode>(
+                scene->mRootNode->mName.C_Str(),
+                _ConvertMatrix(scene->mRootNode->mTransformation)
+            );
+
+            _ProcessMeshes(scene);
+            _ProcessNode(scene->mRootNode, scene, model->root);
+            _meshes.clear();
+
+            model->Flatten();
+        }
+
+        // Slots of merged duplicates hold the same material.
+        std::unordered_set<const Material*> uniqueMaterials;
+        for (const auto& material : _materials)
+        {
+            if (material)
+                uniqueMaterials.insert(material.get());
+        }
+        _materials.clear();
 
         Add(name, model);
 
+        if (_currentVertexCount > 0)
+        {
+            Logger::Info("Model '{}' vertex data: {} vertices, {} bytes/vertex, {:.2f} MB",
+                name, _currentVertexCount, _currentVertexBytes / _currentVertexCount,
+                static_cast<double>(_currentVertexBytes) / (1024.0 * 1024.0));
+
+            Logger::Info("Model '{}' index data: {} of {} meshes use 16-bit indices",
+                name, _currentShortIndexMeshes, _currentMeshCount);
+
+            Logger::Info("Model '{}' geometry memory: GPU {:.2f} MB, CPU {:.2f} MB, released after upload {:.2f} MB",
+                name, static_cast<double>(_currentGPUBytes) / (1024.0 * 1024.0),
+                static_cast<double>(_currentCPUBytes) / (1024.0 * 1024.0),
+                static_cast<double>(_currentReleasedBytes) / (1024.0 * 1024.0));
+        }
+
+        // Batches are keyed by material pointer, so this is also the drop in opaque/transparent batches.
+        Logger::Info("Model '{}' materials: {} mesh references -> {} materials ({} duplicates merged, {} shared with other models)",
+            name, _currentMaterialRefs, uniqueMaterials.size(), _currentMaterialsMerged, _currentMaterialsShared);
+
         Logger::Info("Model '{}' loaded successfully!", name);
 
         return model;
@@ -76,8 +170,8 @@ namespace AE
         {
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
             
-            auto processedMesh = _ProcessMesh(mesh, scene);
-            auto processedMaterial = _ProcessMaterial(scene->mMaterials[mesh->mMaterialIndex], scene);
+            auto processedMesh = _meshes[node->mMeshes[i]];
+            auto processedMaterial = _GetMaterial(mesh->mMaterialIndex, scene);
 
             parent->AddMesh(std::move(processedMesh));
             parent->AddMaterial(std::move(processedMaterial));
@@ -96,53 +190,200 @@ namespace AE
         }
     }
 
-    std::shared_ptr<Mesh> ModelManager::_ProcessMesh(aiMesh* mesh, const aiScene* scene)
+    void ModelManager::_BatchNode(aiNode* node, const aiScene* scene, const glm::mat4& parentTransform,
+        const std::vector<MeshGeometry>& geometries, StaticBatcher& batcher)
+    {
+        const glm::mat4 transform = parentTransform * _ConvertMatrix(node->mTransformation);
+
+        for (unsigned int i = 0; i < node->mNumMeshes; ++i)
+        {
+            const MeshGeometry& geometry = geometries[node->mMeshes[i]];
+            const aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+
+            batcher.Add(geometry.positions, geometry.normals, geometry.texCoords, geometry.tangents, geometry.bitangents,
+                geometry.lightmapTexCoords, IndexView{ geometry.indices.data(), geometry.indices.size(), IndexType::UInt32 },
+                transform, _GetMaterial(mesh->mMaterialIndex, scene));
+        }
+
+        for (unsigned int i = 0; i < node->mNumChildren; ++i)
+            _BatchNode(node->mChildren[i], scene, transform, geometries, batcher);
+    }
+
+    void ModelManager::_ProcessMeshes(const aiScene* scene)
+    {
+        const unsigned int meshCount = scene->mNumMeshes;
+        std::vector<MeshGeometry> geometries = _ExtractGeometries(scene, EngineSettings::Get().importer.optimizeMeshes);
+
+        _meshes.resize(meshCount);
+        for (unsigned int i = 0; i < meshCount; ++i)
+        {
+            _meshes[i] = _CreateMesh(scene->mMeshes[i], std::move(geometries[i]));
+        }
+    }
+
+    std::vector<MeshGeometry> ModelManager::_ExtractGeometries(const aiScene* scene, bool optimize)
+    {
+        LoggerContext ctx("ModelManager", "_ExtractGeometries");
+
+        const auto& importer = EngineSettings::Get().importer;
+
+        const unsigned int meshCount = scene->mNumMeshes;
+        const unsigned int threadCount = std::max(1u, std::min(meshCount,
+            importer.optimizerThreads > 0 ? static_cast<unsigned int>(importer.optimizerThreads) : std::thread::hardware_concurrency()));
+
+        const MeshOptimizer::Settings optimizerSettings = GetOptimizerSettings();
+
+        std::vector<MeshGeometry> geometries(meshCount);
+        std::vector<MeshOptimizer::Stats> stats(meshCount);
+
+        auto start = std::chrono::steady_clock::now();
+
+        // Extraction and optimization are CPU-only; the GPU upload stays on this thread.
+        std::atomic<unsigned int> nextMesh = 0;
+        auto Worker = [&]()
+        {
+            for (unsigned int i = nextMesh++; i < meshCount; i = nextMesh++)
+            {
+                geometries[i] = _ExtractGeometry(scene->mMeshes[i]);
+
+                if (optimize)
+                    stats[i] = MeshOptimizer::Optimize(geometries[i], optimizerSettings);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < threadCount; ++i)
+            workers.emplace_back(Worker);
+
+        Worker();
+
+        for (std::thread& worker : workers)
+            worker.join();
+
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (optimize && meshCount > 0)
+        {
+            std::size_t verticesBefore = 0, verticesAfter = 0, triangles = 0, meshlets = 0;
+            double missesBefore = 0.0, missesAfter = 0.0;
+
+            for (unsigned int i = 0; i < meshCount; ++i)
+            {
+                Logger::Debug("Mesh '{}': {} -> {} vertices, ACMR {:.3f} -> {:.3f}", scene->mMeshes[i]->mName.C_Str(),
+                    stats[i].verticesBefore, stats[i].verticesAfter, stats[i].acmrBefore, stats[i].acmrAfter);
+
+                verticesBefore += stats[i].verticesBefore;
+                verticesAfter += stats[i].verticesAfter;
+                triangles += stats[i].triangles;
+                meshlets += stats[i].meshlets;
+                missesBefore += static_cast<double>(stats[i].acmrBefore) * stats[i].triangles;
+                missesAfter += static_cast<double>(stats[i].acmrAfter) * stats[i].triangles;
+            }
+
+            Logger::Info("Optimized {} meshes in {:.1f} ms on {} thread(s): {} -> {} vertices, ACMR {:.3f} -> {:.3f}, {} meshlets",
+                meshCount, elapsedMs, threadCount, verticesBefore, verticesAfter,
+                triangles > 0 ? missesBefore / triangles : 0.0,
+                triangles > 0 ? missesAfter / triangles : 0.0,
+                meshlets);
+        }
+
+        return geometries;
+    }
+
+    MeshGeometry ModelManager::_ExtractGeometry(const aiMesh* mesh) const
     {
-        LoggerContext ctx("ModelManager", "_ProcessMesh");
+        MeshGeometry geometry;
 
-        Logger::Debug("Processing mesh '{}' with {} vertices and {} faces...", mesh->mName.C_Str(), mesh->mNumVertices, mesh->mNumFaces);
+        const bool hasNormals = mesh->HasNormals();
+        const bool hasTangents = mesh->HasTangentsAndBitangents();
 
-        std::vector<glm::vec3> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> texCoords;
+        // A second UV channel is the lightmap layout, as written by the LightBaker tool.
+        const bool hasLightmap = mesh->HasTextureCoords(1);
 
-        vertices.reserve(mesh->mNumVertices);
-        indices.reserve(mesh->mNumFaces * 3);
-        normals.reserve(mesh->mNumVertices);
-        texCoords.reserve(mesh->mNumVertices);
+        geometry.positions.reserve(mesh->mNumVertices);
+        geometry.indices.reserve(mesh->mNumFaces * 3);
+        geometry.texCoords.reserve(mesh->mNumVertices);
+        if (hasNormals)
+            geometry.normals.reserve(mesh->mNumVertices);
+        if (hasTangents)
+        {
+            geometry.tangents.reserve(mesh->mNumVertices);
+            geometry.bitangents.reserve(mesh->mNumVertices);
+        }
+        if (hasLightmap)
+            geometry.lightmapTexCoords.reserve(mesh->mNumVertices);
 
         for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
         {
-            vertices.push_back(glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z));
-            normals.push_back(glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z));
+            geometry.positions.push_back(glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z));
+
+            if (hasNormals)
+                geometry.normals.push_back(glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z));
             
             if (mesh->mTextureCoords[0]) {
-                texCoords.push_back(glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y));
+                geometry.texCoords.push_back(glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y));
             } else {
-                texCoords.push_back(glm::vec2(0.0f, 0.0f));
+                geometry.texCoords.push_back(glm::vec2(0.0f, 0.0f));
+            }
+
+            if (hasTangents)
+            {
+                geometry.tangents.push_back(glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z));
+                geometry.bitangents.push_back(glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z));
             }
+
+            if (hasLightmap)
+                geometry.lightmapTexCoords.push_back(glm::vec2(mesh->mTextureCoords[1][i].x, mesh->mTextureCoords[1][i].y));
         }
 
         for (unsigned int i = 0; i < mesh->mNumFaces; ++i)
         {
-            aiFace face = mesh->mFaces[i];
+            const aiFace& face = mesh->mFaces[i];
             for (unsigned int j = 0; j < face.mNumIndices; ++j)
             {
-                indices.push_back(face.mIndices[j]);
+                geometry.indices.push_back(face.mIndices[j]);
             }
         }
 
-        auto outMesh = std::make_shared<Mesh>(vertices, indices, normals, texCoords);
-        
-        glm::vec3 aabbMin = {mesh->mAABB.mMin[0], mesh->mAABB.mMin[1], mesh->mAABB.mMin[2]};
-        glm::vec3 aabbMax = {mesh->mAABB.mMax[0], mesh->mAABB.mMax[1], mesh->mAABB.mMax[2]};
+        return geometry;
+    }
+
+    std::shared_ptr<Mesh> ModelManager::_CreateMesh(const aiMesh* mesh, MeshGeometry&& geometry)
+    {
+        LoggerContext ctx("ModelManager", "_CreateMesh");
+
+        Logger::Debug("Uploading mesh '{}' with {} vertices and {} triangles...", mesh->mName.C_Str(), geometry.GetVertexCount(), geometry.GetTriangleCount());
 
-        outMesh->SetAABB({aabbMin, aabbMax});
+        const auto& settings = EngineSettings::Get().renderer;
+
+        auto outMesh = std::make_shared<Mesh>(std::move(geometry.positions), IndexData(geometry.indices),
+            std::move(geometry.normals), std::move(geometry.texCoords), std::move(geometry.tangents), std::move(geometry.bitangents),
+            std::move(geometry.lightmapTexCoords), settings.meshVertexLayout,
+            _currentKeepCPUData ? MeshResidency::CPURetained : settings.meshResidency);
+
+        if (!geometry.meshlets.empty())
+            outMesh->SetMeshlets(std::move(geometry.meshlets));
+
+        _AddMeshStats(*outMesh);
     
         return outMesh;
     }
 
+    void ModelManager::_AddMeshStats(const Mesh& mesh)
+    {
+        const Mesh::MemoryUsage& memory = mesh.GetMemoryUsage();
+
+        _currentMeshCount++;
+        if (mesh.GetIndexType() == IndexType::UInt16)
+            _currentShortIndexMeshes++;
+
+        _currentVertexCount += mesh.GetVerticesCount();
+        _currentVertexBytes += mesh.GetVerticesCount() * mesh.GetVertexStride();
+        _currentGPUBytes += memory.gpuBytes;
+        _currentCPUBytes += memory.cpuBytes + memory.arenaBytes;
+        _currentReleasedBytes += memory.releasedBytes;
+    }
+
     static const char* TextureTypeToString(aiTextureType type)
     {
         switch (type)
@@ -162,6 +403,43 @@ namespace AE
         }
     }
 
+    std::shared_ptr<Material> ModelManager::_GetMaterial(unsigned int index, const aiScene* scene)
+    {
+        _currentMaterialRefs++;
+
+        std::shared_ptr<Material>& material = _materials[index];
+        if (material)
+            return material;
+
+        material = _ProcessMaterial(scene->mMaterials[index], scene);
+
+        if (EngineSettings::Get().importer.shareMaterials)
+            material = _InternMaterial(material);
+
+        return material;
+    }
+
+    std::shared_ptr<Material> ModelManager::_InternMaterial(const std::shared_ptr<Material>& material)
+    {
+        auto& bucket = _materialCache[material->GetContentHash()];
+
+        std::erase_if(bucket, [](const std::weak_ptr<Material>& entry) { return entry.expired(); });
+
+        for (const auto& entry : bucket)
+        {
+            std::shared_ptr<Material> existing = entry.lock();
+            if (existing && *existing == *material)
+            {
+                const bool inModel = std::find(_materials.begin(), _materials.end(), existing) != _materials.end();
+                (inModel ? _currentMaterialsMerged : _currentMaterialsShared)++;
+                return existing;
+            }
+        }
+
+        bucket.push_back(material);
+        return material;
+    }
+
     std::shared_ptr<Material> ModelManager::_ProcessMaterial(aiMaterial* aiMat, const aiScene* scene)
     {
         aiColor3D color;
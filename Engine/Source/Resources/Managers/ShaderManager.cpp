@@ -1,103 +1,161 @@
 #include "Resources/Managers.hpp"
 #include "Resources/Shader.hpp"
+#include "Resources/ShaderCache.hpp"
+#include "Resources/ShaderCompiler.hpp"
+#include "Core/EngineSettings.hpp"
 
 #include <fstream>
 
 namespace AE
 {
     ShaderManager::ShaderManager()
-        : ResourceManager("Shader") {}
+        : ResourceManager("Shader")
+    {
+        const EngineSettings& settings = EngineSettings::Get();
+
+        std::shared_ptr<ShaderCache> cache;
+        if (settings.renderer.enableShaderCache)
+            cache = std::make_shared<ShaderCache>(settings.renderer.shaderCacheDirectory);
+
+        _compiler = std::make_shared<ShaderCompiler>(std::move(cache));
+    }
 
     static std::string ReadFile(const std::string& path);
-    static GLuint CompileShader(GLenum type, const std::string& source);
-    static GLuint LinkProgram(GLuint vertexShader, GLuint fragmentShader);
+    static std::string InjectDefines(const std::string& source, ShaderFeature features);
 
     std::shared_ptr<Shader> ShaderManager::Load(const std::string& name,
         const std::string& vertexPath, const std::string& fragmentPath)
     {
         LoggerContext ctx("ShaderManager", "Load");
 
+        return _LoadFromFiles(name, vertexPath, fragmentPath, false, false);
+    }
+
+    std::shared_ptr<Shader> ShaderManager::LoadFromSource(const std::string& name,
+        const std::string& vertexSrc, const std::string& fragmentSrc)
+    {
+        LoggerContext ctx("ShaderManager", "Load");
+
         if (Has(name))
         {
             Logger::Error("Shader with name '{}' already exists!", name);
             return Get(name);
         }
 
-        if (vertexPath.empty() || fragmentPath.empty())
+        if (vertexSrc.empty() || fragmentSrc.empty())
         {
-            Logger::Error("Invalid params! Paths cannot be empty!");
+            Logger::Error("Invalid parameters! Shader source can't be empty!");
             return nullptr;
         }
 
-        Logger::Info("Loading shader '{}' from: ", name);
-        Logger::Info("\tVertex: '{}'", vertexPath);
-        Logger::Info("\tFragment: '{}'", fragmentPath);
-
-        const std::string vertexSrc = ReadFile(vertexPath);
-        const std::string fragmentSrc = ReadFile(fragmentPath);
+        Logger::Info("Loading shader '{}' from source...", name);
 
-        if (vertexSrc.empty() || fragmentSrc.empty())
-            return nullptr;
+        return _Build(name, vertexSrc, fragmentSrc, false, false);
+    }
 
-        GLuint vertexID = CompileShader(GL_VERTEX_SHADER, vertexSrc);
-        GLuint fragmentID = CompileShader(GL_FRAGMENT_SHADER, fragmentSrc);
-    
-        if (vertexID == 0 || fragmentID == 0)
-            return nullptr;
+    std::shared_ptr<Shader> ShaderManager::LoadPermutations(const std::string& name,
+        const std::string& vertexPath, const std::string& fragmentPath)
+    {
+        LoggerContext ctx("ShaderManager", "LoadPermutations");
 
-        const GLuint programID = LinkProgram(vertexID, fragmentID);
-    
-        glDeleteShader(vertexID);
-        glDeleteShader(fragmentID);
+        return _LoadFromFiles(name, vertexPath, fragmentPath, true, false);
+    }
 
-        if (!programID) return nullptr;
+    std::shared_ptr<Shader> ShaderManager::LoadAsync(const std::string& name,
+        const std::string& vertexPath, const std::string& fragmentPath)
+    {
+        LoggerContext ctx("ShaderManager", "LoadAsync");
 
-        auto shader = std::make_shared<Shader>(programID);
+        return _LoadFromFiles(name, vertexPath, fragmentPath, false, true);
+    }
 
-        Add(name, shader);
+    std::shared_ptr<Shader> ShaderManager::LoadPermutationsAsync(const std::string& name,
+        const std::string& vertexPath, const std::string& fragmentPath)
+    {
+        LoggerContext ctx("ShaderManager", "LoadPermutationsAsync");
 
-        Logger::Info("Shader '{}' loaded successfully! (ID = {})", name, programID);
+        return _LoadFromFiles(name, vertexPath, fragmentPath, true, true);
+    }
 
-        return shader;
+    void ShaderManager::WaitForPending()
+    {
+        _compiler->Flush();
     }
 
-    std::shared_ptr<Shader> ShaderManager::LoadFromSource(const std::string& name,
-        const std::string& vertexSrc, const std::string& fragmentSrc)
+    std::size_t ShaderManager::GetPendingCount() const { return _compiler->GetPendingCount(); }
+    ShaderCache* ShaderManager::GetCache() const { return _compiler->GetCache(); }
+
+    void ShaderManager::_Update()
     {
-        LoggerContext ctx("ShaderManager", "Load");
+        _compiler->Update();
+    }
 
+    std::shared_ptr<Shader> ShaderManager::_LoadFromFiles(const std::string& name,
+        const std::string& vertexPath, const std::string& fragmentPath, bool permutations, bool async)
+    {
         if (Has(name))
         {
             Logger::Error("Shader with name '{}' already exists!", name);
             return Get(name);
         }
 
-        if (vertexSrc.empty() || fragmentSrc.empty())
+        if (vertexPath.empty() || fragmentPath.empty())
         {
-            Logger::Error("Invalid parameters! Shader source can't be empty!");
+            Logger::Error("Invalid params! Paths cannot be empty!");
             return nullptr;
         }
 
-        Logger::Info("Loading shader '{}' from source...", name);
+        Logger::Info("Loading shader{} '{}' from: ", permutations ? " permutations" : "", name);
+        Logger::Info("\tVertex: '{}'", vertexPath);
+        Logger::Info("\tFragment: '{}'", fragmentPath);
 
-        GLuint vertexID = CompileShader(GL_VERTEX_SHADER, vertexSrc);
-        GLuint fragmentID = CompileShader(GL_FRAGMENT_SHADER, fragmentSrc);
+        const std::string vertexSrc = ReadFile(vertexPath);
+        const std::string fragmentSrc = ReadFile(fragmentPath);
 
-        if (vertexID == 0 || fragmentID == 0)
+        if (vertexSrc.empty() || fragmentSrc.empty())
             return nullptr;
 
-        const GLuint programID = LinkProgram(vertexID, fragmentID);
-    
-        glDeleteShader(vertexID);
-        glDeleteShader(fragmentID);
+        return _Build(name, vertexSrc, fragmentSrc, permutations, async);
+    }
+
+    std::shared_ptr<Shader> ShaderManager::_Build(const std::string& name,
+        const std::string& vertexSrc, const std::string& fragmentSrc, bool permutations, bool async)
+    {
+        // For permutations the base program is the variant without any features.
+        const std::string baseVertexSrc = permutations ? InjectDefines(vertexSrc, ShaderFeature::None) : vertexSrc;
+        const std::string baseFragmentSrc = permutations ? InjectDefines(fragmentSrc, ShaderFeature::None) : fragmentSrc;
+
+        std::shared_ptr<Shader> shader;
+        if (async)
+        {
+            shader = _compiler->CompileAsync(name, baseVertexSrc, baseFragmentSrc, ShaderFeature::None);
+        }
+        else
+        {
+            const GLuint programID = _compiler->Compile(baseVertexSrc, baseFragmentSrc);
+            if (!programID) return nullptr;
 
-        if (!programID) return nullptr;
+            shader = std::make_shared<Shader>(programID);
+        }
 
-        auto shader = std::make_shared<Shader>(programID);
+        if (permutations)
+        {
+            shader->_SetVariantCompiler([compiler = _compiler, name, vertexSrc, fragmentSrc](ShaderFeature features)
+            {
+                return compiler->CompileAsync(name + "#" + std::to_string(static_cast<uint32_t>(features)),
+                    InjectDefines(vertexSrc, features),
+                    InjectDefines(fragmentSrc, features),
+                    features
+                );
+            });
+        }
 
         Add(name, shader);
 
-        Logger::Info("Shader '{}' loaded successfully! (ID = {})", name, programID);
+        if (shader->IsPending())
+            Logger::Info("Shader '{}' queued for compilation", name);
+        else
+            Logger::Info("Shader '{}' loaded successfully! (ID = {})", name, shader->GetID());
 
         return shader;
     }
@@ -116,63 +174,50 @@ namespace AE
         return buffer.str();
     }
 
-    static GLuint CompileShader(GLenum type, const std::string& source)
+    static std::string InjectDefines(const std::string& source, ShaderFeature features)
     {
-        const std::string typeStr = type == GL_VERTEX_SHADER ? "Vertex" : "Fragment";
-        
-        Logger::Debug("Compiling {} shader...", typeStr);
-        
-        GLuint shader = glCreateShader(type);
-        const char* src = source.c_str();
-        glShaderSource(shader, 1, &src, nullptr);
-        glCompileShader(shader);
-    
-        GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success)
+        static const std::pair<ShaderFeature, const char*> defines[] = {
+            { ShaderFeature::DiffuseTexture,  "HAS_DIFFUSE_TEXTURE" },
+            { ShaderFeature::SpecularTexture, "HAS_SPECULAR_TEXTURE" },
+            { ShaderFeature::EmissiveTexture, "HAS_EMISSIVE_TEXTURE" },
+            { ShaderFeature::NormalTexture,   "HAS_NORMAL_TEXTURE" },
+            { ShaderFeature::OpacityTexture,  "HAS_OPACITY_TEXTURE" },
+            { ShaderFeature::Wireframe,       "RENDER_WIREFRAME" },
+            { ShaderFeature::OctahedralNormal, "HAS_OCTAHEDRAL_NORMAL" },
+            { ShaderFeature::QTangentFrame,    "HAS_QTANGENT" },
+            { ShaderFeature::Lightmap,         "HAS_LIGHTMAP" },
+            { ShaderFeature::BakedLighting,    "BAKED_LIGHTING" }
+        };
+
+        std::string block;
+        for (const auto& [feature, define] : defines)
         {
-            GLint logLength = 0;
-            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-            std::string infoLog(logLength, '\0');
-            glGetShaderInfoLog(shader, logLength, nullptr, infoLog.data());
-            
-            Logger::Error("{} shader compilation failed: {}", typeStr, infoLog);
-            
-            glDeleteShader(shader);
-            return 0;
+            if (HasFeature(features, feature))
+                block += std::string("#define ") + define + "\n";
         }
 
-        Logger::Debug("{} shader compiled! (ID = {})", typeStr, shader);
-    
-        return shader;
-    }
-    
-    static GLuint LinkProgram(GLuint vertexShader, GLuint fragmentShader)
-    {
-        Logger::Debug("Linking shader program...");
+        // #version must stay the first directive, so the block goes right after it.
+        std::size_t insertPos = 0;
+        int line = 1;
 
-        GLuint program = glCreateProgram();
-        glAttachShader(program, vertexShader);
-        glAttachShader(program, fragmentShader);
-        glLinkProgram(program);
-    
-        GLint success;
-        glGetProgramiv(program, GL_LINK_STATUS, &success);
-        if (!success)
+        std::size_t versionPos = source.find("#version");
+        if (versionPos != std::string::npos)
         {
-            GLint logLength = 0;
-            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
-            std::string infoLog(logLength, '\0');
-            glGetProgramInfoLog(program, logLength, nullptr, infoLog.data());
-    
-            Logger::Error("Shader linking failed: {}", infoLog);
-            
-            glDeleteProgram(program);
-            return 0;
+            std::size_t lineEnd = source.find('\n', versionPos);
+            insertPos = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+            line = 1 + static_cast<int>(std::count(source.begin(), source.begin() + insertPos, '\n'));
         }
 
-        Logger::Debug("Shader program linked! (ID = {})", program);
-    
-        return program;
+        if (block.empty())
+            return source;
+
+        // Keep compiler error line numbers matching the file on disk.
+        block += "#line " + std::to_string(line) + "\n";
+
+        std::string result = source;
+        if (insertPos == source.size() && !source.empty() && source.back() != '\n')
+            result += '\n';
+        result.insert(std::min(insertPos, result.size()), block);
+        return result;
     }
-}
+}
\ No newline at end of file
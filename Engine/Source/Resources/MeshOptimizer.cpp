@@ -0,0 +1,837 @@
+#include "Resources/MeshOptimizer.hpp"
+#include "Math/AABB.hpp"
+#include "Math/BoundingSphere.hpp"
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+
+namespace AE
+{
+    // Forsyth, "Linear-Speed Vertex Cache Optimisation" (2006)
+    static constexpr int FORSYTH_CACHE_SIZE = 32;
+    static constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+    static constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+    static constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+    static constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+    static float ForsythVertexScore(int cachePosition, uint32_t remainingValence)
+    {
+        if (remainingValence == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+            {
+                score = FORSYTH_LAST_TRIANGLE_SCORE;
+            }
+            else
+            {
+                float t = 1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+                score = std::pow(t, FORSYTH_CACHE_DECAY_POWER);
+            }
+        }
+
+        score += FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingValence), -FORSYTH_VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    // FIFO post-transform cache simulation. Calls 'onTriangle(triangle, misses)' per triangle.
+    template<typename Callback>
+    static std::size_t SimulateCache(const std::vector<uint32_t>& indices, std::size_t vertexCount, int cacheSize, Callback onTriangle)
+    {
+        std::vector<uint32_t> stamp(vertexCount, 0);
+        uint32_t time = static_cast<uint32_t>(cacheSize) + 1;
+
+        std::size_t misses = 0;
+        for (std::size_t t = 0; t < indices.size() / 3; ++t)
+        {
+            int triangleMisses = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = indices[t * 3 + k];
+                if (time - stamp[v] > static_cast<uint32_t>(cacheSize))
+                {
+                    stamp[v] = time++;
+                    triangleMisses++;
+                }
+            }
+
+            misses += triangleMisses;
+            onTriangle(t, triangleMisses);
+        }
+
+        return misses;
+    }
+
+    template<typename T>
+    static void RemapAttribute(std::vector<T>& attribute, const std::vector<uint32_t>& remap, std::size_t newCount)
+    {
+        if (attribute.size() != remap.size())
+            return;
+
+        std::vector<T> result(newCount);
+        for (std::size_t i = 0; i < remap.size(); ++i)
+        {
+            if (remap[i] != std::numeric_limits<uint32_t>::max())
+                result[remap[i]] = attribute[i];
+        }
+
+        attribute.swap(result);
+    }
+
+    MeshOptimizer::Stats MeshOptimizer::Optimize(MeshGeometry& geometry)
+    {
+        return Optimize(geometry, Settings{});
+    }
+
+    MeshOptimizer::Stats MeshOptimizer::Optimize(MeshGeometry& geometry, const Settings& settings)
+    {
+        Stats stats;
+        stats.verticesBefore = geometry.GetVertexCount();
+
+        if (geometry.positions.empty())
+            return stats;
+
+        // Non-indexed input is treated as an identity index buffer, welding then shares vertices.
+        if (geometry.indices.empty())
+        {
+            geometry.indices.resize(geometry.positions.size() - geometry.positions.size() % 3);
+            std::iota(geometry.indices.begin(), geometry.indices.end(), 0u);
+        }
+
+        stats.acmrBefore = ComputeACMR(geometry.indices, geometry.GetVertexCount(), settings.cacheSize);
+
+        if (settings.weldVertices)
+            WeldVertices(geometry);
+
+        if (settings.optimizeVertexCache)
+            OptimizeVertexCache(geometry.indices, geometry.GetVertexCount());
+
+        if (settings.optimizeOverdraw)
+            OptimizeOverdraw(geometry.indices, geometry.positions, settings.cacheSize, settings.overdrawThreshold);
+
+        // Vertex fetch ordering below only renames vertices, the meshlet ranges and bounds stay valid.
+        if (settings.buildMeshlets && geometry.GetTriangleCount() > settings.meshletMaxTriangles)
+        {
+            geometry.meshlets = BuildMeshlets(geometry.indices, geometry.positions,
+                settings.meshletMaxVertices, settings.meshletMaxTriangles, settings.meshletConeWeight);
+        }
+
+        if (settings.optimizeVertexFetch)
+            OptimizeVertexFetch(geometry);
+
+        stats.verticesAfter = geometry.GetVertexCount();
+        stats.triangles = geometry.GetTriangleCount();
+        stats.meshlets = geometry.meshlets.size();
+        stats.acmrAfter = ComputeACMR(geometry.indices, geometry.GetVertexCount(), settings.cacheSize);
+
+        return stats;
+    }
+
+    std::size_t MeshOptimizer::WeldVertices(MeshGeometry& geometry)
+    {
+        const std::size_t count = geometry.GetVertexCount();
+
+        const bool hasNormals = geometry.normals.size() == count;
+        const bool hasTexCoords = geometry.texCoords.size() == count;
+        const bool hasTangents = geometry.tangents.size() == count;
+        const bool hasBitangents = geometry.bitangents.size() == count;
+        const bool hasLightmap = geometry.lightmapTexCoords.size() == count;
+
+        auto Hash = [&](uint32_t i)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            auto Mix = [&hash](const void* data, std::size_t size)
+            {
+                const unsigned char* bytes = static_cast<const unsigned char*>(data);
+                for (std::size_t b = 0; b < size; ++b)
+                {
+                    hash ^= bytes[b];
+                    hash *= 1099511628211ull;
+                }
+            };
+
+            Mix(&geometry.positions[i], sizeof(glm::vec3));
+            if (hasNormals) Mix(&geometry.normals[i], sizeof(glm::vec3));
+            if (hasTexCoords) Mix(&geometry.texCoords[i], sizeof(glm::vec2));
+            if (hasTangents) Mix(&geometry.tangents[i], sizeof(glm::vec3));
+            if (hasBitangents) Mix(&geometry.bitangents[i], sizeof(glm::vec3));
+            if (hasLightmap) Mix(&geometry.lightmapTexCoords[i], sizeof(glm::vec2));
+
+            return static_cast<std::size_t>(hash);
+        };
+
+        auto Equal = [&](uint32_t a, uint32_t b)
+        {
+            return std::memcmp(&geometry.positions[a], &geometry.positions[b], sizeof(glm::vec3)) == 0
+                && (!hasNormals || std::memcmp(&geometry.normals[a], &geometry.normals[b], sizeof(glm::vec3)) == 0)
+                && (!hasTexCoords || std::memcmp(&geometry.texCoords[a], &geometry.texCoords[b], sizeof(glm::vec2)) == 0)
+                && (!hasTangents || std::memcmp(&geometry.tangents[a], &geometry.tangents[b], sizeof(glm::vec3)) == 0)
+                && (!hasBitangents || std::memcmp(&geometry.bitangents[a], &geometry.bitangents[b], sizeof(glm::vec3)) == 0)
+                && (!hasLightmap || std::memcmp(&geometry.lightmapTexCoords[a], &geometry.lightmapTexCoords[b], sizeof(glm::vec2)) == 0);
+        };
+
+        // Keys are indices of already compacted vertices, whose data no longer moves.
+        std::unordered_set<uint32_t, decltype(Hash), decltype(Equal)> unique(count, Hash, Equal);
+        std::vector<uint32_t> remap(count);
+
+        uint32_t next = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            auto it = unique.find(i);
+            if (it != unique.end())
+            {
+                remap[i] = *it;
+                continue;
+            }
+
+            // First occurrences come in increasing order, so compacting in place is safe.
+            remap[i] = next;
+            geometry.positions[next] = geometry.positions[i];
+            if (hasNormals) geometry.normals[next] = geometry.normals[i];
+            if (hasTexCoords) geometry.texCoords[next] = geometry.texCoords[i];
+            if (hasTangents) geometry.tangents[next] = geometry.tangents[i];
+            if (hasBitangents) geometry.bitangents[next] = geometry.bitangents[i];
+            if (hasLightmap) geometry.lightmapTexCoords[next] = geometry.lightmapTexCoords[i];
+            unique.insert(next++);
+        }
+
+        geometry.positions.resize(next);
+        if (hasNormals) geometry.normals.resize(next);
+        if (hasTexCoords) geometry.texCoords.resize(next);
+        if (hasTangents) geometry.tangents.resize(next);
+        if (hasBitangents) geometry.bitangents.resize(next);
+        if (hasLightmap) geometry.lightmapTexCoords.resize(next);
+
+        for (uint32_t& index : geometry.indices)
+            index = remap[index];
+
+        return next;
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, std::size_t vertexCount)
+    {
+        const std::size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+            return;
+
+        // Vertex -> live triangles, as a compact adjacency list.
+        std::vector<uint32_t> remaining(vertexCount, 0);
+        for (std::size_t i = 0; i < triangleCount * 3; ++i)
+            remaining[indices[i]]++;
+
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (std::size_t v = 0; v < vertexCount; ++v)
+            offsets[v + 1] = offsets[v] + remaining[v];
+
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                for (int k = 0; k < 3; ++k)
+                    adjacency[fill[indices[t * 3 + k]]++] = t;
+            }
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (std::size_t v = 0; v < vertexCount; ++v)
+            vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+
+        std::vector<float> triangleScore(triangleCount);
+        for (std::size_t t = 0; t < triangleCount; ++t)
+            triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> output;
+        output.reserve(triangleCount * 3);
+
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> newCache;
+        cache.reserve(FORSYTH_CACHE_SIZE + 3);
+        newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+        uint32_t best = static_cast<uint32_t>(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+        std::size_t cursor = 0;
+
+        while (true)
+        {
+            emitted[best] = true;
+
+            const uint32_t triangle[3] = { indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2] };
+
+            newCache.clear();
+            for (uint32_t v : triangle)
+            {
+                output.push_back(v);
+
+                // Unlink the triangle from the vertex's live list.
+                uint32_t* begin = adjacency.data() + offsets[v];
+                uint32_t* end = begin + remaining[v];
+                uint32_t* it = std::find(begin, end, best);
+                if (it != end)
+                {
+                    *it = *(end - 1);
+                    remaining[v]--;
+                }
+
+                if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+                    newCache.push_back(v);
+            }
+
+            for (uint32_t v : cache)
+            {
+                if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+                    newCache.push_back(v);
+            }
+
+            // Rescore everything that entered, moved in, or fell out of the cache.
+            for (std::size_t i = 0; i < newCache.size(); ++i)
+            {
+                uint32_t v = newCache[i];
+                cachePosition[v] = i < static_cast<std::size_t>(FORSYTH_CACHE_SIZE) ? static_cast<int>(i) : -1;
+
+                float score = ForsythVertexScore(cachePosition[v], remaining[v]);
+                float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+
+                for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a)
+                    triangleScore[adjacency[a]] += delta;
+            }
+
+            if (newCache.size() > static_cast<std::size_t>(FORSYTH_CACHE_SIZE))
+                newCache.resize(FORSYTH_CACHE_SIZE);
+            cache.swap(newCache);
+
+            // The next triangle is the best one touching the cache...
+            float bestScore = -std::numeric_limits<float>::max();
+            bool found = false;
+            for (uint32_t v : cache)
+            {
+                for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a)
+                {
+                    uint32_t t = adjacency[a];
+                    if (triangleScore[t] > bestScore)
+                    {
+                        bestScore = triangleScore[t];
+                        best = t;
+                        found = true;
+                    }
+                }
+            }
+
+            // ...or, when the cache has nothing left to offer, the next unused one in order.
+            if (!found)
+            {
+                while (cursor < triangleCount && emitted[cursor])
+                    cursor++;
+
+                if (cursor == triangleCount)
+                    break;
+
+                best = static_cast<uint32_t>(cursor);
+            }
+        }
+
+        indices.swap(output);
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+        int cacheSize, float threshold)
+    {
+        // Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (2007):
+        // split the cache-ordered list where the cache restarts, then draw outward-facing clusters first.
+        const std::size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+            return;
+
+        std::vector<std::size_t> clusterStarts;
+        const std::size_t baseMisses = SimulateCache(indices, positions.size(), cacheSize,
+            [&](std::size_t t, int misses)
+            {
+                if (t == 0 || misses == 3)
+                    clusterStarts.push_back(t);
+            });
+
+        if (clusterStarts.size() < 2)
+            return;
+
+        clusterStarts.push_back(triangleCount);
+        const std::size_t clusterCount = clusterStarts.size() - 1;
+
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+
+        std::vector<glm::vec3> clusterCentroid(clusterCount, glm::vec3(0.0f));
+        std::vector<glm::vec3> clusterNormal(clusterCount, glm::vec3(0.0f));
+        std::vector<float> clusterArea(clusterCount, 0.0f);
+
+        for (std::size_t c = 0; c < clusterCount; ++c)
+        {
+            for (std::size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t)
+            {
+                const glm::vec3& a = positions[indices[t * 3]];
+                const glm::vec3& b = positions[indices[t * 3 + 1]];
+                const glm::vec3& d = positions[indices[t * 3 + 2]];
+
+                glm::vec3 normal = glm::cross(b - a, d - a);
+                float area = glm::length(normal);
+                glm::vec3 centroid = (a + b + d) / 3.0f;
+
+                clusterCentroid[c] += centroid * area;
+                clusterNormal[c] += normal;
+                clusterArea[c] += area;
+            }
+
+            meshCentroid += clusterCentroid[c];
+            meshArea += clusterArea[c];
+        }
+
+        if (meshArea <= 0.0f)
+            return;
+
+        meshCentroid /= meshArea;
+
+        std::vector<float> sortKey(clusterCount, 0.0f);
+        for (std::size_t c = 0; c < clusterCount; ++c)
+        {
+            float normalLength = glm::length(clusterNormal[c]);
+            if (clusterArea[c] <= 0.0f || normalLength <= 0.0f)
+                continue;
+
+            glm::vec3 centroid = clusterCentroid[c] / clusterArea[c];
+            sortKey[c] = glm::dot(centroid - meshCentroid, clusterNormal[c] / normalLength);
+        }
+
+        std::vector<std::size_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return sortKey[a] > sortKey[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (std::size_t c : order)
+        {
+            result.insert(result.end(),
+                indices.begin() + clusterStarts[c] * 3,
+                indices.begin() + clusterStarts[c + 1] * 3);
+        }
+
+        // Only keep the new order if it does not give back too much of the vertex cache win.
+        const std::size_t newMisses = SimulateCache(result, positions.size(), cacheSize, [](std::size_t, int) {});
+        if (static_cast<float>(newMisses) <= static_cast<float>(baseMisses) * threshold)
+            indices.swap(result);
+    }
+
+    std::vector<Meshlet> MeshOptimizer::BuildMeshlets(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+        std::size_t maxVertices, std::size_t maxTriangles, float coneWeight)
+    {
+        constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        const std::size_t triangleCount = indices.size() / 3;
+        const std::size_t vertexCount = positions.size();
+
+        std::vector<Meshlet> meshlets;
+        if (triangleCount == 0 || maxVertices < 3 || maxTriangles == 0)
+            return meshlets;
+
+        std::vector<glm::vec3> triangleNormal(triangleCount);
+        std::vector<glm::vec3> triangleCentroid(triangleCount);
+
+        // Vertex -> triangle adjacency, in CSR form.
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+
+        for (std::size_t t = 0; t < triangleCount; ++t)
+        {
+            const glm::vec3& a = positions[indices[t * 3]];
+            const glm::vec3& b = positions[indices[t * 3 + 1]];
+            const glm::vec3& c = positions[indices[t * 3 + 2]];
+
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float length = glm::length(normal);
+
+            triangleNormal[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+            triangleCentroid[t] = (a + b + c) / 3.0f;
+
+            for (int k = 0; k < 3; ++k)
+                adjacencyOffset[indices[t * 3 + k] + 1]++;
+        }
+
+        for (std::size_t v = 0; v < vertexCount; ++v)
+            adjacencyOffset[v + 1] += adjacencyOffset[v];
+
+        {
+            std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (std::size_t t = 0; t < triangleCount; ++t)
+                for (int k = 0; k < 3; ++k)
+                    adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> vertexSlot(vertexCount, NONE);
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        std::vector<uint32_t> vertices;
+        std::vector<uint32_t> triangles;
+        std::vector<glm::vec3> meshletPositions;
+        glm::vec3 normalSum(0.0f);
+        AABB bounds;
+
+        auto MissingVertices = [&](std::size_t t)
+        {
+            return (vertexSlot[indices[t * 3]] == NONE ? 1u : 0u)
+                + (vertexSlot[indices[t * 3 + 1]] == NONE ? 1u : 0u)
+                + (vertexSlot[indices[t * 3 + 2]] == NONE ? 1u : 0u);
+        };
+
+        auto Fits = [&](std::size_t t)
+        {
+            return triangles.size() < maxTriangles && vertices.size() + MissingVertices(t) <= maxVertices;
+        };
+
+        auto Add = [&](std::size_t t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = indices[t * 3 + k];
+                if (vertexSlot[v] != NONE)
+                    continue;
+
+                vertexSlot[v] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(v);
+
+                if (vertices.size() == 1)
+                    bounds = AABB(positions[v], positions[v]);
+                else
+                    bounds.Expand(positions[v]);
+            }
+
+            emitted[t] = true;
+            triangles.push_back(static_cast<uint32_t>(t));
+            normalSum += triangleNormal[t];
+        };
+
+        auto Flush = [&]()
+        {
+            Meshlet meshlet;
+            meshlet.firstIndex = static_cast<uint32_t>(result.size());
+            meshlet.triangleCount = static_cast<uint32_t>(triangles.size());
+            meshlet.vertexCount = static_cast<uint32_t>(vertices.size());
+
+            meshletPositions.clear();
+            for (uint32_t v : vertices)
+            {
+                meshletPositions.push_back(positions[v]);
+                vertexSlot[v] = NONE;
+            }
+
+            BoundingSphere sphere = BoundingSphere::FromPoints(meshletPositions);
+            meshlet.center = sphere.center;
+            meshlet.radius = sphere.radius;
+
+            // Normal cone as in meshoptimizer's meshopt_computeClusterBounds: the apex is the point on
+            // the axis behind every triangle's plane, the cutoff is sin() of the cone's half angle.
+            float axisLength = glm::length(normalSum);
+            glm::vec3 axis = axisLength > 0.0f ? normalSum / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+
+            float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+            for (uint32_t t : triangles)
+            {
+                if (triangleNormal[t] != glm::vec3(0.0f))
+                    minDot = std::min(minDot, glm::dot(triangleNormal[t], axis));
+            }
+
+            // A cone wider than ~168 degrees culls next to nothing and makes the apex unstable.
+            if (minDot > 0.1f)
+            {
+                float maxT = 0.0f;
+                for (uint32_t t : triangles)
+                {
+                    const glm::vec3& normal = triangleNormal[t];
+                    if (normal == glm::vec3(0.0f))
+                        continue;
+
+                    float distance = glm::dot(meshlet.center - positions[indices[t * 3]], normal);
+                    maxT = std::max(maxT, distance / glm::dot(axis, normal));
+                }
+
+                meshlet.coneAxis = axis;
+                meshlet.coneApex = meshlet.center - axis * maxT;
+                meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+
+            for (uint32_t t : triangles)
+                result.insert(result.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+
+            meshlets.push_back(meshlet);
+
+            vertices.clear();
+            triangles.clear();
+            normalSum = glm::vec3(0.0f);
+        };
+
+        std::size_t seed = 0;
+        while (true)
+        {
+            // Best unemitted triangle sharing a vertex with the meshlet: fewest new vertices first,
+            // then the one closest to the meshlet's average normal.
+            std::size_t best = NONE;
+            float bestScore = std::numeric_limits<float>::max();
+
+            const float normalLength = glm::length(normalSum);
+            const glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+
+            for (uint32_t v : vertices)
+            {
+                for (uint32_t a = adjacencyOffset[v]; a < adjacencyOffset[v + 1]; ++a)
+                {
+                    const uint32_t t = adjacency[a];
+                    if (emitted[t] || !Fits(t))
+                        continue;
+
+                    float score = static_cast<float>(MissingVertices(t))
+                        + coneWeight * (1.0f - glm::dot(triangleNormal[t], axis));
+
+                    if (score < bestScore || (score == bestScore && t < best))
+                    {
+                        best = t;
+                        bestScore = score;
+                    }
+                }
+            }
+
+            if (best == NONE)
+            {
+                while (seed < triangleCount && emitted[seed])
+                    seed++;
+
+                if (seed == triangleCount)
+                    break;
+
+                // Disconnected pieces join the current meshlet only if they are close enough
+                // not to blow up its bounds, otherwise they start the next one.
+                if (!triangles.empty())
+                {
+                    const float radius = glm::length(bounds.GetExtents());
+                    if (!Fits(seed) || glm::length(triangleCentroid[seed] - bounds.GetCenter()) > radius)
+                        Flush();
+                }
+
+                best = seed;
+            }
+
+            Add(best);
+        }
+
+        if (!triangles.empty())
+            Flush();
+
+        indices.swap(result);
+        return meshlets;
+    }
+
+    std::size_t MeshOptimizer::OptimizeVertexFetch(MeshGeometry& geometry)
+    {
+        const std::size_t count = geometry.GetVertexCount();
+
+        std::vector<uint32_t> remap(count, std::numeric_limits<uint32_t>::max());
+        uint32_t next = 0;
+        for (uint32_t& index : geometry.indices)
+        {
+            if (remap[index] == std::numeric_limits<uint32_t>::max())
+                remap[index] = next++;
+
+            index = remap[index];
+        }
+
+        RemapAttribute(geometry.positions, remap, next);
+        RemapAttribute(geometry.normals, remap, next);
+        RemapAttribute(geometry.texCoords, remap, next);
+        RemapAttribute(geometry.tangents, remap, next);
+        RemapAttribute(geometry.bitangents, remap, next);
+        RemapAttribute(geometry.lightmapTexCoords, remap, next);
+
+        return next;
+    }
+
+    std::size_t MeshOptimizer::SimplifyClustered(MeshGeometry& geometry, float cellSize)
+    {
+        if (geometry.positions.empty())
+            return geometry.GetTriangleCount();
+
+        return SimplifyClustered(geometry, cellSize, AABB::FromPoints(geometry.positions).min);
+    }
+
+    std::size_t MeshOptimizer::SimplifyClustered(MeshGeometry& geometry, float cellSize, const glm::vec3& gridOrigin)
+    {
+        const std::size_t vertexCount = geometry.GetVertexCount();
+        if (vertexCount == 0 || geometry.indices.empty() || cellSize <= 0.0f)
+            return geometry.GetTriangleCount();
+
+        const bool hasNormals = geometry.normals.size() == vertexCount;
+        const bool hasTexCoords = geometry.texCoords.size() == vertexCount;
+
+        // Symmetric 4x4 quadric, upper triangle only.
+        struct Cluster
+        {
+            double q[10] = {};
+            glm::vec3 position = glm::vec3(0.0f);
+            glm::vec3 normal = glm::vec3(0.0f);
+            glm::vec2 texCoord = glm::vec2(0.0f);
+            uint32_t count = 0;
+            glm::ivec3 cell;
+        };
+
+        std::vector<Cluster> clusters;
+        std::vector<uint32_t> vertexCluster(vertexCount);
+        std::unordered_map<uint64_t, uint32_t> cellIndex;
+        cellIndex.reserve(vertexCount / 4);
+
+        for (std::size_t v = 0; v < vertexCount; ++v)
+        {
+            const glm::ivec3 cell(glm::floor((geometry.positions[v] - gridOrigin) / cellSize));
+            const uint64_t key = (static_cast<uint64_t>(cell.x) & 0x1fffff)
+                | ((static_cast<uint64_t>(cell.y) & 0x1fffff) << 21)
+                | ((static_cast<uint64_t>(cell.z) & 0x1fffff) << 42);
+
+            auto [it, inserted] = cellIndex.try_emplace(key, static_cast<uint32_t>(clusters.size()));
+            if (inserted)
+            {
+                clusters.emplace_back();
+                clusters.back().cell = cell;
+            }
+
+            Cluster& cluster = clusters[it->second];
+            cluster.position += geometry.positions[v];
+            if (hasNormals)
+                cluster.normal += geometry.normals[v];
+            if (hasTexCoords)
+                cluster.texCoord += geometry.texCoords[v];
+            cluster.count++;
+
+            vertexCluster[v] = it->second;
+        }
+
+        // Area-weighted plane quadrics of every triangle go to the clusters of its corners.
+        for (std::size_t i = 0; i + 2 < geometry.indices.size(); i += 3)
+        {
+            const glm::vec3& p0 = geometry.positions[geometry.indices[i]];
+            const glm::vec3 cross = glm::cross(geometry.positions[geometry.indices[i + 1]] - p0, geometry.positions[geometry.indices[i + 2]] - p0);
+
+            const float length = glm::length(cross);
+            if (length <= 0.0f) continue;
+
+            const glm::vec3 normal = cross / length;
+            const double nx = normal.x, ny = normal.y, nz = normal.z;
+            const double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+            const double area = 0.5 * length;
+
+            const double plane[10] = { nx * nx, nx * ny, nx * nz, nx * d, ny * ny, ny * d, ny * nz, nz * nz, nz * d, d * d };
+
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                Cluster& cluster = clusters[vertexCluster[geometry.indices[i + corner]]];
+                for (int k = 0; k < 10; ++k)
+                    cluster.q[k] += plane[k] * area;
+            }
+        }
+
+        std::vector<glm::vec3> positions(clusters.size());
+        std::vector<glm::vec3> normals(hasNormals ? clusters.size() : 0);
+        std::vector<glm::vec2> texCoords(hasTexCoords ? clusters.size() : 0);
+
+        for (std::size_t c = 0; c < clusters.size(); ++c)
+        {
+            const Cluster& cluster = clusters[c];
+            const float inverseCount = 1.0f / static_cast<float>(cluster.count);
+            const glm::vec3 mean = cluster.position * inverseCount;
+
+            // Solve A x = -b of the quadric with Cramer's rule; flat or degenerate cells keep the mean.
+            const double* q = cluster.q;
+            const double det = q[0] * (q[4] * q[7] - q[6] * q[6]) - q[1] * (q[1] * q[7] - q[6] * q[2]) + q[2] * (q[1] * q[6] - q[4] * q[2]);
+            const double trace = q[0] + q[4] + q[7];
+
+            glm::vec3 position = mean;
+            if (std::abs(det) > 1e-9 * trace * trace * trace)
+            {
+                const double bx = -q[3], by = -q[5], bz = -q[8];
+                const glm::vec3 solved(
+                    static_cast<float>((bx * (q[4] * q[7] - q[6] * q[6]) - q[1] * (by * q[7] - q[6] * bz) + q[2] * (by * q[6] - q[4] * bz)) / det),
+                    static_cast<float>((q[0] * (by * q[7] - bz * q[6]) - bx * (q[1] * q[7] - q[6] * q[2]) + q[2] * (q[1] * bz - by * q[2])) / det),
+                    static_cast<float>((q[0] * (q[4] * bz - q[6] * by) - q[1] * (q[1] * bz - by * q[2]) + bx * (q[1] * q[6] - q[4] * q[2])) / det));
+
+                // Thin features can push the optimum far away; keep it near its cell.
+                const glm::vec3 cellMin = gridOrigin + glm::vec3(cluster.cell.x, cluster.cell.y, cluster.cell.z) * cellSize;
+                const AABB limit(cellMin - glm::vec3(cellSize * 0.5f), cellMin + glm::vec3(cellSize * 1.5f));
+                if (limit.Contains(solved))
+                    position = solved;
+            }
+
+            positions[c] = position;
+            if (hasNormals)
+            {
+                const float length = glm::length(cluster.normal);
+                normals[c] = length > 0.0f ? cluster.normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+            if (hasTexCoords)
+                texCoords[c] = cluster.texCoord * inverseCount;
+        }
+
+        // Triangles with two corners in one cell collapse; duplicates of the same three cells are dropped.
+        std::vector<uint32_t> indices;
+        indices.reserve(geometry.indices.size() / 2);
+
+        // Cluster ids pack into one key up to 2^21 clusters, far beyond any sensible proxy.
+        const bool dedupe = clusters.size() < (std::size_t(1) << 21);
+        std::unordered_set<uint64_t> seen;
+        seen.reserve(dedupe ? geometry.indices.size() / 3 : 0);
+
+        for (std::size_t i = 0; i + 2 < geometry.indices.size(); i += 3)
+        {
+            uint32_t c[3] = { vertexCluster[geometry.indices[i]], vertexCluster[geometry.indices[i + 1]], vertexCluster[geometry.indices[i + 2]] };
+            if (c[0] == c[1] || c[1] == c[2] || c[0] == c[2])
+                continue;
+
+            // Rotate the smallest first so the key keeps the winding; opposite windings are both kept.
+            while (c[0] > c[1] || c[0] > c[2])
+                std::rotate(c, c + 1, c + 3);
+
+            const uint64_t key = static_cast<uint64_t>(c[0]) | (static_cast<uint64_t>(c[1]) << 21) | (static_cast<uint64_t>(c[2]) << 42);
+            if (dedupe && !seen.insert(key).second)
+                continue;
+
+            indices.insert(indices.end(), c, c + 3);
+        }
+
+        geometry.positions = std::move(positions);
+        geometry.normals = std::move(normals);
+        geometry.texCoords = std::move(texCoords);
+        geometry.tangents.clear();
+        geometry.bitangents.clear();
+        geometry.lightmapTexCoords.clear();
+        geometry.indices = std::move(indices);
+        geometry.meshlets.clear();
+
+        OptimizeVertexFetch(geometry);
+
+        return geometry.GetTriangleCount();
+    }
+
+    float MeshOptimizer::ComputeACMR(const std::vector<uint32_t>& indices, std::size_t vertexCount, int cacheSize)
+    {
+        const std::size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return 0.0f;
+
+        const std::size_t misses = SimulateCache(indices, vertexCount, cacheSize, [](std::size_t, int) {});
+        return static_cast<float>(misses) / static_cast<float>(triangleCount);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "Resources/Model.hpp"
+#include "Rendering/Mesh.hpp"
+#include "Core/Logger.hpp"
+
+namespace AE
+{
+    void Model::Flatten()
+    {
+        LoggerContext ctx("Model", "Flatten");
+
+        _drawItems.clear();
+        _triangleCount = 0;
+
+        if (root)
+            _FlattenNode(root.get(), glm::mat4(1.0f));
+
+        if (_drawItems.empty())
+        {
+            _sphere = BoundingSphere();
+            _bounds = AABB();
+            return;
+        }
+
+        _bounds = _drawItems[0].bounds;
+        for (const DrawItem& item : _drawItems)
+            _bounds.Expand(item.bounds);
+
+        // Box corners are enough for a sphere around the whole model.
+        std::vector<glm::vec3> corners;
+        corners.reserve(_drawItems.size() * 8);
+        for (const DrawItem& item : _drawItems)
+        {
+            auto vertices = item.bounds.GetVertices();
+            corners.insert(corners.end(), vertices.begin(), vertices.end());
+        }
+
+        _sphere = BoundingSphere::FromPoints(corners);
+
+        Logger::Debug("Flattened model into {} draw items, {} triangles", _drawItems.size(), _triangleCount);
+    }
+
+    const std::vector<Model::DrawItem>& Model::GetDrawItems() const { return _drawItems; }
+    bool Model::IsFlattened() const { return !_drawItems.empty(); }
+
+    const BoundingSphere& Model::GetBoundingSphere() const { return _sphere; }
+    const AABB& Model::GetAABB() const { return _bounds; }
+    std::size_t Model::GetTriangleCount() const { return _triangleCount; }
+
+    void Model::_FlattenNode(const ModelNode* node, const glm::mat4& parentTransform)
+    {
+        const glm::mat4 transform = parentTransform * node->GetTransform();
+
+        const auto& meshes = node->GetMeshes();
+        const auto& materials = node->GetMaterials();
+
+        for (std::size_t i = 0; i < meshes.size(); ++i)
+        {
+            Mesh* mesh = meshes[i].get();
+            if (!mesh) continue;
+
+            DrawItem item;
+            item.mesh = mesh;
+            item.material = i < materials.size() ? materials[i].get() : nullptr;
+            item.transform = transform;
+            item.sphere = mesh->GetBoundingSphere().Transform(transform);
+            item.bounds = mesh->GetAABB().Transform(transform);
+            item.triangleCount = (mesh->HasIndices() ? mesh->GetIndicesCount() : mesh->GetVerticesCount()) / 3;
+
+            _triangleCount += item.triangleCount;
+            _drawItems.push_back(item);
+        }
+
+        for (const auto& child : node->GetChildren())
+            _FlattenNode(child.get(), transform);
+    }
+}
\ No newline at end of file
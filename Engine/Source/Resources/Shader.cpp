@@ -1,13 +1,61 @@
 #include "Resources/Shader.hpp"
 #include "Core/Logger.hpp"
 
+#include <cstring>
+#include <deque>
+#include <mutex>
+
 namespace AE
 {
-    Shader::Shader(GLuint id) : _id(id) {}
+    static constexpr GLint UNRESOLVED_SLOT = -2;
+
+    static Shader::UniformStats GlobalUniformStats;
+
+    struct UniformRegistry
+    {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> indices;
+        std::deque<std::string> names;
+    };
+
+    static UniformRegistry& GetUniformRegistry()
+    {
+        static UniformRegistry registry;
+        return registry;
+    }
+
+    UniformHandle::UniformHandle(std::string_view name)
+        : _hash(HashUniformName(name))
+    {
+        UniformRegistry& registry = GetUniformRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        auto [it, inserted] = registry.indices.emplace(_hash, static_cast<uint32_t>(registry.names.size()));
+        if (inserted)
+            registry.names.emplace_back(name);
+
+        _index = it->second;
+    }
+
+    uint32_t UniformHandle::GetIndex() const { return _index; }
+    uint64_t UniformHandle::GetHash() const { return _hash; }
+
+    const std::string& UniformHandle::GetName() const
+    {
+        UniformRegistry& registry = GetUniformRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        return registry.names[_index];
+    }
+
+    Shader::Shader(GLuint id, ShaderFeature features)
+        : _id(id), _features(features)
+    {
+        _Reflect();
+    }
     
     Shader::~Shader()
     {
-        if (_id == 0)
+        if (_id != 0)
             glDeleteProgram(_id);
     }
     
@@ -25,66 +73,348 @@ namespace AE
     
     GLint Shader::GetUniformLocation(const std::string& name)
     {
-        LoggerContext ctx("Shader", "GetUniformLocation");
-    
+        const GLint slot = _FindSlot(HashUniformName(name), name);
+        return slot >= 0 ? _uniforms[slot].location : -1;
+    }
+
+    GLint Shader::GetUniformLocation(const UniformHandle& handle)
+    {
+        const GLint slot = _GetSlot(handle);
+        return slot >= 0 ? _uniforms[slot].location : -1;
+    }
+
+    const std::vector<Shader::UniformInfo>& Shader::GetUniforms() const { return _uniforms; }
+
+    bool Shader::IsValid() const { return _id != 0; }
+    bool Shader::IsPending() const { return _pending; }
+
+    Shader* Shader::GetVariant(ShaderFeature features)
+    {
+        if (!_variantCompiler || features == _features)
+            return this;
+
+        auto it = _variants.find(static_cast<uint32_t>(features));
+        if (it == _variants.end())
+        {
+            LoggerContext ctx("Shader", "GetVariant");
+
+            Logger::Debug("Compiling variant 0x{:x} of shader program {}...", static_cast<uint32_t>(features), _id);
+
+            // Failed variants are cached too, so they are not recompiled every frame.
+            it = _variants.emplace(static_cast<uint32_t>(features), _variantCompiler(features)).first;
+        }
+
+        Shader* variant = it->second.get();
+        if (!variant || (!variant->IsValid() && !variant->IsPending()))
+            return this;
+
+        return variant;
+    }
+
+    ShaderFeature Shader::GetFeatures() const { return _features; }
+    std::size_t Shader::GetVariantCount() const { return _variants.size(); }
+
+    void Shader::_SetVariantCompiler(VariantCompiler compiler) { _variantCompiler = std::move(compiler); }
+
+    void Shader::_SetProgram(GLuint id)
+    {
+        if (_id != 0)
+            glDeleteProgram(_id);
+
+        _id = id;
+        _pending = false;
+
+        _Reflect();
+    }
+
+    void Shader::_Reflect()
+    {
+        _uniforms.clear();
+        _shadows.clear();
+        _arrayLengths.clear();
+        _slots.clear();
+        _handleSlots.clear();
+
+        if (_id == 0) return;
+
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::string buffer(std::max(maxLength, 1), '\0');
+
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(_id, static_cast<GLuint>(i), maxLength, &length, &size, &type, buffer.data());
+
+            std::string name(buffer.data(), length);
+
+            // Arrays of basic types are reported once as "name[0]"; expose the bare name
+            // and every element so both spellings resolve.
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                const std::string base = name.substr(0, name.size() - 3);
+                const std::size_t firstSlot = _uniforms.size();
+
+                for (GLint element = 0; element < size; ++element)
+                {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    GLint location = glGetUniformLocation(_id, elementName.c_str());
+                    if (location < 0) break;
+
+                    _slots[HashUniformName(elementName)] = static_cast<GLint>(_uniforms.size());
+                    _uniforms.push_back({std::move(elementName), location, type, 1});
+                }
+
+                // Array uploads from a slot may only cover the active elements after it.
+                for (std::size_t slot = firstSlot; slot < _uniforms.size(); ++slot)
+                    _arrayLengths.push_back(static_cast<GLint>(_uniforms.size() - slot));
+
+                auto first = _slots.find(HashUniformName(name));
+                if (first != _slots.end())
+                    _slots[HashUniformName(base)] = first->second;
+                continue;
+            }
+
+            // Members of uniform blocks have no location.
+            GLint location = glGetUniformLocation(_id, name.c_str());
+            if (location < 0) continue;
+
+            _slots[HashUniformName(name)] = static_cast<GLint>(_uniforms.size());
+            _uniforms.push_back({std::move(name), location, type, size});
+            _arrayLengths.push_back(1);
+        }
+
+        _shadows.resize(_uniforms.size());
+    }
+
+    GLint Shader::_FindSlot(uint64_t hash, const std::string& name)
+    {
         if (_id == 0)
         {
+            LoggerContext ctx("Shader", "GetUniformLocation");
             Logger::Warning("Attempted to get uniform '{}' from an invalid shader program (ID = 0)", name);
             return -1;
         }
-    
-        if (_uniforms.find(name) != _uniforms.end())
-            return _uniforms[name];
-    
-        GLint location = glGetUniformLocation(_id, name.c_str());
-        if (location == -1)
+
+        auto it = _slots.find(hash);
+        if (it != _slots.end())
+            return it->second;
+
+        // Unknown names are remembered as -1 so the warning is only logged once.
+        LoggerContext ctx("Shader", "GetUniformLocation");
+        Logger::Warning("Uniform '{}' not found in shader program {}", name, _id);
+
+        _slots[hash] = -1;
+        return -1;
+    }
+
+    GLint Shader::_GetSlot(const UniformHandle& handle)
+    {
+        const uint32_t index = handle.GetIndex();
+        if (index < _handleSlots.size() && _handleSlots[index] != UNRESOLVED_SLOT)
+            return _handleSlots[index];
+
+        return _ResolveHandle(handle);
+    }
+
+    GLint Shader::_ResolveHandle(const UniformHandle& handle)
+    {
+        const GLint slot = _FindSlot(handle.GetHash(), handle.GetName());
+        if (_id == 0) return slot;
+
+        const uint32_t index = handle.GetIndex();
+        if (index >= _handleSlots.size())
+            _handleSlots.resize(index + 1, UNRESOLVED_SLOT);
+
+        _handleSlots[index] = slot;
+        return slot;
+    }
+
+    bool Shader::_ShouldUpload(GLint slot, const void* data, std::size_t size)
+    {
+        if (slot < 0) return false;
+
+        // The program keeps its uniform values across binds, so the last upload stays valid.
+        UniformShadow& shadow = _shadows[slot];
+        if (shadow.valid && std::memcmp(shadow.value.data(), data, size) == 0)
         {
-            Logger::Warning("Uniform '{}' not found in shader program {}", name, _id);
+            _uniformStats.skipped++;
+            GlobalUniformStats.skipped++;
+            return false;
         }
-    
-        _uniforms[name] = location;
-        return location;
+
+        std::memcpy(shadow.value.data(), data, size);
+        shadow.valid = true;
+
+        _uniformStats.uploads++;
+        GlobalUniformStats.uploads++;
+        return true;
     }
 
-    bool Shader::IsValid() const { return _id != 0; }
+    void Shader::_UploadInt(GLint slot, int value)
+    {
+        if (_ShouldUpload(slot, &value, sizeof(value)))
+            glUniform1i(_uniforms[slot].location, value);
+    }
+
+    void Shader::_UploadFloat(GLint slot, float value)
+    {
+        if (_ShouldUpload(slot, &value, sizeof(value)))
+            glUniform1f(_uniforms[slot].location, value);
+    }
+
+    void Shader::_UploadVec2(GLint slot, const glm::vec2& value)
+    {
+        if (_ShouldUpload(slot, &value[0], sizeof(value)))
+            glUniform2fv(_uniforms[slot].location, 1, &value[0]);
+    }
+
+    void Shader::_UploadVec3(GLint slot, const glm::vec3& value)
+    {
+        if (_ShouldUpload(slot, &value[0], sizeof(value)))
+            glUniform3fv(_uniforms[slot].location, 1, &value[0]);
+    }
+
+    void Shader::_UploadVec4(GLint slot, const glm::vec4& value)
+    {
+        if (_ShouldUpload(slot, &value[0], sizeof(value)))
+            glUniform4fv(_uniforms[slot].location, 1, &value[0]);
+    }
+
+    void Shader::_UploadMat3(GLint slot, const glm::mat3& value)
+    {
+        if (_ShouldUpload(slot, &value[0][0], sizeof(value)))
+            glUniformMatrix3fv(_uniforms[slot].location, 1, GL_FALSE, &value[0][0]);
+    }
+
+    void Shader::_UploadMat4(GLint slot, const glm::mat4& value)
+    {
+        if (_ShouldUpload(slot, &value[0][0], sizeof(value)))
+            glUniformMatrix4fv(_uniforms[slot].location, 1, GL_FALSE, &value[0][0]);
+    }
+
+    void Shader::_UploadVec3Array(GLint slot, std::span<const glm::vec3> values)
+    {
+        if (slot < 0 || values.empty()) return;
+
+        // Elements were reflected into consecutive slots, each shadowed on its own; any change uploads them all.
+        const std::size_t count = std::min(values.size(), static_cast<std::size_t>(_arrayLengths[slot]));
+
+        bool changed = false;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            UniformShadow& shadow = _shadows[slot + i];
+            if (shadow.valid && std::memcmp(shadow.value.data(), &values[i][0], sizeof(glm::vec3)) == 0)
+                continue;
+
+            std::memcpy(shadow.value.data(), &values[i][0], sizeof(glm::vec3));
+            shadow.valid = true;
+            changed = true;
+        }
+
+        if (!changed)
+        {
+            _uniformStats.skipped++;
+            GlobalUniformStats.skipped++;
+            return;
+        }
+
+        _uniformStats.uploads++;
+        GlobalUniformStats.uploads++;
+        glUniform3fv(_uniforms[slot].location, static_cast<GLsizei>(count), &values[0][0]);
+    }
     
     void Shader::SetInt(const std::string& name, int value)
     {
-        glUniform1i(GetUniformLocation(name), value);
+        _UploadInt(_FindSlot(HashUniformName(name), name), value);
     }
     
     void Shader::SetFloat(const std::string& name, float value)
     {
-        glUniform1f(GetUniformLocation(name), value);
+        _UploadFloat(_FindSlot(HashUniformName(name), name), value);
     }
     
     void Shader::SetBool(const std::string& name, bool value)
     {
-        glUniform1i(GetUniformLocation(name), value ? 1 : 0);
+        _UploadInt(_FindSlot(HashUniformName(name), name), value ? 1 : 0);
     }
     
     void Shader::SetVec2(const std::string& name, const glm::vec2& value)
     {
-        glUniform2fv(GetUniformLocation(name), 1, &value[0]);
+        _UploadVec2(_FindSlot(HashUniformName(name), name), value);
     }
     
     void Shader::SetVec3(const std::string& name, const glm::vec3& value)
     {
-        glUniform3fv(GetUniformLocation(name), 1, &value[0]);
+        _UploadVec3(_FindSlot(HashUniformName(name), name), value);
     }
     
     void Shader::SetVec4(const std::string& name, const glm::vec4& value)
     {
-        glUniform4fv(GetUniformLocation(name), 1, &value[0]);
+        _UploadVec4(_FindSlot(HashUniformName(name), name), value);
     }
     
     void Shader::SetMat3(const std::string& name, const glm::mat3& value)
     {
-        glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+        _UploadMat3(_FindSlot(HashUniformName(name), name), value);
     }
     
     void Shader::SetMat4(const std::string& name, const glm::mat4& value)
     {
-        glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+        _UploadMat4(_FindSlot(HashUniformName(name), name), value);
     }
+
+    void Shader::SetInt(const UniformHandle& handle, int value)
+    {
+        _UploadInt(_GetSlot(handle), value);
+    }
+
+    void Shader::SetFloat(const UniformHandle& handle, float value)
+    {
+        _UploadFloat(_GetSlot(handle), value);
+    }
+
+    void Shader::SetBool(const UniformHandle& handle, bool value)
+    {
+        _UploadInt(_GetSlot(handle), value ? 1 : 0);
+    }
+
+    void Shader::SetVec2(const UniformHandle& handle, const glm::vec2& value)
+    {
+        _UploadVec2(_GetSlot(handle), value);
+    }
+
+    void Shader::SetVec3(const UniformHandle& handle, const glm::vec3& value)
+    {
+        _UploadVec3(_GetSlot(handle), value);
+    }
+
+    void Shader::SetVec4(const UniformHandle& handle, const glm::vec4& value)
+    {
+        _UploadVec4(_GetSlot(handle), value);
+    }
+
+    void Shader::SetVec3Array(const UniformHandle& handle, std::span<const glm::vec3> values)
+    {
+        _UploadVec3Array(_GetSlot(handle), values);
+    }
+
+    void Shader::SetMat3(const UniformHandle& handle, const glm::mat3& value)
+    {
+        _UploadMat3(_GetSlot(handle), value);
+    }
+
+    void Shader::SetMat4(const UniformHandle& handle, const glm::mat4& value)
+    {
+        _UploadMat4(_GetSlot(handle), value);
+    }
+
+    const Shader::UniformStats& Shader::GetUniformStats() const { return _uniformStats; }
+    const Shader::UniformStats& Shader::GetGlobalUniformStats() { return GlobalUniformStats; }
+    void Shader::ResetGlobalUniformStats() { GlobalUniformStats = UniformStats(); }
 }
\ No newline at end of file
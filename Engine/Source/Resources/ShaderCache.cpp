@@ -0,0 +1,264 @@
+#include "Resources/ShaderCache.hpp"
+#include "Core/Logger.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+namespace AE
+{
+    static constexpr uint32_t CACHE_MAGIC = 0x43534541; // "AESC"
+    static constexpr uint32_t CACHE_VERSION = 1;
+
+    struct CacheEntryHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t driverHash;
+        uint64_t key;
+        uint32_t binaryFormat;
+        uint32_t binaryLength;
+        double compileTimeMs;
+    };
+
+    static uint64_t HashFNV1a(const void* data, std::size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    static std::string GetGLString(GLenum name)
+    {
+        const GLubyte* str = glGetString(name);
+        return str ? reinterpret_cast<const char*>(str) : "";
+    }
+
+    ShaderCache::ShaderCache(const std::string& directory)
+        : _directory(directory)
+    {
+        LoggerContext ctx("ShaderCache", "ShaderCache");
+
+        if (!GLAD_GL_ARB_get_program_binary)
+        {
+            Logger::Warning("GL_ARB_get_program_binary is not supported, program cache disabled");
+            return;
+        }
+
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        if (formatCount <= 0)
+        {
+            Logger::Warning("Driver exposes no program binary formats, program cache disabled");
+            return;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(_directory, ec);
+        if (ec)
+        {
+            Logger::Error("Failed to create cache directory '{}': {}", _directory.string(), ec.message());
+            return;
+        }
+
+        const std::string driverInfo = GetGLString(GL_VENDOR) + "\n" + GetGLString(GL_RENDERER) + "\n" + GetGLString(GL_VERSION);
+        _driverHash = HashFNV1a(driverInfo.data(), driverInfo.size());
+
+        _ValidateDriver(driverInfo);
+
+        _enabled = true;
+    }
+
+    ShaderCache::~ShaderCache()
+    {
+        if (_stats.hits + _stats.misses == 0) return;
+
+        LoggerContext ctx("ShaderCache", "~ShaderCache");
+        Logger::Info("Program cache: {} hit(s), {} miss(es), saved ~{:.1f} ms of shader compilation",
+            _stats.hits, _stats.misses, _stats.savedTimeMs);
+    }
+
+    uint64_t ShaderCache::GetKey(const std::string& vertexSrc, const std::string& fragmentSrc) const
+    {
+        const char separator = '\0';
+
+        uint64_t hash = HashFNV1a(&_driverHash, sizeof(_driverHash));
+        hash = HashFNV1a(vertexSrc.data(), vertexSrc.size(), hash);
+        hash = HashFNV1a(&separator, 1, hash);
+        hash = HashFNV1a(fragmentSrc.data(), fragmentSrc.size(), hash);
+        return hash;
+    }
+
+    GLuint ShaderCache::Load(uint64_t key)
+    {
+        if (!_enabled) return 0;
+
+        LoggerContext ctx("ShaderCache", "Load");
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::ifstream file(_GetEntryPath(key), std::ios::binary);
+        if (!file)
+        {
+            _stats.misses++;
+            return 0;
+        }
+
+        CacheEntryHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+            header.driverHash != _driverHash || header.key != key || header.binaryLength == 0)
+        {
+            Logger::Debug("Discarding stale cache entry {:016x}", key);
+            _stats.misses++;
+            return 0;
+        }
+
+        std::vector<char> binary(header.binaryLength);
+        file.read(binary.data(), binary.size());
+        if (!file)
+        {
+            Logger::Warning("Cache entry {:016x} is truncated", key);
+            _stats.misses++;
+            return 0;
+        }
+
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        GLint success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            // Drivers may reject binaries for reasons not covered by the version string.
+            Logger::Debug("Driver rejected cache entry {:016x}, recompiling", key);
+            glDeleteProgram(program);
+
+            std::error_code ec;
+            std::filesystem::remove(_GetEntryPath(key), ec);
+
+            _stats.misses++;
+            return 0;
+        }
+
+        double loadTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        _stats.hits++;
+        _stats.loadTimeMs += loadTimeMs;
+        _stats.savedTimeMs += std::max(header.compileTimeMs - loadTimeMs, 0.0);
+
+        Logger::Info("Loaded program binary {:016x} in {:.2f} ms, saved ~{:.2f} ms of compilation",
+            key, loadTimeMs, std::max(header.compileTimeMs - loadTimeMs, 0.0));
+
+        return program;
+    }
+
+    bool ShaderCache::Store(uint64_t key, GLuint program, double compileTimeMs)
+    {
+        if (!_enabled || program == 0) return false;
+
+        LoggerContext ctx("ShaderCache", "Store");
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+        {
+            Logger::Warning("Program {} has no retrievable binary", program);
+            return false;
+        }
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+        CacheEntryHeader header{};
+        header.magic = CACHE_MAGIC;
+        header.version = CACHE_VERSION;
+        header.driverHash = _driverHash;
+        header.key = key;
+        header.binaryFormat = format;
+        header.binaryLength = static_cast<uint32_t>(length);
+        header.compileTimeMs = compileTimeMs;
+
+        // Written to a temporary file first so a crash never leaves a half-written entry.
+        const std::filesystem::path path = _GetEntryPath(key);
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                Logger::Error("Failed to open file: '{}'", tempPath.string());
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(binary.data(), binary.size());
+
+            if (!file)
+            {
+                Logger::Error("Failed to write file: '{}'", tempPath.string());
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            Logger::Error("Failed to store cache entry '{}': {}", path.string(), ec.message());
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        _stats.stores++;
+        return true;
+    }
+
+    const ShaderCache::CacheStats& ShaderCache::GetStats() const { return _stats; }
+    bool ShaderCache::IsEnabled() const { return _enabled; }
+
+    std::filesystem::path ShaderCache::_GetEntryPath(uint64_t key) const
+    {
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "%016llx.bin", static_cast<unsigned long long>(key));
+        return _directory / fileName;
+    }
+
+    void ShaderCache::_ValidateDriver(const std::string& driverInfo)
+    {
+        const std::filesystem::path driverPath = _directory / "driver.txt";
+
+        std::string cachedInfo;
+        {
+            std::ifstream file(driverPath, std::ios::binary);
+            if (file)
+            {
+                std::ostringstream buffer;
+                buffer << file.rdbuf();
+                cachedInfo = buffer.str();
+            }
+        }
+
+        if (cachedInfo == driverInfo) return;
+
+        if (!cachedInfo.empty())
+            Logger::Info("Graphics driver changed, purging program cache '{}'", _directory.string());
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(_directory, ec))
+        {
+            if (entry.path().extension() == ".bin" || entry.path().extension() == ".tmp")
+                std::filesystem::remove(entry.path(), ec);
+        }
+
+        std::ofstream file(driverPath, std::ios::binary | std::ios::trunc);
+        file << driverInfo;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "Resources/ShaderCompiler.hpp"
+#include "Resources/ShaderCache.hpp"
+#include "Resources/Shader.hpp"
+#include "Core/Logger.hpp"
+
+namespace AE
+{
+    static GLuint IssueShader(GLenum type, const std::string& source);
+    static bool CheckShader(GLuint shader, GLenum type);
+    static bool CheckProgram(GLuint program);
+
+    ShaderCompiler::ShaderCompiler(std::shared_ptr<ShaderCache> cache)
+        : _cache(std::move(cache))
+    {
+        _parallel = GLAD_GL_KHR_parallel_shader_compile != 0;
+
+        // Let the driver pick as many compiler threads as it sees fit.
+        if (_parallel)
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+
+    ShaderCompiler::~ShaderCompiler()
+    {
+        for (auto& pending : _pending)
+        {
+            glDeleteShader(pending.vertex);
+            glDeleteShader(pending.fragment);
+            glDeleteProgram(pending.program);
+        }
+    }
+
+    std::shared_ptr<Shader> ShaderCompiler::CompileAsync(const std::string& name,
+        const std::string& vertexSrc, const std::string& fragmentSrc, ShaderFeature features)
+    {
+        const bool useCache = _cache && _cache->IsEnabled();
+        const uint64_t key = useCache ? _cache->GetKey(vertexSrc, fragmentSrc) : 0;
+
+        if (useCache)
+        {
+            if (GLuint programID = _cache->Load(key))
+                return std::make_shared<Shader>(programID, features);
+        }
+
+        auto shader = std::make_shared<Shader>(0, features);
+        shader->_pending = true;
+
+        PendingProgram pending = _Issue(vertexSrc, fragmentSrc);
+        pending.name = name;
+        pending.shader = shader;
+        pending.cacheKey = key;
+
+        _pending.push_back(std::move(pending));
+
+        return shader;
+    }
+
+    GLuint ShaderCompiler::Compile(const std::string& vertexSrc, const std::string& fragmentSrc)
+    {
+        const bool useCache = _cache && _cache->IsEnabled();
+        const uint64_t key = useCache ? _cache->GetKey(vertexSrc, fragmentSrc) : 0;
+
+        if (useCache)
+        {
+            if (GLuint programID = _cache->Load(key))
+                return programID;
+        }
+
+        PendingProgram pending = _Issue(vertexSrc, fragmentSrc);
+        pending.cacheKey = key;
+
+        return _Finalize(pending);
+    }
+
+    void ShaderCompiler::Update()
+    {
+        // Without the extension any status query blocks, so everything is finalized at once.
+        // The compiles were still all issued up front and can overlap in the driver.
+        _Resolve(!_parallel);
+    }
+
+    void ShaderCompiler::Flush()
+    {
+        _Resolve(true);
+    }
+
+    std::size_t ShaderCompiler::GetPendingCount() const { return _pending.size(); }
+    bool ShaderCompiler::IsParallel() const { return _parallel; }
+    ShaderCache* ShaderCompiler::GetCache() const { return _cache.get(); }
+
+    ShaderCompiler::PendingProgram ShaderCompiler::_Issue(const std::string& vertexSrc, const std::string& fragmentSrc)
+    {
+        PendingProgram pending;
+        const auto start = std::chrono::steady_clock::now();
+
+        pending.vertex = IssueShader(GL_VERTEX_SHADER, vertexSrc);
+        pending.fragment = IssueShader(GL_FRAGMENT_SHADER, fragmentSrc);
+
+        // Linking right away is valid; the driver waits for the compiles itself.
+        pending.program = glCreateProgram();
+        if (GLAD_GL_ARB_get_program_binary)
+            glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+        glAttachShader(pending.program, pending.vertex);
+        glAttachShader(pending.program, pending.fragment);
+        glLinkProgram(pending.program);
+
+        pending.compileTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        return pending;
+    }
+
+    void ShaderCompiler::_Resolve(bool wait)
+    {
+        std::size_t remaining = 0;
+
+        for (std::size_t i = 0; i < _pending.size(); ++i)
+        {
+            PendingProgram& pending = _pending[i];
+
+            if (!wait)
+            {
+                GLint completed = GL_FALSE;
+                glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &completed);
+                if (completed != GL_TRUE)
+                {
+                    if (remaining != i)
+                        _pending[remaining] = std::move(pending);
+                    remaining++;
+                    continue;
+                }
+            }
+
+            GLuint programID = _Finalize(pending);
+
+            if (auto shader = pending.shader.lock())
+            {
+                shader->_SetProgram(programID);
+            }
+            else if (programID)
+            {
+                glDeleteProgram(programID);
+            }
+        }
+
+        _pending.resize(remaining);
+    }
+
+    GLuint ShaderCompiler::_Finalize(PendingProgram& pending)
+    {
+        LoggerContext ctx("ShaderCompiler", "_Finalize");
+
+        // Status queries block until the driver is done, unless a completion poll already said it was.
+        const auto start = std::chrono::steady_clock::now();
+
+        const bool compiled = CheckShader(pending.vertex, GL_VERTEX_SHADER) &
+                              CheckShader(pending.fragment, GL_FRAGMENT_SHADER);
+
+        GLuint programID = pending.program;
+        const bool linked = compiled && CheckProgram(programID);
+
+        pending.compileTimeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (!linked)
+        {
+            glDeleteProgram(programID);
+            programID = 0;
+        }
+
+        glDeleteShader(pending.vertex);
+        glDeleteShader(pending.fragment);
+
+        pending.vertex = pending.fragment = pending.program = 0;
+
+        if (!programID)
+        {
+            if (!pending.name.empty())
+                Logger::Error("Failed to build shader '{}'!", pending.name);
+            return 0;
+        }
+
+        if (!pending.name.empty())
+            Logger::Debug("Shader '{}' compiled in {:.2f} ms (ID = {})", pending.name, pending.compileTimeMs, programID);
+
+        if (_cache && _cache->IsEnabled())
+            _cache->Store(pending.cacheKey, programID, pending.compileTimeMs);
+
+        return programID;
+    }
+
+    static GLuint IssueShader(GLenum type, const std::string& source)
+    {
+        GLuint shader = glCreateShader(type);
+        const char* src = source.c_str();
+        glShaderSource(shader, 1, &src, nullptr);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    static bool CheckShader(GLuint shader, GLenum type)
+    {
+        const std::string typeStr = type == GL_VERTEX_SHADER ? "Vertex" : "Fragment";
+
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            GLint logLength = 0;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+            std::string infoLog(logLength, '\0');
+            glGetShaderInfoLog(shader, logLength, nullptr, infoLog.data());
+            
+            Logger::Error("{} shader compilation failed: {}", typeStr, infoLog);
+            return false;
+        }
+
+        Logger::Debug("{} shader compiled! (ID = {})", typeStr, shader);
+
+        return true;
+    }
+
+    static bool CheckProgram(GLuint program)
+    {
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            GLint logLength = 0;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+            std::string infoLog(logLength, '\0');
+            glGetProgramInfoLog(program, logLength, nullptr, infoLog.data());
+    
+            Logger::Error("Shader linking failed: {}", infoLog);
+            return false;
+        }
+
+        Logger::Debug("Shader program linked! (ID = {})", program);
+
+        return true;
+    }
+}
\ No newline at end of file
@@ -5,14 +5,37 @@
 
 #include "PCH.hpp"
 
+#include <cstring>
+
 namespace AE
 {
+    // Grows by half at least and rounds up to 64 texels, so a window dragged wider reallocates a few times, not on every event.
+    static int GrowCapacity(int size, int capacity)
+    {
+        if (size <= capacity)
+            return capacity;
+
+        static const GLint maxSize = []
+        {
+            GLint value = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &value);
+            return value;
+        }();
+
+        int grown = (std::max(size, capacity + capacity / 2) + 63) & ~63;
+        if (maxSize > 0)
+            grown = std::min(grown, static_cast<int>(maxSize));
+
+        return std::max(grown, size);
+    }
+
     Texture::Texture(
         GLuint id,
         const TextureDesc& descriptor,
         GLenum target,
         bool generateMipmaps
-    ) : _id(id), desc(descriptor), target(target)
+    ) : _id(id), desc(descriptor), target(target),
+        _capacityWidth(descriptor.width), _capacityHeight(descriptor.height)
     {
         if (_id != 0 && generateMipmaps)
         {
@@ -95,6 +118,25 @@ namespace AE
         return texture;
     }
 
+    std::shared_ptr<Texture> Texture::Create(const TextureDesc& descriptor)
+    {
+        GLuint textureID;
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(descriptor.internalFormat), descriptor.width, descriptor.height, 0,
+            static_cast<GLenum>(descriptor.format), descriptor.type, nullptr);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(descriptor.minFilter));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(descriptor.magFilter));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLint>(descriptor.wrapS));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLint>(descriptor.wrapT));
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        return std::make_shared<Texture>(textureID, descriptor);
+    }
+
     void Texture::Bind(int slot) const
     {
         glActiveTexture(GL_TEXTURE0 + slot);
@@ -107,26 +149,51 @@ namespace AE
         glBindTexture(target, 0);
     }
 
-    void Texture::Resize(int width, int height)
+    bool Texture::Resize(int width, int height)
     {
-        if (_id != 0)
-        glDeleteTextures(1, &_id);
+        desc.width = width;
+        desc.height = height;
 
-        glGenTextures(1, &_id);
-        glBindTexture(target, _id);
+        // Shrinking keeps the storage until less than a quarter of it is used.
+        const bool grow = width > _capacityWidth || height > _capacityHeight;
+        const bool shrink = static_cast<int64_t>(width) * height * 4 < static_cast<int64_t>(_capacityWidth) * _capacityHeight;
 
-        const GLenum internalFormat = TextureUtils::GetInternalFormat(desc.channels);
-        const GLenum format = TextureUtils::GetFormat(desc.channels);
+        if (_id != 0 && !grow && !shrink)
+            return false;
 
-        AllocateStorage(width, height, internalFormat, format);
+        if (_id != 0 && grow)
+        {
+            _capacityWidth = GrowCapacity(width, _capacityWidth);
+            _capacityHeight = GrowCapacity(height, _capacityHeight);
+        }
+        else
+        {
+            _capacityWidth = width;
+            _capacityHeight = height;
+        }
 
-        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(desc.minFilter));
-        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(desc.magFilter));
-        glTexParameteri(target, GL_TEXTURE_WRAP_S, static_cast<GLint>(desc.wrapS));
-        glTexParameteri(target, GL_TEXTURE_WRAP_T, static_cast<GLint>(desc.wrapT));
+        // The storage is specified again under the same name, so framebuffers it's attached to keep it.
+        if (_id == 0)
+        {
+            glGenTextures(1, &_id);
+            glBindTexture(target, _id);
 
-        desc.width = width;
-        desc.height = height;
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(desc.minFilter));
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(desc.magFilter));
+            glTexParameteri(target, GL_TEXTURE_WRAP_S, static_cast<GLint>(desc.wrapS));
+            glTexParameteri(target, GL_TEXTURE_WRAP_T, static_cast<GLint>(desc.wrapT));
+        }
+        else
+        {
+            glBindTexture(target, _id);
+        }
+
+        AllocateStorage(_capacityWidth, _capacityHeight, static_cast<GLenum>(desc.internalFormat), static_cast<GLenum>(desc.format));
+
+        if (_hasMipmaps)
+            glGenerateMipmap(target);
+
+        return true;
     }
 
     void Texture::GenerateMipmaps()
@@ -144,6 +211,42 @@ namespace AE
         _hasMipmaps = true;
     }
 
+    std::vector<unsigned char> Texture::ReadPixels(int level, int& width, int& height) const
+    {
+        width = height = 0;
+        if (_id == 0 || target != GL_TEXTURE_2D) return {};
+
+        Bind();
+
+        glGetTexLevelParameteriv(target, level, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(target, level, GL_TEXTURE_HEIGHT, &height);
+
+        if (width <= 0 || height <= 0)
+        {
+            width = height = 0;
+            return {};
+        }
+
+        std::vector<unsigned char> pixels(static_cast<std::size_t>(width) * height * 4);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(target, level, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        // The base level may be larger than the texture after a resize, only the used corner is returned.
+        if (level == 0 && (width > desc.width || height > desc.height))
+        {
+            const std::size_t rowBytes = static_cast<std::size_t>(desc.width) * 4;
+            for (int y = 1; y < desc.height; ++y)
+                std::memmove(pixels.data() + y * rowBytes, pixels.data() + static_cast<std::size_t>(y) * width * 4, rowBytes);
+
+            width = desc.width;
+            height = desc.height;
+            pixels.resize(static_cast<std::size_t>(width) * height * 4);
+        }
+
+        return pixels;
+    }
+
     std::shared_ptr<Texture> Texture::GetDefault()
     {
         static std::shared_ptr<Texture> defaultTexture = []() -> std::shared_ptr<Texture>
@@ -188,6 +291,22 @@ namespace AE
     GLuint Texture::GetID() const { return _id; }
     int Texture::GetWidth() const { return desc.width; }
     int Texture::GetHeight() const { return desc.height; }
+    int Texture::GetCapacityWidth() const { return _capacityWidth; }
+    int Texture::GetCapacityHeight() const { return _capacityHeight; }
+
+    glm::vec2 Texture::GetUVScale() const
+    {
+        return glm::vec2(
+            _capacityWidth > 0 ? static_cast<float>(desc.width) / static_cast<float>(_capacityWidth) : 1.0f,
+            _capacityHeight > 0 ? static_cast<float>(desc.height) / static_cast<float>(_capacityHeight) : 1.0f);
+    }
+
+    glm::vec2 Texture::GetUVLimit() const
+    {
+        return glm::vec2(
+            _capacityWidth > 0 ? (static_cast<float>(desc.width) - 0.5f) / static_cast<float>(_capacityWidth) : 1.0f,
+            _capacityHeight > 0 ? (static_cast<float>(desc.height) - 0.5f) / static_cast<float>(_capacityHeight) : 1.0f);
+    }
     int Texture::GetChannels() const { return desc.channels; }
     TextureFilter Texture::GetMinFilter() const { return desc.minFilter; }
     TextureFilter Texture::GetMagFilter() const { return desc.magFilter; }
@@ -227,6 +346,12 @@ namespace AE
         glTexParameteri(target, GL_TEXTURE_WRAP_T, static_cast<GLint>(wrap));
     }
 
+    void Texture::SetMaxLevel(int level)
+    {
+        glBindTexture(target, _id);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, std::max(level, 0));
+    }
+
     void Texture::AllocateStorage(int width, int height, GLenum internalFormat, GLenum format)
     {
         glTexImage2D(target, 0, internalFormat, width, height, 0, format, desc.type, nullptr);
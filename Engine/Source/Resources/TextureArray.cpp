@@ -4,7 +4,7 @@
 namespace AE
 {
     TextureArray::TextureArray(GLuint id, const TextureDesc& desc, int layers)
-        : Texture(id, desc, GL_TEXTURE_2D_ARRAY) {}
+        : Texture(id, desc, GL_TEXTURE_2D_ARRAY), _layers(layers) {}
 
     std::shared_ptr<TextureArray> TextureArray::Create(const TextureDesc& desc, int layers)
     {
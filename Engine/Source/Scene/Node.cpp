@@ -129,6 +129,12 @@ namespace AE
     bool SceneNode::IsEnabled() const { return _state.enabled; }
     void SceneNode::SetEnabled(bool enabled) { _state.enabled = enabled; }
 
+    bool SceneNode::IsVisible() const { return _state.visible; }
+    void SceneNode::SetVisible(bool visible) { _state.visible = visible; }
+
+    bool SceneNode::IsStatic() const { return _state.isStatic; }
+    void SceneNode::SetStatic(bool isStatic) { _state.isStatic = isStatic; }
+
     bool SceneNode::_Initialize() 
     {
         LoggerContext ctx("SceneNode(" + _name + ")", "_Initialize");
@@ -205,7 +211,7 @@ namespace AE
 
     void SceneNode::_Render()
     {
-        if (!_state.enabled || !_state.initialized) 
+        if (!_state.enabled || !_state.visible || !_state.initialized) 
             return;
 
         LoggerContext ctx("SceneNode(" + _name + ")", "_Render");
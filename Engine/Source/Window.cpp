@@ -49,6 +49,7 @@ namespace AE
     bool Window::IsVSyncEnabled() const { return _vsync; }
 
     bool Window::IsInitialized() const { return _state.initialized; }
+    bool Window::WasResized() const { return _state.resized; }
 
     void Window::SetTitle(const std::string& title)
     {
@@ -71,6 +72,7 @@ namespace AE
         _height = (height == -1 ? _height : height);
 
         _aspectRatio = static_cast<float>(_width) / static_cast<float>(_height);
+        _state.resized = true;
 
         SDL_SetWindowSize(_window, _width, _height);
     }
@@ -219,6 +221,7 @@ namespace AE
                 _width = event.window.data1;
                 _height = event.window.data2;
                 _aspectRatio = static_cast<float>(_width) / static_cast<float>(_height);
+                _state.resized = true;
                 break;
 
             case SDL_EVENT_WINDOW_MOVED:
@@ -241,4 +244,11 @@ namespace AE
     {
         SDL_GL_SwapWindow(_window);
     }
+
+    bool Window::_ConsumeResize()
+    {
+        const bool resized = _state.resized;
+        _state.resized = false;
+        return resized;
+    }
 }
@@ -0,0 +1,1000 @@
+#include "World/BakedLighting.hpp"
+#include "Math/BVH.hpp"
+#include "Lighting/Sources.hpp"
+#include "Resources/Texture.hpp"
+#include "Core/Logger.hpp"
+
+#include <glm/gtc/packing.hpp>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+
+namespace AE
+{
+    static constexpr uint32_t BAKED_LIGHTING_MAGIC = 0x4C424541; // "AEBL"
+    static constexpr uint32_t BAKED_LIGHTING_VERSION = 1;
+
+    struct BakedLightingFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        int32_t lightmapSize[2];
+        float probeOrigin[3];
+        float probeSpacing;
+        int32_t probeResolution[3];
+    };
+
+    static constexpr float Pi = 3.14159265358979f;
+
+    // Lights copied into plain values once, so workers never touch the light objects.
+    struct BakeLight
+    {
+        LightType type;
+        glm::vec3 radiance;
+        glm::vec3 position;
+        glm::vec3 direction;
+        float constant, linear, quadratic;
+        float innerCutoff, outerCutoff;
+    };
+
+    struct Chart
+    {
+        uint32_t mesh;
+        int axis;                   // dominant axis of the normals, the chart is projected along it
+        std::vector<uint32_t> triangles;
+        glm::vec2 min, max;         // projected, in world units
+        glm::ivec2 size;            // texels, padding included
+        glm::ivec2 origin;
+    };
+
+    // Where the center of a lightmap texel lies on the level.
+    struct Texel
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec3 faceNormal;
+        bool covered = false;
+    };
+
+    // xorshift, seeded per texel and probe so bakes are reproducible.
+    struct Random
+    {
+        uint32_t state;
+
+        explicit Random(uint32_t seed) : state(seed * 2654435761u ^ 0x9e3779b9u) { if (state == 0) state = 1; }
+
+        float Next()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    // Real L2 spherical harmonics basis.
+    static std::array<float, 9> GetSHBasis(const glm::vec3& d)
+    {
+        return {
+            0.282095f,
+            0.488603f * d.y, 0.488603f * d.z, 0.488603f * d.x,
+            1.092548f * d.x * d.y, 1.092548f * d.y * d.z, 0.315392f * (3.0f * d.z * d.z - 1.0f),
+            1.092548f * d.x * d.z, 0.546274f * (d.x * d.x - d.y * d.y)
+        };
+    }
+
+    // Duff et al. 2017, continuous around the poles.
+    static void GetBasis(const glm::vec3& n, glm::vec3& t, glm::vec3& b)
+    {
+        const float sign = std::copysign(1.0f, n.z);
+        const float a = -1.0f / (sign + n.z);
+        const float c = n.x * n.y * a;
+        t = glm::vec3(1.0f + sign * n.x * n.x * a, sign * c, -sign * n.x);
+        b = glm::vec3(c, sign + n.y * n.y * a, -n.y);
+    }
+
+    static glm::vec3 SampleCosine(const glm::vec3& normal, Random& random)
+    {
+        glm::vec3 t, b;
+        GetBasis(normal, t, b);
+
+        const float r1 = random.Next();
+        const float r = std::sqrt(r1);
+        const float phi = 2.0f * Pi * random.Next();
+        return t * (r * std::cos(phi)) + b * (r * std::sin(phi)) + normal * std::sqrt(std::max(1.0f - r1, 0.0f));
+    }
+
+    static glm::vec3 SampleSphere(Random& random)
+    {
+        const float z = 1.0f - 2.0f * random.Next();
+        const float r = std::sqrt(std::max(1.0f - z * z, 0.0f));
+        const float phi = 2.0f * Pi * random.Next();
+        return glm::vec3(r * std::cos(phi), r * std::sin(phi), z);
+    }
+
+    static glm::vec2 Project(const glm::vec3& p, int axis)
+    {
+        return glm::vec2(p[(axis + 1) % 3], p[(axis + 2) % 3]);
+    }
+
+    static uint32_t FindRoot(std::vector<uint32_t>& parents, uint32_t i)
+    {
+        while (parents[i] != i)
+        {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    }
+
+    // Triangles sharing an edge and facing the same way along the same axis form a chart.
+    static void BuildCharts(const std::vector<BakedLighting::BakeMesh>& meshes, std::vector<Chart>& charts)
+    {
+        for (uint32_t m = 0; m < meshes.size(); ++m)
+        {
+            const BakedLighting::BakeMesh& mesh = meshes[m];
+            const uint32_t triangleCount = static_cast<uint32_t>(mesh.indices.size() / 3);
+
+            std::vector<int> classes(triangleCount);
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                const glm::vec3& p0 = mesh.positions[mesh.indices[t * 3]];
+                const glm::vec3 n = glm::cross(mesh.positions[mesh.indices[t * 3 + 1]] - p0, mesh.positions[mesh.indices[t * 3 + 2]] - p0);
+                const glm::vec3 a = glm::abs(n);
+                const int axis = a.x >= a.y && a.x >= a.z ? 0 : (a.y >= a.z ? 1 : 2);
+                classes[t] = axis * 2 + (n[axis] < 0.0f ? 1 : 0);
+            }
+
+            std::vector<uint32_t> parents(triangleCount);
+            std::iota(parents.begin(), parents.end(), 0u);
+
+            std::unordered_map<uint64_t, uint32_t> edges;
+            edges.reserve(mesh.indices.size());
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                for (int e = 0; e < 3; ++e)
+                {
+                    const uint32_t a = mesh.indices[t * 3 + e];
+                    const uint32_t b = mesh.indices[t * 3 + (e + 1) % 3];
+                    const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+
+                    auto [it, inserted] = edges.try_emplace(key, t);
+                    if (!inserted && classes[it->second] == classes[t])
+                        parents[FindRoot(parents, t)] = FindRoot(parents, it->second);
+                }
+            }
+
+            std::unordered_map<uint32_t, std::size_t> chartOfRoot;
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                auto [it, inserted] = chartOfRoot.try_emplace(FindRoot(parents, t), charts.size());
+                if (inserted)
+                    charts.push_back({ m, classes[t] / 2, {}, glm::vec2(std::numeric_limits<float>::max()), glm::vec2(std::numeric_limits<float>::lowest()), {}, {} });
+
+                Chart& chart = charts[it->second];
+                chart.triangles.push_back(t);
+                for (int c = 0; c < 3; ++c)
+                {
+                    const glm::vec2 p = Project(mesh.positions[mesh.indices[t * 3 + c]], chart.axis);
+                    chart.min = glm::min(chart.min, p);
+                    chart.max = glm::max(chart.max, p);
+                }
+            }
+        }
+    }
+
+    // Shelf packing, tallest charts first. False when the charts don't fit at this density.
+    static bool PackCharts(std::vector<Chart>& charts, float density, int padding, int maxSize, glm::ivec2& atlasSize)
+    {
+        std::size_t area = 0;
+        int widest = 0;
+        for (Chart& chart : charts)
+        {
+            const glm::vec2 extent = (chart.max - chart.min) * density;
+            chart.size = glm::ivec2(static_cast<int>(std::ceil(extent.x)) + 1 + 2 * padding,
+                static_cast<int>(std::ceil(extent.y)) + 1 + 2 * padding);
+            area += static_cast<std::size_t>(chart.size.x) * chart.size.y;
+            widest = std::max(widest, chart.size.x);
+        }
+
+        if (widest > maxSize)
+            return false;
+
+        int width = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(area)) * 1.1));
+        width = std::min(std::max((width + 3) & ~3, widest), maxSize);
+
+        std::vector<std::size_t> order(charts.size());
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return charts[a].size.y > charts[b].size.y; });
+
+        glm::ivec2 cursor(0, 0);
+        int shelfHeight = 0;
+        for (std::size_t index : order)
+        {
+            Chart& chart = charts[index];
+            if (cursor.x + chart.size.x > width)
+            {
+                cursor = glm::ivec2(0, cursor.y + shelfHeight);
+                shelfHeight = 0;
+            }
+
+            chart.origin = cursor;
+            cursor.x += chart.size.x;
+            shelfHeight = std::max(shelfHeight, chart.size.y);
+        }
+
+        const int height = (cursor.y + shelfHeight + 3) & ~3;
+        if (height > maxSize)
+            return false;
+
+        atlasSize = glm::ivec2((width + 3) & ~3, height);
+        return true;
+    }
+
+    std::shared_ptr<BakedLighting> BakedLighting::Bake(std::vector<BakeMesh>& meshes, std::span<LightSource* const> lights)
+    {
+        return Bake(meshes, lights, BakeSettings());
+    }
+
+    std::shared_ptr<BakedLighting> BakedLighting::Bake(std::vector<BakeMesh>& meshes, std::span<LightSource* const> lights,
+        const BakeSettings& settings)
+    {
+        LoggerContext ctx("BakedLighting", "Bake");
+
+        auto start = std::chrono::steady_clock::now();
+
+        // Broken triangles are dropped and missing normals are generated, smooth over shared vertices.
+        for (BakeMesh& mesh : meshes)
+        {
+            const std::size_t vertexCount = mesh.positions.size();
+
+            std::vector<uint32_t> indices;
+            indices.reserve(mesh.indices.size());
+            for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+            {
+                if (mesh.indices[i] < vertexCount && mesh.indices[i + 1] < vertexCount && mesh.indices[i + 2] < vertexCount)
+                    indices.insert(indices.end(), mesh.indices.begin() + i, mesh.indices.begin() + i + 3);
+            }
+            mesh.indices = std::move(indices);
+
+            if (mesh.normals.size() != vertexCount)
+            {
+                mesh.normals.assign(vertexCount, glm::vec3(0.0f));
+                for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+                {
+                    const glm::vec3& p0 = mesh.positions[mesh.indices[i]];
+                    const glm::vec3 n = glm::cross(mesh.positions[mesh.indices[i + 1]] - p0, mesh.positions[mesh.indices[i + 2]] - p0);
+                    for (int c = 0; c < 3; ++c)
+                        mesh.normals[mesh.indices[i + c]] += n;
+                }
+            }
+
+            for (glm::vec3& normal : mesh.normals)
+                normal = glm::dot(normal, normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+
+        // Charts
+        std::vector<Chart> charts;
+        BuildCharts(meshes, charts);
+
+        if (charts.empty())
+        {
+            Logger::Error("No triangles to bake!");
+            return nullptr;
+        }
+
+        const int padding = std::max(settings.padding, 1);
+        const int maxSize = std::max(settings.maxLightmapSize, 16);
+
+        float density = std::max(settings.texelsPerUnit, 1e-4f);
+        glm::ivec2 atlasSize(0, 0);
+        while (!PackCharts(charts, density, padding, maxSize, atlasSize))
+        {
+            density *= 0.85f;
+            if (density < 1e-6f)
+            {
+                Logger::Error("The level doesn't fit a {}x{} lightmap!", maxSize, maxSize);
+                return nullptr;
+            }
+        }
+
+        if (density < settings.texelsPerUnit)
+            Logger::Warning("{} texels per unit don't fit a {}x{} lightmap, using {:.2f}", settings.texelsPerUnit, maxSize, maxSize, density);
+
+        // Vertices used by several charts are split, one copy per chart.
+        std::vector<std::vector<std::size_t>> meshCharts(meshes.size());
+        for (std::size_t c = 0; c < charts.size(); ++c)
+            meshCharts[charts[c].mesh].push_back(c);
+
+        for (std::size_t m = 0; m < meshes.size(); ++m)
+        {
+            BakeMesh& mesh = meshes[m];
+
+            std::vector<glm::vec3> positions, normals;
+            std::vector<glm::vec2> texCoords;
+            std::vector<uint32_t> sources;
+            std::vector<uint32_t> indices(mesh.indices.size());
+            std::unordered_map<uint64_t, uint32_t> remap;
+
+            for (std::size_t c : meshCharts[m])
+            {
+                const Chart& chart = charts[c];
+                for (uint32_t t : chart.triangles)
+                {
+                    for (int corner = 0; corner < 3; ++corner)
+                    {
+                        const uint32_t vertex = mesh.indices[t * 3 + corner];
+                        auto [it, inserted] = remap.try_emplace((static_cast<uint64_t>(c) << 32) | vertex,
+                            static_cast<uint32_t>(positions.size()));
+
+                        if (inserted)
+                        {
+                            // Texel centers are at half coordinates, the chart starts on the first one past the padding.
+                            const glm::vec2 texel = glm::vec2(chart.origin) + glm::vec2(static_cast<float>(padding) + 0.5f)
+                                + (Project(mesh.positions[vertex], chart.axis) - chart.min) * density;
+
+                            positions.push_back(mesh.positions[vertex]);
+                            normals.push_back(mesh.normals[vertex]);
+                            texCoords.push_back(texel / glm::vec2(atlasSize));
+                            sources.push_back(vertex);
+                        }
+
+                        indices[t * 3 + corner] = it->second;
+                    }
+                }
+            }
+
+            mesh.positions = std::move(positions);
+            mesh.normals = std::move(normals);
+            mesh.lightmapTexCoords = std::move(texCoords);
+            mesh.sourceVertices = std::move(sources);
+            mesh.indices = std::move(indices);
+        }
+
+        // Level geometry for the rays, triangles numbered across all meshes.
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> triangleMeshes;
+        for (uint32_t m = 0; m < meshes.size(); ++m)
+        {
+            const uint32_t base = static_cast<uint32_t>(positions.size());
+            positions.insert(positions.end(), meshes[m].positions.begin(), meshes[m].positions.end());
+            normals.insert(normals.end(), meshes[m].normals.begin(), meshes[m].normals.end());
+            for (uint32_t index : meshes[m].indices)
+                indices.push_back(base + index);
+            triangleMeshes.insert(triangleMeshes.end(), meshes[m].indices.size() / 3, m);
+        }
+
+        BVH bvh;
+        bvh.Build(positions, indices);
+
+        Logger::Info("Built BVH over {} triangles ({} nodes)", bvh.GetTriangleCount(), bvh.GetNodeCount());
+
+        const AABB& bounds = bvh.GetBounds();
+        const float diagonal = glm::length(bounds.max - bounds.min);
+        const float farDistance = diagonal * 2.0f;
+        const float bias = std::max(diagonal * 1e-5f, 1e-4f);
+
+        std::vector<BakeLight> bakeLights;
+        for (LightSource* light : lights)
+        {
+            if (!light || !light->enabled) continue;
+
+            BakeLight bakeLight{};
+            bakeLight.type = light->GetType();
+            bakeLight.radiance = light->color.ToVec3() * light->intensity;
+
+            if (bakeLight.type == LightType::Directional)
+            {
+                bakeLight.direction = glm::normalize(static_cast<DirectionalLight*>(light)->direction);
+            }
+            else if (bakeLight.type == LightType::Point)
+            {
+                const PointLight* point = static_cast<PointLight*>(light);
+                bakeLight.position = point->position;
+                bakeLight.constant = point->constant;
+                bakeLight.linear = point->linear;
+                bakeLight.quadratic = point->quadratic;
+            }
+            else
+            {
+                const SpotLight* spot = static_cast<SpotLight*>(light);
+                bakeLight.position = spot->position;
+                bakeLight.direction = glm::normalize(spot->direction);
+                bakeLight.constant = spot->constant;
+                bakeLight.linear = spot->linear;
+                bakeLight.quadratic = spot->quadratic;
+                bakeLight.innerCutoff = spot->innerCutoff;
+                bakeLight.outerCutoff = spot->outerCutoff;
+            }
+
+            bakeLights.push_back(bakeLight);
+        }
+
+        // Light arriving at the position from a light, unshadowed, with the same falloff as Main.frag.
+        auto GetIncidentLight = [&](const BakeLight& light, const glm::vec3& position, glm::vec3& direction, glm::vec3& target)
+        {
+            if (light.type == LightType::Directional)
+            {
+                direction = -light.direction;
+                target = position + direction * farDistance;
+                return light.radiance;
+            }
+
+            const glm::vec3 toLight = light.position - position;
+            const float distance = glm::length(toLight);
+            if (distance <= 0.0f)
+                return glm::vec3(0.0f);
+
+            direction = toLight / distance;
+            target = light.position;
+
+            float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+            if (light.type == LightType::Spot)
+            {
+                const float theta = glm::dot(direction, -light.direction);
+                attenuation *= std::clamp((theta - light.outerCutoff) / (light.innerCutoff - light.outerCutoff), 0.0f, 1.0f);
+            }
+
+            return light.radiance * attenuation;
+        };
+
+        // Diffuse light reaching a surface, in the units of the real-time shading: radiance times N.L.
+        auto GetDirectLight = [&](const glm::vec3& position, const glm::vec3& normal, std::size_t& rays)
+        {
+            glm::vec3 result(0.0f);
+            for (const BakeLight& light : bakeLights)
+            {
+                glm::vec3 direction, target;
+                const glm::vec3 radiance = GetIncidentLight(light, position, direction, target);
+                const float cosine = glm::dot(normal, direction);
+                if (cosine <= 0.0f || radiance == glm::vec3(0.0f))
+                    continue;
+
+                rays++;
+                if (!bvh.IsOccluded(position, target))
+                    result += radiance * cosine;
+            }
+            return result;
+        };
+
+        // Light coming back along a path: direct light at every surface it reflects off, and the sky.
+        auto TracePath = [&](glm::vec3 origin, glm::vec3 direction, Random& random, std::size_t& rays, bool& backFace)
+        {
+            glm::vec3 radiance(0.0f);
+            glm::vec3 throughput(1.0f);
+
+            for (int bounce = 0; bounce < settings.bounces; ++bounce)
+            {
+                BVH::Hit hit;
+                rays++;
+                if (!bvh.Intersect(origin, direction, farDistance, hit))
+                {
+                    radiance += throughput * settings.skyColor;
+                    break;
+                }
+
+                // The inside of closed geometry stays dark.
+                if (hit.backFace)
+                {
+                    backFace = bounce == 0;
+                    break;
+                }
+
+                const uint32_t* triangle = &indices[hit.triangle * 3];
+                const float w = 1.0f - hit.u - hit.v;
+                const glm::vec3& p0 = positions[triangle[0]];
+                const glm::vec3 faceNormal = glm::normalize(glm::cross(positions[triangle[1]] - p0, positions[triangle[2]] - p0));
+                glm::vec3 normal = normals[triangle[0]] * w + normals[triangle[1]] * hit.u + normals[triangle[2]] * hit.v;
+                normal = glm::dot(normal, normal) > 0.0f ? glm::normalize(normal) : faceNormal;
+
+                origin = origin + direction * hit.distance + faceNormal * bias;
+                throughput *= meshes[triangleMeshes[hit.triangle]].albedo;
+                radiance += throughput * GetDirectLight(origin, normal, rays);
+
+                direction = SampleCosine(normal, random);
+            }
+
+            return radiance;
+        };
+
+        auto lighting = std::make_shared<BakedLighting>();
+        lighting->_lightmapSize = atlasSize;
+
+        // Texels covered by a triangle, found at their centers.
+        const std::size_t texelCount = static_cast<std::size_t>(atlasSize.x) * atlasSize.y;
+        std::vector<Texel> texels(texelCount);
+
+        for (const BakeMesh& mesh : meshes)
+        {
+            for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+            {
+                const uint32_t* triangle = &mesh.indices[i];
+                glm::vec2 q[3];
+                for (int c = 0; c < 3; ++c)
+                    q[c] = mesh.lightmapTexCoords[triangle[c]] * glm::vec2(atlasSize) - glm::vec2(0.5f);
+
+                const glm::vec2 e1 = q[1] - q[0];
+                const glm::vec2 e2 = q[2] - q[0];
+                const float area = e1.x * e2.y - e2.x * e1.y;
+                if (std::abs(area) < 1e-12f)
+                    continue;
+
+                const glm::vec3& p0 = mesh.positions[triangle[0]];
+                const glm::vec3 faceNormal = glm::normalize(glm::cross(mesh.positions[triangle[1]] - p0, mesh.positions[triangle[2]] - p0));
+
+                const glm::vec2 lo = glm::min(q[0], glm::min(q[1], q[2]));
+                const glm::vec2 hi = glm::max(q[0], glm::max(q[1], q[2]));
+                const int x0 = std::max(static_cast<int>(std::ceil(lo.x)), 0), x1 = std::min(static_cast<int>(std::floor(hi.x)), atlasSize.x - 1);
+                const int y0 = std::max(static_cast<int>(std::ceil(lo.y)), 0), y1 = std::min(static_cast<int>(std::floor(hi.y)), atlasSize.y - 1);
+
+                for (int y = y0; y <= y1; ++y)
+                {
+                    for (int x = x0; x <= x1; ++x)
+                    {
+                        const glm::vec2 d = glm::vec2(static_cast<float>(x), static_cast<float>(y)) - q[0];
+                        const float b1 = (d.x * e2.y - e2.x * d.y) / area;
+                        const float b2 = (e1.x * d.y - d.x * e1.y) / area;
+                        const float b0 = 1.0f - b1 - b2;
+                        if (b0 < 0.0f || b1 < 0.0f || b2 < 0.0f)
+                            continue;
+
+                        Texel& texel = texels[static_cast<std::size_t>(y) * atlasSize.x + x];
+                        if (texel.covered)
+                            continue;
+
+                        const glm::vec3 normal = mesh.normals[triangle[0]] * b0 + mesh.normals[triangle[1]] * b1 + mesh.normals[triangle[2]] * b2;
+
+                        texel.position = p0 * b0 + mesh.positions[triangle[1]] * b1 + mesh.positions[triangle[2]] * b2;
+                        texel.normal = glm::dot(normal, normal) > 0.0f ? glm::normalize(normal) : faceNormal;
+                        texel.faceNormal = faceNormal;
+                        texel.covered = true;
+                    }
+                }
+            }
+        }
+
+        // Probes on a grid over the level, cell-centered so none sits on the outer walls.
+        float spacing = std::max(settings.probeSpacing, 1e-3f);
+        auto CountProbes = [&bounds](float cell)
+        {
+            const glm::vec3 size = bounds.max - bounds.min;
+            return static_cast<std::size_t>(std::max(std::ceil(size.x / cell), 1.0f)) * static_cast<std::size_t>(std::max(std::ceil(size.y / cell), 1.0f))
+                * static_cast<std::size_t>(std::max(std::ceil(size.z / cell), 1.0f));
+        };
+
+        if (CountProbes(spacing) > settings.maxProbes)
+        {
+            const float requested = spacing;
+            while (CountProbes(spacing) > settings.maxProbes)
+                spacing *= 1.1f;
+
+            Logger::Warning("Probe spacing {} gives too many probes, using {:.2f}", requested, spacing);
+        }
+
+        lighting->_ResizeProbes(bounds, spacing);
+
+        const std::size_t probeCount = lighting->GetProbeCount();
+        const int samples = std::max(settings.samples, 1);
+        const std::size_t rows = static_cast<std::size_t>(atlasSize.y);
+
+        const unsigned int threadCount = std::max(1u,
+            settings.threads > 0 ? static_cast<unsigned int>(settings.threads) : std::thread::hardware_concurrency());
+
+        Logger::Info("Baking a {}x{} lightmap ({} charts, {:.2f} texels per unit) and {} probes ({}x{}x{}, {:.2f} units) "
+            "with {} samples and {} bounce(s) on {} thread(s)...",
+            atlasSize.x, atlasSize.y, charts.size(), density, probeCount, lighting->_probeResolution.x, lighting->_probeResolution.y,
+            lighting->_probeResolution.z, spacing, samples, settings.bounces, threadCount);
+
+        std::vector<glm::vec3> lightmap(texelCount, glm::vec3(0.0f));
+        std::vector<uint8_t> valid(texelCount, 0);
+        std::vector<uint8_t> validProbes(probeCount, 0);
+        lighting->_probes.assign(probeCount, SHCoefficients{});
+
+        // Samples seeing mostly back faces start inside geometry; their light is taken from the neighbours.
+        const int maxBackFaces = samples / 4;
+
+        std::atomic<std::size_t> nextItem = 0;
+        std::atomic<std::size_t> raysCast = 0;
+
+        // Work items are the lightmap rows, then the probes.
+        auto Worker = [&]()
+        {
+            std::size_t rays = 0;
+
+            for (std::size_t item = nextItem++; item < rows + probeCount; item = nextItem++)
+            {
+                if (item < rows)
+                {
+                    for (int x = 0; x < atlasSize.x; ++x)
+                    {
+                        const std::size_t index = item * atlasSize.x + x;
+                        const Texel& texel = texels[index];
+                        if (!texel.covered)
+                            continue;
+
+                        Random random(static_cast<uint32_t>(index));
+                        const glm::vec3 origin = texel.position + texel.faceNormal * bias;
+
+                        glm::vec3 indirect(0.0f);
+                        int backFaces = 0;
+                        for (int s = 0; s < samples && settings.bounces > 0; ++s)
+                        {
+                            bool backFace = false;
+                            indirect += TracePath(origin, SampleCosine(texel.normal, random), random, rays, backFace);
+                            backFaces += backFace ? 1 : 0;
+                        }
+
+                        if (backFaces > maxBackFaces)
+                            continue;
+
+                        // With cosine-weighted directions the mean radiance is the irradiance over pi,
+                        // which is what the shading multiplies with the surface color.
+                        lightmap[index] = GetDirectLight(origin, texel.normal, rays) + indirect / static_cast<float>(samples);
+                        valid[index] = 1;
+                    }
+                }
+                else
+                {
+                    const std::size_t probe = item - rows;
+                    const glm::ivec3 coords(static_cast<int>(probe % lighting->_probeResolution.x),
+                        static_cast<int>((probe / lighting->_probeResolution.x) % lighting->_probeResolution.y),
+                        static_cast<int>(probe / (static_cast<std::size_t>(lighting->_probeResolution.x) * lighting->_probeResolution.y)));
+                    const glm::vec3 position = lighting->_probeBounds.min + glm::vec3(coords.x, coords.y, coords.z) * lighting->_probeSpacing;
+
+                    Random random(static_cast<uint32_t>(texelCount + probe));
+
+                    // Projection of the incoming radiance, then of the lights themselves as deltas.
+                    SHCoefficients radiance{};
+                    int backFaces = 0;
+                    for (int s = 0; s < samples; ++s)
+                    {
+                        const glm::vec3 direction = SampleSphere(random);
+                        bool backFace = false;
+                        const glm::vec3 incoming = TracePath(position, direction, random, rays, backFace);
+                        backFaces += backFace ? 1 : 0;
+
+                        const std::array<float, 9> basis = GetSHBasis(direction);
+                        for (int i = 0; i < 9; ++i)
+                            radiance[i] += incoming * (basis[i] * 4.0f * Pi / static_cast<float>(samples));
+                    }
+
+                    if (backFaces > maxBackFaces)
+                        continue;
+
+                    for (const BakeLight& light : bakeLights)
+                    {
+                        glm::vec3 direction, target;
+                        const glm::vec3 incoming = GetIncidentLight(light, position, direction, target);
+                        if (incoming == glm::vec3(0.0f))
+                            continue;
+
+                        rays++;
+                        if (bvh.IsOccluded(position, target))
+                            continue;
+
+                        // Scaled by pi so a lit surface facing the light gets radiance * N.L, as in Main.frag.
+                        const std::array<float, 9> basis = GetSHBasis(direction);
+                        for (int i = 0; i < 9; ++i)
+                            radiance[i] += incoming * (basis[i] * Pi);
+                    }
+
+                    // Convolution with the clamped cosine (pi, 2pi/3, pi/4 per band), over pi.
+                    SHCoefficients& sh = lighting->_probes[probe];
+                    for (int i = 0; i < 9; ++i)
+                        sh[i] = radiance[i] * (i == 0 ? 1.0f : (i < 4 ? 2.0f / 3.0f : 0.25f));
+
+                    validProbes[probe] = 1;
+                }
+            }
+
+            raysCast += rays;
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < threadCount; ++i)
+            workers.emplace_back(Worker);
+
+        Worker();
+
+        for (std::thread& worker : workers)
+            worker.join();
+
+        std::size_t coveredTexels = 0;
+        for (uint8_t texel : valid)
+            coveredTexels += texel;
+
+        // Empty texels take the average of their lit neighbours, which fills the chart padding and
+        // the texels no triangle center fell into.
+        for (int pass = 0; pass <= padding; ++pass)
+        {
+            const std::vector<uint8_t> source = valid;
+            for (int y = 0; y < atlasSize.y; ++y)
+            {
+                for (int x = 0; x < atlasSize.x; ++x)
+                {
+                    const std::size_t index = static_cast<std::size_t>(y) * atlasSize.x + x;
+                    if (source[index])
+                        continue;
+
+                    glm::vec3 sum(0.0f);
+                    int count = 0;
+                    for (int dy = -1; dy <= 1; ++dy)
+                    {
+                        for (int dx = -1; dx <= 1; ++dx)
+                        {
+                            const int nx = x + dx, ny = y + dy;
+                            if (nx < 0 || ny < 0 || nx >= atlasSize.x || ny >= atlasSize.y)
+                                continue;
+
+                            const std::size_t neighbour = static_cast<std::size_t>(ny) * atlasSize.x + nx;
+                            if (source[neighbour])
+                            {
+                                sum += lightmap[neighbour];
+                                count++;
+                            }
+                        }
+                    }
+
+                    if (count > 0)
+                    {
+                        lightmap[index] = sum / static_cast<float>(count);
+                        valid[index] = 1;
+                    }
+                }
+            }
+        }
+
+        lighting->_lightmap.resize(texelCount * 3);
+        for (std::size_t i = 0; i < texelCount; ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+                lighting->_lightmap[i * 3 + c] = glm::packHalf1x16(lightmap[i][c]);
+        }
+
+        // Probes inside geometry take the average of their valid neighbours, spreading inwards.
+        std::size_t invalidProbes = probeCount;
+        for (uint8_t probe : validProbes)
+            invalidProbes -= probe;
+
+        const glm::ivec3& resolution = lighting->_probeResolution;
+        for (bool changed = invalidProbes < probeCount; changed; )
+        {
+            changed = false;
+            const std::vector<uint8_t> source = validProbes;
+
+            for (std::size_t probe = 0; probe < probeCount; ++probe)
+            {
+                if (source[probe])
+                    continue;
+
+                const glm::ivec3 coords(static_cast<int>(probe % resolution.x), static_cast<int>((probe / resolution.x) % resolution.y),
+                    static_cast<int>(probe / (static_cast<std::size_t>(resolution.x) * resolution.y)));
+
+                SHCoefficients sum{};
+                int count = 0;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    for (int step = -1; step <= 1; step += 2)
+                    {
+                        glm::ivec3 neighbour = coords;
+                        neighbour[axis] += step;
+                        if (neighbour[axis] < 0 || neighbour[axis] >= resolution[axis])
+                            continue;
+
+                        const std::size_t index = lighting->_GetProbeIndex(neighbour);
+                        if (!source[index])
+                            continue;
+
+                        for (int i = 0; i < 9; ++i)
+                            sum[i] += lighting->_probes[index][i];
+                        count++;
+                    }
+                }
+
+                if (count > 0)
+                {
+                    for (int i = 0; i < 9; ++i)
+                        lighting->_probes[probe][i] = sum[i] / static_cast<float>(count);
+                    validProbes[probe] = 1;
+                    changed = true;
+                }
+            }
+        }
+
+        BakeStats& stats = lighting->_bakeStats;
+        stats.lightmapSize = atlasSize;
+        stats.charts = charts.size();
+        stats.texels = coveredTexels;
+        stats.probes = probeCount;
+        stats.invalidProbes = invalidProbes;
+        stats.raysCast = raysCast;
+        stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        Logger::Info("Baked in {:.1f} ms: {} rays, {:.1f}% of the lightmap covered, {} of {} probes inside geometry",
+            stats.elapsedMs, stats.raysCast, 100.0 * static_cast<double>(coveredTexels) / static_cast<double>(texelCount),
+            invalidProbes, probeCount);
+
+        return lighting;
+    }
+
+    std::shared_ptr<BakedLighting> BakedLighting::Load(const std::string& path)
+    {
+        LoggerContext ctx("BakedLighting", "Load");
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            Logger::Error("Failed to open file: '{}'", path);
+            return nullptr;
+        }
+
+        BakedLightingFileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file || header.magic != BAKED_LIGHTING_MAGIC || header.version != BAKED_LIGHTING_VERSION
+            || header.lightmapSize[0] < 0 || header.lightmapSize[1] < 0 || header.probeSpacing <= 0.0f
+            || header.probeResolution[0] <= 0 || header.probeResolution[1] <= 0 || header.probeResolution[2] <= 0)
+        {
+            Logger::Error("'{}' is not a valid baked lighting file!", path);
+            return nullptr;
+        }
+
+        auto lighting = std::make_shared<BakedLighting>();
+        lighting->_lightmapSize = glm::ivec2(header.lightmapSize[0], header.lightmapSize[1]);
+        lighting->_lightmap.resize(static_cast<std::size_t>(header.lightmapSize[0]) * header.lightmapSize[1] * 3);
+
+        const glm::vec3 origin(header.probeOrigin[0], header.probeOrigin[1], header.probeOrigin[2]);
+        const glm::ivec3 resolution(header.probeResolution[0], header.probeResolution[1], header.probeResolution[2]);
+        lighting->_probeSpacing = header.probeSpacing;
+        lighting->_probeResolution = resolution;
+        lighting->_probeBounds = AABB(origin, origin + glm::vec3(resolution.x - 1, resolution.y - 1, resolution.z - 1) * header.probeSpacing);
+        lighting->_probes.resize(lighting->GetProbeCount());
+
+        file.read(reinterpret_cast<char*>(lighting->_lightmap.data()), lighting->_lightmap.size() * sizeof(uint16_t));
+        file.read(reinterpret_cast<char*>(lighting->_probes.data()), lighting->_probes.size() * sizeof(SHCoefficients));
+        if (!file)
+        {
+            Logger::Error("'{}' is truncated!", path);
+            return nullptr;
+        }
+
+        Logger::Info("Loaded baked lighting '{}': {}x{} lightmap, {} probes",
+            path, lighting->_lightmapSize.x, lighting->_lightmapSize.y, lighting->GetProbeCount());
+
+        return lighting;
+    }
+
+    bool BakedLighting::Save(const std::string& path) const
+    {
+        LoggerContext ctx("BakedLighting", "Save");
+
+        static_assert(sizeof(SHCoefficients) == 27 * sizeof(float));
+
+        BakedLightingFileHeader header{};
+        header.magic = BAKED_LIGHTING_MAGIC;
+        header.version = BAKED_LIGHTING_VERSION;
+        header.lightmapSize[0] = _lightmapSize.x;
+        header.lightmapSize[1] = _lightmapSize.y;
+        header.probeOrigin[0] = _probeBounds.min.x;
+        header.probeOrigin[1] = _probeBounds.min.y;
+        header.probeOrigin[2] = _probeBounds.min.z;
+        header.probeSpacing = _probeSpacing;
+        header.probeResolution[0] = _probeResolution.x;
+        header.probeResolution[1] = _probeResolution.y;
+        header.probeResolution[2] = _probeResolution.z;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            Logger::Error("Failed to open file: '{}'", path);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(_lightmap.data()), _lightmap.size() * sizeof(uint16_t));
+        file.write(reinterpret_cast<const char*>(_probes.data()), _probes.size() * sizeof(SHCoefficients));
+
+        if (!file)
+        {
+            Logger::Error("Failed to write file: '{}'", path);
+            return false;
+        }
+
+        return true;
+    }
+
+    BakedLighting::SHCoefficients BakedLighting::SampleProbes(const glm::vec3& position) const
+    {
+        SHCoefficients result{};
+        if (_probes.empty())
+            return result;
+
+        const glm::ivec3 last = _probeResolution - glm::ivec3(1, 1, 1);
+        const glm::vec3 local = glm::clamp((position - _probeBounds.min) / _probeSpacing, glm::vec3(0.0f), glm::vec3(last.x, last.y, last.z));
+        const glm::ivec3 base = glm::min(glm::ivec3(glm::floor(local)), last);
+        const glm::vec3 f = local - glm::vec3(base.x, base.y, base.z);
+
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const glm::ivec3 offset(corner & 1, (corner >> 1) & 1, corner >> 2);
+            const glm::ivec3 coords = glm::min(base + offset, last);
+            const float weight = (offset.x ? f.x : 1.0f - f.x) * (offset.y ? f.y : 1.0f - f.y) * (offset.z ? f.z : 1.0f - f.z);
+            if (weight <= 0.0f)
+                continue;
+
+            const SHCoefficients& probe = _probes[_GetProbeIndex(coords)];
+            for (int i = 0; i < 9; ++i)
+                result[i] += probe[i] * weight;
+        }
+
+        return result;
+    }
+
+    glm::vec3 BakedLighting::EvaluateSH(const SHCoefficients& sh, const glm::vec3& normal)
+    {
+        const std::array<float, 9> basis = GetSHBasis(normal);
+
+        glm::vec3 result(0.0f);
+        for (int i = 0; i < 9; ++i)
+            result += sh[i] * basis[i];
+
+        return glm::max(result, glm::vec3(0.0f));
+    }
+
+    const std::shared_ptr<Texture>& BakedLighting::GetLightmapTexture()
+    {
+        if (_lightmapTexture || _lightmap.empty())
+            return _lightmapTexture;
+
+        TextureDesc descriptor;
+        descriptor.width = _lightmapSize.x;
+        descriptor.height = _lightmapSize.y;
+        descriptor.channels = 3;
+        descriptor.type = GL_HALF_FLOAT;
+        descriptor.internalFormat = TextureFormat::RGB16F;
+        descriptor.format = TextureFormat::RGB;
+        descriptor.wrapS = TextureWrap::ClampToEdge;
+        descriptor.wrapT = TextureWrap::ClampToEdge;
+
+        _lightmapTexture = Texture::Create(descriptor);
+
+        // Rows are 6 bytes per texel, not always a multiple of 4.
+        glBindTexture(GL_TEXTURE_2D, _lightmapTexture->GetID());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _lightmapSize.x, _lightmapSize.y, GL_RGB, GL_HALF_FLOAT, _lightmap.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        return _lightmapTexture;
+    }
+
+    const glm::ivec2& BakedLighting::GetLightmapSize() const { return _lightmapSize; }
+    const AABB& BakedLighting::GetProbeBounds() const { return _probeBounds; }
+    const glm::ivec3& BakedLighting::GetProbeResolution() const { return _probeResolution; }
+    float BakedLighting::GetProbeSpacing() const { return _probeSpacing; }
+    std::size_t BakedLighting::GetProbeCount() const { return static_cast<std::size_t>(_probeResolution.x) * _probeResolution.y * _probeResolution.z; }
+    const BakedLighting::BakeStats& BakedLighting::GetBakeStats() const { return _bakeStats; }
+
+    void BakedLighting::_ResizeProbes(const AABB& bounds, float spacing)
+    {
+        const glm::vec3 size = bounds.max - bounds.min;
+
+        _probeSpacing = spacing;
+        _probeResolution = glm::max(glm::ivec3(glm::ceil(size / spacing)), glm::ivec3(1, 1, 1));
+
+        // Centered in the level, half a cell in from its sides.
+        const glm::vec3 span = glm::vec3(_probeResolution.x - 1, _probeResolution.y - 1, _probeResolution.z - 1) * spacing;
+        const glm::vec3 first = bounds.GetCenter() - span * 0.5f;
+        _probeBounds = AABB(first, first + span);
+    }
+
+    std::size_t BakedLighting::_GetProbeIndex(const glm::ivec3& coords) const
+    {
+        return static_cast<std::size_t>(coords.x) + static_cast<std::size_t>(_probeResolution.x)
+            * (static_cast<std::size_t>(coords.y) + static_cast<std::size_t>(_probeResolution.y) * coords.z);
+    }
+}
\ No newline at end of file
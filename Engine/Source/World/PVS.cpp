@@ -0,0 +1,377 @@
+#include "World/PVS.hpp"
+#include "Math/BVH.hpp"
+#include "Core/Logger.hpp"
+
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <bit>
+
+namespace AE
+{
+    static constexpr uint32_t PVS_MAGIC = 0x56504541; // "AEPV"
+    static constexpr uint32_t PVS_VERSION = 1;
+
+    struct PVSFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        float origin[3];
+        float cellSize;
+        int32_t resolution[3];
+        uint32_t rowWords;
+    };
+
+    std::shared_ptr<PVS> PVS::Bake(std::span<const glm::vec3> positions, std::span<const uint32_t> indices)
+    {
+        return Bake(positions, indices, BakeSettings());
+    }
+
+    std::shared_ptr<PVS> PVS::Bake(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+        const BakeSettings& settings)
+    {
+        LoggerContext ctx("PVS", "Bake");
+
+        auto start = std::chrono::steady_clock::now();
+
+        BVH bvh;
+        bvh.Build(positions, indices);
+
+        if (bvh.IsEmpty())
+        {
+            Logger::Error("No triangles to bake!");
+            return nullptr;
+        }
+
+        Logger::Info("Built BVH over {} triangles ({} nodes)", bvh.GetTriangleCount(), bvh.GetNodeCount());
+
+        // Pad the level a little so geometry on the border falls inside the grid.
+        AABB bounds = bvh.GetBounds();
+        bounds.min -= glm::vec3(1e-3f);
+        bounds.max += glm::vec3(1e-3f);
+
+        float cellSize = std::max(settings.cellSize, 1e-3f);
+        const glm::vec3 size = bounds.max - bounds.min;
+        auto CountCells = [&size](float cell)
+        {
+            return static_cast<std::size_t>(std::ceil(size.x / cell)) * static_cast<std::size_t>(std::ceil(size.y / cell))
+                * static_cast<std::size_t>(std::ceil(size.z / cell));
+        };
+
+        // Memory and bake time grow with the square of the cell count.
+        if (CountCells(cellSize) > settings.maxCells)
+        {
+            const float requested = cellSize;
+            while (CountCells(cellSize) > settings.maxCells)
+                cellSize *= 1.1f;
+
+            Logger::Warning("Cell size {} gives too many cells, using {:.2f}", requested, cellSize);
+        }
+
+        auto pvs = std::make_shared<PVS>();
+        pvs->_Resize(bounds, cellSize);
+
+        const std::size_t cellCount = pvs->GetCellCount();
+        const int samples = std::max(settings.samples, 1);
+
+        const unsigned int threadCount = std::max(1u,
+            settings.threads > 0 ? static_cast<unsigned int>(settings.threads) : std::thread::hardware_concurrency());
+
+        Logger::Info("Baking {} cells ({}x{}x{}, {:.2f} units) with {} samples per pair on {} thread(s)...",
+            cellCount, pvs->_resolution.x, pvs->_resolution.y, pvs->_resolution.z, cellSize, samples, threadCount);
+
+        std::atomic<std::size_t> nextCell = 0;
+        std::atomic<std::size_t> raysCast = 0;
+
+        // Each worker owns whole rows and only tests the pairs (a, b >= a); the rest is mirrored after.
+        auto Worker = [&]()
+        {
+            std::size_t rays = 0;
+
+            for (std::size_t a = nextCell++; a < cellCount; a = nextCell++)
+            {
+                const glm::ivec3 ca = pvs->_GetCoords(a);
+                const glm::vec3 minA = bounds.min + glm::vec3(ca.x, ca.y, ca.z) * cellSize;
+
+                for (std::size_t b = a; b < cellCount; ++b)
+                {
+                    const glm::ivec3 cb = pvs->_GetCoords(b);
+
+                    // Neighbours always see each other.
+                    if (std::abs(ca.x - cb.x) <= 1 && std::abs(ca.y - cb.y) <= 1 && std::abs(ca.z - cb.z) <= 1)
+                    {
+                        pvs->_SetVisible(a, b);
+                        continue;
+                    }
+
+                    const glm::vec3 minB = bounds.min + glm::vec3(cb.x, cb.y, cb.z) * cellSize;
+
+                    // xorshift seeded by the pair, so bakes are reproducible.
+                    uint32_t state = static_cast<uint32_t>(a * 2654435761u) ^ static_cast<uint32_t>(b * 40503u) ^ 0x9e3779b9u;
+                    auto Random = [&state]()
+                    {
+                        state ^= state << 13;
+                        state ^= state >> 17;
+                        state ^= state << 5;
+                        return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+                    };
+
+                    for (int i = 0; i < samples; ++i)
+                    {
+                        const glm::vec3 from = minA + glm::vec3(Random(), Random(), Random()) * cellSize;
+                        const glm::vec3 to = minB + glm::vec3(Random(), Random(), Random()) * cellSize;
+
+                        rays++;
+                        if (!bvh.IsOccluded(from, to))
+                        {
+                            pvs->_SetVisible(a, b);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            raysCast += rays;
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < threadCount; ++i)
+            workers.emplace_back(Worker);
+
+        Worker();
+
+        for (std::thread& worker : workers)
+            worker.join();
+
+        for (std::size_t a = 0; a < cellCount; ++a)
+            for (std::size_t b = 0; b < a; ++b)
+                if (pvs->IsCellVisible(static_cast<int>(b), static_cast<int>(a)))
+                    pvs->_SetVisible(a, b);
+
+        if (settings.dilation > 0)
+        {
+            const std::vector<uint64_t> source = pvs->_bits;
+            const int d = settings.dilation;
+
+            for (std::size_t a = 0; a < cellCount; ++a)
+            {
+                const uint64_t* row = &source[a * pvs->_rowWords];
+
+                for (std::size_t b = 0; b < cellCount; ++b)
+                {
+                    if (!(row[b / 64] & (uint64_t(1) << (b % 64))))
+                        continue;
+
+                    const glm::ivec3 cb = pvs->_GetCoords(b);
+                    const glm::ivec3 lo = glm::max(cb - glm::ivec3(d, d, d), glm::ivec3(0, 0, 0));
+                    const glm::ivec3 hi = glm::min(cb + glm::ivec3(d, d, d), pvs->_resolution - glm::ivec3(1, 1, 1));
+
+                    for (int z = lo.z; z <= hi.z; ++z)
+                        for (int y = lo.y; y <= hi.y; ++y)
+                            for (int x = lo.x; x <= hi.x; ++x)
+                                pvs->_SetVisible(a, pvs->_GetIndex(glm::ivec3(x, y, z)));
+                }
+            }
+        }
+
+        BakeStats& stats = pvs->_bakeStats;
+        stats.cells = cellCount;
+        stats.pairsTested = cellCount * (cellCount + 1) / 2;
+        stats.raysCast = raysCast;
+        stats.visibleFraction = pvs->GetVisibleFraction();
+        stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        Logger::Info("Baked {} cells in {:.1f} ms: {} rays, {:.1f}% of the level visible per cell on average",
+            cellCount, stats.elapsedMs, stats.raysCast, stats.visibleFraction * 100.0f);
+
+        return pvs;
+    }
+
+    std::shared_ptr<PVS> PVS::Load(const std::string& path)
+    {
+        LoggerContext ctx("PVS", "Load");
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            Logger::Error("Failed to open file: '{}'", path);
+            return nullptr;
+        }
+
+        PVSFileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file || header.magic != PVS_MAGIC || header.version != PVS_VERSION || header.cellSize <= 0.0f
+            || header.resolution[0] <= 0 || header.resolution[1] <= 0 || header.resolution[2] <= 0)
+        {
+            Logger::Error("'{}' is not a valid PVS file!", path);
+            return nullptr;
+        }
+
+        auto pvs = std::make_shared<PVS>();
+
+        const glm::vec3 origin(header.origin[0], header.origin[1], header.origin[2]);
+        const glm::ivec3 resolution(header.resolution[0], header.resolution[1], header.resolution[2]);
+        pvs->_Resize(AABB(origin, origin + glm::vec3(resolution.x, resolution.y, resolution.z) * header.cellSize), header.cellSize);
+
+        if (pvs->_resolution != resolution || pvs->_rowWords != header.rowWords)
+        {
+            Logger::Error("'{}' has an inconsistent grid!", path);
+            return nullptr;
+        }
+
+        file.read(reinterpret_cast<char*>(pvs->_bits.data()), pvs->_bits.size() * sizeof(uint64_t));
+        if (!file)
+        {
+            Logger::Error("'{}' is truncated!", path);
+            return nullptr;
+        }
+
+        Logger::Info("Loaded PVS '{}': {} cells, {:.1f}% visible per cell on average",
+            path, pvs->GetCellCount(), pvs->GetVisibleFraction() * 100.0f);
+
+        return pvs;
+    }
+
+    bool PVS::Save(const std::string& path) const
+    {
+        LoggerContext ctx("PVS", "Save");
+
+        PVSFileHeader header{};
+        header.magic = PVS_MAGIC;
+        header.version = PVS_VERSION;
+        header.origin[0] = _bounds.min.x;
+        header.origin[1] = _bounds.min.y;
+        header.origin[2] = _bounds.min.z;
+        header.cellSize = _cellSize;
+        header.resolution[0] = _resolution.x;
+        header.resolution[1] = _resolution.y;
+        header.resolution[2] = _resolution.z;
+        header.rowWords = static_cast<uint32_t>(_rowWords);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            Logger::Error("Failed to open file: '{}'", path);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(_bits.data()), _bits.size() * sizeof(uint64_t));
+
+        if (!file)
+        {
+            Logger::Error("Failed to write file: '{}'", path);
+            return false;
+        }
+
+        return true;
+    }
+
+    int PVS::GetCell(const glm::vec3& position) const
+    {
+        if (_bits.empty() || !_bounds.Contains(position))
+            return -1;
+
+        glm::ivec3 coords(glm::floor((position - _bounds.min) / _cellSize));
+        coords = glm::clamp(coords, glm::ivec3(0, 0, 0), _resolution - glm::ivec3(1, 1, 1));
+
+        return static_cast<int>(_GetIndex(coords));
+    }
+
+    bool PVS::IsCellVisible(int from, int to) const
+    {
+        if (from < 0 || to < 0)
+            return true;
+
+        const std::size_t bit = static_cast<std::size_t>(to);
+        return (_bits[static_cast<std::size_t>(from) * _rowWords + bit / 64] >> (bit % 64)) & 1;
+    }
+
+    bool PVS::IsVisible(int fromCell, const AABB& bounds) const
+    {
+        if (fromCell < 0)
+            return true;
+
+        const glm::ivec3 lo(glm::floor((bounds.min - _bounds.min) / _cellSize));
+        const glm::ivec3 hi(glm::floor((bounds.max - _bounds.min) / _cellSize));
+
+        if (lo.x < 0 || lo.y < 0 || lo.z < 0 || hi.x >= _resolution.x || hi.y >= _resolution.y || hi.z >= _resolution.z)
+            return true;
+
+        const uint64_t* row = &_bits[static_cast<std::size_t>(fromCell) * _rowWords];
+
+        // Cells along x are consecutive bits, so each row of the box is tested a word at a time.
+        for (int z = lo.z; z <= hi.z; ++z)
+        {
+            for (int y = lo.y; y <= hi.y; ++y)
+            {
+                const std::size_t first = _GetIndex(glm::ivec3(lo.x, y, z));
+                const std::size_t last = first + static_cast<std::size_t>(hi.x - lo.x);
+
+                for (std::size_t word = first / 64; word <= last / 64; ++word)
+                {
+                    uint64_t mask = ~uint64_t(0);
+                    if (word == first / 64)
+                        mask &= ~uint64_t(0) << (first % 64);
+                    if (word == last / 64)
+                        mask &= ~uint64_t(0) >> (63 - last % 64);
+
+                    if (row[word] & mask)
+                        return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    const AABB& PVS::GetBounds() const { return _bounds; }
+    const glm::ivec3& PVS::GetResolution() const { return _resolution; }
+    float PVS::GetCellSize() const { return _cellSize; }
+    std::size_t PVS::GetCellCount() const { return static_cast<std::size_t>(_resolution.x) * _resolution.y * _resolution.z; }
+    const PVS::BakeStats& PVS::GetBakeStats() const { return _bakeStats; }
+
+    float PVS::GetVisibleFraction() const
+    {
+        const std::size_t cellCount = GetCellCount();
+        if (cellCount == 0)
+            return 0.0f;
+
+        std::size_t visible = 0;
+        for (uint64_t word : _bits)
+            visible += std::popcount(word);
+
+        return static_cast<float>(visible) / (static_cast<float>(cellCount) * static_cast<float>(cellCount));
+    }
+
+    void PVS::_Resize(const AABB& bounds, float cellSize)
+    {
+        const glm::vec3 size = bounds.max - bounds.min;
+
+        _cellSize = cellSize;
+        _resolution = glm::max(glm::ivec3(glm::ceil(size / cellSize - glm::vec3(1e-4f))), glm::ivec3(1, 1, 1));
+        _bounds = AABB(bounds.min, bounds.min + glm::vec3(_resolution.x, _resolution.y, _resolution.z) * cellSize);
+
+        _rowWords = (GetCellCount() + 63) / 64;
+        _bits.assign(GetCellCount() * _rowWords, 0);
+    }
+
+    glm::ivec3 PVS::_GetCoords(std::size_t cell) const
+    {
+        const int index = static_cast<int>(cell);
+        return glm::ivec3(index % _resolution.x, (index / _resolution.x) % _resolution.y, index / (_resolution.x * _resolution.y));
+    }
+
+    std::size_t PVS::_GetIndex(const glm::ivec3& coords) const
+    {
+        return static_cast<std::size_t>(coords.x) + static_cast<std::size_t>(_resolution.x)
+            * (static_cast<std::size_t>(coords.y) + static_cast<std::size_t>(_resolution.y) * coords.z);
+    }
+
+    void PVS::_SetVisible(std::size_t from, std::size_t to)
+    {
+        _bits[from * _rowWords + to / 64] |= uint64_t(1) << (to % 64);
+    }
+}
\ No newline at end of file
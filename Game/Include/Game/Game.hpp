@@ -30,6 +30,8 @@ private:
     struct GameShaders {
         std::shared_ptr<AE::Shader> main;
         std::shared_ptr<AE::Shader> skybox;
+        std::shared_ptr<AE::Shader> impostor;
+        std::shared_ptr<AE::Shader> shadow;
     } _shaders;
 
     struct GameScenes {
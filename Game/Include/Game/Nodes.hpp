@@ -1,12 +1,15 @@
 #pragma once
 
 #include <AE/Scene/Node.hpp>
+#include <AE/Rendering/CullCache.hpp>
 
 namespace AE
 {
     class Shader;
     class Model;
     class Camera;
+    class HLOD;
+    class Impostor;
 }
 
 class CameraNode : public AE::SceneNode
@@ -39,6 +42,50 @@ public:
 
     std::shared_ptr<AE::Shader> mainShader;
     std::shared_ptr<AE::Model> testModel;
+    AE::CullCache cullCache;
+
+    bool OnInitialize() override;
+    void OnDestroy() override;
+    void OnUpdate() override;
+    void OnRender() override;
+};
+
+class PropNode : public AE::SceneNode
+{
+public:
+
+    PropNode(const std::string& name, std::shared_ptr<AE::Model> model, std::shared_ptr<AE::Shader> shader)
+        : AE::SceneNode(name), model(std::move(model)), mainShader(std::move(shader)) {}
+
+    std::shared_ptr<AE::Model> model;
+    std::shared_ptr<AE::Shader> mainShader;
+    AE::CullCache cullCache;
+
+    // Drawn instead of the model beyond the distance, when set.
+    std::shared_ptr<AE::Impostor> impostor;
+    float impostorDistance = 30.0f;
+
+    void OnDestroy() override;
+    void OnRender() override;
+};
+
+// A grid of static props outside the level. Props farther out are drawn as impostors when one was
+// baked next to their model (see ImpostorBaker), and beyond the switch distance each group of them is
+// drawn as one HLOD proxy instead.
+class PropFieldNode : public AE::SceneNode
+{
+public:
+
+    PropFieldNode(const std::string& name = "PropFieldNode")
+        : AE::SceneNode(name) {}
+
+    int propsPerSide = 12;
+    float spacing = 6.0f;
+
+    std::shared_ptr<AE::Shader> mainShader;
+    std::shared_ptr<AE::Model> propModel;
+    std::shared_ptr<AE::Impostor> propImpostor;
+    std::shared_ptr<AE::HLOD> hlod;
 
     bool OnInitialize() override;
     void OnDestroy() override;
@@ -38,7 +38,15 @@ bool AustereGame::OnInitialize()
     auto cameraNode = std::make_shared<CameraNode>();
     root->AddChild(cameraNode);
 
-    root->AddChild(std::make_shared<TestNode>());
+    auto testNode = std::make_shared<TestNode>();
+    testNode->SetStatic(true);
+    root->AddChild(testNode);
+
+    // Props past the end of the level, to look at the HLOD proxies from afar
+    auto propField = std::make_shared<PropFieldNode>();
+    propField->SetStatic(true);
+    propField->GetTransform().SetPosition(glm::vec3(80.0f, 0.0f, 0.0f));
+    root->AddChild(propField);
 
     // Add and activate test scene
     AE::SceneManager* sceneMgr = engine->GetSceneManager();
@@ -50,9 +58,16 @@ bool AustereGame::OnInitialize()
 
     // Add light sources
     AE::LightManager* lightMgr = engine->GetLightManager();
-    lightMgr->AddLight("Sun", std::make_unique<AE::DirectionalLight>(
+    // Baked along with the level by LightBaker (--sun -0.5,-1,-0.5), real-time while no baked lighting is set.
+    auto sun = std::make_unique<AE::DirectionalLight>(
         AE::Color::White, 1.0f, glm::normalize(glm::vec3(-0.5f, -1.0f, -0.5f))
-    ));
+    );
+    sun->baked = true;
+    lightMgr->AddLight("Sun", std::move(sun));
+
+    auto lamp = std::make_unique<AE::PointLight>(AE::Color(1.0f, 0.85f, 0.6f), 2.0f, glm::vec3(0.0f, 3.0f, 0.0f));
+    lamp->castShadows = true;
+    lightMgr->AddLight("Lamp", std::move(lamp));
 
     // Setup renderer
     AE::Renderer* renderer = engine->GetRenderer();
@@ -60,6 +75,8 @@ bool AustereGame::OnInitialize()
     renderer->SetCamera(cameraNode->camera);
     renderer->SetSkybox(_testSkybox);
     renderer->SetSkyboxShader(_shaders.skybox);
+    renderer->SetImpostorShader(_shaders.impostor);
+    renderer->SetShadowShader(_shaders.shadow);
 
     // AE::Window* window = engine->GetWindow();
     // window->SetVSync(false);
@@ -71,6 +88,8 @@ void AustereGame::OnShutdown()
 {
     _shaders.main.reset();
     _shaders.skybox.reset();
+    _shaders.impostor.reset();
+    _shaders.shadow.reset();
     _scenes.test.reset();
     _skyboxCubemap.reset();
     _testSkybox.reset();
@@ -91,7 +110,10 @@ void AustereGame::OnUpdate()
     }
 
     AE::Window* window = engine->GetWindow();
-    window->SetTitle(GetName() + " v" + GetVersion() + " | FPS: " + std::to_string(engine->GetFPS()));
+    const int culledPercent = static_cast<int>(renderer->GetCullingStats().GetTriangleRejectionRate() * 100.0f + 0.5f);
+    window->SetTitle(GetName() + " v" + GetVersion() + " | FPS: " + std::to_string(engine->GetFPS())
+        + " | Culled: " + std::to_string(culledPercent) + "% tris"
+        + " | Batches: " + std::to_string(renderer->GetBatchStats().GetBatchCount()));
 
     // _testCamera->SetAspectRatio(window->GetAspectRatio());
 }
@@ -109,7 +131,7 @@ bool AustereGame::_LoadResources()
     AE::CubemapManager* cubemapMgr = engine->GetCubemapManager();
 
     // Load main shader
-    _shaders.main = shaderMgr->Load("Main",
+    _shaders.main = shaderMgr->LoadPermutationsAsync("Main",
         "Assets/Shaders/Main.vert",
         "Assets/Shaders/Main.frag"
     );
@@ -121,7 +143,7 @@ bool AustereGame::_LoadResources()
     }
 
     // Load skybox shader
-    _shaders.skybox = shaderMgr->Load("Skybox",
+    _shaders.skybox = shaderMgr->LoadAsync("Skybox",
         "Assets/Shaders/Skybox.vert",
         "Assets/Shaders/Skybox.frag"
     );
@@ -132,6 +154,30 @@ bool AustereGame::_LoadResources()
         return false;
     }
 
+    // Load impostor shader, the atlases are baked offline by ImpostorBaker
+    _shaders.impostor = shaderMgr->LoadAsync("Impostor",
+        "Assets/Shaders/Impostor.vert",
+        "Assets/Shaders/Impostor.frag"
+    );
+
+    if (!_shaders.impostor)
+    {
+        AE::Logger::Error("Failed to load impostor shader!");
+        return false;
+    }
+
+    // Load shadow atlas shader
+    _shaders.shadow = shaderMgr->LoadAsync("Shadow",
+        "Assets/Shaders/Shadow.vert",
+        "Assets/Shaders/Shadow.frag"
+    );
+
+    if (!_shaders.shadow)
+    {
+        AE::Logger::Error("Failed to load shadow shader!");
+        return false;
+    }
+
     // Load skybox cubemap
     _skyboxCubemap = cubemapMgr->Load("Skybox", {
         "Assets/Skyboxes/Clouds_East.bmp",   // +X (right)
@@ -0,0 +1,95 @@
+#include "Game/Nodes.hpp"
+
+#include <AE/Core/Engine.hpp>
+#include <AE/Core/Logger.hpp>
+#include <AE/Rendering/Camera.hpp>
+#include <AE/Rendering/Renderer.hpp>
+#include <AE/Rendering/HLOD.hpp>
+#include <AE/Rendering/Impostor.hpp>
+#include <AE/Resources/Shader.hpp>
+#include <AE/Resources/Model.hpp>
+#include <AE/Resources/Managers.hpp>
+
+#include <filesystem>
+
+bool PropFieldNode::OnInitialize()
+{
+    AE::ShaderManager* shaderMgr = engine->GetShaderManager();
+    AE::ModelManager* modelMgr = engine->GetModelManager();
+
+    mainShader = shaderMgr->Get("Main");
+    if (!mainShader) return false;
+
+    // The HLOD builder merges the props on the CPU, so their meshes must keep their data.
+    propModel = modelMgr->Load("Prop", "Assets/Models/DamagedHelmet.glb", false, true);
+    if (!propModel) return false;
+
+    if (std::filesystem::exists("Assets/Models/DamagedHelmet.impostor"))
+        propImpostor = AE::Impostor::Load("Assets/Models/DamagedHelmet.impostor");
+
+    AE::HLODBuilder::Settings settings;
+    settings.clusterSize = 24.0f;
+    settings.switchDistance = 60.0f;
+    settings.simplifyCellSize = 0.5f;
+
+    AE::HLODBuilder builder(settings);
+
+    const float offset = (propsPerSide - 1) * spacing * 0.5f;
+    for (int z = 0; z < propsPerSide; ++z)
+    {
+        for (int x = 0; x < propsPerSide; ++x)
+        {
+            auto prop = std::make_shared<PropNode>("Prop_" + std::to_string(x) + "_" + std::to_string(z), propModel, mainShader);
+            prop->SetStatic(true);
+            prop->impostor = propImpostor;
+            prop->GetTransform().SetPosition(glm::vec3(x * spacing - offset, 0.0f, z * spacing - offset));
+
+            if (!AddChild(prop)) return false;
+
+            builder.Add(prop, propModel, prop->GetTransform().GetWorldMatrix());
+        }
+    }
+
+    hlod = builder.Build();
+
+    return true;
+}
+
+void PropFieldNode::OnDestroy()
+{
+    hlod.reset();
+    mainShader.reset();
+    propModel.reset();
+    propImpostor.reset();
+}
+
+void PropFieldNode::OnUpdate()
+{
+    auto camera = engine->GetRenderer()->GetCamera();
+    if (hlod && camera)
+        hlod->Update(camera->transform.GetWorldPosition());
+}
+
+void PropFieldNode::OnRender()
+{
+    if (hlod)
+        hlod->Submit(engine->GetRenderer(), mainShader.get());
+}
+
+void PropNode::OnDestroy()
+{
+    model.reset();
+    mainShader.reset();
+    impostor.reset();
+}
+
+void PropNode::OnRender()
+{
+    AE::Renderer* renderer = engine->GetRenderer();
+    auto camera = renderer->GetCamera();
+
+    if (impostor && camera && glm::distance(camera->transform.GetWorldPosition(), transform.GetWorldPosition()) > impostorDistance)
+        renderer->SubmitImpostor(impostor.get(), transform.GetWorldMatrix());
+    else
+        renderer->SubmitModel(model.get(), mainShader.get(), transform.GetWorldMatrix(), &cullCache);
+}
\ No newline at end of file
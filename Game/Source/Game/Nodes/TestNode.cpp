@@ -5,6 +5,10 @@
 #include <AE/Resources/Shader.hpp>
 #include <AE/Resources/Model.hpp>
 #include <AE/Resources/Managers.hpp>
+#include <AE/World/PVS.hpp>
+#include <AE/World/BakedLighting.hpp>
+
+#include <filesystem>
 
 bool TestNode::OnInitialize()
 {
@@ -14,11 +18,23 @@ bool TestNode::OnInitialize()
     mainShader = shaderMgr->Get("Main");
     if (!mainShader) return false;
 
+    // LightBaker writes a copy of the level with lightmap coordinates, drawn with the lighting baked for it.
+    const bool hasBakedLighting = std::filesystem::exists("Assets/Models/SponzaAtrium3.lightmapped.glb")
+        && std::filesystem::exists("Assets/Models/SponzaAtrium3.lightmap");
+
     testModel = modelMgr->Load("SponzaAtrium",
-        "Assets/Models/SponzaAtrium3.glb"
+        hasBakedLighting ? "Assets/Models/SponzaAtrium3.lightmapped.glb" : "Assets/Models/SponzaAtrium3.glb",
+        IsStatic()
     );
 
     if (!testModel) return false;
+
+    // Baked by PVSBaker in level space, which matches world space as long as the node isn't moved.
+    if (std::filesystem::exists("Assets/Models/SponzaAtrium3.pvs"))
+        engine->GetRenderer()->SetPVS(AE::PVS::Load("Assets/Models/SponzaAtrium3.pvs"));
+
+    if (hasBakedLighting)
+        engine->GetRenderer()->SetBakedLighting(AE::BakedLighting::Load("Assets/Models/SponzaAtrium3.lightmap"));
     
     return true;
 }
@@ -27,13 +43,17 @@ void TestNode::OnDestroy()
 {
     mainShader.reset();
     testModel.reset();
+
+    engine->GetRenderer()->SetPVS(nullptr);
+    engine->GetRenderer()->SetBakedLighting(nullptr);
 }
 
 void TestNode::OnRender()
 {
     AE::Renderer* renderer = engine->GetRenderer();
     
-    renderer->SubmitModel(testModel.get(), mainShader.get(), transform.GetWorldMatrix());
+    renderer->SubmitModel(testModel.get(), mainShader.get(), transform.GetWorldMatrix(), &cullCache);
+    renderer->SubmitShadowCaster(testModel.get(), transform.GetWorldMatrix(), IsStatic());
 }
 
 void TestNode::OnUpdate()
@@ -0,0 +1,123 @@
+// Offline impostor bake for far-away props:
+//   ImpostorBaker <model> [--frames 8] [--resolution 128] [--shaders Assets/Shaders] [--output <model>.impostor]
+// Renders through a hidden window's GL context, nothing is shown. The impostor is written next to the
+// model by default, where the game looks for it.
+
+#include <AE/Rendering/Impostor.hpp>
+#include <AE/Resources/Model.hpp>
+#include <AE/Resources/Shader.hpp>
+#include <AE/Resources/Managers.hpp>
+#include <AE/Core/Logger.hpp>
+
+#include <SDL3/SDL.h>
+
+#include <filesystem>
+
+// The managers free their GL objects when destroyed, so they live in here, inside the context's lifetime.
+static bool Bake(const std::string& modelPath, const std::string& shaderDirectory, const std::string& outputPath,
+    const AE::ImpostorBaker::Settings& settings)
+{
+    AE::LoggerContext ctx("ImpostorBaker", "Bake");
+
+    AE::ShaderManager shaderMgr;
+    AE::TextureManager textureMgr;
+    AE::ModelManager modelMgr(&textureMgr);
+
+    auto shader = shaderMgr.LoadPermutations("ImpostorBake",
+        (std::filesystem::path(shaderDirectory) / "Main.vert").string(),
+        (std::filesystem::path(shaderDirectory) / "ImpostorBake.frag").string()
+    );
+
+    if (!shader)
+    {
+        AE::Logger::Error("Failed to load the bake shader from '{}'", shaderDirectory);
+        return false;
+    }
+
+    auto model = modelMgr.Load("Model", modelPath);
+    if (!model)
+        return false;
+
+    AE::ImpostorBaker baker(settings);
+    auto impostor = baker.Bake(*model, shader.get(), &shaderMgr);
+
+    return impostor && impostor->Save(outputPath);
+}
+
+int main(int argc, char* argv[])
+{
+    AE::LoggerContext ctx("ImpostorBaker", "main");
+
+    if (argc < 2)
+    {
+        AE::Logger::Error("Usage: ImpostorBaker <model> [--frames 8] [--resolution 128] [--shaders <dir>] [--output <path>]");
+        return 1;
+    }
+
+    const std::string modelPath = argv[1];
+    std::string outputPath = std::filesystem::path(modelPath).replace_extension(".impostor").string();
+    std::string shaderDirectory = "Assets/Shaders";
+
+    AE::ImpostorBaker::Settings settings;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+
+        if (i + 1 >= argc)
+        {
+            AE::Logger::Error("Missing value for '{}'", option);
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+
+        if (option == "--frames")
+            settings.framesPerSide = std::stoi(value);
+        else if (option == "--resolution")
+            settings.frameResolution = std::stoi(value);
+        else if (option == "--shaders")
+            shaderDirectory = value;
+        else if (option == "--output")
+            outputPath = value;
+        else
+        {
+            AE::Logger::Error("Unknown option '{}'", option);
+            return 1;
+        }
+    }
+
+    if (!SDL_Init(SDL_INIT_VIDEO))
+    {
+        AE::Logger::Error("Failed to initialize SDL: {}", SDL_GetError());
+        return 1;
+    }
+
+    // Same context as the engine's, the bake draws into its own framebuffer only.
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+    SDL_Window* window = SDL_CreateWindow("ImpostorBaker", 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    SDL_GLContext context = window ? SDL_GL_CreateContext(window) : nullptr;
+
+    bool success = false;
+
+    if (!context)
+        AE::Logger::Error("Failed to create a GL context: {}", SDL_GetError());
+    else if (!gladLoadGL((GLADloadfunc)SDL_GL_GetProcAddress))
+        AE::Logger::Error("GLAD initialization failed!");
+    else
+        success = Bake(modelPath, shaderDirectory, outputPath, settings);
+
+    if (context) SDL_GL_DestroyContext(context);
+    if (window) SDL_DestroyWindow(window);
+    SDL_Quit();
+
+    if (!success)
+        return 1;
+
+    AE::Logger::Info("Wrote '{}'", outputPath);
+
+    return 0;
+}
\ No newline at end of file
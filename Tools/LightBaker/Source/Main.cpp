@@ -0,0 +1,360 @@
+// Offline lightmap and light probe bake for static levels:
+//   LightBaker <level> [--texels-per-unit 4] [--max-size 2048] [--samples 128] [--bounces 2] [--probe-spacing 2]
+//              [--sky r,g,b] [--sun x,y,z] [--sun-color r,g,b] [--threads 0] [--output <level>.lightmap]
+//              [--export <level>.lightmapped.glb]
+// Bakes the lights of the level file, plus the sun if given. The lightmap coordinates are generated
+// here, so the level is exported again with them in its second UV channel; the game draws that
+// copy with the baked lighting written next to it.
+
+#include <AE/World/BakedLighting.hpp>
+#include <AE/Lighting/Sources.hpp>
+#include <AE/Core/Logger.hpp>
+
+#include <assimp/Importer.hpp>
+#include <assimp/Exporter.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <filesystem>
+#include <cstdio>
+
+struct Level
+{
+    std::unique_ptr<aiScene> scene;
+    std::vector<AE::BakedLighting::BakeMesh> meshes; // one per aiMesh, in the same order
+    std::vector<std::unique_ptr<AE::LightSource>> lights;
+};
+
+static glm::mat4 ConvertMatrix(const aiMatrix4x4& m)
+{
+    return glm::mat4(
+        m.a1, m.b1, m.c1, m.d1,
+        m.a2, m.b2, m.c2, m.d2,
+        m.a3, m.b3, m.c3, m.d3,
+        m.a4, m.b4, m.c4, m.d4
+    );
+}
+
+static glm::mat4 GetGlobalTransform(const aiNode* node)
+{
+    glm::mat4 transform(1.0f);
+    for (; node; node = node->mParent)
+        transform = ConvertMatrix(node->mTransformation) * transform;
+    return transform;
+}
+
+static bool ParseVec3(const std::string& value, glm::vec3& result)
+{
+    return std::sscanf(value.c_str(), "%f,%f,%f", &result.x, &result.y, &result.z) == 3;
+}
+
+// The brightest channel becomes the intensity, the engine's colors stay within [0, 1].
+static void SplitColor(const aiColor3D& color, AE::Color& result, float& intensity)
+{
+    intensity = std::max(color.r, std::max(color.g, color.b));
+    result = intensity > 0.0f ? AE::Color(color.r / intensity, color.g / intensity, color.b / intensity) : AE::Color::Black;
+}
+
+static bool LoadLevel(const std::string& path, Level& level)
+{
+    AE::LoggerContext ctx("LightBaker", "LoadLevel");
+
+    // Pre-transformed vertices put every mesh in level space, the space the game draws the level in.
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path,
+        aiProcess_Triangulate | aiProcess_PreTransformVertices | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals);
+
+    if (!scene || !scene->mRootNode)
+    {
+        AE::Logger::Error("Failed to load level '{}': {}", path, importer.GetErrorString());
+        return false;
+    }
+
+    // Kept to export the level again with its lightmap coordinates.
+    level.scene.reset(importer.GetOrphanedScene());
+    scene = level.scene.get();
+
+    std::size_t triangles = 0;
+    for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
+    {
+        const aiMesh* mesh = scene->mMeshes[m];
+        AE::BakedLighting::BakeMesh& bakeMesh = level.meshes.emplace_back();
+
+        for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+            bakeMesh.positions.emplace_back(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z);
+
+        if (mesh->mNormals)
+        {
+            for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+                bakeMesh.normals.emplace_back(mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z);
+        }
+
+        for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
+        {
+            const aiFace& face = mesh->mFaces[f];
+            if (face.mNumIndices != 3) continue;
+
+            bakeMesh.indices.insert(bakeMesh.indices.end(), face.mIndices, face.mIndices + 3);
+        }
+        triangles += bakeMesh.indices.size() / 3;
+
+        // Textures aren't sampled, a textured surface is taken as a mid-grey of its color.
+        if (mesh->mMaterialIndex < scene->mNumMaterials)
+        {
+            const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+
+            aiColor3D diffuse(0.8f, 0.8f, 0.8f);
+            material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse);
+
+            glm::vec3 albedo(diffuse.r, diffuse.g, diffuse.b);
+            if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0)
+                albedo *= 0.5f;
+
+            bakeMesh.albedo = glm::min(albedo, glm::vec3(0.9f));
+        }
+    }
+
+    for (unsigned int l = 0; l < scene->mNumLights; ++l)
+    {
+        const aiLight* light = scene->mLights[l];
+        const glm::mat4 transform = GetGlobalTransform(scene->mRootNode->FindNode(light->mName));
+
+        const glm::vec3 position = glm::vec3(transform * glm::vec4(light->mPosition.x, light->mPosition.y, light->mPosition.z, 1.0f));
+        glm::vec3 direction = glm::vec3(transform * glm::vec4(light->mDirection.x, light->mDirection.y, light->mDirection.z, 0.0f));
+        direction = glm::dot(direction, direction) > 0.0f ? glm::normalize(direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+
+        AE::Color color = AE::Color::White;
+        float intensity;
+        SplitColor(light->mColorDiffuse, color, intensity);
+
+        // The engine's falloff needs a constant term, or lights blow up at their position.
+        const float constant = std::max(light->mAttenuationConstant, 1.0f);
+
+        switch (light->mType)
+        {
+        case aiLightSource_DIRECTIONAL:
+            level.lights.push_back(std::make_unique<AE::DirectionalLight>(color, intensity, direction));
+            break;
+        case aiLightSource_POINT:
+            level.lights.push_back(std::make_unique<AE::PointLight>(color, intensity, position,
+                constant, light->mAttenuationLinear, light->mAttenuationQuadratic));
+            break;
+        case aiLightSource_SPOT:
+            // Cone angles are full angles, the cutoffs cosines of half of them.
+            level.lights.push_back(std::make_unique<AE::SpotLight>(color, intensity, position, direction,
+                std::cos(light->mAngleInnerCone * 0.5f), std::cos(light->mAngleOuterCone * 0.5f),
+                constant, light->mAttenuationLinear, light->mAttenuationQuadratic));
+            break;
+        default:
+            AE::Logger::Warning("Skipping light '{}' of unsupported type", light->mName.C_Str());
+            break;
+        }
+    }
+
+    AE::Logger::Info("Loaded '{}': {} meshes, {} triangles, {} lights", path, level.meshes.size(), triangles, level.lights.size());
+
+    return triangles > 0;
+}
+
+template<typename T>
+static void RemapArray(T*& data, const std::vector<uint32_t>& sources)
+{
+    if (!data) return;
+
+    T* remapped = new T[sources.size()];
+    for (std::size_t i = 0; i < sources.size(); ++i)
+        remapped[i] = data[sources[i]];
+
+    delete[] data;
+    data = remapped;
+}
+
+// Rebuilds the meshes with the vertices the bake split, and writes the lightmap coordinates to UV channel 1.
+static bool ExportLevel(const std::string& path, Level& level)
+{
+    AE::LoggerContext ctx("LightBaker", "ExportLevel");
+
+    aiScene* scene = level.scene.get();
+
+    for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
+    {
+        aiMesh* mesh = scene->mMeshes[m];
+        const AE::BakedLighting::BakeMesh& bakeMesh = level.meshes[m];
+        const std::vector<uint32_t>& sources = bakeMesh.sourceVertices;
+
+        RemapArray(mesh->mVertices, sources);
+        RemapArray(mesh->mNormals, sources);
+        RemapArray(mesh->mTangents, sources);
+        RemapArray(mesh->mBitangents, sources);
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c)
+            RemapArray(mesh->mColors[c], sources);
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c)
+            RemapArray(mesh->mTextureCoords[c], sources);
+
+        mesh->mNumVertices = static_cast<unsigned int>(sources.size());
+
+        // Channels have to be contiguous for the exporters.
+        if (!mesh->mTextureCoords[0])
+        {
+            mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+            mesh->mNumUVComponents[0] = 2;
+        }
+
+        // The game loads with flipped UVs, v = 0 has to end up at the first lightmap row.
+        delete[] mesh->mTextureCoords[1];
+        mesh->mTextureCoords[1] = new aiVector3D[mesh->mNumVertices];
+        mesh->mNumUVComponents[1] = 2;
+        for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+        {
+            const glm::vec2& texCoord = bakeMesh.lightmapTexCoords[v];
+            mesh->mTextureCoords[1][v] = aiVector3D(texCoord.x, 1.0f - texCoord.y, 0.0f);
+        }
+
+        delete[] mesh->mFaces;
+        mesh->mNumFaces = static_cast<unsigned int>(bakeMesh.indices.size() / 3);
+        mesh->mFaces = new aiFace[mesh->mNumFaces];
+        for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
+        {
+            mesh->mFaces[f].mNumIndices = 3;
+            mesh->mFaces[f].mIndices = new unsigned int[3];
+            std::copy_n(bakeMesh.indices.begin() + f * 3, 3, mesh->mFaces[f].mIndices);
+        }
+
+        mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+    }
+
+    const std::string extension = std::filesystem::path(path).extension().string();
+
+    Assimp::Exporter exporter;
+    std::string format;
+    if (extension == ".glb")
+        format = "glb2";
+    else if (extension == ".gltf")
+        format = "gltf2";
+    else
+    {
+        for (std::size_t i = 0; i < exporter.GetExportFormatCount(); ++i)
+        {
+            const aiExportFormatDesc* description = exporter.GetExportFormatDescription(i);
+            if (extension == std::string(".") + description->fileExtension)
+            {
+                format = description->id;
+                break;
+            }
+        }
+    }
+
+    if (format.empty())
+    {
+        AE::Logger::Error("No exporter for '{}'", path);
+        return false;
+    }
+
+    if (exporter.Export(scene, format, path) != aiReturn_SUCCESS)
+    {
+        AE::Logger::Error("Failed to export '{}': {}", path, exporter.GetErrorString());
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    AE::LoggerContext ctx("LightBaker", "main");
+
+    if (argc < 2)
+    {
+        AE::Logger::Error("Usage: LightBaker <level> [--texels-per-unit 4] [--max-size 2048] [--samples 128] [--bounces 2] "
+            "[--probe-spacing 2] [--sky r,g,b] [--sun x,y,z] [--sun-color r,g,b] [--threads 0] [--output <path>] [--export <path>]");
+        return 1;
+    }
+
+    const std::string levelPath = argv[1];
+    std::filesystem::path basePath = std::filesystem::path(levelPath);
+    std::string outputPath = std::filesystem::path(basePath).replace_extension(".lightmap").string();
+    std::string exportPath = std::filesystem::path(basePath).replace_extension(".lightmapped" + basePath.extension().string()).string();
+
+    AE::BakedLighting::BakeSettings settings;
+    bool hasSun = false;
+    glm::vec3 sunDirection(0.0f, -1.0f, 0.0f);
+    glm::vec3 sunColor(1.0f);
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+
+        if (i + 1 >= argc)
+        {
+            AE::Logger::Error("Missing value for '{}'", option);
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        bool valid = true;
+
+        if (option == "--texels-per-unit")
+            settings.texelsPerUnit = std::stof(value);
+        else if (option == "--max-size")
+            settings.maxLightmapSize = std::stoi(value);
+        else if (option == "--samples")
+            settings.samples = std::stoi(value);
+        else if (option == "--bounces")
+            settings.bounces = std::stoi(value);
+        else if (option == "--probe-spacing")
+            settings.probeSpacing = std::stof(value);
+        else if (option == "--sky")
+            valid = ParseVec3(value, settings.skyColor);
+        else if (option == "--sun")
+            valid = hasSun = ParseVec3(value, sunDirection);
+        else if (option == "--sun-color")
+            valid = ParseVec3(value, sunColor);
+        else if (option == "--threads")
+            settings.threads = std::stoi(value);
+        else if (option == "--output")
+            outputPath = value;
+        else if (option == "--export")
+            exportPath = value;
+        else
+        {
+            AE::Logger::Error("Unknown option '{}'", option);
+            return 1;
+        }
+
+        if (!valid)
+        {
+            AE::Logger::Error("Expected x,y,z for '{}', got '{}'", option, value);
+            return 1;
+        }
+    }
+
+    Level level;
+    if (!LoadLevel(levelPath, level))
+        return 1;
+
+    // Same as the light the game adds, which has to be marked baked to not be lit twice.
+    if (hasSun && glm::dot(sunDirection, sunDirection) > 0.0f)
+    {
+        AE::Color color = AE::Color::White;
+        float intensity;
+        SplitColor(aiColor3D(sunColor.x, sunColor.y, sunColor.z), color, intensity);
+        level.lights.push_back(std::make_unique<AE::DirectionalLight>(color, intensity, glm::normalize(sunDirection)));
+    }
+
+    std::vector<AE::LightSource*> lights;
+    for (const auto& light : level.lights)
+        lights.push_back(light.get());
+
+    auto lighting = AE::BakedLighting::Bake(level.meshes, lights, settings);
+    if (!lighting || !lighting->Save(outputPath))
+        return 1;
+
+    AE::Logger::Info("Wrote '{}'", outputPath);
+
+    if (!ExportLevel(exportPath, level))
+        return 1;
+
+    AE::Logger::Info("Wrote '{}'", exportPath);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,353 @@
+// Offline PVS bake for static levels:
+//   PVSBaker <level> [--cell-size 4] [--samples 32] [--dilation 1] [--threads 0] [--output <level>.pvs] [--bench <frames>]
+//            [--generate-rooms <n>]
+// The PVS is written next to the level by default, where the game looks for it. --generate-rooms first writes
+// a test level of n x n rooms joined by doorways to <level>, so the bench can be reproduced without assets.
+
+#include <AE/World/PVS.hpp>
+#include <AE/Math/AABB.hpp>
+#include <AE/Math/Frustum.hpp>
+#include <AE/Math/BoundingSphere.hpp>
+#include <AE/Core/Logger.hpp>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+
+struct LevelMesh
+{
+    AE::AABB bounds;
+    AE::BoundingSphere sphere;
+    std::size_t triangles = 0;
+};
+
+struct Level
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    std::vector<LevelMesh> meshes;
+};
+
+static bool LoadLevel(const std::string& path, Level& level)
+{
+    AE::LoggerContext ctx("PVSBaker", "LoadLevel");
+
+    // Pre-transformed vertices put every mesh in level space, the space the game draws the level in.
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path,
+        aiProcess_Triangulate | aiProcess_PreTransformVertices | aiProcess_JoinIdenticalVertices);
+
+    if (!scene || !scene->mRootNode)
+    {
+        AE::Logger::Error("Failed to load level '{}': {}", path, importer.GetErrorString());
+        return false;
+    }
+
+    for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
+    {
+        const aiMesh* mesh = scene->mMeshes[m];
+        const uint32_t base = static_cast<uint32_t>(level.positions.size());
+
+        LevelMesh levelMesh;
+
+        for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+            level.positions.emplace_back(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z);
+
+        for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
+        {
+            const aiFace& face = mesh->mFaces[f];
+            if (face.mNumIndices != 3) continue;
+
+            level.indices.push_back(base + face.mIndices[0]);
+            level.indices.push_back(base + face.mIndices[1]);
+            level.indices.push_back(base + face.mIndices[2]);
+            levelMesh.triangles++;
+        }
+
+        if (mesh->mNumVertices == 0) continue;
+
+        levelMesh.bounds = AE::AABB::FromPoints(std::span<const glm::vec3>(level.positions).subspan(base));
+        levelMesh.sphere = AE::BoundingSphere(levelMesh.bounds.GetCenter(), glm::length(levelMesh.bounds.GetExtents()));
+        level.meshes.push_back(levelMesh);
+    }
+
+    AE::Logger::Info("Loaded '{}': {} meshes, {} triangles", path, level.meshes.size(), level.indices.size() / 3);
+
+    return !level.indices.empty();
+}
+
+// Box from `min` to `max` as 12 outward-facing triangles, vertices are numbered on from `vertexCount`.
+static void WriteBox(std::ostream& file, const glm::vec3& min, const glm::vec3& max, uint32_t& vertexCount)
+{
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        file << "v " << ((corner & 1) ? max.x : min.x) << ' ' << ((corner & 2) ? max.y : min.y) << ' '
+            << ((corner & 4) ? max.z : min.z) << '\n';
+    }
+
+    static const int faces[6][4] = {
+        { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 2, 3, 1 }, { 4, 5, 7, 6 }
+    };
+
+    for (const auto& face : faces)
+    {
+        const uint32_t a = vertexCount + face[0] + 1, b = vertexCount + face[1] + 1;
+        const uint32_t c = vertexCount + face[2] + 1, d = vertexCount + face[3] + 1;
+        file << "f " << a << ' ' << b << ' ' << c << "\nf " << a << ' ' << c << ' ' << d << '\n';
+    }
+
+    vertexCount += 8;
+}
+
+// A grid of 10 x 10 unit rooms with a floor, a ceiling, a pillar and walls. Every inner wall has one
+// doorway, placed off-center in every other room so no sight line runs through the whole level.
+// Each part is its own object with its own material, so the level loads as separate meshes.
+static bool GenerateRooms(const std::string& path, int rooms)
+{
+    AE::LoggerContext ctx("PVSBaker", "GenerateRooms");
+
+    const std::string materialPath = std::filesystem::path(path).replace_extension(".mtl").string();
+
+    std::ofstream file(path, std::ios::trunc);
+    std::ofstream materials(materialPath, std::ios::trunc);
+    if (!file || !materials)
+    {
+        AE::Logger::Error("Failed to open file: '{}'", path);
+        return false;
+    }
+
+    constexpr float RoomSize = 10.0f;
+    constexpr float Height = 4.0f;
+    constexpr float Thickness = 0.4f;
+    constexpr float DoorWidth = 2.0f;
+    constexpr float DoorHeight = 2.5f;
+
+    file << "mtllib " << std::filesystem::path(materialPath).filename().string() << '\n';
+
+    uint32_t vertexCount = 0;
+    std::size_t objects = 0;
+
+    auto BeginObject = [&](const std::string& name)
+    {
+        file << "o " << name << "\nusemtl " << name << '\n';
+        materials << "newmtl " << name << "\nKd 0.8 0.8 0.8\n";
+        objects++;
+    };
+
+    // A wall along x (or z when `alongZ`) from `start`, with a doorway at `door` along it unless negative.
+    auto Wall = [&](const std::string& name, glm::vec2 start, bool alongZ, float door)
+    {
+        BeginObject(name);
+
+        auto Span = [&](float from, float to, float bottom, float top)
+        {
+            const glm::vec3 min = alongZ
+                ? glm::vec3(start.x - Thickness * 0.5f, bottom, start.y + from)
+                : glm::vec3(start.x + from, bottom, start.y - Thickness * 0.5f);
+            const glm::vec3 max = alongZ
+                ? glm::vec3(start.x + Thickness * 0.5f, top, start.y + to)
+                : glm::vec3(start.x + to, top, start.y + Thickness * 0.5f);
+            WriteBox(file, min, max, vertexCount);
+        };
+
+        if (door < 0.0f)
+        {
+            Span(0.0f, RoomSize, 0.0f, Height);
+            return;
+        }
+
+        Span(0.0f, door - DoorWidth * 0.5f, 0.0f, Height);
+        Span(door + DoorWidth * 0.5f, RoomSize, 0.0f, Height);
+        Span(door - DoorWidth * 0.5f, door + DoorWidth * 0.5f, DoorHeight, Height);
+    };
+
+    for (int z = 0; z < rooms; ++z)
+    {
+        for (int x = 0; x < rooms; ++x)
+        {
+            const glm::vec2 origin(static_cast<float>(x) * RoomSize, static_cast<float>(z) * RoomSize);
+            const std::string room = "Room_" + std::to_string(x) + "_" + std::to_string(z);
+            const float door = RoomSize * ((x + z) % 2 == 0 ? 0.25f : 0.75f);
+
+            BeginObject(room + "_Floor");
+            WriteBox(file, glm::vec3(origin.x, -Thickness, origin.y), glm::vec3(origin.x + RoomSize, 0.0f, origin.y + RoomSize), vertexCount);
+
+            BeginObject(room + "_Ceiling");
+            WriteBox(file, glm::vec3(origin.x, Height, origin.y), glm::vec3(origin.x + RoomSize, Height + Thickness, origin.y + RoomSize), vertexCount);
+
+            BeginObject(room + "_Pillar");
+            WriteBox(file, glm::vec3(origin.x + RoomSize * 0.5f - 0.5f, 0.0f, origin.y + RoomSize * 0.5f - 0.5f),
+                glm::vec3(origin.x + RoomSize * 0.5f + 0.5f, 2.0f, origin.y + RoomSize * 0.5f + 0.5f), vertexCount);
+
+            // West and south walls, the outer ones closed.
+            Wall(room + "_West", origin, true, x > 0 ? door : -1.0f);
+            Wall(room + "_South", origin, false, z > 0 ? door : -1.0f);
+        }
+
+        const float edge = static_cast<float>(rooms) * RoomSize;
+        Wall("East_" + std::to_string(z), glm::vec2(edge, static_cast<float>(z) * RoomSize), true, -1.0f);
+        Wall("North_" + std::to_string(z), glm::vec2(static_cast<float>(z) * RoomSize, edge), false, -1.0f);
+    }
+
+    AE::Logger::Info("Wrote '{}': {}x{} rooms, {} meshes, {} triangles", path, rooms, rooms, objects, vertexCount / 8 * 12);
+
+    return true;
+}
+
+// Flies an ellipse around the level at a low height, looking along the path, and compares
+// frustum-only culling of every mesh with rejecting PVS-hidden meshes first.
+static void Benchmark(const Level& level, const AE::PVS& pvs, int frames)
+{
+    AE::LoggerContext ctx("PVSBaker", "Benchmark");
+
+    const AE::AABB& bounds = pvs.GetBounds();
+    const glm::vec3 center = bounds.GetCenter();
+    const glm::vec3 size = bounds.max - bounds.min;
+
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, glm::length(size));
+
+    struct Result
+    {
+        std::size_t meshes = 0;
+        std::size_t triangles = 0;
+        double microseconds = 0.0;
+    } frustumOnly, withPVS;
+
+    std::size_t pvsRejected = 0;
+    std::size_t outsideGrid = 0;
+
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        const float angle = glm::radians(360.0f) * static_cast<float>(frame) / static_cast<float>(frames);
+
+        const glm::vec3 eye(center.x + std::cos(angle) * size.x * 0.35f, bounds.min.y + size.y * 0.2f,
+            center.z + std::sin(angle) * size.z * 0.35f);
+        const glm::vec3 ahead(center.x + std::cos(angle + 0.05f) * size.x * 0.35f, eye.y,
+            center.z + std::sin(angle + 0.05f) * size.z * 0.35f);
+
+        AE::Frustum frustum;
+        frustum.Update(projection * glm::lookAt(eye, ahead, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        auto start = std::chrono::steady_clock::now();
+        for (const LevelMesh& mesh : level.meshes)
+        {
+            if (!frustum.Intersects(mesh.sphere.center, mesh.sphere.radius) || !frustum.Intersects(mesh.bounds))
+                continue;
+
+            frustumOnly.meshes++;
+            frustumOnly.triangles += mesh.triangles;
+        }
+        auto middle = std::chrono::steady_clock::now();
+
+        // Same order as the renderer: only meshes the frustum kept pay for the PVS test.
+        const int cell = pvs.GetCell(eye);
+        for (const LevelMesh& mesh : level.meshes)
+        {
+            if (!frustum.Intersects(mesh.sphere.center, mesh.sphere.radius) || !frustum.Intersects(mesh.bounds))
+                continue;
+
+            if (!pvs.IsVisible(cell, mesh.bounds))
+            {
+                pvsRejected++;
+                continue;
+            }
+
+            withPVS.meshes++;
+            withPVS.triangles += mesh.triangles;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        frustumOnly.microseconds += std::chrono::duration<double, std::micro>(middle - start).count();
+        withPVS.microseconds += std::chrono::duration<double, std::micro>(end - middle).count();
+
+        if (cell < 0)
+            outsideGrid++;
+    }
+
+    const double n = static_cast<double>(frames);
+
+    AE::Logger::Info("Flythrough of {} frames, {} meshes ({} frames outside the grid):", frames, level.meshes.size(), outsideGrid);
+    AE::Logger::Info("  frustum only: {:.1f} meshes, {:.0f} triangles, {:.2f} us per frame",
+        frustumOnly.meshes / n, frustumOnly.triangles / n, frustumOnly.microseconds / n);
+    AE::Logger::Info("  frustum + PVS: {:.1f} meshes, {:.0f} triangles, {:.2f} us per frame ({:.1f} meshes rejected by the PVS)",
+        withPVS.meshes / n, withPVS.triangles / n, withPVS.microseconds / n, pvsRejected / n);
+
+    if (frustumOnly.triangles > 0)
+        AE::Logger::Info("  triangles submitted: {:.1f}% of frustum only",
+            100.0 * static_cast<double>(withPVS.triangles) / static_cast<double>(frustumOnly.triangles));
+}
+
+int main(int argc, char* argv[])
+{
+    AE::LoggerContext ctx("PVSBaker", "main");
+
+    if (argc < 2)
+    {
+        AE::Logger::Error("Usage: PVSBaker <level> [--cell-size 4] [--samples 32] [--dilation 1] [--threads 0] [--output <path>] [--bench <frames>] [--generate-rooms <n>]");
+        return 1;
+    }
+
+    const std::string levelPath = argv[1];
+    std::string outputPath = std::filesystem::path(levelPath).replace_extension(".pvs").string();
+
+    AE::PVS::BakeSettings settings;
+    int benchFrames = 0;
+    int generateRooms = 0;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+
+        if (i + 1 >= argc)
+        {
+            AE::Logger::Error("Missing value for '{}'", option);
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+
+        if (option == "--cell-size")
+            settings.cellSize = std::stof(value);
+        else if (option == "--samples")
+            settings.samples = std::stoi(value);
+        else if (option == "--dilation")
+            settings.dilation = std::stoi(value);
+        else if (option == "--threads")
+            settings.threads = std::stoi(value);
+        else if (option == "--output")
+            outputPath = value;
+        else if (option == "--bench")
+            benchFrames = std::stoi(value);
+        else if (option == "--generate-rooms")
+            generateRooms = std::stoi(value);
+        else
+        {
+            AE::Logger::Error("Unknown option '{}'", option);
+            return 1;
+        }
+    }
+
+    if (generateRooms > 0 && !GenerateRooms(levelPath, generateRooms))
+        return 1;
+
+    Level level;
+    if (!LoadLevel(levelPath, level))
+        return 1;
+
+    auto pvs = AE::PVS::Bake(level.positions, level.indices, settings);
+    if (!pvs || !pvs->Save(outputPath))
+        return 1;
+
+    AE::Logger::Info("Wrote '{}'", outputPath);
+
+    if (benchFrames > 0)
+        Benchmark(level, *pvs, benchFrames);
+
+    return 0;
+}
\ No newline at end of file